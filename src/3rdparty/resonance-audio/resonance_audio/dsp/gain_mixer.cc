@@ -70,6 +70,36 @@ void GainMixer::AddInputChannel(const AudioBuffer::Channel& input,
   is_empty_ = false;
 }
 
+void GainMixer::AddInputChannels(const std::vector<const AudioBuffer*>& inputs,
+                                 const std::vector<std::vector<float>>& gains,
+                                 TaskThreadPool* thread_pool) {
+  DCHECK_LE(inputs.size(), gains.size());
+  if (inputs.empty()) {
+    return;
+  }
+
+  // Look up the processors up front, this is not thread safe.
+  input_processors_.resize(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    input_processors_[i] = GetOrCreateProcessors(inputs[i]->source_id());
+  }
+
+  const auto mix_channel = [this, &inputs, &gains](size_t channel) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      const AudioBuffer::Channel& input = (*inputs[i])[0];
+      GainProcessor& processor = (*input_processors_[i])[channel];
+      if (input.IsEnabled()) {
+        processor.ApplyGain(gains[i][channel], input, &output_[channel],
+                            true /* accumulate_output */);
+      } else {
+        processor.Reset(gains[i][channel]);
+      }
+    }
+  };
+  thread_pool->ParallelFor(num_channels_, std::cref(mix_channel));
+  is_empty_ = false;
+}
+
 const AudioBuffer* GainMixer::GetOutput() const {
   if (is_empty_) {
     return nullptr;
@@ -24,6 +24,7 @@ limitations under the License.
 #include "base/audio_buffer.h"
 #include "base/constants_and_types.h"
 #include "dsp/gain_processor.h"
+#include "utils/task_thread_pool.h"
 
 namespace vraudio {
 
@@ -49,6 +50,18 @@ class GainMixer {
   void AddInputChannel(const AudioBuffer::Channel& input, SourceId source_id,
                        const std::vector<float>& gains);
 
+  // Equivalent to calling |AddInputChannel| for the first channel of each of
+  // the |inputs| in order, but processes the output channels in parallel on
+  // |thread_pool|.
+  //
+  // @param inputs Input buffers to be added.
+  // @param gains Gains to be applied per input, each equal in length to the
+  //     number of channels in the output buffer.
+  // @param thread_pool Worker threads to use.
+  void AddInputChannels(const std::vector<const AudioBuffer*>& inputs,
+                        const std::vector<std::vector<float>>& gains,
+                        TaskThreadPool* thread_pool);
+
   // Returns a pointer to the accumulator.
   //
   // @return Pointer to the processed (mixed) output buffer, or nullptr if no
@@ -89,6 +102,9 @@ class GainMixer {
 
   // Scale and accumulation processors, one per channel for each source.
   std::unordered_map<SourceId, GainProcessors> source_gain_processors_;
+
+  // Processors of the inputs passed to |AddInputChannels|.
+  std::vector<std::vector<GainProcessor>*> input_processors_;
 };
 
 }  // namespace vraudio
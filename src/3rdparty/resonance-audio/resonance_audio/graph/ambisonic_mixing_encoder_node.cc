@@ -31,7 +31,12 @@ AmbisonicMixingEncoderNode::AmbisonicMixingEncoderNode(
       ambisonic_order_(ambisonic_order),
       gain_mixer_(GetNumPeriphonicComponents(ambisonic_order_),
                   system_settings_.GetFramesPerBuffer()),
-      coefficients_(GetNumPeriphonicComponents(ambisonic_order_)) {}
+      coefficients_(GetNumPeriphonicComponents(ambisonic_order_)),
+      thread_pool_(nullptr) {}
+
+void AmbisonicMixingEncoderNode::SetThreadPool(TaskThreadPool* thread_pool) {
+  thread_pool_ = thread_pool;
+}
 
 const AudioBuffer* AmbisonicMixingEncoderNode::AudioProcess(
     const NodeInput& input) {
@@ -41,7 +46,14 @@ const AudioBuffer* AmbisonicMixingEncoderNode::AudioProcess(
   const WorldRotation& listener_rotation = system_settings_.GetHeadRotation();
 
   gain_mixer_.Reset();
-  for (auto& input_buffer : input.GetInputBuffers()) {
+  const auto& input_buffers = input.GetInputBuffers();
+  const bool parallel = thread_pool_ != nullptr && input_buffers.size() > 1;
+  if (parallel && input_coefficients_.size() < input_buffers.size()) {
+    input_coefficients_.resize(input_buffers.size(), coefficients_);
+  }
+
+  for (size_t i = 0; i < input_buffers.size(); ++i) {
+    const AudioBuffer* input_buffer = input_buffers[i];
     const int source_id = input_buffer->source_id();
     const auto source_parameters =
         system_settings_.GetSourceParameters(source_id);
@@ -57,11 +69,24 @@ const AudioBuffer* AmbisonicMixingEncoderNode::AudioProcess(
     const SphericalAngle source_direction =
         SphericalAngle::FromWorldPosition(relative_direction);
 
+    std::vector<float>* coefficients =
+        parallel ? &input_coefficients_[i] : &coefficients_;
     lookup_table_.GetEncodingCoeffs(ambisonic_order_, source_direction,
                                     source_parameters->spread_deg,
-                                    &coefficients_);
+                                    coefficients);
+
+    if (!parallel) {
+      gain_mixer_.AddInputChannel((*input_buffer)[0], source_id,
+                                  *coefficients);
+    }
+  }
 
-    gain_mixer_.AddInputChannel((*input_buffer)[0], source_id, coefficients_);
+  if (parallel) {
+    // Each worker accumulates a subset of the Ambisonic channels, adding the
+    // inputs in the same order as above. The result is identical to encoding
+    // on a single thread.
+    gain_mixer_.AddInputChannels(input_buffers, input_coefficients_,
+                                 thread_pool_);
   }
   return gain_mixer_.GetOutput();
 }
@@ -25,6 +25,7 @@ limitations under the License.
 #include "dsp/gain_mixer.h"
 #include "graph/system_settings.h"
 #include "node/processing_node.h"
+#include "utils/task_thread_pool.h"
 
 namespace vraudio {
 
@@ -41,6 +42,12 @@ class AmbisonicMixingEncoderNode : public ProcessingNode {
                              const AmbisonicLookupTable& lookup_table,
                              int ambisonic_order);
 
+  // Distributes the encoding of the Ambisonic channels over |thread_pool|.
+  // Pass nullptr to encode on the audio thread only.
+  //
+  // @param thread_pool Worker threads to use, must outlive this node.
+  void SetThreadPool(TaskThreadPool* thread_pool);
+
   // Node implementation.
   bool CleanUp() final {
     CallCleanUpOnInputNodes();
@@ -64,6 +71,12 @@ class AmbisonicMixingEncoderNode : public ProcessingNode {
 
   // Encoding coefficient values to be applied to encode the input.
   std::vector<float> coefficients_;
+
+  // Optional worker threads.
+  TaskThreadPool* thread_pool_;
+
+  // Encoding coefficients for each input when encoding on |thread_pool_|.
+  std::vector<std::vector<float>> input_coefficients_;
 };
 
 }  // namespace vraudio
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "graph/graph_manager.h"
 
+#include <algorithm>
 #include <functional>
 
 #include "ambisonics/utils.h"
@@ -138,6 +139,9 @@ void GraphManager::CreateSoundObjectSource(SourceId sound_object_source_id,
 
     near_field_effect_node->Connect(occlusion_node);
     stereo_mixer_node_->Connect(near_field_effect_node);
+
+    source_direct_nodes_[sound_object_source_id] = near_field_effect_node;
+    parallel_nodes_.push_back(near_field_effect_node.get());
   }
 
   // Connect to room effects rendering pipeline.
@@ -243,16 +247,49 @@ void GraphManager::DestroySource(SourceId source_id) {
     output_node_->CleanUp();
     // Unregister the source from |source_nodes_|.
     source_nodes_.erase(source_id);
+
+    auto direct_node = source_direct_nodes_.find(source_id);
+    if (direct_node != source_direct_nodes_.end()) {
+      parallel_nodes_.erase(std::find(parallel_nodes_.begin(),
+                                      parallel_nodes_.end(),
+                                      direct_node->second.get()));
+      source_direct_nodes_.erase(direct_node);
+    }
   }
 }
 
 std::shared_ptr<SinkNode> GraphManager::GetSinkNode() { return output_node_; }
 
 void GraphManager::Process() {
+  if (thread_pool_ != nullptr && parallel_nodes_.size() > 1) {
+    // Process the per source chains up front. Their output stays buffered in
+    // the node outputs, so reading the graph below picks it up without
+    // processing them again, and mixes it in the usual order.
+    thread_pool_->ParallelFor(parallel_nodes_.size(), [this](size_t index) {
+      parallel_nodes_[index]->Process();
+    });
+  }
 
   output_node_->ReadInputs();
 }
 
+void GraphManager::SetNumWorkerThreads(size_t num_threads,
+                                       std::function<void()> thread_init) {
+  TaskThreadPool* thread_pool = nullptr;
+  if (num_threads > 0) {
+    thread_pool_.reset(new TaskThreadPool());
+    if (thread_pool_->StartThreadPool(num_threads, std::move(thread_init))) {
+      thread_pool = thread_pool_.get();
+    }
+  }
+  for (auto& encoder_node : ambisonic_mixing_encoder_nodes_) {
+    encoder_node.second->SetThreadPool(thread_pool);
+  }
+  if (thread_pool == nullptr) {
+    thread_pool_.reset();
+  }
+}
+
 AudioBuffer* GraphManager::GetMutableAudioBuffer(SourceId source_id) {
   auto source_node = LookupSourceNode(source_id);
   if (source_node == nullptr) {
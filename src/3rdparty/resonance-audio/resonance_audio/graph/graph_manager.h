@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef RESONANCE_AUDIO_GRAPH_GRAPH_MANAGER_H_
 #define RESONANCE_AUDIO_GRAPH_GRAPH_MANAGER_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -37,6 +38,7 @@ limitations under the License.
 #include "graph/stereo_mixing_panner_node.h"
 #include "graph/system_settings.h"
 #include "node/sink_node.h"
+#include "utils/task_thread_pool.h"
 
 namespace vraudio {
 
@@ -58,6 +60,17 @@ class GraphManager {
   // Triggers processing of the audio graph for all the connected nodes.
   void Process();
 
+  // Processes the nodes belonging to a single sound object source, and the
+  // Ambisonic encoding of all sources, on |num_threads| worker threads in
+  // addition to the audio thread. The output is identical to processing on a
+  // single thread. Must not be called while the graph is being processed.
+  //
+  // @param num_threads Number of worker threads, 0 disables the workers.
+  // @param thread_init Called first thing in every worker thread, for example
+  //     to give it the priority of the audio thread. May be empty.
+  void SetNumWorkerThreads(size_t num_threads,
+                           std::function<void()> thread_init);
+
   // Returns a mutable pointer to the |AudioBuffer| of an audio source with
   // given |source_id|. Calls to this method must be synchronized with the audio
   // graph processing.
@@ -397,6 +410,17 @@ class GraphManager {
   // allows look up by id.
   std::unordered_map<SourceId, std::shared_ptr<BufferedSourceNode>>
       source_nodes_;
+
+  // Worker threads, or nullptr if the graph is processed on a single thread.
+  std::unique_ptr<TaskThreadPool> thread_pool_;
+
+  // Last node of each source's direct rendering path. Processing it pulls
+  // the whole per source chain (source, attenuation, occlusion and near
+  // field), which does not share any state with other sources.
+  std::unordered_map<SourceId, std::shared_ptr<Node>> source_direct_nodes_;
+
+  // Flat copy of |source_direct_nodes_| for index based access from workers.
+  std::vector<Node*> parallel_nodes_;
 };
 
 }  // namespace vraudio
@@ -455,6 +455,11 @@ const AudioBuffer *ResonanceAudioApiImpl::GetReverbBuffer() const {
     return graph_manager_->GetReverbBuffer();
 }
 
+void ResonanceAudioApiImpl::SetNumWorkerThreads(
+    size_t num_threads, std::function<void()> thread_init) {
+  graph_manager_->SetNumWorkerThreads(num_threads, std::move(thread_init));
+}
+
 void ResonanceAudioApiImpl::ProcessNextBuffer() {
 #if defined(ENABLE_TRACING) && !ION_PRODUCTION
   // This enables tracing on the audio thread.
@@ -18,6 +18,7 @@ limitations under the License.
 #define RESONANCE_AUDIO_GRAPH_RESONANCE_AUDIO_API_IMPL_H_
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -132,6 +133,16 @@ class ResonanceAudioApiImpl : public ResonanceAudioApi {
   // Triggers processing of the audio graph with the updated system properties.
   void ProcessNextBuffer();
 
+  // Sets the number of worker threads used in addition to the audio thread to
+  // process the audio graph. 0 processes everything on the audio thread.
+  // Starting the threads blocks, so this is applied directly instead of on the
+  // audio thread, and must be called before processing starts.
+  //
+  // @param num_threads Number of worker threads.
+  // @param thread_init Called first thing in every worker thread. May be empty.
+  void SetNumWorkerThreads(size_t num_threads,
+                           std::function<void()> thread_init);
+
  private:
   // This method triggers the processing of the audio graph and outputs a
   // binaural stereo output buffer.
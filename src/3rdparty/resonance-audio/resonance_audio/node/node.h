@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef RESONANCE_AUDIO_NODE_NODE_H_
 #define RESONANCE_AUDIO_NODE_NODE_H_
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -105,6 +106,9 @@ class Node : public std::enable_shared_from_this<Node> {
     void RemoveOutput(Output<T>* output);
 
     OutputNodeMap outputs_;
+    // Connected outputs in the order they were connected. |Read| pulls in
+    // this order, so that mixing results do not depend on pointer values.
+    std::vector<Output<T>*> connection_order_;
     std::vector<T> read_data_;
   };
 
@@ -160,9 +164,9 @@ template <class T>
 const std::vector<T>& Node::Input<T>::Read() {
   read_data_.clear();
 
-  for (auto& o : outputs_) {
+  for (Output<T>* output : connection_order_) {
     // Obtain processed data.
-    T processed_data = o.first->PullData();
+    T processed_data = output->PullData();
     if (processed_data != nullptr) {
       read_data_.emplace_back(std::move(processed_data));
     }
@@ -200,6 +204,9 @@ Node::Input<T>::GetConnectedNodeOutputPairs() {
 template <class T>
 void Node::Input<T>::AddOutput(const std::shared_ptr<Node>& node,
                                Output<T>* output) {
+  if (outputs_.find(output) == outputs_.end()) {
+    connection_order_.push_back(output);
+  }
   outputs_[output] = node;
 
   DCHECK(outputs_.find(output) != outputs_.end());
@@ -207,6 +214,9 @@ void Node::Input<T>::AddOutput(const std::shared_ptr<Node>& node,
 
 template <class T>
 void Node::Input<T>::RemoveOutput(Output<T>* output) {
+  connection_order_.erase(
+      std::remove(connection_order_.begin(), connection_order_.end(), output),
+      connection_order_.end());
   outputs_.erase(output);
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "utils/task_thread_pool.h"
 
+#include <algorithm>
 #include <thread>
 
 #include "base/integral_types.h"
@@ -23,6 +24,21 @@ limitations under the License.
 
 namespace vraudio {
 
+namespace {
+
+enum ParallelForSlotState : uint64_t {
+  kSlotPending = 0,
+  kSlotRunning = 1,
+  kSlotDone = 2,
+  kSlotClosed = 3,
+};
+
+uint64_t SlotValue(uint64_t generation, ParallelForSlotState state) {
+  return (generation << 2) | state;
+}
+
+}  // namespace
+
 // A simple worker thread wrapper, to be used by TaskThreadPool.
 class TaskThreadPool::WorkerThread {
  public:
@@ -95,10 +111,17 @@ TaskThreadPool::TaskThreadPool()
 
 TaskThreadPool::~TaskThreadPool() { StopThreadPool(); }
 
-bool TaskThreadPool::StartThreadPool(size_t num_worker_threads) {
+bool TaskThreadPool::StartThreadPool(size_t num_worker_threads,
+                                     TaskClosure thread_init) {
   if (is_pool_running_) {
     return true;
   }
+  thread_init_ = std::move(thread_init);
+  parallel_for_slots_.reset(new std::atomic<uint64_t>[num_worker_threads]);
+  for (size_t i = 0; i < num_worker_threads; ++i) {
+    parallel_for_slots_[i] = SlotValue(0, kSlotClosed);
+  }
+  num_parallel_for_slots_ = num_worker_threads;
   is_pool_running_ = true;
   worker_threads_.resize(num_worker_threads);
 
@@ -176,6 +199,62 @@ size_t TaskThreadPool::GetAvailableTaskThreadCount() const {
   return num_worker_threads_available_.load();
 }
 
+void TaskThreadPool::ParallelFor(size_t count,
+                                 const std::function<void(size_t)>& task) {
+  const uint64_t generation = ++parallel_for_generation_;
+  std::atomic<size_t> next_index(0);
+  const auto run = [&task, &next_index, count]() {
+    for (size_t i = next_index++; i < count; i = next_index++) {
+      task(i);
+    }
+  };
+
+  // The calling thread takes part in the work, so one worker less is needed.
+  const size_t num_workers =
+      std::min({GetAvailableTaskThreadCount(), count > 0 ? count - 1 : 0,
+                num_parallel_for_slots_});
+  size_t num_dispatched = 0;
+  for (; num_dispatched < num_workers; ++num_dispatched) {
+    std::atomic<uint64_t>* slot = &parallel_for_slots_[num_dispatched];
+    slot->store(SlotValue(generation, kSlotPending));
+    // |run| is only dereferenced after claiming the slot, which the calling
+    // thread waits for before returning.
+    if (!RunOnWorkerThread([this, slot, generation, &run]() {
+          uint64_t expected = SlotValue(generation, kSlotPending);
+          if (!slot->compare_exchange_strong(
+                  expected, SlotValue(generation, kSlotRunning))) {
+            return;
+          }
+          run();
+          {
+            std::lock_guard<std::mutex> lock(parallel_for_done_mutex_);
+            slot->store(SlotValue(generation, kSlotDone));
+          }
+          parallel_for_done_condition_.notify_one();
+        })) {
+      break;
+    }
+  }
+
+  run();
+
+  // Every index has been claimed by now. Close the slots of the workers that
+  // did not start yet, and wait for the ones still processing their last
+  // index.
+  for (size_t i = 0; i < num_dispatched; ++i) {
+    std::atomic<uint64_t>& slot = parallel_for_slots_[i];
+    uint64_t expected = SlotValue(generation, kSlotPending);
+    if (slot.compare_exchange_strong(expected,
+                                     SlotValue(generation, kSlotClosed))) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(parallel_for_done_mutex_);
+    parallel_for_done_condition_.wait(lock, [&slot, generation]() {
+      return slot.load() == SlotValue(generation, kSlotDone);
+    });
+  }
+}
+
 bool TaskThreadPool::IsPoolRunning() { return is_pool_running_.load(); }
 
 void TaskThreadPool::SignalWorkerAvailable() {
@@ -224,6 +303,10 @@ bool TaskThreadPool::WorkerThread::IsAvailable() const {
 }
 
 void TaskThreadPool::WorkerThread::TaskLoop() {
+  if (parent_pool_->thread_init_) {
+    parent_pool_->thread_init_();
+  }
+
   // Signal back to the parent thread pool that this thread has started and is
   // ready for use.
   task_loop_triggered_ = false;
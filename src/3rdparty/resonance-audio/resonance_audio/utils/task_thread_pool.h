@@ -20,7 +20,9 @@ limitations under the License.
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -53,8 +55,11 @@ class TaskThreadPool {
   //
   // @param num_worker_threads The number of worker threads to make available in
   //     the pool.
+  // @param thread_init Called first thing in every worker thread, for example
+  //     to set its priority. May be empty.
   // @return true on success or if thread pool has been already started.
-  bool StartThreadPool(size_t num_worker_threads);
+  bool StartThreadPool(size_t num_worker_threads,
+                       TaskClosure thread_init = TaskClosure());
 
   // Signals all |WorkerThread|s to stop and waits for completion.
   void StopThreadPool();
@@ -79,6 +84,17 @@ class TaskThreadPool {
   // Query the number of |WorkerThread|s current available to do work.
   size_t GetAvailableTaskThreadCount() const;
 
+  // Calls |task| for every index in [0, |count|), distributing the calls over
+  // the available |WorkerThread|s and the calling thread. Returns once all
+  // calls have completed. The calling thread processes every index that no
+  // worker has taken yet, and only waits for the calls already running on
+  // workers, never for a worker to wake up. The same single dispatching thread
+  // restrictions as for |RunOnWorkerThread| apply.
+  //
+  // @param count Number of indices to process.
+  // @param task Function to call for each index.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
  private:
   // Forward declaration of |WorkerThread| class. See implementation file for
   // class details.
@@ -114,6 +130,21 @@ class TaskThreadPool {
 
   // Mutex for the worker thread available condition notification receiver.
   std::mutex worker_available_mutex_;
+
+  // Called at the start of every worker thread.
+  TaskClosure thread_init_;
+
+  // One slot per worker dispatched by |ParallelFor|, holding the generation of
+  // the call in the upper bits and the |ParallelForSlotState| in the lowest
+  // two. A worker only touches the state of the call if it moves its slot from
+  // pending to running before the calling thread closes it.
+  std::unique_ptr<std::atomic<uint64_t>[]> parallel_for_slots_;
+  size_t num_parallel_for_slots_ = 0;
+  uint64_t parallel_for_generation_ = 0;
+
+  // Signals the calling thread of |ParallelFor| that a worker is done.
+  std::condition_variable parallel_for_done_condition_;
+  std::mutex parallel_for_done_mutex_;
 };
 
 }  // namespace vraudio
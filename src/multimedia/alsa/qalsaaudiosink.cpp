@@ -466,9 +466,11 @@ qint64 QAlsaAudioSink::write( const char *data, qint64 len )
 
     frames = snd_pcm_bytes_to_frames(handle, space);
 
-    if (m_volume < 1.0f) {
+    if (m_volume < 1.0f || m_appliedVolume < 1.0f) {
         QVarLengthArray<char, 4096> out(space);
-        QAudioHelperInternal::qMultiplySamples(m_volume, settings, data, out.data(), space);
+        QAudioHelperInternal::qMultiplySamples(m_appliedVolume, m_volume, settings, data,
+                                               out.data(), space);
+        m_appliedVolume = m_volume;
         err = snd_pcm_writei(handle, out.constData(), frames);
     } else {
         err = snd_pcm_writei(handle, data, frames);
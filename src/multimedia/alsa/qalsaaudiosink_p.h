@@ -99,6 +99,8 @@ private:
     snd_pcm_format_t pcmformat = SND_PCM_FORMAT_S16;
     snd_pcm_hw_params_t *hwparams = nullptr;
     qreal m_volume = 1.0f;
+    // The volume the last written buffer ended with; changes are ramped from it
+    qreal m_appliedVolume = 1.0f;
 };
 
 class AlsaOutputPrivate : public QIODevice
@@ -4,18 +4,38 @@
 #include "qaudiohelpers_p.h"
 
 #include <QDebug>
+#include <private/qsimd_p.h>
+
+#include <limits>
 
 QT_BEGIN_NAMESPACE
 
 namespace QAudioHelperInternal
 {
 
-template<class T> void adjustSamples(qreal factor, const void *src, void *dst, int samples)
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+// Defined in qaudiohelpers_avx2.cpp. They process a multiple of 32 bytes and
+// return the number of samples processed.
+int QT_FASTCALL qMultiplySamplesInt16_avx2(qint16 gain, const qint16 *src, qint16 *dst, int samples);
+int QT_FASTCALL qMultiplySamplesInt32_avx2(qint32 gain, const qint32 *src, qint32 *dst, int samples);
+int QT_FASTCALL qMultiplySamplesFloat_avx2(float gain, const float *src, float *dst, int samples);
+int QT_FASTCALL qAccumulateSamplesFloat_avx2(float gain, const float *src, float *dst, int samples);
+#endif
+
+// Duration over which gain changes are ramped
+static constexpr qint64 RampDurationUs = 5000;
+// Frames per gain step of a ramp
+static constexpr int RampBlockFrames = 8;
+
+// Used for gains >= 1, where the result has to be clamped to the sample range
+template<class T> void adjustSamplesSaturating(qreal factor, const void *src, void *dst, int samples)
 {
     const T *pSrc = (const T *)src;
     T *pDst = (T*)dst;
+    constexpr qreal min = std::numeric_limits<T>::min();
+    constexpr qreal max = std::numeric_limits<T>::max();
     for ( int i = 0; i < samples; i++ )
-        pDst[i] = pSrc[i] * factor;
+        pDst[i] = T(qBound(min, pSrc[i] * factor, max));
 }
 
 // Unsigned samples are biased around 0x80/0x8000 :/
@@ -32,13 +52,114 @@ template<class T> void adjustUnsignedSamples(qreal factor, const void *src, void
     const T *pSrc = (const T *)src;
     T *pDst = (T*)dst;
     for ( int i = 0; i < samples; i++ ) {
-        pDst[i] = signedVersion<T>::offset + ((typename signedVersion<T>::TS)(pSrc[i] - signedVersion<T>::offset) * factor);
+        const qreal value = (typename signedVersion<T>::TS)(pSrc[i] - signedVersion<T>::offset) * factor;
+        pDst[i] = signedVersion<T>::offset + qBound<qreal>(-signedVersion<T>::offset, value,
+                                                          signedVersion<T>::offset - 1);
+    }
+}
+
+void QT_FASTCALL qMultiplySamplesInt16(qint16 gain, const qint16 *src, qint16 *dst, int samples)
+{
+    int i = 0;
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+    if (qCpuHasFeature(AVX2))
+        i = qMultiplySamplesInt16_avx2(gain, src, dst, samples);
+#endif
+#if defined(__SSE2__)
+    // 16x16 -> 32 bit products, rounded and shifted back to Q0 with saturation
+    const __m128i g = _mm_set1_epi16(gain);
+    const __m128i rounding = _mm_set1_epi32(1 << 14);
+    for (; i + 8 <= samples; i += 8) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i lo = _mm_mullo_epi16(s, g);
+        const __m128i hi = _mm_mulhi_epi16(s, g);
+        __m128i p0 = _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), rounding);
+        __m128i p1 = _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), rounding);
+        p0 = _mm_srai_epi32(p0, 15);
+        p1 = _mm_srai_epi32(p1, 15);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(p0, p1));
+    }
+#elif defined(__ARM_NEON__)
+    const int16x8_t g = vdupq_n_s16(gain);
+    for (; i + 8 <= samples; i += 8)
+        vst1q_s16(dst + i, vqrdmulhq_s16(vld1q_s16(src + i), g));
+#endif
+    for (; i < samples; ++i)
+        dst[i] = qint16((int(src[i]) * gain + (1 << 14)) >> 15);
+}
+
+void QT_FASTCALL qMultiplySamplesInt32(qint32 gain, const qint32 *src, qint32 *dst, int samples)
+{
+    int i = 0;
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+    if (qCpuHasFeature(AVX2))
+        i = qMultiplySamplesInt32_avx2(gain, src, dst, samples);
+#endif
+#if defined(__ARM_NEON__)
+    const int32x4_t g = vdupq_n_s32(gain);
+    for (; i + 4 <= samples; i += 4)
+        vst1q_s32(dst + i, vqrdmulhq_s32(vld1q_s32(src + i), g));
+#endif
+    // SSE2 has no signed 32x32 -> 64 bit multiply, leave the rest to the compiler
+    for (; i < samples; ++i)
+        dst[i] = qint32((qint64(src[i]) * gain + (Q_INT64_C(1) << 30)) >> 31);
+}
+
+void QT_FASTCALL qMultiplySamplesFloat(float gain, const float *src, float *dst, int samples)
+{
+    int i = 0;
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+    if (qCpuHasFeature(AVX2))
+        i = qMultiplySamplesFloat_avx2(gain, src, dst, samples);
+#endif
+#if defined(__SSE2__)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= samples; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+#elif defined(__ARM_NEON__)
+    for (; i + 4 <= samples; i += 4)
+        vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(src + i), gain));
+#endif
+    for (; i < samples; ++i)
+        dst[i] = src[i] * gain;
+}
+
+void QT_FASTCALL qAccumulateSamplesFloat(float gain, const float *src, float *dst, int samples)
+{
+    int i = 0;
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+    if (qCpuHasFeature(AVX2))
+        i = qAccumulateSamplesFloat_avx2(gain, src, dst, samples);
+#endif
+#if defined(__SSE2__)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= samples; i += 4) {
+        const __m128 product = _mm_mul_ps(_mm_loadu_ps(src + i), g);
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), product));
     }
+#elif defined(__ARM_NEON__)
+    for (; i + 4 <= samples; i += 4)
+        vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), gain));
+#endif
+    for (; i < samples; ++i)
+        dst[i] += src[i] * gain;
+}
+
+static qint16 int16Gain(qreal factor)
+{
+    return qint16(qMin<qint64>(qRound64(factor * (1 << 15)), std::numeric_limits<qint16>::max()));
+}
+
+static qint32 int32Gain(qreal factor)
+{
+    return qint32(qMin<qint64>(qRound64(factor * (Q_INT64_C(1) << 31)),
+                               std::numeric_limits<qint32>::max()));
 }
 
 void qMultiplySamples(qreal factor, const QAudioFormat &format, const void* src, void* dest, int len)
 {
     const int samplesCount = len / qMax(1, format.bytesPerSample());
+    factor = qMax(factor, 0.);
 
     switch (format.sampleFormat()) {
     case QAudioFormat::Unknown:
@@ -48,16 +169,56 @@ void qMultiplySamples(qreal factor, const QAudioFormat &format, const void* src,
         QAudioHelperInternal::adjustUnsignedSamples<quint8>(factor,src,dest,samplesCount);
         break;
     case QAudioFormat::Int16:
-        QAudioHelperInternal::adjustSamples<qint16>(factor,src,dest,samplesCount);
+        if (factor < 1.)
+            qMultiplySamplesInt16(int16Gain(factor), static_cast<const qint16 *>(src),
+                                  static_cast<qint16 *>(dest), samplesCount);
+        else
+            QAudioHelperInternal::adjustSamplesSaturating<qint16>(factor,src,dest,samplesCount);
         break;
     case QAudioFormat::Int32:
-        QAudioHelperInternal::adjustSamples<qint32>(factor,src,dest,samplesCount);
+        if (factor < 1.)
+            qMultiplySamplesInt32(int32Gain(factor), static_cast<const qint32 *>(src),
+                                  static_cast<qint32 *>(dest), samplesCount);
+        else
+            QAudioHelperInternal::adjustSamplesSaturating<qint32>(factor,src,dest,samplesCount);
         break;
     case QAudioFormat::Float:
-        QAudioHelperInternal::adjustSamples<float>(factor,src,dest,samplesCount);
+        qMultiplySamplesFloat(float(factor), static_cast<const float *>(src),
+                              static_cast<float *>(dest), samplesCount);
         break;
     }
 }
+
+void qMultiplySamples(qreal startFactor, qreal endFactor, const QAudioFormat &format,
+                      const void *src, void *dest, int len)
+{
+    const int bytesPerFrame = format.bytesPerFrame();
+    if (startFactor == endFactor || bytesPerFrame <= 0) {
+        qMultiplySamples(endFactor, format, src, dest, len);
+        return;
+    }
+
+    const int frames = len / bytesPerFrame;
+    const int rampFrames = qMin(frames, qMax(1, format.framesForDuration(RampDurationUs)));
+
+    // The gain steps once per block, so that each block goes through the SIMD kernels.
+    // The last block of the ramp gets endFactor.
+    const int blocks = (rampFrames + RampBlockFrames - 1) / RampBlockFrames;
+    const qreal step = (endFactor - startFactor) / blocks;
+
+    auto *pSrc = static_cast<const char *>(src);
+    auto *pDst = static_cast<char *>(dest);
+    for (int block = 0; block < blocks; ++block) {
+        const int blockBytes =
+                qMin(RampBlockFrames, rampFrames - block * RampBlockFrames) * bytesPerFrame;
+        const qreal factor = block == blocks - 1 ? endFactor : startFactor + step * (block + 1);
+        qMultiplySamples(factor, format, pSrc, pDst, blockBytes);
+        pSrc += blockBytes;
+        pDst += blockBytes;
+    }
+
+    qMultiplySamples(endFactor, format, pSrc, pDst, len - rampFrames * bytesPerFrame);
+}
 }
 
 QT_END_NAMESPACE
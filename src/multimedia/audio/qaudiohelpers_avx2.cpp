@@ -0,0 +1,72 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qaudiohelpers_p.h"
+
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+int QT_FASTCALL qMultiplySamplesInt16_avx2(qint16 gain, const qint16 *src, qint16 *dst, int samples)
+{
+    // mulhrs computes (s * g + 0x4000) >> 15, matching the scalar code
+    const __m256i g = _mm256_set1_epi16(gain);
+    int i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_mulhrs_epi16(s, g));
+    }
+    return i;
+}
+
+int QT_FASTCALL qMultiplySamplesInt32_avx2(qint32 gain, const qint32 *src, qint32 *dst, int samples)
+{
+    const __m256i g = _mm256_set1_epi32(gain);
+    const __m256i rounding = _mm256_set1_epi64x(Q_INT64_C(1) << 30);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        // 64 bit products of the even and odd samples. Only the low 32 bits of the
+        // shifted result are kept, so a logical shift gives the same result as an
+        // arithmetic one.
+        __m256i even = _mm256_add_epi64(_mm256_mul_epi32(s, g), rounding);
+        __m256i odd = _mm256_add_epi64(_mm256_mul_epi32(_mm256_srli_epi64(s, 32), g), rounding);
+        even = _mm256_srli_epi64(even, 31);
+        odd = _mm256_slli_epi64(_mm256_srli_epi64(odd, 31), 32);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                            _mm256_blend_epi32(even, odd, 0xaa));
+    }
+    return i;
+}
+
+int QT_FASTCALL qMultiplySamplesFloat_avx2(float gain, const float *src, float *dst, int samples)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+    return i;
+}
+
+int QT_FASTCALL qAccumulateSamplesFloat_avx2(float gain, const float *src, float *dst, int samples)
+{
+    // Separate multiply and add, so that the result doesn't depend on FMA support
+    const __m256 g = _mm256_set1_ps(gain);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m256 product = _mm256_mul_ps(_mm256_loadu_ps(src + i), g);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), product));
+    }
+    return i;
+}
+
+}
+
+QT_END_NAMESPACE
+
+#endif
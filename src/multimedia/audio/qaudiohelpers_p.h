@@ -23,6 +23,21 @@ QT_BEGIN_NAMESPACE
 namespace QAudioHelperInternal
 {
 Q_MULTIMEDIA_EXPORT void qMultiplySamples(qreal factor, const QAudioFormat& format, const void *src, void* dest, int len);
+
+// Ramps the gain linearly from startFactor to endFactor over the first few milliseconds
+// of the buffer and applies endFactor to the rest. Used to avoid clicks on volume changes.
+Q_MULTIMEDIA_EXPORT void qMultiplySamples(qreal startFactor, qreal endFactor, const QAudioFormat &format,
+                                          const void *src, void *dest, int len);
+
+// Integer sample kernels. The gain is fixed point (Q15 for 16 bit and Q31 for 32 bit
+// samples) and has to be in [0, 1).
+void QT_FASTCALL qMultiplySamplesInt16(qint16 gain, const qint16 *src, qint16 *dst, int samples);
+void QT_FASTCALL qMultiplySamplesInt32(qint32 gain, const qint32 *src, qint32 *dst, int samples);
+void QT_FASTCALL qMultiplySamplesFloat(float gain, const float *src, float *dst, int samples);
+
+// Adds src multiplied by gain to dst. Used to mix voices into a float accumulator.
+Q_MULTIMEDIA_EXPORT void QT_FASTCALL qAccumulateSamplesFloat(float gain, const float *src, float *dst,
+                                                             int samples);
 }
 
 QT_END_NAMESPACE
@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "qsamplecache_p.h"
+#include "qaudiobuffer.h"
+#include "qaudiodecoder.h"
 #include "qwavedecoder.h"
 
 #include <QtNetwork/QNetworkAccessManager>
@@ -9,10 +11,15 @@
 #include <QtNetwork/QNetworkRequest>
 
 #include <QtCore/QDebug>
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qloggingcategory.h>
+#include <QtCore/qsysinfo.h>
 
 static Q_LOGGING_CATEGORY(qLcSampleCache, "qt.multimedia.samplecache")
 
+#include <cstring>
+#include <memory>
 #include <mutex>
 
 QT_BEGIN_NAMESPACE
@@ -126,7 +133,55 @@ bool QSampleCache::isCached(const QUrl &url) const
     return m_samples.contains(url);
 }
 
+void QSampleCache::setDecodingFormat(const QAudioFormat &format)
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    m_decodingFormat = format;
+}
+
+QAudioFormat QSampleCache::decodingFormat() const
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    return m_decodingFormat;
+}
+
+QSampleCache::Statistics QSampleCache::statistics() const
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    Statistics statistics;
+    statistics.hits = m_hits;
+    statistics.misses = m_misses;
+    statistics.evictions = m_evictions;
+    statistics.usage = m_usage;
+    statistics.capacity = m_capacity;
+    statistics.samples = m_samples.size();
+    return statistics;
+}
+
 QSample* QSampleCache::requestSample(const QUrl& url)
+{
+    return acquireSample(url, false);
+}
+
+void QSampleCache::preload(const QList<QUrl> &urls)
+{
+    for (const QUrl &url : urls) {
+        {
+            const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+            const auto it = m_samples.constFind(url);
+            if (it != m_samples.cend() && m_preloadedSamples.contains(*it))
+                continue;
+        }
+
+        qCDebug(qLcSampleCache) << "QSampleCache: preload sample [" << url << "]";
+        QSample *sample = acquireSample(url, true);
+
+        const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+        m_preloadedSamples.insert(sample);
+    }
+}
+
+QSample *QSampleCache::acquireSample(const QUrl &url, bool preload)
 {
     //lock and add first to make sure live loadingThread will not be killed during this function call
     m_loadingMutex.lock();
@@ -136,24 +191,37 @@ QSample* QSampleCache::requestSample(const QUrl& url)
 
     qCDebug(qLcSampleCache) << "QSampleCache: request sample [" << url << "]";
     std::unique_lock<QRecursiveMutex> locker(m_mutex);
-    QMap<QUrl, QSample*>::iterator it = m_samples.find(url);
+    auto it = m_samples.find(url);
     QSample* sample;
     if (it == m_samples.end()) {
+        if (!preload)
+            ++m_misses;
         if (needsThreadStart) {
             // Previous thread might be finishing, need to wait for it. If not, this is a no-op.
             m_loadingThread.wait();
             m_loadingThread.start();
         }
         sample = new QSample(url, this);
+        sample->m_unreferencedPosition = m_unreferencedSamples.end();
         m_samples.insert(url, sample);
 #if QT_CONFIG(thread)
         sample->moveToThread(&m_loadingThread);
 #endif
     } else {
         sample = *it;
+        if (!preload)
+            ++m_hits;
+
+        // In use again, so it can't be evicted
+        if (sample->m_unreferencedPosition != m_unreferencedSamples.end()) {
+            m_unreferencedSamples.erase(sample->m_unreferencedPosition);
+            sample->m_unreferencedPosition = m_unreferencedSamples.end();
+        }
     }
 
-    sample->addRef();
+    // The first requester takes the reference of the preload over
+    if (preload || !m_preloadedSamples.remove(sample))
+        sample->addRef();
     locker.unlock();
 
     sample->loadIfNecessary();
@@ -167,15 +235,8 @@ void QSampleCache::setCapacity(qint64 capacity)
         return;
     qCDebug(qLcSampleCache) << "QSampleCache: capacity changes from " << m_capacity << "to " << capacity;
     if (m_capacity > 0 && capacity <= 0) { //memory management strategy changed
-        for (QMap<QUrl, QSample*>::iterator it = m_samples.begin(); it != m_samples.end();) {
-            QSample* sample = *it;
-            if (sample->m_ref == 0) {
-                unloadSample(sample);
-                it = m_samples.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        while (!m_unreferencedSamples.empty())
+            unloadSample(m_unreferencedSamples.front());
     }
 
     m_capacity = capacity;
@@ -185,6 +246,12 @@ void QSampleCache::setCapacity(qint64 capacity)
 // Called locked
 void QSampleCache::unloadSample(QSample *sample)
 {
+    m_samples.remove(sample->m_url);
+    if (sample->m_unreferencedPosition != m_unreferencedSamples.end()) {
+        m_unreferencedSamples.erase(sample->m_unreferencedPosition);
+        sample->m_unreferencedPosition = m_unreferencedSamples.end();
+    }
+
     m_usage -= sample->m_soundData.size();
     m_staleSamples.insert(sample);
     sample->deleteLater();
@@ -200,18 +267,12 @@ void QSampleCache::refresh(qint64 usageChange)
 
     qint64 recoveredSize = 0;
 
-    //free unused samples to keep usage under capacity limit.
-    for (QMap<QUrl, QSample*>::iterator it = m_samples.begin(); it != m_samples.end();) {
-        QSample* sample = *it;
-        if (sample->m_ref > 0) {
-            ++it;
-            continue;
-        }
+    // Free the least recently used samples to keep the usage under the capacity
+    while (m_usage > m_capacity && !m_unreferencedSamples.empty()) {
+        QSample *sample = m_unreferencedSamples.front();
         recoveredSize += sample->m_soundData.size();
         unloadSample(sample);
-        it = m_samples.erase(it);
-        if (m_usage <= m_capacity)
-            return;
+        ++m_evictions;
     }
 
     qCDebug(qLcSampleCache) << "QSampleCache: refresh(" << usageChange
@@ -261,9 +322,16 @@ bool QSampleCache::notifyUnreferencedSample(QSample* sample)
 
     const std::lock_guard<QRecursiveMutex> locker(m_mutex);
 
-    if (m_capacity > 0)
+    // Requested again meanwhile
+    if (sample->m_ref > 0)
         return false;
-    m_samples.remove(sample->m_url);
+
+    if (m_capacity > 0) {
+        // Evicted by the next load that exceeds the capacity, unless it's used again before
+        sample->m_unreferencedPosition =
+                m_unreferencedSamples.insert(m_unreferencedSamples.end(), sample);
+        return false;
+    }
     unloadSample(sample);
     return true;
 }
@@ -292,9 +360,14 @@ void QSample::cleanup()
         m_stream->disconnect(this);
         m_stream->deleteLater();
     }
+    if (m_audioDecoder) {
+        m_audioDecoder->disconnect(this);
+        m_audioDecoder->deleteLater();
+    }
 
     m_waveDecoder = nullptr;
     m_stream = nullptr;
+    m_audioDecoder = nullptr;
 }
 
 // Called in application thread
@@ -330,6 +403,11 @@ void QSample::decoderReady()
 #endif
     QMutexLocker m(&m_mutex);
     qCDebug(qLcSampleCache) << "QSample: decoder ready";
+    if (mapSoundData()) {
+        onReady();
+        return;
+    }
+
     m_parent->refresh(m_waveDecoder->size());
 
     m_soundData.resize(m_waveDecoder->size());
@@ -357,14 +435,45 @@ void QSample::load()
     Q_ASSERT(QThread::currentThread()->objectName() == QLatin1String("QSampleCache::LoadingThread"));
 #endif
     qCDebug(qLcSampleCache) << "QSample: load [" << m_url << "]";
-    m_stream = m_parent->networkAccessManager().get(QNetworkRequest(m_url));
-    connect(m_stream, SIGNAL(errorOccurred(QNetworkReply::NetworkError)), SLOT(loadingError(QNetworkReply::NetworkError)));
+
+    // Local and qrc files are read directly, so that their samples can be mapped
+    QFile *file = nullptr;
+    if (m_url.isLocalFile())
+        file = new QFile(m_url.toLocalFile());
+    else if (m_url.scheme() == QLatin1String("qrc"))
+        file = new QFile(QLatin1Char(':') + m_url.path());
+    if (file && !file->open(QIODevice::ReadOnly)) {
+        delete file;
+        file = nullptr;
+    }
+
+    if (file) {
+        m_stream = file;
+    } else {
+        m_stream = m_parent->networkAccessManager().get(QNetworkRequest(m_url));
+        connect(m_stream, SIGNAL(errorOccurred(QNetworkReply::NetworkError)), SLOT(loadingError(QNetworkReply::NetworkError)));
+    }
     m_waveDecoder = new QWaveDecoder(m_stream);
     connect(m_waveDecoder, SIGNAL(formatKnown()), SLOT(decoderReady()));
     connect(m_waveDecoder, SIGNAL(parsingError()), SLOT(decoderError()));
     connect(m_waveDecoder, SIGNAL(readyRead()), SLOT(readSample()));
 
     m_waveDecoder->open(QIODevice::ReadOnly);
+
+    // A file doesn't signal more data, so the decoder got all there is already
+    if (!file || m_stream != file)
+        return;
+    if (m_waveDecoder->size() == 0) {
+        decoderError();
+        return;
+    }
+
+    QMutexLocker m(&m_mutex);
+    qCDebug(qLcSampleCache) << "QSample: truncated file, keep" << m_sampleReadLength << "bytes";
+    // decoderReady() charged the size from the header
+    m_parent->refresh(m_sampleReadLength - m_waveDecoder->size());
+    m_soundData.resize(m_sampleReadLength);
+    onReady();
 }
 
 void QSample::loadingError(QNetworkReply::NetworkError errorCode)
@@ -388,6 +497,144 @@ void QSample::decoderError()
 #endif
     QMutexLocker m(&m_mutex);
     qCDebug(qLcSampleCache) << "QSample: decoder error";
+    // Not WAV, or not a WAV that we can parse; try the decoder of the media backend
+    if (!m_audioDecoder && startAudioDecoder())
+        return;
+    cleanup();
+    m_state = QSample::Error;
+    qobject_cast<QSampleCache*>(m_parent)->loadingRelease();
+    emit error();
+}
+
+// Called in loading thread, locked. Maps the samples of local and qrc files instead of
+// copying them to the heap, so that the pages are shared with other processes playing them.
+bool QSample::mapSoundData()
+{
+    auto *file = qobject_cast<QFile *>(m_stream);
+    if (!file)
+        return false;
+
+    // The decoder stops right behind the header of the data chunk, which follows at least
+    // the RIFF header
+    const qint64 dataStart = file->pos();
+    const qint64 fileSize = file->size();
+    if (dataStart < 20 || dataStart > fileSize)
+        return false;
+
+    // Compressed qrc files can't be mapped
+    uchar *mapped = file->map(0, fileSize);
+    if (!mapped)
+        return false;
+
+    // The decoder converts the samples on read if they aren't in the byte order of the host
+    // (RIFX files are big endian), or if they're 24 bit, which changes their size
+    const bool bigEndian = std::memcmp(mapped, "RIFX", 4) == 0;
+    const uchar *chunkSize = mapped + dataStart - 4;
+    const qint64 dataSize = bigEndian ? qFromBigEndian<quint32>(chunkSize)
+                                      : qFromLittleEndian<quint32>(chunkSize);
+    const QAudioFormat format = m_waveDecoder->audioFormat();
+    const bool byteSwap = bigEndian != (QSysInfo::ByteOrder == QSysInfo::BigEndian)
+            && format.bytesPerSample() > 1;
+
+    qint64 length = qMin(dataSize, fileSize - dataStart);
+    length -= length % format.bytesPerFrame();
+    if (byteSwap || dataSize != m_waveDecoder->size() || length <= 0) {
+        file->unmap(mapped);
+        return false;
+    }
+
+    qCDebug(qLcSampleCache) << "QSample: mapped" << length << "bytes";
+    m_parent->refresh(length);
+    m_soundData = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped + dataStart),
+                                          qsizetype(length));
+    m_sampleReadLength = length;
+
+    // Keep the file open for the mapping, instead of deleting it with the decoder
+    file->disconnect(this);
+    m_stream = nullptr;
+    m_mappedFile.reset(file);
+    return true;
+}
+
+// Called in loading thread, locked. Returns false if the media backend can't decode.
+bool QSample::startAudioDecoder()
+{
+    cleanup();
+
+    auto decoder = std::make_unique<QAudioDecoder>();
+    if (!decoder->isSupported())
+        return false;
+
+    // Decode to the format that the sample is played in, so that it's converted only once
+    const QAudioFormat format = m_parent->decodingFormat();
+    if (format.isValid())
+        decoder->setAudioFormat(format);
+
+    // Back ends can't decode qrc files directly
+    if (m_url.scheme() == QLatin1String("qrc")) {
+        auto *file = new QFile(QLatin1Char(':') + m_url.path(), decoder.get());
+        if (!file->open(QIODevice::ReadOnly))
+            return false;
+        decoder->setSourceDevice(file);
+    } else {
+        decoder->setSource(m_url);
+    }
+
+    qCDebug(qLcSampleCache) << "QSample: decode with the media backend [" << m_url << "]";
+    m_audioDecoder = decoder.release();
+    connect(m_audioDecoder, &QAudioDecoder::bufferReady, this, &QSample::audioBufferReady);
+    connect(m_audioDecoder, &QAudioDecoder::finished, this, &QSample::audioDecoderFinished);
+    connect(m_audioDecoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this,
+            &QSample::audioDecoderError);
+    // Queued, as the decoder may report errors right away, and we're locked
+    QMetaObject::invokeMethod(m_audioDecoder, &QAudioDecoder::start, Qt::QueuedConnection);
+    return true;
+}
+
+// Called in loading thread
+void QSample::audioBufferReady()
+{
+    QMutexLocker m(&m_mutex);
+    if (!m_audioDecoder)
+        return;
+
+    const QAudioBuffer buffer = m_audioDecoder->read();
+    if (!buffer.isValid())
+        return;
+
+    if (m_soundData.isEmpty()) {
+        m_audioFormat = buffer.format();
+        const qint64 duration = m_audioDecoder->duration();
+        if (duration > 0)
+            m_soundData.reserve(m_audioFormat.bytesForDuration(duration * 1000));
+    }
+
+    m_parent->refresh(buffer.byteCount());
+    m_soundData.append(buffer.constData<char>(), buffer.byteCount());
+}
+
+// Called in loading thread
+void QSample::audioDecoderFinished()
+{
+    QMutexLocker m(&m_mutex);
+    qCDebug(qLcSampleCache) << "QSample: decoding finished, bytes decoded" << m_soundData.size();
+    if (!m_soundData.isEmpty()) {
+        onReady();
+        return;
+    }
+
+    cleanup();
+    m_state = QSample::Error;
+    qobject_cast<QSampleCache*>(m_parent)->loadingRelease();
+    emit error();
+}
+
+// Called in loading thread
+void QSample::audioDecoderError()
+{
+    QMutexLocker m(&m_mutex);
+    qCDebug(qLcSampleCache) << "QSample: decoding error"
+                            << (m_audioDecoder ? m_audioDecoder->errorString() : QString());
     cleanup();
     m_state = QSample::Error;
     qobject_cast<QSampleCache*>(m_parent)->loadingRelease();
@@ -400,7 +647,8 @@ void QSample::onReady()
 #if QT_CONFIG(thread)
     Q_ASSERT(QThread::currentThread()->objectName() == QLatin1String("QSampleCache::LoadingThread"));
 #endif
-    m_audioFormat = m_waveDecoder->audioFormat();
+    if (m_waveDecoder)
+        m_audioFormat = m_waveDecoder->audioFormat();
     qCDebug(qLcSampleCache) << "QSample: load ready format:" << m_audioFormat;
     cleanup();
     m_state = QSample::Ready;
@@ -19,14 +19,19 @@
 #include <QtCore/qthread.h>
 #include <QtCore/qurl.h>
 #include <QtCore/qmutex.h>
-#include <QtCore/qmap.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qset.h>
 #include <qaudioformat.h>
 #include <qnetworkreply.h>
 #include <private/qglobal_p.h>
 
+#include <list>
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
+class QAudioDecoder;
+class QFile;
 class QIODevice;
 class QNetworkAccessManager;
 class QSampleCache;
@@ -48,7 +53,8 @@ public:
 
     State state() const;
     // These are not (currently) locked because they are only meant to be called after these
-    // variables are updated to their final states
+    // variables are updated to their final states. The data may refer to a memory mapped
+    // file, so copies of it must not outlive the sample.
     const QByteArray& data() const { Q_ASSERT(state() == Ready); return m_soundData; }
     const QAudioFormat& format() const { Q_ASSERT(state() == Ready); return m_audioFormat; }
     void release();
@@ -66,8 +72,13 @@ private Q_SLOTS:
     void decoderError();
     void readSample();
     void decoderReady();
+    void audioBufferReady();
+    void audioDecoderFinished();
+    void audioDecoderError();
 
 private:
+    bool mapSoundData();
+    bool startAudioDecoder();
     void onReady();
     void cleanup();
     void addRef();
@@ -81,10 +92,16 @@ private:
     QAudioFormat m_audioFormat;
     QIODevice    *m_stream;
     QWaveDecoder *m_waveDecoder;
+    // Decodes what isn't WAV, if the media backend can
+    QAudioDecoder *m_audioDecoder = nullptr;
+    // Local and qrc files that m_soundData is mapped from
+    std::unique_ptr<QFile> m_mappedFile;
     QUrl         m_url;
     qint64       m_sampleReadLength;
     State        m_state;
     int          m_ref;
+    // Position among the unreferenced samples of the cache, or their end
+    std::list<QSample *>::iterator m_unreferencedPosition;
 };
 
 class Q_MULTIMEDIA_EXPORT QSampleCache : public QObject
@@ -96,22 +113,52 @@ public:
     QSampleCache(QObject *parent = nullptr);
     ~QSampleCache();
 
+    struct Statistics
+    {
+        qint64 hits = 0;      // Requests of samples that were cached or loading
+        qint64 misses = 0;    // Requests that started loading a sample
+        qint64 evictions = 0; // Unreferenced samples unloaded to stay within the capacity
+        qint64 usage = 0;     // Bytes of sample data held
+        qint64 capacity = 0;
+        qsizetype samples = 0;
+    };
+
     QSample* requestSample(const QUrl& url);
     void setCapacity(qint64 capacity);
 
+    // The format that samples which aren't WAV are decoded to, such as the one of the
+    // output device, so that they don't need converting when played. If it isn't set,
+    // they keep the format the decoder chooses.
+    void setDecodingFormat(const QAudioFormat &format);
+    QAudioFormat decodingFormat() const;
+
+    // Starts loading the samples in the loading thread. Each sample is kept until it's
+    // requested for the first time, so that it's ready when it's needed.
+    void preload(const QList<QUrl> &urls);
+
     bool isLoading() const;
     bool isCached(const QUrl& url) const;
+    Statistics statistics() const;
 
 private:
-    QMap<QUrl, QSample*> m_samples;
+    QHash<QUrl, QSample*> m_samples;
+    // Samples without references that are kept while the capacity allows, least recently
+    // used first
+    std::list<QSample *> m_unreferencedSamples;
+    QSet<QSample*> m_preloadedSamples;
     QSet<QSample*> m_staleSamples;
     QNetworkAccessManager *m_networkAccessManager;
     mutable QRecursiveMutex m_mutex;
     qint64 m_capacity;
     qint64 m_usage;
+    QAudioFormat m_decodingFormat;
+    qint64 m_hits = 0;
+    qint64 m_misses = 0;
+    qint64 m_evictions = 0;
     QThread m_loadingThread;
 
     QNetworkAccessManager& networkAccessManager();
+    QSample *acquireSample(const QUrl &url, bool preload);
     void refresh(qint64 usageChange);
     bool notifyUnreferencedSample(QSample* sample);
     void removeUnreferencedSample(QSample* sample);
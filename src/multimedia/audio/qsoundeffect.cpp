@@ -3,7 +3,8 @@
 
 #include <QtMultimedia/private/qtmultimediaglobal_p.h>
 #include "qsoundeffect.h"
-#include "qsamplecache_p.h"
+#include "qsoundeffect_p.h"
+#include "qsoundeffectmixer_p.h"
 #include "qaudiodevice.h"
 #include "qaudiosink.h"
 #include "qmediadevices.h"
@@ -14,7 +15,18 @@ static Q_LOGGING_CATEGORY(qLcSoundEffect, "qt.multimedia.soundeffect")
 
 QT_BEGIN_NAMESPACE
 
-Q_GLOBAL_STATIC(QSampleCache, sampleCache)
+Q_GLOBAL_STATIC(QSoundEffectSampleCache, sampleCache)
+
+QSoundEffectSampleCache::QSoundEffectSampleCache()
+{
+    setCapacity(qgetenv("QT_SOUNDEFFECT_CACHE_SIZE").toLongLong());
+    setDecodingFormat(QMediaDevices::defaultAudioOutput().preferredFormat());
+}
+
+QSoundEffectSampleCache *QSoundEffectSampleCache::instance()
+{
+    return sampleCache();
+}
 
 class QSoundEffectPrivate : public QIODevice
 {
@@ -45,6 +57,8 @@ public:
     void setLoopsRemaining(int loopsRemaining);
     void setStatus(QSoundEffect::Status status);
     void setPlaying(bool playing);
+    void updateVoiceGain();
+    void voiceNotified(quint64 playId, bool finished);
 
 public Q_SLOTS:
     void sampleReady();
@@ -65,8 +79,15 @@ public:
     bool m_sampleReady = false;
     qint64 m_offset = 0;
     QAudioDevice m_audioDevice;
+
+    // Set instead of m_audioOutput if the shared mixer is enabled
+    std::shared_ptr<QSoundEffectMixer> m_mixer;
+    std::shared_ptr<QSoundEffectVoice> m_voice;
+    QList<float> m_mixerData;
 };
 
+static_assert(QSoundEffectVoice::Infinite == QSoundEffect::Infinite);
+
 QSoundEffectPrivate::QSoundEffectPrivate(QSoundEffect *q, const QAudioDevice &audioDevice)
     : QIODevice(q)
     , q_ptr(q)
@@ -85,6 +106,27 @@ void QSoundEffectPrivate::sampleReady()
     qCDebug(qLcSoundEffect) << this << "sampleReady: sample size:" << m_sample->data().size();
     disconnect(m_sample, &QSample::error, this, &QSoundEffectPrivate::decoderError);
     disconnect(m_sample, &QSample::ready, this, &QSoundEffectPrivate::sampleReady);
+
+    if (QSoundEffectMixer::isEnabled()) {
+        if (!m_mixer)
+            m_mixer = QSoundEffectMixer::instance(m_audioDevice);
+        if (!m_voice) {
+            m_voice = std::make_shared<QSoundEffectVoice>(
+                    this, [this](quint64 playId, bool finished) { voiceNotified(playId, finished); });
+            updateVoiceGain();
+        }
+        m_mixerData = m_mixer->convert(m_sample->data(), m_sample->format());
+        m_sampleReady = true;
+        setStatus(QSoundEffect::Ready);
+
+        if (m_playing) {
+            qCDebug(qLcSoundEffect) << this << "starting playback on the mixer";
+            m_voice->startPlay(m_runningCount);
+            m_mixer->play(m_voice, m_mixerData);
+        }
+        return;
+    }
+
     if (!m_audioOutput) {
         m_audioOutput = new QAudioSink(m_audioDevice, m_sample->format());
         connect(m_audioOutput, &QAudioSink::stateChanged, this, &QSoundEffectPrivate::stateChanged);
@@ -187,6 +229,16 @@ void QSoundEffectPrivate::setPlaying(bool playing)
             return;
     }
 
+    if (m_mixer) {
+        // Restarts the voice if it's playing already
+        if (playing && m_sampleReady) {
+            m_voice->startPlay(m_runningCount);
+            m_mixer->play(m_voice, m_mixerData);
+        } else {
+            m_mixer->stop(m_voice);
+        }
+    }
+
     if (m_playing == playing)
         return;
     m_playing = playing;
@@ -197,6 +249,26 @@ void QSoundEffectPrivate::setPlaying(bool playing)
     emit q_ptr->playingChanged();
 }
 
+void QSoundEffectPrivate::updateVoiceGain()
+{
+    if (m_voice)
+        m_voice->setGain(m_muted ? 0.f : m_volume);
+}
+
+void QSoundEffectPrivate::voiceNotified(quint64 playId, bool finished)
+{
+    // Left over from a play that has been stopped or restarted since
+    if (!m_playing || playId != m_voice->playId())
+        return;
+
+    if (finished) {
+        setLoopsRemaining(0);
+        q_ptr->stop();
+    } else {
+        setLoopsRemaining(m_voice->loopsRemaining());
+    }
+}
+
 /*!
     \class QSoundEffect
     \brief The QSoundEffect class provides a way to play low latency sound effects.
@@ -212,6 +284,10 @@ void QSoundEffectPrivate::setPlaying(bool playing)
     consider using the QMediaPlayer class instead, since it supports a wider
     variety of media formats and is less resource intensive.
 
+    Sources in other formats than WAV, such as FLAC or Ogg Vorbis, are decoded with
+    the media backend if it supports them. They're decoded completely, and only once,
+    when they're loaded, to the format of the default audio output device.
+
     This example shows how a looping, somewhat quiet sound effect
     can be played:
 
@@ -283,10 +359,14 @@ QSoundEffect::QSoundEffect(const QAudioDevice &audioDevice, QObject *parent)
 QSoundEffect::~QSoundEffect()
 {
     stop();
+    if (d->m_voice)
+        d->m_voice->detach();
     if (d->m_audioOutput) {
         d->m_audioOutput->stop();
         d->m_audioOutput->deleteLater();
         d->m_sample->release();
+    } else if (d->m_mixer && d->m_sample) {
+        d->m_sample->release();
     }
     delete d;
 }
@@ -309,6 +389,19 @@ QStringList QSoundEffect::supportedMimeTypes()
                          << QLatin1String("audio/x-pn-wav");
 }
 
+/*!
+    \since 6.7
+
+    Starts loading the sounds at \a sources in the background, so that they are
+    ready when an effect plays them for the first time.
+
+    Each sound is kept until a sound effect uses it as its source.
+*/
+void QSoundEffect::preload(const QList<QUrl> &sources)
+{
+    sampleCache()->preload(sources);
+}
+
 /*!
     \qmlproperty url QtMultimedia::SoundEffect::source
 
@@ -448,8 +541,11 @@ void QSoundEffect::setLoopCount(int loopCount)
         return;
 
     d->m_loopCount = loopCount;
-    if (d->m_playing)
+    if (d->m_playing) {
         d->setLoopsRemaining(loopCount);
+        if (d->m_voice)
+            d->m_voice->setLoopsRemaining(loopCount);
+    }
     emit loopCountChanged();
 }
 
@@ -544,6 +640,7 @@ void QSoundEffect::setVolume(float volume)
 
     if (d->m_audioOutput && !d->m_muted)
         d->m_audioOutput->setVolume(volume);
+    d->updateVoiceGain();
 
     emit volumeChanged();
 }
@@ -584,6 +681,7 @@ void QSoundEffect::setMuted(bool muted)
         d->m_audioOutput->setVolume(d->m_volume);
 
     d->m_muted = muted;
+    d->updateVoiceGain();
     emit mutedChanged();
 }
 
@@ -51,6 +51,7 @@ public:
     ~QSoundEffect();
 
     static QStringList supportedMimeTypes();
+    static void preload(const QList<QUrl> &sources);
 
     QUrl source() const;
     void setSource(const QUrl &url);
@@ -0,0 +1,36 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSOUNDEFFECT_P_H
+#define QSOUNDEFFECT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/private/qsamplecache_p.h>
+
+QT_BEGIN_NAMESPACE
+
+// Keeps released samples up to QT_SOUNDEFFECT_CACHE_SIZE bytes, so that effects created
+// again for the same source don't load it again. Compressed sources are decoded to the
+// format of the default output device.
+class Q_MULTIMEDIA_EXPORT QSoundEffectSampleCache : public QSampleCache
+{
+public:
+    QSoundEffectSampleCache();
+
+    // The cache of all sound effects, e.g. to inspect its statistics()
+    static QSoundEffectSampleCache *instance();
+};
+
+QT_END_NAMESPACE
+
+#endif // QSOUNDEFFECT_P_H
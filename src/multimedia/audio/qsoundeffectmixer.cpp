@@ -0,0 +1,526 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsoundeffectmixer_p.h"
+#include "qaudiohelpers_p.h"
+#include "qaudiosink.h"
+#include "qmediadevices.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qloggingcategory.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcSoundEffectMixer, "qt.multimedia.soundeffect.mixer")
+
+// The latency of triggering a sound, which is what the mixer is for; keep it short
+static constexpr qint64 BufferTimeUs = 20000;
+// Voices are mixed in blocks of this many frames, picking up gain changes in between
+static constexpr qsizetype BlockFrames = 256;
+static constexpr int DefaultMaxVoices = 32;
+
+int QSoundEffectVoice::takeLoop(quint64 playId)
+{
+    // A new play has been started meanwhile, the loops aren't ours to count
+    if (playId != this->playId())
+        return 0;
+
+    int loops = loopsRemaining();
+    while (loops > 0
+           && !m_loopsRemaining.compare_exchange_weak(loops, loops - 1,
+                                                      std::memory_order_relaxed)) {
+    }
+
+    if (loops == Infinite)
+        return Infinite;
+    return qMax(loops - 1, 0);
+}
+
+void QSoundEffectVoice::notify(quint64 playId, bool finished)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_receiver)
+        return;
+
+    QMetaObject::invokeMethod(
+            m_receiver, [callback = m_callback, playId, finished]() { callback(playId, finished); },
+            Qt::QueuedConnection);
+}
+
+// Pulls the mixed audio for the sink. Lives in the mixing thread.
+class QSoundEffectMixerStream : public QIODevice
+{
+public:
+    explicit QSoundEffectMixerStream(QSoundEffectMixer *mixer) : m_mixer(mixer)
+    {
+        open(QIODevice::ReadOnly);
+    }
+
+    qint64 readData(char *data, qint64 len) override { return m_mixer->mix(data, len); }
+    qint64 writeData(const char *, qint64) override { return 0; }
+
+    qint64 size() const override { return 0; }
+    qint64 bytesAvailable() const override { return std::numeric_limits<qint64>::max(); }
+    bool isSequential() const override { return true; }
+    bool atEnd() const override { return false; }
+
+    void startOutput(const QAudioDevice &device, const QAudioFormat &format)
+    {
+        Q_ASSERT(!m_sink);
+        m_sink.reset(new QAudioSink(device, format));
+        m_sink->setBufferSize(format.bytesForDuration(BufferTimeUs));
+        m_sink->start(this);
+    }
+
+    void stopOutput()
+    {
+        if (!m_sink)
+            return;
+        m_sink->stop();
+        m_sink.reset();
+    }
+
+private:
+    QSoundEffectMixer *const m_mixer;
+    std::unique_ptr<QAudioSink> m_sink;
+};
+
+static qsizetype maxVoicesFromEnvironment()
+{
+    bool ok = false;
+    const int voices = qEnvironmentVariableIntValue("QT_SOUNDEFFECT_MIXER_VOICES", &ok);
+    return ok && voices > 0 ? voices : DefaultMaxVoices;
+}
+
+static QAudioFormat mixingFormat(const QAudioDevice &device)
+{
+    // The voices are mixed in float, so prefer handing that to the device directly
+    QAudioFormat format = device.preferredFormat();
+    QAudioFormat floatFormat = format;
+    floatFormat.setSampleFormat(QAudioFormat::Float);
+    if (device.isFormatSupported(floatFormat))
+        format = floatFormat;
+
+    if (!format.isValid()) {
+        format.setSampleRate(44100);
+        format.setChannelCount(2);
+        format.setSampleFormat(QAudioFormat::Int16);
+    }
+    return format;
+}
+
+QSoundEffectMixer::QSoundEffectMixer(const QAudioFormat &format, qsizetype maxVoices)
+    : QSoundEffectMixer(QAudioDevice(), format, maxVoices)
+{
+}
+
+QSoundEffectMixer::QSoundEffectMixer(const QAudioDevice &device, const QAudioFormat &format,
+                                     qsizetype maxVoices)
+    : m_device(device),
+      m_format(format),
+      m_maxVoices(qMax(maxVoices, qsizetype(1))),
+      // A few loops per voice may end before the notifications are delivered
+      m_notifications(m_maxVoices * 4)
+{
+    qCDebug(qLcSoundEffectMixer) << "Create mixer for" << m_device.description() << m_format
+                                 << "with" << m_maxVoices << "voices";
+
+    // Nothing is allocated or freed on the mixing thread while playing. Every voice can
+    // finish once between two handovers, and each of them is handed back with a command.
+    m_commands.reserve(m_maxVoices * 2);
+    m_released.reserve(m_maxVoices);
+    m_slots.reserve(m_maxVoices);
+    m_accumulator.resize(BlockFrames * m_format.channelCount());
+
+    // The mixer may be created from any thread of an effect, which might end before the
+    // mixer does
+    if (auto *app = QCoreApplication::instance())
+        m_notificationTimer.moveToThread(app->thread());
+    m_notificationTimer.setInterval(BufferTimeUs / 1000);
+    QObject::connect(&m_notificationTimer, &QTimer::timeout, &m_notificationTimer,
+                     [this]() { deliverNotifications(); });
+
+    if (m_device.isNull())
+        return;
+
+    m_thread.setObjectName(QStringLiteral("QSoundEffectMixer"));
+    m_stream = std::make_unique<QSoundEffectMixerStream>(this);
+    m_stream->moveToThread(&m_thread);
+    m_thread.start(QThread::TimeCriticalPriority);
+
+    QMetaObject::invokeMethod(m_stream.get(),
+                              [this]() { m_stream->startOutput(m_device, m_format); });
+}
+
+QSoundEffectMixer::~QSoundEffectMixer()
+{
+    if (!m_stream)
+        return;
+
+    QMetaObject::invokeMethod(m_stream.get(), [this]() { m_stream->stopOutput(); },
+                              Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool QSoundEffectMixer::isEnabled()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_SOUNDEFFECT_MIXER") > 0;
+    return enabled;
+}
+
+// The notification timer lives in the main thread, so the mixer is destroyed there
+static void deleteMixer(QSoundEffectMixer *mixer)
+{
+    QObject *app = QCoreApplication::instance();
+    if (!app || app->thread() == QThread::currentThread())
+        delete mixer;
+    else
+        QMetaObject::invokeMethod(app, [mixer]() { delete mixer; });
+}
+
+std::shared_ptr<QSoundEffectMixer> QSoundEffectMixer::instance(const QAudioDevice &device)
+{
+    static QBasicMutex mutex;
+    static std::map<QByteArray, std::weak_ptr<QSoundEffectMixer>> mixers;
+
+    const QAudioDevice target = device.isNull() ? QMediaDevices::defaultAudioOutput() : device;
+
+    QMutexLocker locker(&mutex);
+    std::weak_ptr<QSoundEffectMixer> &entry = mixers[target.id()];
+    std::shared_ptr<QSoundEffectMixer> mixer = entry.lock();
+    if (!mixer) {
+        mixer.reset(new QSoundEffectMixer(target, mixingFormat(target),
+                                          maxVoicesFromEnvironment()),
+                    deleteMixer);
+        entry = mixer;
+    }
+    return mixer;
+}
+
+QList<float> QSoundEffectMixer::convert(const QByteArray &data, const QAudioFormat &format) const
+{
+    if (!format.isValid())
+        return {};
+
+    const int inChannels = format.channelCount();
+    const int outChannels = m_format.channelCount();
+    const int bytesPerSample = format.bytesPerSample();
+    const qsizetype inFrames = data.size() / format.bytesPerFrame();
+    if (inFrames == 0)
+        return {};
+
+    const double step = double(format.sampleRate()) / m_format.sampleRate();
+    const qsizetype outFrames = qsizetype((inFrames - 1) / step) + 1;
+
+    const char *src = data.constData();
+    auto sampleValue = [&](qsizetype frame, int channel) {
+        return format.normalizedSampleValue(src + (frame * inChannels + channel) * bytesPerSample);
+    };
+    auto frameValue = [&](qsizetype frame, int channel) {
+        if (inChannels == 1)
+            return sampleValue(frame, 0);
+        if (outChannels == 1) {
+            float sum = 0.f;
+            for (int c = 0; c < inChannels; ++c)
+                sum += sampleValue(frame, c);
+            return sum / inChannels;
+        }
+        // Extra output channels stay silent, extra input channels are dropped
+        return channel < inChannels ? sampleValue(frame, channel) : 0.f;
+    };
+
+    QList<float> result(outFrames * outChannels);
+    float *dst = result.data();
+    for (qsizetype i = 0; i < outFrames; ++i) {
+        const double position = i * step;
+        const qsizetype frame = qsizetype(position);
+        const qsizetype next = qMin(frame + 1, inFrames - 1);
+        const float fraction = float(position - frame);
+        for (int c = 0; c < outChannels; ++c) {
+            const float value = frameValue(frame, c);
+            *dst++ = fraction > 0.f ? value + (frameValue(next, c) - value) * fraction : value;
+        }
+    }
+
+    return result;
+}
+
+void QSoundEffectMixer::play(const std::shared_ptr<QSoundEffectVoice> &voice,
+                             const QList<float> &data)
+{
+    // Nothing to play, so it's finished right away
+    if (data.isEmpty()) {
+        voice->notify(voice->playId(), true);
+        return;
+    }
+
+    post({ voice, data, voice->playId() });
+}
+
+void QSoundEffectMixer::stop(const std::shared_ptr<QSoundEffectVoice> &voice)
+{
+    post({ voice, {}, 0 });
+}
+
+void QSoundEffectMixer::post(Command command)
+{
+    QMutexLocker locker(&m_commandMutex);
+    releaseProcessedCommands();
+
+    // The last command for a voice supersedes the earlier ones, which also keeps the
+    // number of commands bounded if the sink doesn't pull
+    m_commands.erase(std::remove_if(m_commands.begin(), m_commands.end(),
+                                    [&](const Command &c) { return c.voice == command.voice; }),
+                     m_commands.end());
+    m_commands.push_back(std::move(command));
+
+    // Leave room for what the mixing thread hands back with the commands: the voices
+    // playing now, and one for each command it hasn't taken yet
+    const size_t required = m_commands.size() * 2 + m_maxVoices;
+    if (m_commands.capacity() < required)
+        m_commands.reserve(required * 2);
+
+    const bool startTimer = !std::exchange(m_notificationTimerRequested, true);
+    locker.unlock();
+
+    if (startTimer)
+        QMetaObject::invokeMethod(&m_notificationTimer, qOverload<>(&QTimer::start));
+}
+
+void QSoundEffectMixer::releaseProcessedCommands()
+{
+    m_commands.erase(m_commands.begin(), m_commands.begin() + m_processedCommands);
+    m_processedCommands = 0;
+}
+
+void QSoundEffectMixer::deliverNotifications()
+{
+    Notification notification;
+    while (m_notifications.tryPop(notification))
+        notification.voice->notify(notification.playId, notification.finished);
+
+    // Nothing might be posted for a while, which would keep the released data alive
+    QMutexLocker locker(&m_commandMutex);
+    releaseProcessedCommands();
+
+    // Anything the mixing thread queued before it went idle is visible here, as it
+    // stores m_busy under the mutex. The next post() starts the timer again.
+    if (m_commands.empty() && !m_busy && m_notifications.isEmpty()) {
+        m_notificationTimerRequested = false;
+        m_notificationTimer.stop();
+    }
+}
+
+qint64 QSoundEffectMixer::mix(char *data, qint64 len)
+{
+    takeCommands();
+
+    const int channels = m_format.channelCount();
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    qint64 frames = len / bytesPerFrame;
+    char *out = data;
+
+    while (frames > 0) {
+        const qsizetype blockFrames = qMin(frames, qint64(BlockFrames));
+        float *accumulator = m_accumulator.data();
+        std::fill_n(accumulator, blockFrames * channels, 0.f);
+
+        mixBlock(accumulator, blockFrames);
+        writeSamples(accumulator, out, blockFrames * channels);
+
+        out += blockFrames * bytesPerFrame;
+        frames -= blockFrames;
+    }
+
+    return out - data;
+}
+
+void QSoundEffectMixer::takeCommands()
+{
+    // Never wait for the threads of the effects; whatever they're posting is taken
+    // in the next period
+    if (!m_commandMutex.tryLock())
+        return;
+
+    // The posting threads left room for this
+    Q_ASSERT(m_commands.capacity() - m_commands.size() >= m_released.size());
+    m_commands.insert(m_commands.begin() + m_processedCommands,
+                      std::make_move_iterator(m_released.begin()),
+                      std::make_move_iterator(m_released.end()));
+    m_processedCommands += m_released.size();
+    m_released.clear();
+
+    // A processed command keeps what its voice replaced
+    for (; m_processedCommands < m_commands.size(); ++m_processedCommands) {
+        Command &command = m_commands[m_processedCommands];
+        if (command.data.isEmpty())
+            stopVoice(command);
+        else if (!startVoice(command))
+            break;
+    }
+
+    // Voices finishing later go to m_released, which keeps us busy until they're handed over
+    m_busy = !m_slots.empty();
+    m_commandMutex.unlock();
+}
+
+bool QSoundEffectMixer::startVoice(Command &command)
+{
+    auto slot = std::find_if(m_slots.begin(), m_slots.end(),
+                             [&](const Slot &s) { return s.voice == command.voice; });
+
+    if (slot == m_slots.end()) {
+        if (qsizetype(m_slots.size()) < m_maxVoices) {
+            slot = m_slots.emplace(m_slots.end());
+        } else {
+            slot = std::min_element(m_slots.begin(), m_slots.end(),
+                                    [this](const Slot &a, const Slot &b) {
+                                        if (a.finished != b.finished)
+                                            return a.finished;
+                                        const float gainA = a.voice->gain();
+                                        const float gainB = b.voice->gain();
+                                        if (gainA != gainB)
+                                            return gainA < gainB;
+                                        return remainingFrames(a) < remainingFrames(b);
+                                    });
+            // Retried in the next period, when the notifications have been delivered
+            if (!m_notifications.tryPush(slot->voice, slot->playId, true))
+                return false;
+            qCDebug(qLcSoundEffectMixer) << "All voices are busy, steal one";
+        }
+    }
+
+    std::swap(slot->voice, command.voice);
+    std::swap(slot->data, command.data);
+    slot->playId = command.playId;
+    slot->frame = 0;
+    slot->finished = false;
+    return true;
+}
+
+void QSoundEffectMixer::stopVoice(Command &command)
+{
+    auto slot = std::find_if(m_slots.begin(), m_slots.end(),
+                             [&](const Slot &s) { return s.voice == command.voice; });
+    if (slot == m_slots.end())
+        return;
+
+    // The command holds the voice as well, so only the data has to be taken over
+    command.data = std::move(slot->data);
+    std::swap(*slot, m_slots.back());
+    m_slots.pop_back();
+}
+
+void QSoundEffectMixer::releaseSlot(size_t index)
+{
+    Slot &slot = m_slots[index];
+    Q_ASSERT(m_released.size() < m_released.capacity());
+    m_released.push_back({ std::move(slot.voice), std::move(slot.data), slot.playId });
+
+    // The order of the slots doesn't matter
+    std::swap(slot, m_slots.back());
+    m_slots.pop_back();
+}
+
+qsizetype QSoundEffectMixer::remainingFrames(const Slot &slot) const
+{
+    const int loops = slot.voice->loopsRemaining();
+    if (loops == QSoundEffectVoice::Infinite)
+        return std::numeric_limits<qsizetype>::max();
+
+    const qsizetype frames = slot.data.size() / m_format.channelCount();
+    return qMax(loops - 1, 0) * frames + frames - slot.frame;
+}
+
+void QSoundEffectMixer::mixBlock(float *accumulator, qsizetype frames)
+{
+    const int channels = m_format.channelCount();
+
+    for (size_t i = 0; i < m_slots.size();) {
+        Slot &slot = m_slots[i];
+        if (slot.finished) {
+            if (m_notifications.tryPush(slot.voice, slot.playId, true))
+                releaseSlot(i);
+            else
+                ++i;
+            continue;
+        }
+
+        const float gain = slot.voice->gain();
+        const qsizetype sampleFrames = slot.data.size() / channels;
+        bool finished = false;
+
+        for (qsizetype mixed = 0; mixed < frames && !finished;) {
+            const qsizetype count = qMin(frames - mixed, sampleFrames - slot.frame);
+            // Muted voices keep their position, as if they were audible
+            if (gain > 0.f)
+                QAudioHelperInternal::qAccumulateSamplesFloat(
+                        gain, slot.data.constData() + slot.frame * channels,
+                        accumulator + mixed * channels, int(count * channels));
+
+            mixed += count;
+            slot.frame += count;
+            if (slot.frame < sampleFrames)
+                continue;
+
+            slot.frame = 0;
+            const int loops = slot.voice->takeLoop(slot.playId);
+            finished = loops == 0;
+            // Dropped if the queue is full; the effect reads the remaining loops anyway
+            if (loops != QSoundEffectVoice::Infinite && !finished)
+                m_notifications.tryPush(slot.voice, slot.playId, false);
+        }
+
+        // Kept until the end can be notified, which mustn't get lost
+        if (finished && m_notifications.tryPush(slot.voice, slot.playId, true)) {
+            releaseSlot(i);
+            continue;
+        }
+
+        slot.finished = finished;
+        ++i;
+    }
+}
+
+void QSoundEffectMixer::writeSamples(const float *src, char *dst, qsizetype samples) const
+{
+    switch (m_format.sampleFormat()) {
+    case QAudioFormat::UInt8: {
+        auto *out = reinterpret_cast<quint8 *>(dst);
+        for (qsizetype i = 0; i < samples; ++i)
+            out[i] = quint8(qRound(qBound(-1.f, src[i], 1.f) * 127.f) + 128);
+        break;
+    }
+    case QAudioFormat::Int16: {
+        auto *out = reinterpret_cast<qint16 *>(dst);
+        for (qsizetype i = 0; i < samples; ++i)
+            out[i] = qint16(qRound(qBound(-1.f, src[i], 1.f) * 32767.f));
+        break;
+    }
+    case QAudioFormat::Int32: {
+        auto *out = reinterpret_cast<qint32 *>(dst);
+        for (qsizetype i = 0; i < samples; ++i)
+            out[i] = qint32(qRound64(double(qBound(-1.f, src[i], 1.f)) * 2147483647.));
+        break;
+    }
+    case QAudioFormat::Float: {
+        auto *out = reinterpret_cast<float *>(dst);
+        for (qsizetype i = 0; i < samples; ++i)
+            out[i] = qBound(-1.f, src[i], 1.f);
+        break;
+    }
+    default:
+        memset(dst, 0, samples * m_format.bytesPerSample());
+        break;
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,246 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSOUNDEFFECTMIXER_P_H
+#define QSOUNDEFFECTMIXER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qaudiodevice.h>
+#include <QtMultimedia/qaudioformat.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qtimer.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QSoundEffectMixerStream;
+
+// What the mixer plays for one QSoundEffect. The effect changes the gain and the
+// remaining loops at any time, the mixer counts the loops down while playing.
+class Q_MULTIMEDIA_EXPORT QSoundEffectVoice
+{
+public:
+    static constexpr int Infinite = -2;
+
+    // Called in the thread of the receiver when a loop of the play with the given id
+    // ended, or when the play finished or was stolen
+    using Callback = std::function<void(quint64 playId, bool finished)>;
+
+    QSoundEffectVoice(QObject *receiver, Callback callback)
+        : m_receiver(receiver), m_callback(std::move(callback))
+    {
+    }
+
+    float gain() const { return m_gain.load(std::memory_order_relaxed); }
+    void setGain(float gain) { m_gain.store(gain, std::memory_order_relaxed); }
+
+    int loopsRemaining() const { return m_loopsRemaining.load(std::memory_order_relaxed); }
+    void setLoopsRemaining(int loops) { m_loopsRemaining.store(loops, std::memory_order_relaxed); }
+
+    // Starts a new play, so that notifications of the previous ones can be told apart
+    quint64 startPlay(int loops)
+    {
+        setLoopsRemaining(loops);
+        return m_playId.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    quint64 playId() const { return m_playId.load(std::memory_order_relaxed); }
+
+    // Mixing thread. Returns the loops left after the one that ended.
+    int takeLoop(quint64 playId);
+    // Not called in the mixing thread, which queues its notifications instead
+    void notify(quint64 playId, bool finished);
+
+    // Stops notifications; called by the receiver before it's destroyed
+    void detach()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_receiver = nullptr;
+    }
+
+private:
+    std::atomic<float> m_gain = 1.f;
+    std::atomic_int m_loopsRemaining = 0;
+    std::atomic<quint64> m_playId = 0;
+
+    QMutex m_mutex;
+    QObject *m_receiver = nullptr;
+    const Callback m_callback;
+};
+
+// Mixes the voices of all sound effects playing on an audio device into one output
+// stream, instead of opening a stream per effect.
+//
+// The mixing runs in a thread of its own with time critical priority. It never blocks on
+// the threads of the effects, and neither allocates nor frees memory:
+// - The effects hand play and stop commands over under a mutex, which the mixing thread
+//   only tries to lock once per period.
+// - What the mixing thread is done with, such as the data of a finished voice, goes back
+//   with the next handover and is released by the other threads.
+// - Loops and finished plays are queued in a preallocated ring, which a timer in the
+//   main thread drains. The timer only runs while voices are playing.
+//
+// Voices are accumulated in float with the SIMD helpers. When all voices are busy, a new
+// play steals the voice that is the quietest, or closest to its end.
+//
+// Enabled with QT_SOUNDEFFECT_MIXER=1. QT_SOUNDEFFECT_MIXER_VOICES sets the number of
+// voices, 32 by default.
+class Q_MULTIMEDIA_EXPORT QSoundEffectMixer
+{
+public:
+    // A mixer without an output of its own, whose owner pulls the audio with mix()
+    QSoundEffectMixer(const QAudioFormat &format, qsizetype maxVoices);
+    ~QSoundEffectMixer();
+
+    static bool isEnabled();
+
+    // The mixer of the device, created on first use and shared while it's referenced
+    static std::shared_ptr<QSoundEffectMixer> instance(const QAudioDevice &device);
+
+    QAudioFormat format() const { return m_format; }
+
+    // Converts a sample to the format of the mixer, once, so that mixing is plain
+    // accumulation. Resamples linearly and maps mono to all output channels.
+    QList<float> convert(const QByteArray &data, const QAudioFormat &format) const;
+
+    // Thread safe. Restarts the voice if it's playing already.
+    void play(const std::shared_ptr<QSoundEffectVoice> &voice, const QList<float> &data);
+    void stop(const std::shared_ptr<QSoundEffectVoice> &voice);
+
+    // Mixing thread. Fills data with the mix of the playing voices in the mixer format.
+    qint64 mix(char *data, qint64 len);
+
+    // Whether notifications are being delivered, which is the case while voices are playing
+    bool isDeliveringNotifications() const { return m_notificationTimer.isActive(); }
+
+private:
+    QSoundEffectMixer(const QAudioDevice &device, const QAudioFormat &format,
+                      qsizetype maxVoices);
+
+    struct Command
+    {
+        std::shared_ptr<QSoundEffectVoice> voice;
+        QList<float> data; // Empty to stop the voice
+        quint64 playId = 0;
+    };
+
+    struct Slot
+    {
+        std::shared_ptr<QSoundEffectVoice> voice;
+        QList<float> data;
+        quint64 playId = 0;
+        qsizetype frame = 0;
+        // Played to its end, waiting for room in the notification queue
+        bool finished = false;
+    };
+
+    struct Notification
+    {
+        std::shared_ptr<QSoundEffectVoice> voice;
+        quint64 playId = 0;
+        bool finished = false;
+    };
+
+    // Ring with a single producer, the mixing thread, and a single consumer, the thread
+    // of the mixer. The consumer takes the voices out of the cells, so that the producer
+    // only ever assigns to empty ones.
+    class NotificationQueue
+    {
+    public:
+        explicit NotificationQueue(size_t capacity) : m_cells(capacity) { }
+
+        bool tryPush(const std::shared_ptr<QSoundEffectVoice> &voice, quint64 playId,
+                     bool finished)
+        {
+            const size_t pushPos = m_pushPos.load(std::memory_order_relaxed);
+            if (pushPos - m_popPos.load(std::memory_order_acquire) == m_cells.size())
+                return false;
+
+            Notification &cell = m_cells[pushPos % m_cells.size()];
+            cell.voice = voice;
+            cell.playId = playId;
+            cell.finished = finished;
+            m_pushPos.store(pushPos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool isEmpty() const
+        {
+            return m_popPos.load(std::memory_order_relaxed)
+                    == m_pushPos.load(std::memory_order_acquire);
+        }
+
+        bool tryPop(Notification &notification)
+        {
+            const size_t popPos = m_popPos.load(std::memory_order_relaxed);
+            if (popPos == m_pushPos.load(std::memory_order_acquire))
+                return false;
+
+            notification = std::move(m_cells[popPos % m_cells.size()]);
+            m_popPos.store(popPos + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        std::vector<Notification> m_cells;
+        alignas(64) std::atomic<size_t> m_pushPos = 0;
+        alignas(64) std::atomic<size_t> m_popPos = 0;
+    };
+
+    void post(Command command);
+    void releaseProcessedCommands();
+    void deliverNotifications();
+
+    // Mixing thread
+    void takeCommands();
+    bool startVoice(Command &command);
+    void stopVoice(Command &command);
+    void releaseSlot(size_t index);
+    qsizetype remainingFrames(const Slot &slot) const;
+    void mixBlock(float *accumulator, qsizetype frames);
+    void writeSamples(const float *src, char *dst, qsizetype samples) const;
+
+    const QAudioDevice m_device;
+    const QAudioFormat m_format;
+    const qsizetype m_maxVoices;
+
+    QMutex m_commandMutex;
+    // The commands before m_processedCommands were taken by the mixing thread. They only
+    // hold what it released, for the other threads to destroy.
+    std::vector<Command> m_commands;
+    size_t m_processedCommands = 0;
+    // Whether the mixing thread had voices to mix when it last took the commands
+    bool m_busy = false;
+    // Whether the notification timer has been started, or is about to be
+    bool m_notificationTimerRequested = false;
+
+    // Mixing thread only
+    std::vector<Slot> m_slots;
+    std::vector<Command> m_released;
+    std::vector<float> m_accumulator;
+
+    NotificationQueue m_notifications;
+    QTimer m_notificationTimer;
+
+    QThread m_thread;
+    std::unique_ptr<QSoundEffectMixerStream> m_stream;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSOUNDEFFECTMIXER_P_H
@@ -1329,6 +1329,127 @@ void QCamera::setColorTemperature(int colorTemperature)
     d->control->setColorTemperature(colorTemperature);
 }
 
+/*!
+    \qmlproperty qint64 QtMultimedia::Camera::droppedFrames
+    \since 6.7
+    \brief This property holds the number of frames the camera couldn't
+    deliver since it became active.
+*/
+
+/*!
+    \property QCamera::droppedFrames
+    \since 6.7
+    \brief This property holds the number of frames the camera couldn't
+    deliver since it became active.
+
+    Frames are dropped when the device runs out of capture buffers because
+    the application doesn't consume them fast enough, or when frames can't
+    be decoded in time. The count is reset when the camera is started.
+    Backends that can't detect dropped frames always report \c 0.
+
+    \sa frameBufferCount
+*/
+qint64 QCamera::droppedFrames() const
+{
+    Q_D(const QCamera);
+    return d->control ? d->control->droppedFrames() : 0;
+}
+
+/*!
+    \fn void QCamera::droppedFramesChanged(qint64 droppedFrames)
+
+    Signals when the number of \a droppedFrames changes.
+*/
+
+/*!
+    \qmlproperty int QtMultimedia::Camera::frameBufferCount
+    \since 6.7
+    \brief This property holds the number of buffers the camera captures
+    frames into.
+*/
+
+/*!
+    \property QCamera::frameBufferCount
+    \since 6.7
+    \brief This property holds the number of buffers the camera captures
+    frames into.
+
+    More buffers let the camera keep capturing while the application holds
+    on to frames, at the cost of memory. A value of \c -1 lets the backend
+    choose the count. The property is applied when the camera starts or its
+    format changes, and backends may adjust it to the limits of the device.
+    Backends that don't manage capture buffers ignore it.
+
+    \sa droppedFrames
+*/
+int QCamera::frameBufferCount() const
+{
+    Q_D(const QCamera);
+    return d->control ? d->control->frameBufferCount() : -1;
+}
+
+/*!
+    \fn void QCamera::frameBufferCountChanged()
+
+    Signals when the frame buffer count changes.
+*/
+void QCamera::setFrameBufferCount(int count)
+{
+    Q_D(QCamera);
+    if (count < 1)
+        count = -1;
+    if (!d->control || d->control->frameBufferCount() == count)
+        return;
+    d->control->setFrameBufferCount(count);
+    emit frameBufferCountChanged();
+}
+
+/*!
+    \qmlproperty int QtMultimedia::Camera::decodingThreadCount
+    \since 6.7
+    \brief This property holds the number of threads that decode compressed
+    camera frames.
+*/
+
+/*!
+    \property QCamera::decodingThreadCount
+    \since 6.7
+    \brief This property holds the number of threads that decode compressed
+    camera frames.
+
+    Some cameras deliver compressed frames, such as Motion JPEG, which the
+    backend decodes before passing them on. More threads keep up with higher
+    resolutions and frame rates. Frames that can't be decoded in time are
+    dropped and counted in droppedFrames.
+
+    A value of \c -1 lets the backend choose the count. The property is
+    applied when the camera starts or its format changes. Backends that don't
+    decode frames ignore it.
+
+    \sa droppedFrames
+*/
+int QCamera::decodingThreadCount() const
+{
+    Q_D(const QCamera);
+    return d->control ? d->control->decodingThreadCount() : -1;
+}
+
+/*!
+    \fn void QCamera::decodingThreadCountChanged()
+
+    Signals when the decoding thread count changes.
+*/
+void QCamera::setDecodingThreadCount(int count)
+{
+    Q_D(QCamera);
+    if (count < 1)
+        count = -1;
+    if (!d->control || d->control->decodingThreadCount() == count)
+        return;
+    d->control->setDecodingThreadCount(count);
+    emit decodingThreadCountChanged();
+}
+
 /*!
     \enum QCamera::WhiteBalanceMode
 
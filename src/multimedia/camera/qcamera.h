@@ -55,6 +55,11 @@ class Q_MULTIMEDIA_EXPORT QCamera : public QObject
     Q_PROPERTY(WhiteBalanceMode whiteBalanceMode READ whiteBalanceMode WRITE setWhiteBalanceMode NOTIFY whiteBalanceModeChanged)
     Q_PROPERTY(int colorTemperature READ colorTemperature WRITE setColorTemperature NOTIFY colorTemperatureChanged)
     Q_PROPERTY(Features supportedFeatures READ supportedFeatures NOTIFY supportedFeaturesChanged)
+    Q_PROPERTY(qint64 droppedFrames READ droppedFrames NOTIFY droppedFramesChanged)
+    Q_PROPERTY(int frameBufferCount READ frameBufferCount WRITE setFrameBufferCount
+                       NOTIFY frameBufferCountChanged)
+    Q_PROPERTY(int decodingThreadCount READ decodingThreadCount WRITE setDecodingThreadCount
+                       NOTIFY decodingThreadCountChanged)
 
 public:
     enum Error
@@ -199,6 +204,14 @@ public:
 
     int colorTemperature() const;
 
+    qint64 droppedFrames() const;
+
+    int frameBufferCount() const;
+    void setFrameBufferCount(int count);
+
+    int decodingThreadCount() const;
+    void setDecodingThreadCount(int count);
+
 public Q_SLOTS:
     void setActive(bool active);
     void start() { setActive(true); }
@@ -255,6 +268,10 @@ Q_SIGNALS:
     void saturationChanged();
     void hueChanged();
 
+    void droppedFramesChanged(qint64 droppedFrames);
+    void frameBufferCountChanged();
+    void decodingThreadCountChanged();
+
 private:
     class QPlatformCamera *platformCamera();
     void setCaptureSession(QMediaCaptureSession *session);
@@ -70,6 +70,26 @@ int main(int, char **)
 }
 ")
 
+qt_config_compile_test(xdamage
+    LABEL "XDamage"
+    LIBRARIES
+        X11
+        Xdamage
+    CODE
+"#include <X11/Xlib.h>
+#include <X11/extensions/Xdamage.h>
+
+int main(int, char **)
+{
+    /* BEGIN TEST: */
+    int eventBase = 0;
+    int errorBase = 0;
+    XDamageQueryExtension(nullptr, &eventBase, &errorBase);
+    /* END TEST: */
+    return 0;
+}
+")
+
 #### Features
 
 qt_feature("ffmpeg" PRIVATE
@@ -133,6 +153,10 @@ qt_feature("linux_dmabuf" PRIVATE
     LABEL "Linux DMA buffer support"
     CONDITION UNIX AND TEST_linux_dmabuf
 )
+qt_feature("xdamage" PRIVATE
+    LABEL "XDamage"
+    CONDITION QT_FEATURE_xlib AND TEST_xdamage
+)
 qt_feature("vaapi" PRIVATE
     LABEL "VAAPI support"
     CONDITION UNIX AND VAAPI_FOUND AND QT_FEATURE_linux_dmabuf
@@ -196,6 +220,7 @@ qt_configure_add_summary_section(NAME "Hardware acceleration and features")
 qt_configure_add_summary_entry(ARGS "linux_v4l")
 qt_configure_add_summary_entry(ARGS "vaapi")
 qt_configure_add_summary_entry(ARGS "linux_dmabuf")
+qt_configure_add_summary_entry(ARGS "xdamage")
 qt_configure_add_summary_entry(ARGS "videotoolbox")
 qt_configure_end_summary_section()
 qt_configure_end_summary_section() # end of "Qt Multimedia" section
@@ -194,6 +194,14 @@ void QPlatformCamera::colorTemperatureChanged(int temperature)
     emit m_camera->colorTemperatureChanged();
 }
 
+void QPlatformCamera::droppedFramesChanged(qint64 frames)
+{
+    if (m_droppedFrames == frames)
+        return;
+    m_droppedFrames = frames;
+    emit m_camera->droppedFramesChanged(frames);
+}
+
 int QPlatformCamera::colorTemperatureForWhiteBalance(QCamera::WhiteBalanceMode mode)
 {
     switch (mode) {
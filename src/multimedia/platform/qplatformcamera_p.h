@@ -86,6 +86,12 @@ public:
     QCamera::WhiteBalanceMode whiteBalanceMode() const { return m_whiteBalance; }
     int colorTemperature() const { return m_colorTemperature; }
 
+    qint64 droppedFrames() const { return m_droppedFrames; }
+    int frameBufferCount() const { return m_frameBufferCount; }
+    void setFrameBufferCount(int count) { m_frameBufferCount = count; }
+    int decodingThreadCount() const { return m_decodingThreadCount; }
+    void setDecodingThreadCount(int count) { m_decodingThreadCount = count; }
+
     void supportedFeaturesChanged(QCamera::Features);
     void minimumZoomFactorChanged(float factor);
     void maximumZoomFactorChanged(float);
@@ -107,6 +113,7 @@ public:
     void maxExposureTimeChanged(float secs) { m_maxExposureTime = secs; }
     void whiteBalanceModeChanged(QCamera::WhiteBalanceMode mode);
     void colorTemperatureChanged(int temperature);
+    void droppedFramesChanged(qint64 frames);
 
     static int colorTemperatureForWhiteBalance(QCamera::WhiteBalanceMode mode);
 
@@ -146,6 +153,9 @@ private:
     float m_maxExposureTime = -1.;
     QCamera::WhiteBalanceMode m_whiteBalance = QCamera::WhiteBalanceAuto;
     int m_colorTemperature = 0;
+    qint64 m_droppedFrames = 0;
+    int m_frameBufferCount = -1;
+    int m_decodingThreadCount = -1;
 };
 
 QT_END_NAMESPACE
@@ -42,11 +42,34 @@ public:
 
     virtual float bufferProgress() const = 0;
 
+    QMediaBufferingPolicy bufferingPolicy() const { return m_bufferingPolicy; }
+    virtual void setBufferingPolicy(const QMediaBufferingPolicy &policy)
+    {
+        if (m_bufferingPolicy == policy)
+            return;
+        m_bufferingPolicy = policy;
+        Q_EMIT player->bufferingPolicyChanged();
+    }
+    virtual qint64 bufferedDuration() const { return 0; }
+    virtual qint64 bufferedBytes() const { return 0; }
+
+    virtual qint64 droppedVideoFrames() const { return 0; }
+    virtual qint64 skippedVideoFrames() const { return 0; }
+
     virtual bool isAudioAvailable() const { return m_audioAvailable; }
     virtual bool isVideoAvailable() const { return m_videoAvailable; }
 
     virtual bool isSeekable() const { return m_seekable; }
 
+    QMediaPlayer::SeekMode seekMode() const { return m_seekMode; }
+    virtual void setSeekMode(QMediaPlayer::SeekMode mode)
+    {
+        if (m_seekMode == mode)
+            return;
+        m_seekMode = mode;
+        Q_EMIT player->seekModeChanged();
+    }
+
     virtual QMediaTimeRange availablePlaybackRanges() const = 0;
 
     virtual qreal playbackRate() const = 0;
@@ -136,6 +159,8 @@ private:
     bool m_audioAvailable = false;
     int m_loops = 1;
     int m_currentLoop = 0;
+    QMediaBufferingPolicy m_bufferingPolicy;
+    QMediaPlayer::SeekMode m_seekMode = QMediaPlayer::AccurateSeek;
     qint64 m_position = 0;
 };
 
@@ -37,6 +37,14 @@ void QPlatformMediaRecorder::durationChanged(qint64 duration)
     emit q->durationChanged(duration);
 }
 
+void QPlatformMediaRecorder::droppedFramesChanged(qint64 droppedFrames)
+{
+    if (m_droppedFrames == droppedFrames)
+        return;
+    m_droppedFrames = droppedFrames;
+    emit q->droppedFramesChanged(droppedFrames);
+}
+
 void QPlatformMediaRecorder::actualLocationChanged(const QUrl &location)
 {
     if (m_actualLocation == location)
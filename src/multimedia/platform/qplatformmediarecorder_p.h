@@ -44,6 +44,10 @@ class Q_MULTIMEDIA_EXPORT QMediaEncoderSettings
     QSize m_videoResolution = QSize(-1, -1);
     int m_videoFrameRate = -1;
     int m_videoBitRate = -1;
+
+    int m_encodingQueueDepth = -1;
+    int m_encodingThreadCount = -1;
+    QMediaRecorder::EncodingThreadType m_encodingThreadType = QMediaRecorder::AutomaticThreading;
 public:
 
     QMediaFormat mediaFormat() const { return m_format; }
@@ -80,6 +84,16 @@ public:
     int audioSampleRate() const { return m_audioSampleRate; }
     void setAudioSampleRate(int rate) { m_audioSampleRate = rate; }
 
+    int encodingQueueDepth() const { return m_encodingQueueDepth; }
+    void setEncodingQueueDepth(int depth) { m_encodingQueueDepth = depth; }
+
+    int encodingThreadCount() const { return m_encodingThreadCount; }
+    void setEncodingThreadCount(int count) { m_encodingThreadCount = count; }
+
+    QMediaRecorder::EncodingThreadType encodingThreadType() const { return m_encodingThreadType; }
+    void setEncodingThreadType(QMediaRecorder::EncodingThreadType type)
+    { m_encodingThreadType = type; }
+
     bool operator==(const QMediaEncoderSettings &other) const
     {
         return m_format == other.m_format &&
@@ -90,7 +104,10 @@ public:
                m_audioChannels == other.m_audioChannels &&
                m_videoResolution == other.m_videoResolution &&
                m_videoFrameRate == other.m_videoFrameRate &&
-               m_videoBitRate == other.m_videoBitRate;
+               m_videoBitRate == other.m_videoBitRate &&
+               m_encodingQueueDepth == other.m_encodingQueueDepth &&
+               m_encodingThreadCount == other.m_encodingThreadCount &&
+               m_encodingThreadType == other.m_encodingThreadType;
     }
 
     bool operator!=(const QMediaEncoderSettings &other) const
@@ -111,6 +128,7 @@ public:
     virtual void stop() = 0;
 
     virtual qint64 duration() const { return m_duration; }
+    virtual qint64 droppedFrames() const { return m_droppedFrames; }
 
     virtual void setMetaData(const QMediaMetaData &) {}
     virtual QMediaMetaData metaData() const { return {}; }
@@ -129,6 +147,7 @@ protected:
 
     void stateChanged(QMediaRecorder::RecorderState state);
     void durationChanged(qint64 position);
+    void droppedFramesChanged(qint64 droppedFrames);
     void actualLocationChanged(const QUrl &location);
     void error(QMediaRecorder::Error error, const QString &errorString);
     void metaDataChanged();
@@ -142,6 +161,7 @@ private:
     QUrl m_actualLocation;
     QUrl m_outputLocation;
     qint64 m_duration = 0;
+    qint64 m_droppedFrames = 0;
 
     QMediaRecorder::RecorderState m_state = QMediaRecorder::StoppedState;
 };
@@ -23,6 +23,8 @@ void QPlatformSurfaceCapture::setActive(bool active)
         return;
 
     m_active = active;
+    if (active)
+        updateStatistics(0, 0, 0.);
     emit activeChanged(active);
 }
 
@@ -76,6 +78,19 @@ void QPlatformSurfaceCapture::updateError(Error error, const QString &errorStrin
     }
 }
 
+void QPlatformSurfaceCapture::updateStatistics(qint64 capturedFrames, qint64 skippedFrames,
+                                               qreal averageCaptureTime)
+{
+    if (m_capturedFrames == capturedFrames && m_skippedFrames == skippedFrames
+        && m_averageCaptureTime == averageCaptureTime)
+        return;
+
+    m_capturedFrames = capturedFrames;
+    m_skippedFrames = skippedFrames;
+    m_averageCaptureTime = averageCaptureTime;
+    emit statisticsChanged();
+}
+
 bool QPlatformSurfaceCapture::checkScreenWithError(ScreenSource &screen)
 {
     if (!screen)
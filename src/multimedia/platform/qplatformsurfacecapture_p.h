@@ -62,6 +62,10 @@ public:
     Error error() const;
     QString errorString() const;
 
+    qint64 capturedFrames() const { return m_capturedFrames; }
+    qint64 skippedFrames() const { return m_skippedFrames; }
+    qreal averageCaptureTime() const { return m_averageCaptureTime; }
+
 protected:
     virtual bool setActiveInternal(bool) = 0;
 
@@ -69,18 +73,26 @@ protected:
 
 public Q_SLOTS:
     void updateError(Error error, const QString &errorString);
+    void updateStatistics(qint64 capturedFrames, qint64 skippedFrames,
+                          qreal averageCaptureTime);
 
 Q_SIGNALS:
     void sourceChanged(WindowSource);
     void sourceChanged(ScreenSource);
     void errorChanged();
     void errorOccurred(Error error, QString errorString);
+    void statisticsChanged();
 
 private:
     Error m_error = NoError;
     QString m_errorString;
     Source m_source;
     bool m_active = false;
+    qint64 m_capturedFrames = 0;
+    // Grabbings that didn't produce a frame, e.g. because nothing has changed
+    qint64 m_skippedFrames = 0;
+    // In milliseconds
+    qreal m_averageCaptureTime = 0.;
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,143 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#include <QDebug>
+#include <qmediabufferingpolicy.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QMediaBufferingPolicy
+    \brief The QMediaBufferingPolicy class describes how much media data a
+    QMediaPlayer reads ahead.
+    \since 6.7
+
+    \inmodule QtMultimedia
+    \ingroup multimedia
+    \ingroup multimedia_playback
+
+    While playing, QMediaPlayer reads compressed media data ahead of the
+    current playback position. A larger buffer makes playback more resilient
+    against stalls of the source, for example on network streams, at the cost
+    of memory.
+
+    The buffer is limited both by the duration of the buffered media, which
+    is counted per stream, and by the number of buffered bytes, which is
+    counted over all streams. The fill level of the buffer is the larger of
+    the two ratios of the buffered amount to its limit.
+
+    The player stops reading when the fill level reaches the high watermark,
+    and resumes once it has dropped below the low watermark. Keeping some
+    distance between the two lets the player read data in larger batches
+    instead of waking up for every consumed packet.
+
+    The policy is applied by backends that support it. Currently this is the
+    FFmpeg backend.
+
+    \sa QMediaPlayer::bufferingPolicy
+*/
+
+/*!
+    \fn QMediaBufferingPolicy::QMediaBufferingPolicy()
+
+    Constructs the default policy. It buffers up to 4 seconds of media with no
+    limit on the number of bytes, resumes reading at a fill level of 0.75 and
+    stops at 1.
+*/
+
+/*!
+    \fn void QMediaBufferingPolicy::setMaximumDuration(qint64 milliseconds)
+
+    Sets the maximal duration of media to buffer per stream to \a milliseconds.
+    A value of 0 or less removes the limit.
+*/
+
+/*!
+    \fn qint64 QMediaBufferingPolicy::maximumDuration() const
+
+    Returns the maximal duration of media to buffer per stream in milliseconds.
+*/
+
+/*!
+    \fn void QMediaBufferingPolicy::setMaximumBytes(qint64 bytes)
+
+    Sets the maximal amount of compressed media data to buffer over all streams
+    to \a bytes. A value of 0 or less removes the limit.
+*/
+
+/*!
+    \fn qint64 QMediaBufferingPolicy::maximumBytes() const
+
+    Returns the maximal amount of compressed media data to buffer in bytes.
+*/
+
+/*!
+    \fn void QMediaBufferingPolicy::setLowWatermark(float fill)
+
+    Sets the fill level below which the player resumes reading to \a fill.
+
+    The value is bounded to the range above 0 and up to 1. If it is above the
+    high watermark, the high watermark is raised to it.
+*/
+
+/*!
+    \fn float QMediaBufferingPolicy::lowWatermark() const
+
+    Returns the fill level below which the player resumes reading.
+*/
+
+/*!
+    \fn void QMediaBufferingPolicy::setHighWatermark(float fill)
+
+    Sets the fill level at which the player stops reading to \a fill.
+
+    The value is bounded to the range above 0 and up to 1. If it is below the
+    low watermark, the low watermark is lowered to it.
+*/
+
+/*!
+    \fn float QMediaBufferingPolicy::highWatermark() const
+
+    Returns the fill level at which the player stops reading.
+*/
+
+/*!
+    Returns the fill level of a buffer holding \a bufferedDuration milliseconds
+    of media in its longest stream and \a bufferedBytes bytes over all streams.
+
+    Returns 0 if the policy sets no limits at all. Such a policy never stops
+    reading.
+*/
+float QMediaBufferingPolicy::fill(qint64 bufferedDuration, qint64 bufferedBytes) const noexcept
+{
+    float result = 0.f;
+    if (m_maximumDuration > 0)
+        result = qMax(result, float(bufferedDuration) / m_maximumDuration);
+    if (m_maximumBytes > 0)
+        result = qMax(result, float(bufferedBytes) / m_maximumBytes);
+    return result;
+}
+
+/*!
+    \fn bool QMediaBufferingPolicy::operator==(const QMediaBufferingPolicy &a, const QMediaBufferingPolicy &b)
+
+    Returns \c true if \a a and \a b describe the same policy.
+*/
+
+/*!
+    \fn bool QMediaBufferingPolicy::operator!=(const QMediaBufferingPolicy &a, const QMediaBufferingPolicy &b)
+
+    Returns \c true if \a a and \a b describe different policies.
+*/
+
+#ifndef QT_NO_DEBUG_STREAM
+QDebug operator<<(QDebug dbg, const QMediaBufferingPolicy &p)
+{
+    QDebugStateSaver saver(dbg);
+    dbg.nospace() << "QMediaBufferingPolicy(" << p.maximumDuration() << "ms, "
+                  << p.maximumBytes() << "bytes, watermarks " << p.lowWatermark() << '-'
+                  << p.highWatermark() << ')';
+    return dbg;
+}
+#endif
+
+QT_END_NAMESPACE
@@ -0,0 +1,74 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QMEDIABUFFERINGPOLICY_H
+#define QMEDIABUFFERINGPOLICY_H
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtCore/qmetatype.h>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+class Q_MULTIMEDIA_EXPORT QMediaBufferingPolicy
+{
+public:
+    constexpr QMediaBufferingPolicy() noexcept = default;
+
+    constexpr void setMaximumDuration(qint64 milliseconds) noexcept { m_maximumDuration = milliseconds; }
+    constexpr qint64 maximumDuration() const noexcept { return m_maximumDuration; }
+
+    constexpr void setMaximumBytes(qint64 bytes) noexcept { m_maximumBytes = bytes; }
+    constexpr qint64 maximumBytes() const noexcept { return m_maximumBytes; }
+
+    constexpr void setLowWatermark(float fill) noexcept
+    {
+        m_lowWatermark = boundedWatermark(fill);
+        m_highWatermark = qMax(m_highWatermark, m_lowWatermark);
+    }
+    constexpr float lowWatermark() const noexcept { return m_lowWatermark; }
+
+    constexpr void setHighWatermark(float fill) noexcept
+    {
+        m_highWatermark = boundedWatermark(fill);
+        m_lowWatermark = qMin(m_lowWatermark, m_highWatermark);
+    }
+    constexpr float highWatermark() const noexcept { return m_highWatermark; }
+
+    float fill(qint64 bufferedDuration, qint64 bufferedBytes) const noexcept;
+
+    friend bool operator==(const QMediaBufferingPolicy &a, const QMediaBufferingPolicy &b)
+    {
+        return a.m_maximumDuration == b.m_maximumDuration
+                && a.m_maximumBytes == b.m_maximumBytes
+                && a.m_lowWatermark == b.m_lowWatermark
+                && a.m_highWatermark == b.m_highWatermark;
+    }
+    friend bool operator!=(const QMediaBufferingPolicy &a, const QMediaBufferingPolicy &b)
+    {
+        return !(a == b);
+    }
+
+private:
+    // Watermarks are in (0, 1]. A low watermark of 0 would never resume reading.
+    static constexpr float boundedWatermark(float fill) noexcept
+    {
+        return fill > 1.f ? 1.f : fill > 0.f ? fill : std::numeric_limits<float>::epsilon();
+    }
+
+    qint64 m_maximumDuration = 4000;
+    qint64 m_maximumBytes = 0;
+    float m_lowWatermark = 0.75f;
+    float m_highWatermark = 1.f;
+};
+
+#ifndef QT_NO_DEBUG_STREAM
+Q_MULTIMEDIA_EXPORT QDebug operator<<(QDebug, const QMediaBufferingPolicy &);
+#endif
+
+QT_END_NAMESPACE
+
+Q_DECLARE_METATYPE(QMediaBufferingPolicy)
+
+#endif // QMEDIABUFFERINGPOLICY_H
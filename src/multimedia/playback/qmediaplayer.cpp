@@ -364,6 +364,106 @@ QMediaTimeRange QMediaPlayer::bufferedTimeRange() const
     return d->control ? d->control->availablePlaybackRanges() : QMediaTimeRange{};
 }
 
+/*!
+    \property QMediaPlayer::bufferingPolicy
+    \since 6.7
+
+    This property holds how much media data the player reads ahead of the
+    current position.
+
+    Backends that don't support buffering policies ignore this property.
+
+    \sa QMediaBufferingPolicy, bufferedDuration(), bufferedBytes()
+*/
+QMediaBufferingPolicy QMediaPlayer::bufferingPolicy() const
+{
+    Q_D(const QMediaPlayer);
+    return d->control ? d->control->bufferingPolicy() : QMediaBufferingPolicy{};
+}
+
+void QMediaPlayer::setBufferingPolicy(const QMediaBufferingPolicy &policy)
+{
+    Q_D(QMediaPlayer);
+    if (d->control)
+        d->control->setBufferingPolicy(policy);
+}
+
+/*!
+    \since 6.7
+
+    Returns the duration in ms of the media data that is currently buffered
+    ahead of the playback position, in the stream holding the most data.
+
+    Returns 0 if the backend doesn't report the buffer fill.
+
+    \sa bufferingPolicy, bufferedBytes(), QMediaBufferingPolicy::fill()
+*/
+qint64 QMediaPlayer::bufferedDuration() const
+{
+    Q_D(const QMediaPlayer);
+    return d->control ? d->control->bufferedDuration() : 0;
+}
+
+/*!
+    \since 6.7
+
+    Returns the amount of compressed media data in bytes that is currently
+    buffered ahead of the playback position, summed over all streams.
+
+    Returns 0 if the backend doesn't report the buffer fill.
+
+    \sa bufferingPolicy, bufferedDuration(), QMediaBufferingPolicy::fill()
+*/
+qint64 QMediaPlayer::bufferedBytes() const
+{
+    Q_D(const QMediaPlayer);
+    return d->control ? d->control->bufferedBytes() : 0;
+}
+
+/*!
+    \since 6.7
+
+    Returns the number of decoded video frames that were not shown because
+    they were already late, for the current video track.
+
+    When decoding can't keep up with the playback, dropping late frames keeps
+    the video in sync with the audio. The count is reset when the source or the
+    active video track changes.
+
+    Returns 0 if the backend doesn't report dropped frames.
+
+    \sa skippedVideoFrames()
+*/
+qint64 QMediaPlayer::droppedVideoFrames() const
+{
+    Q_D(const QMediaPlayer);
+    return d->control ? d->control->droppedVideoFrames() : 0;
+}
+
+/*!
+    \since 6.7
+
+    Returns an estimate of the number of video frames that were not decoded
+    at all, for the current video track.
+
+    When video frames are late persistently, backends may stop decoding the
+    frames no other frame depends on, until the playback catches up. The
+    decoder discards these frames without reporting them, so the count is
+    derived from the input that produced no frame. Decoders that delay their
+    output, for example to decode several frames in parallel, make it count
+    a few frames too many. The count is reset when the source or the active
+    video track changes.
+
+    Returns 0 if the backend doesn't skip frames.
+
+    \sa droppedVideoFrames()
+*/
+qint64 QMediaPlayer::skippedVideoFrames() const
+{
+    Q_D(const QMediaPlayer);
+    return d->control ? d->control->skippedVideoFrames() : 0;
+}
+
 /*!
     \qmlproperty bool QtMultimedia::MediaPlayer::hasAudio
 
@@ -408,6 +508,49 @@ bool QMediaPlayer::isSeekable() const
     return d->control && d->control->isSeekable();
 }
 
+/*!
+    \enum QMediaPlayer::SeekMode
+    \since 6.7
+
+    Defines where the playback continues after the \l position was set.
+
+    \value AccurateSeek The playback continues exactly at the requested
+    position. The video frames from the preceding key frame up to the position
+    have to be decoded first, which is what frame stepping needs. This is the
+    default.
+    \value KeyFrameSeek The playback continues at the key frame closest to the
+    requested position, and the position changes to it. Backends may look the
+    key frame up asynchronously, so the position can change only after
+    setPosition() returned. Nothing has to be decoded ahead, so seeking is
+    fast, which is what scrubbing needs.
+*/
+
+/*!
+    \property QMediaPlayer::seekMode
+    \since 6.7
+
+    This property holds where the playback continues after the \l position
+    was set.
+
+    Backends that can't seek to key frames always seek accurately. Media without
+    a video track are always seeked accurately, as every audio frame can be
+    decoded on its own.
+
+    \sa QMediaPlayer::SeekMode, seekable
+*/
+QMediaPlayer::SeekMode QMediaPlayer::seekMode() const
+{
+    Q_D(const QMediaPlayer);
+    return d->control ? d->control->seekMode() : AccurateSeek;
+}
+
+void QMediaPlayer::setSeekMode(SeekMode mode)
+{
+    Q_D(QMediaPlayer);
+    if (d->control)
+        d->control->setSeekMode(mode);
+}
+
 bool QMediaPlayer::isPlaying() const
 {
     Q_D(const QMediaPlayer);
@@ -1211,6 +1354,7 @@ QMediaMetaData QMediaPlayer::metaData() const
     indicated with the positionChanged() signal.
 
     If the \l seekable property is true, this property can be set to milliseconds.
+    The \l seekMode property tells where the playback continues then.
 */
 
 /*!
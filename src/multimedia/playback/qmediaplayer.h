@@ -9,6 +9,7 @@
 #include <QtMultimedia/qtmultimediaglobal.h>
 #include <QtMultimedia/qmediaenumdebug.h>
 #include <QtMultimedia/qaudio.h>
+#include <QtMultimedia/qmediabufferingpolicy.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -26,6 +27,9 @@ class Q_MULTIMEDIA_EXPORT QMediaPlayer : public QObject
     Q_PROPERTY(qint64 duration READ duration NOTIFY durationChanged)
     Q_PROPERTY(qint64 position READ position WRITE setPosition NOTIFY positionChanged)
     Q_PROPERTY(float bufferProgress READ bufferProgress NOTIFY bufferProgressChanged)
+    Q_PROPERTY(QMediaBufferingPolicy bufferingPolicy READ bufferingPolicy WRITE setBufferingPolicy
+                       NOTIFY bufferingPolicyChanged)
+    Q_PROPERTY(SeekMode seekMode READ seekMode WRITE setSeekMode NOTIFY seekModeChanged)
     Q_PROPERTY(bool hasAudio READ hasAudio NOTIFY hasAudioChanged)
     Q_PROPERTY(bool hasVideo READ hasVideo NOTIFY hasVideoChanged)
     Q_PROPERTY(bool seekable READ isSeekable NOTIFY seekableChanged)
@@ -91,6 +95,13 @@ public:
     };
     Q_ENUM(Loops)
 
+    enum SeekMode
+    {
+        AccurateSeek,
+        KeyFrameSeek
+    };
+    Q_ENUM(SeekMode)
+
     explicit QMediaPlayer(QObject *parent = nullptr);
     ~QMediaPlayer();
 
@@ -130,7 +141,18 @@ public:
     float bufferProgress() const;
     QMediaTimeRange bufferedTimeRange() const;
 
+    QMediaBufferingPolicy bufferingPolicy() const;
+    void setBufferingPolicy(const QMediaBufferingPolicy &policy);
+    qint64 bufferedDuration() const;
+    qint64 bufferedBytes() const;
+
+    qint64 droppedVideoFrames() const;
+    qint64 skippedVideoFrames() const;
+
     bool isSeekable() const;
+    SeekMode seekMode() const;
+    void setSeekMode(SeekMode mode);
+
     qreal playbackRate() const;
 
     bool isPlaying() const;
@@ -168,8 +190,10 @@ Q_SIGNALS:
     void hasVideoChanged(bool videoAvailable);
 
     void bufferProgressChanged(float progress);
+    void bufferingPolicyChanged();
 
     void seekableChanged(bool seekable);
+    void seekModeChanged();
     void playingChanged(bool playing);
     void playbackRateChanged(qreal rate);
     void loopsChanged();
@@ -472,10 +472,12 @@ qint64 QPulseAudioSink::write(const char *data, qint64 len)
 
     len = qMin(len, qint64(nbytes));
 
-    if (m_volume < 1.0f) {
+    if (m_volume < 1.0f || m_appliedVolume < 1.0f) {
         // Don't use PulseAudio volume, as it might affect all other streams of the same category
         // or even affect the system volume if flat volumes are enabled
-        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, dest, len);
+        QAudioHelperInternal::qMultiplySamples(m_appliedVolume, m_volume, m_format, data, dest,
+                                               len);
+        m_appliedVolume = m_volume;
     } else {
         memcpy(dest, data, len);
     }
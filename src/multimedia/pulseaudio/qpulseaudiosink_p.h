@@ -101,6 +101,8 @@ private:
     mutable qint64 averageLatency = 0; // average latency
     mutable qint64 lastProcessedUSecs = 0;
     qreal m_volume = 1.0;
+    // The volume the last written buffer ended with; changes are ramped from it
+    qreal m_appliedVolume = 1.0;
 
     std::atomic<QAudio::Error> m_errorState = QAudio::NoError;
     std::atomic<QAudio::State> m_deviceState = QAudio::StoppedState;
@@ -918,6 +918,175 @@ void QMediaRecorder::setAudioSampleRate(int sampleRate)
     emit audioSampleRateChanged();
 }
 
+/*!
+    \qmlproperty int QtMultimedia::MediaRecorder::encodingQueueDepth
+    \since 6.7
+    \brief This property holds the number of video frames that can wait for
+    the encoder.
+*/
+
+/*!
+    \property QMediaRecorder::encodingQueueDepth
+    \since 6.7
+    \brief This property holds the number of video frames that can wait for
+    the encoder.
+
+    When the encoder can't keep up with a video source, the frames are queued
+    up to this depth; further frames are dropped and counted in
+    droppedFrames(). A deeper queue absorbs longer encoding stalls at the cost
+    of memory, which is about 12 MB per frame for 4K video.
+
+    A value of \c -1 lets the backend choose the depth. The property is
+    applied when recording starts. Backends that don't queue frames ignore it.
+
+    \sa droppedFrames()
+*/
+int QMediaRecorder::encodingQueueDepth() const
+{
+    Q_D(const QMediaRecorder);
+    return d->encoderSettings.encodingQueueDepth();
+}
+
+/*!
+    \fn void QMediaRecorder::encodingQueueDepthChanged()
+
+    Signals when the encoding queue depth changes.
+*/
+void QMediaRecorder::setEncodingQueueDepth(int depth)
+{
+    Q_D(QMediaRecorder);
+    if (d->encoderSettings.encodingQueueDepth() == depth)
+        return;
+    d->encoderSettings.setEncodingQueueDepth(depth);
+    emit encodingQueueDepthChanged();
+}
+
+/*!
+    \qmlproperty qint64 QtMultimedia::MediaRecorder::droppedFrames
+    \since 6.7
+    \brief This property holds the number of video frames and audio buffers
+    dropped in the current recording.
+*/
+
+/*!
+    \property QMediaRecorder::droppedFrames
+    \since 6.7
+    \brief This property holds the number of video frames and audio buffers
+    dropped in the current recording.
+
+    Frames are dropped when the encoder can't keep up with the video sources
+    and the encoding queue is full. Audio buffers are dropped when the audio
+    encoder can't keep up with the audio input. The count is reset when
+    recording starts.
+
+    \sa encodingQueueDepth
+*/
+qint64 QMediaRecorder::droppedFrames() const
+{
+    Q_D(const QMediaRecorder);
+    return d->control ? d->control->droppedFrames() : 0;
+}
+
+/*!
+    \fn void QMediaRecorder::droppedFramesChanged(qint64 droppedFrames)
+
+    Signals when the number of \a droppedFrames changes.
+*/
+
+/*!
+    \qmlproperty int QtMultimedia::MediaRecorder::encodingThreadCount
+    \since 6.7
+    \brief This property holds the number of threads used to encode video.
+*/
+
+/*!
+    \property QMediaRecorder::encodingThreadCount
+    \since 6.7
+    \brief This property holds the number of threads used to encode video.
+
+    Software encoders spread the encoding of a video stream over this number
+    of threads, and convert the frames to the format of the encoder in
+    parallel with encoding. This increases the throughput at high resolutions
+    and frame rates, at the cost of some latency and memory.
+
+    A value of \c -1 lets the backend choose, usually depending on the number
+    of CPU cores. A value of \c 1 encodes each stream on a single thread.
+    The property is applied when recording starts. Backends that don't
+    control the encoder threads ignore it.
+
+    \sa encodingThreadType
+*/
+int QMediaRecorder::encodingThreadCount() const
+{
+    Q_D(const QMediaRecorder);
+    return d->encoderSettings.encodingThreadCount();
+}
+
+/*!
+    \fn void QMediaRecorder::encodingThreadCountChanged()
+
+    Signals when the number of encoding threads changes.
+*/
+void QMediaRecorder::setEncodingThreadCount(int count)
+{
+    Q_D(QMediaRecorder);
+    if (d->encoderSettings.encodingThreadCount() == count)
+        return;
+    d->encoderSettings.setEncodingThreadCount(count);
+    emit encodingThreadCountChanged();
+}
+
+/*!
+    \enum QMediaRecorder::EncodingThreadType
+    \since 6.7
+
+    Enumerates the ways a video encoder can spread its work over threads.
+
+    \value AutomaticThreading The encoder chooses among the types it supports.
+    \value FrameThreading Several frames are encoded in parallel. This gives the
+           best throughput, but delays each frame by one frame per thread.
+    \value SliceThreading The slices of a frame are encoded in parallel. This
+           adds no latency, but scales worse than frame threading.
+*/
+
+/*!
+    \qmlproperty enumeration QtMultimedia::MediaRecorder::encodingThreadType
+    \since 6.7
+    \brief This property holds how video encoding is spread over threads.
+    \sa QMediaRecorder::EncodingThreadType
+*/
+
+/*!
+    \property QMediaRecorder::encodingThreadType
+    \since 6.7
+    \brief This property holds how video encoding is spread over threads.
+
+    Encoders that don't support the requested type fall back to the types
+    they support. The property is applied when recording starts. Backends
+    that don't control the encoder threads ignore it.
+
+    \sa encodingThreadCount
+*/
+QMediaRecorder::EncodingThreadType QMediaRecorder::encodingThreadType() const
+{
+    Q_D(const QMediaRecorder);
+    return d->encoderSettings.encodingThreadType();
+}
+
+/*!
+    \fn void QMediaRecorder::encodingThreadTypeChanged()
+
+    Signals when the encoding thread type changes.
+*/
+void QMediaRecorder::setEncodingThreadType(EncodingThreadType type)
+{
+    Q_D(QMediaRecorder);
+    if (d->encoderSettings.encodingThreadType() == type)
+        return;
+    d->encoderSettings.setEncodingThreadType(type);
+    emit encodingThreadTypeChanged();
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qmediarecorder.cpp"
@@ -44,6 +44,13 @@ class Q_MULTIMEDIA_EXPORT QMediaRecorder : public QObject
     Q_PROPERTY(int audioBitRate READ audioBitRate WRITE setAudioBitRate NOTIFY audioBitRateChanged)
     Q_PROPERTY(int audioChannelCount READ audioChannelCount WRITE setAudioChannelCount NOTIFY audioChannelCountChanged)
     Q_PROPERTY(int audioSampleRate READ audioSampleRate WRITE setAudioSampleRate NOTIFY audioSampleRateChanged)
+    Q_PROPERTY(int encodingQueueDepth READ encodingQueueDepth WRITE setEncodingQueueDepth
+                       NOTIFY encodingQueueDepthChanged)
+    Q_PROPERTY(qint64 droppedFrames READ droppedFrames NOTIFY droppedFramesChanged)
+    Q_PROPERTY(int encodingThreadCount READ encodingThreadCount WRITE setEncodingThreadCount
+                       NOTIFY encodingThreadCountChanged)
+    Q_PROPERTY(QMediaRecorder::EncodingThreadType encodingThreadType READ encodingThreadType
+                       WRITE setEncodingThreadType NOTIFY encodingThreadTypeChanged)
 public:
     enum Quality
     {
@@ -64,6 +71,14 @@ public:
     };
     Q_ENUM(EncodingMode)
 
+    enum EncodingThreadType
+    {
+        AutomaticThreading,
+        FrameThreading,
+        SliceThreading
+    };
+    Q_ENUM(EncodingThreadType)
+
     enum RecorderState
     {
         StoppedState,
@@ -127,6 +142,17 @@ public:
     int audioSampleRate() const;
     void setAudioSampleRate(int sampleRate);
 
+    int encodingQueueDepth() const;
+    void setEncodingQueueDepth(int depth);
+
+    qint64 droppedFrames() const;
+
+    int encodingThreadCount() const;
+    void setEncodingThreadCount(int count);
+
+    EncodingThreadType encodingThreadType() const;
+    void setEncodingThreadType(EncodingThreadType type);
+
     QMediaMetaData metaData() const;
     void setMetaData(const QMediaMetaData &metaData);
     void addMetaData(const QMediaMetaData &metaData);
@@ -159,6 +185,10 @@ Q_SIGNALS:
     void audioBitRateChanged();
     void audioChannelCountChanged();
     void audioSampleRateChanged();
+    void encodingQueueDepthChanged();
+    void droppedFramesChanged(qint64 droppedFrames);
+    void encodingThreadCountChanged();
+    void encodingThreadTypeChanged();
 
 private:
     QMediaRecorderPrivate *d_ptr;
@@ -80,6 +80,8 @@ QScreenCapture::QScreenCapture(QObject *parent)
                 &QScreenCapture::activeChanged);
         connect(platformCapture, &QPlatformSurfaceCapture::errorChanged, this,
                 &QScreenCapture::errorChanged);
+        connect(platformCapture, &QPlatformSurfaceCapture::statisticsChanged, this,
+                &QScreenCapture::statisticsChanged);
         connect(platformCapture, &QPlatformSurfaceCapture::errorOccurred, this,
                 [this](QPlatformSurfaceCapture::Error error, QString errorString) {
                     emit errorOccurred(toScreenCaptureError(error), errorString);
@@ -250,6 +252,87 @@ class QPlatformSurfaceCapture *QScreenCapture::platformScreenCapture() const
     return d->platformScreenCapture.get();
 }
 
+/*!
+    \qmlproperty qint64 QtMultimedia::ScreenCapture::capturedFrames
+    \since 6.7
+    \brief This property holds the number of frames captured since the
+    capturing started.
+*/
+
+/*!
+    \property QScreenCapture::capturedFrames
+    \since 6.7
+    \brief This property holds the number of frames captured since the
+    capturing started.
+
+    The capture statistics are updated about once per second while capturing.
+    Backends that don't collect statistics always report \c 0.
+
+    \sa skippedFrames, averageCaptureTime
+*/
+qint64 QScreenCapture::capturedFrames() const
+{
+    Q_D(const QScreenCapture);
+
+    return d->platformScreenCapture ? d->platformScreenCapture->capturedFrames() : 0;
+}
+
+/*!
+    \qmlproperty qint64 QtMultimedia::ScreenCapture::skippedFrames
+    \since 6.7
+    \brief This property holds the number of captures that didn't produce a
+    frame since the capturing started.
+*/
+
+/*!
+    \property QScreenCapture::skippedFrames
+    \since 6.7
+    \brief This property holds the number of captures that didn't produce a
+    frame since the capturing started.
+
+    A capture is skipped if the screen content hasn't changed, or if it
+    couldn't be grabbed.
+
+    \sa capturedFrames
+*/
+qint64 QScreenCapture::skippedFrames() const
+{
+    Q_D(const QScreenCapture);
+
+    return d->platformScreenCapture ? d->platformScreenCapture->skippedFrames() : 0;
+}
+
+/*!
+    \qmlproperty real QtMultimedia::ScreenCapture::averageCaptureTime
+    \since 6.7
+    \brief This property holds the average time in milliseconds it takes to
+    capture a frame.
+*/
+
+/*!
+    \property QScreenCapture::averageCaptureTime
+    \since 6.7
+    \brief This property holds the average time in milliseconds it takes to
+    capture a frame.
+
+    The average includes the skipped captures. If it approaches the frame
+    interval, the capturing can't keep up with the frame rate.
+
+    \sa capturedFrames
+*/
+qreal QScreenCapture::averageCaptureTime() const
+{
+    Q_D(const QScreenCapture);
+
+    return d->platformScreenCapture ? d->platformScreenCapture->averageCaptureTime() : 0.;
+}
+
+/*!
+    \fn void QScreenCapture::statisticsChanged()
+
+    Signals when the capture statistics change.
+*/
+
 QT_END_NAMESPACE
 
 #include "moc_qscreencapture.cpp"
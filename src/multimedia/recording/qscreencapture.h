@@ -24,6 +24,9 @@ class Q_MULTIMEDIA_EXPORT QScreenCapture : public QObject
     Q_PROPERTY(QScreen *screen READ screen WRITE setScreen NOTIFY screenChanged)
     Q_PROPERTY(Error error READ error NOTIFY errorChanged)
     Q_PROPERTY(QString errorString READ errorString NOTIFY errorChanged)
+    Q_PROPERTY(qint64 capturedFrames READ capturedFrames NOTIFY statisticsChanged)
+    Q_PROPERTY(qint64 skippedFrames READ skippedFrames NOTIFY statisticsChanged)
+    Q_PROPERTY(qreal averageCaptureTime READ averageCaptureTime NOTIFY statisticsChanged)
 
 public:
     enum Error {
@@ -48,6 +51,10 @@ public:
     Error error() const;
     QString errorString() const;
 
+    qint64 capturedFrames() const;
+    qint64 skippedFrames() const;
+    qreal averageCaptureTime() const;
+
 public Q_SLOTS:
     void setActive(bool active);
     void start() { setActive(true); }
@@ -56,6 +63,7 @@ public Q_SLOTS:
 Q_SIGNALS:
     void activeChanged(bool);
     void errorChanged();
+    void statisticsChanged();
     void screenChanged(QScreen *);
     void errorOccurred(QScreenCapture::Error error, const QString &errorString);
 
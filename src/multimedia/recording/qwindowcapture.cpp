@@ -82,6 +82,8 @@ QWindowCapture::QWindowCapture(QObject *parent) : QObject(*new QWindowCapturePri
                 &QWindowCapture::activeChanged);
         connect(platformCapture, &QPlatformSurfaceCapture::errorChanged, this,
                 &QWindowCapture::errorChanged);
+        connect(platformCapture, &QPlatformSurfaceCapture::statisticsChanged, this,
+                &QWindowCapture::statisticsChanged);
         connect(platformCapture, &QPlatformSurfaceCapture::errorOccurred, this,
                 [this](QPlatformSurfaceCapture::Error error, QString errorString) {
                     emit errorOccurred(toWindowCaptureError(error), errorString);
@@ -263,6 +265,87 @@ QPlatformSurfaceCapture *QWindowCapture::platformWindowCapture() const
     return d->platformWindowCapture.get();
 }
 
+/*!
+    \qmlproperty qint64 QtMultimedia::WindowCapture::capturedFrames
+    \since 6.7
+    \brief This property holds the number of frames captured since the
+    capturing started.
+*/
+
+/*!
+    \property QWindowCapture::capturedFrames
+    \since 6.7
+    \brief This property holds the number of frames captured since the
+    capturing started.
+
+    The capture statistics are updated about once per second while capturing.
+    Backends that don't collect statistics always report \c 0.
+
+    \sa skippedFrames, averageCaptureTime
+*/
+qint64 QWindowCapture::capturedFrames() const
+{
+    Q_D(const QWindowCapture);
+
+    return d->platformWindowCapture ? d->platformWindowCapture->capturedFrames() : 0;
+}
+
+/*!
+    \qmlproperty qint64 QtMultimedia::WindowCapture::skippedFrames
+    \since 6.7
+    \brief This property holds the number of captures that didn't produce a
+    frame since the capturing started.
+*/
+
+/*!
+    \property QWindowCapture::skippedFrames
+    \since 6.7
+    \brief This property holds the number of captures that didn't produce a
+    frame since the capturing started.
+
+    A capture is skipped if the window content hasn't changed, or if it
+    couldn't be grabbed.
+
+    \sa capturedFrames
+*/
+qint64 QWindowCapture::skippedFrames() const
+{
+    Q_D(const QWindowCapture);
+
+    return d->platformWindowCapture ? d->platformWindowCapture->skippedFrames() : 0;
+}
+
+/*!
+    \qmlproperty real QtMultimedia::WindowCapture::averageCaptureTime
+    \since 6.7
+    \brief This property holds the average time in milliseconds it takes to
+    capture a frame.
+*/
+
+/*!
+    \property QWindowCapture::averageCaptureTime
+    \since 6.7
+    \brief This property holds the average time in milliseconds it takes to
+    capture a frame.
+
+    The average includes the skipped captures. If it approaches the frame
+    interval, the capturing can't keep up with the frame rate.
+
+    \sa capturedFrames
+*/
+qreal QWindowCapture::averageCaptureTime() const
+{
+    Q_D(const QWindowCapture);
+
+    return d->platformWindowCapture ? d->platformWindowCapture->averageCaptureTime() : 0.;
+}
+
+/*!
+    \fn void QWindowCapture::statisticsChanged()
+
+    Signals when the capture statistics change.
+*/
+
 QT_END_NAMESPACE
 
 #include "moc_qwindowcapture.cpp"
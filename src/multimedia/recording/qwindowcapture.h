@@ -20,6 +20,9 @@ class Q_MULTIMEDIA_EXPORT QWindowCapture : public QObject
     Q_PROPERTY(QCapturableWindow window READ window WRITE setWindow NOTIFY windowChanged)
     Q_PROPERTY(Error error READ error NOTIFY errorChanged)
     Q_PROPERTY(QString errorString READ errorString NOTIFY errorChanged)
+    Q_PROPERTY(qint64 capturedFrames READ capturedFrames NOTIFY statisticsChanged)
+    Q_PROPERTY(qint64 skippedFrames READ skippedFrames NOTIFY statisticsChanged)
+    Q_PROPERTY(qreal averageCaptureTime READ averageCaptureTime NOTIFY statisticsChanged)
 public:
     enum Error {
         NoError = 0,
@@ -46,6 +49,10 @@ public:
     Error error() const;
     QString errorString() const;
 
+    qint64 capturedFrames() const;
+    qint64 skippedFrames() const;
+    qreal averageCaptureTime() const;
+
 public Q_SLOTS:
     void setActive(bool active);
     void start() { setActive(true); }
@@ -55,6 +62,7 @@ Q_SIGNALS:
     void activeChanged(bool);
     void windowChanged(QCapturableWindow window);
     void errorChanged();
+    void statisticsChanged();
     void errorOccurred(QWindowCapture::Error error, const QString &errorString);
 
 private:
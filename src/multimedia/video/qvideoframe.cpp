@@ -670,6 +670,10 @@ bool QVideoFrame::mirrored() const
 
 /*!
     Based on the pixel format converts current video frame to image.
+
+    If the conversion runs on the CPU, large frames are converted on several
+    threads. Set the \c{QT_MEDIA_CPU_CONVERSION_THREADS} environment variable
+    to limit their number.
     \since 5.15
 */
 QImage QVideoFrame::toImage() const
@@ -4,135 +4,229 @@
 #include "qvideoframeconversionhelper_p.h"
 #include "qrgb.h"
 
+#include <private/qvideotexturehelper_p.h>
+
 #include <mutex>
 
 QT_BEGIN_NAMESPACE
 
-#define CLAMP(n) (n > 255 ? 255 : (n < 0 ? 0 : n))
+VideoFrameSlice::VideoFrameSlice(const QVideoFrame &mappedFrame)
+    : m_format(mappedFrame.surfaceFormat()),
+      m_width(mappedFrame.width()),
+      m_height(mappedFrame.height())
+{
+    const int planeCount = qMin(mappedFrame.planeCount(), MaxPlanes);
+    for (int plane = 0; plane < planeCount; ++plane) {
+        m_bits[plane] = mappedFrame.bits(plane);
+        m_bytesPerLine[plane] = mappedFrame.bytesPerLine(plane);
+    }
+}
 
-#define EXPAND_UV(u, v) \
-    int uu = u - 128; \
-    int vv = v - 128; \
-    int rv = 409 * vv + 128; \
-    int guv = 100 * uu + 208 * vv + 128; \
-    int bu = 516 * uu + 128; \
+VideoFrameSlice VideoFrameSlice::band(int firstRow, int rowCount) const
+{
+    const auto *description = QVideoTextureHelper::textureDescription(m_format.pixelFormat());
 
-static inline quint32 qYUVToARGB32(int y, int rv, int guv, int bu, int a = 0xff)
+    VideoFrameSlice result = *this;
+    for (int plane = 0; plane < description->nplanes; ++plane) {
+        if (result.m_bits[plane]) {
+            const int planeRow = firstRow / description->sizeScale[plane].y;
+            result.m_bits[plane] += qsizetype(planeRow) * m_bytesPerLine[plane];
+        }
+    }
+    result.m_height = rowCount;
+    return result;
+}
+
+// Coefficients are derived from the matrices in qvideotexturehelper.cpp, scaled to
+// 3.13 fixed point. Limited (video) range additionally expands luma by 255/219 and
+// chroma by 255/224.
+static const YUVToRGBCoefficients qYUVCoefficientsBT601Video = { 16, 9538, 13075, -3209, -6660, 16525 };
+static const YUVToRGBCoefficients qYUVCoefficientsBT601Full = { 0, 8192, 11485, -2819, -5850, 14516 };
+static const YUVToRGBCoefficients qYUVCoefficientsBT709Video = { 16, 9538, 14686, -1747, -4366, 17305 };
+static const YUVToRGBCoefficients qYUVCoefficientsBT709Full = { 0, 8192, 12901, -1535, -3835, 15201 };
+static const YUVToRGBCoefficients qYUVCoefficientsBT2020Video = { 16, 9538, 13752, -1535, -5328, 17545 };
+static const YUVToRGBCoefficients qYUVCoefficientsBT2020Full = { 0, 8192, 12080, -1348, -4681, 15412 };
+
+const YUVToRGBCoefficients &qYUVToRGBCoefficients(const QVideoFrameFormat &format)
 {
-    int yy = (y - 16) * 298;
-    return (a << 24)
-            | CLAMP((yy + rv) >> 8) << 16
-            | CLAMP((yy - guv) >> 8) << 8
-            | CLAMP((yy + bu) >> 8);
+    auto colorSpace = format.colorSpace();
+    if (colorSpace == QVideoFrameFormat::ColorSpace_Undefined) {
+        // Same heuristics as the shader based conversion
+        if (format.frameHeight() > 576)
+            colorSpace = QVideoFrameFormat::ColorSpace_BT709;
+        else
+            colorSpace = QVideoFrameFormat::ColorSpace_BT601;
+    }
+
+    const bool fullRange = format.colorRange() == QVideoFrameFormat::ColorRange_Full;
+    switch (colorSpace) {
+    case QVideoFrameFormat::ColorSpace_AdobeRgb:
+        return qYUVCoefficientsBT601Full;
+    case QVideoFrameFormat::ColorSpace_BT601:
+        return fullRange ? qYUVCoefficientsBT601Full : qYUVCoefficientsBT601Video;
+    case QVideoFrameFormat::ColorSpace_BT2020:
+        return fullRange ? qYUVCoefficientsBT2020Full : qYUVCoefficientsBT2020Video;
+    default:
+    case QVideoFrameFormat::ColorSpace_BT709:
+        return fullRange ? qYUVCoefficientsBT709Full : qYUVCoefficientsBT709Video;
+    }
 }
 
+void QT_FASTCALL qt_convert_YUVRow_to_ARGB32(const uchar *y, const uchar *u, const uchar *v,
+                                             int uvPixelStride, quint32 *rgb, int width,
+                                             const YUVToRGBCoefficients &c)
+{
+    int x = 0;
+    for (; x < width - 1; x += 2) {
+        const YUVChroma uv = qYUVExpandChroma(c, *u, *v);
+        u += uvPixelStride;
+        v += uvPixelStride;
+
+        *rgb++ = qYUVToARGB32(c, *y++, uv);
+        *rgb++ = qYUVToARGB32(c, *y++, uv);
+    }
+
+    // leftovers
+    if (x < width)
+        *rgb = qYUVToARGB32(c, *y, qYUVExpandChroma(c, *u, *v));
+}
+
+template<int yOffset, int uOffset, int vOffset>
+static inline void packedYUV422Row_to_ARGB32(const uchar *src, quint32 *rgb, int width,
+                                             const YUVToRGBCoefficients &c)
+{
+    int x = 0;
+    for (; x < width - 1; x += 2) {
+        const YUVChroma uv = qYUVExpandChroma(c, src[uOffset], src[vOffset]);
+
+        *rgb++ = qYUVToARGB32(c, src[yOffset], uv);
+        *rgb++ = qYUVToARGB32(c, src[yOffset + 2], uv);
+        src += 4;
+    }
+
+    // leftovers
+    if (x < width)
+        *rgb = qYUVToARGB32(c, src[yOffset], qYUVExpandChroma(c, src[uOffset], src[vOffset]));
+}
+
+void QT_FASTCALL qt_convert_UYVYRow_to_ARGB32(const uchar *src, quint32 *rgb, int width,
+                                              const YUVToRGBCoefficients &c)
+{
+    packedYUV422Row_to_ARGB32<1, 0, 2>(src, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_YUYVRow_to_ARGB32(const uchar *src, quint32 *rgb, int width,
+                                              const YUVToRGBCoefficients &c)
+{
+    packedYUV422Row_to_ARGB32<0, 1, 3>(src, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_P016Row_to_ARGB32(const quint16 *y, const quint16 *uv,
+                                              quint32 *rgb, int width,
+                                              const YUVToRGBCoefficients &c)
+{
+    // Only the 8 most significant bits are used, P010 stores its samples MSB aligned
+    int x = 0;
+    for (; x < width - 1; x += 2) {
+        const YUVChroma chroma = qYUVExpandChroma(c, uv[0] >> 8, uv[1] >> 8);
+        uv += 2;
+
+        *rgb++ = qYUVToARGB32(c, *y++ >> 8, chroma);
+        *rgb++ = qYUVToARGB32(c, *y++ >> 8, chroma);
+    }
+
+    // leftovers
+    if (x < width)
+        *rgb = qYUVToARGB32(c, *y >> 8, qYUVExpandChroma(c, uv[0] >> 8, uv[1] >> 8));
+}
+
+template<YUVRowConvertFunc convertRow>
 static inline void planarYUV420_to_ARGB32(const uchar *y, int yStride,
                                           const uchar *u, int uStride,
                                           const uchar *v, int vStride,
                                           int uvPixelStride,
                                           quint32 *rgb,
-                                          int width, int height)
+                                          int width, int height,
+                                          const YUVToRGBCoefficients &c)
 {
     height &= ~1;
-    quint32 *rgb0 = rgb;
-    quint32 *rgb1 = rgb + width;
 
     for (int j = 0; j < height; j += 2) {
-        const uchar *lineY0 = y;
-        const uchar *lineY1 = y + yStride;
-        const uchar *lineU = u;
-        const uchar *lineV = v;
-
-        for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
-            lineU += uvPixelStride;
-            lineV += uvPixelStride;
-
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
-            *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
-        }
+        convertRow(y, u, v, uvPixelStride, rgb, width, c);
+        convertRow(y + yStride, u, v, uvPixelStride, rgb + width, width, c);
 
         y += yStride << 1; // stride * 2
         u += uStride;
         v += vStride;
-        rgb0 += width;
-        rgb1 += width;
+        rgb += width << 1;
     }
 }
 
+template<YUVRowConvertFunc convertRow>
 static inline void planarYUV422_to_ARGB32(const uchar *y, int yStride,
                                           const uchar *u, int uStride,
                                           const uchar *v, int vStride,
                                           int uvPixelStride,
                                           quint32 *rgb,
-                                          int width, int height)
+                                          int width, int height,
+                                          const YUVToRGBCoefficients &c)
 {
-    quint32 *rgb0 = rgb;
-
     for (int j = 0; j < height; ++j) {
-        const uchar *lineY0 = y;
-        const uchar *lineU = u;
-        const uchar *lineV = v;
-
-        for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
-            lineU += uvPixelStride;
-            lineV += uvPixelStride;
+        convertRow(y, u, v, uvPixelStride, rgb, width, c);
 
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-        }
-
-        y += yStride; // stride * 2
+        y += yStride;
         u += uStride;
         v += vStride;
-        rgb0 += width;
+        rgb += width;
     }
 }
 
-
-
-static void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<YUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
-    planarYUV420_to_ARGB32(plane1, plane1Stride,
-                           plane2, plane2Stride,
-                           plane3, plane3Stride,
-                           1,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
+    planarYUV420_to_ARGB32<convertRow>(plane1, plane1Stride,
+                                       plane2, plane2Stride,
+                                       plane3, plane3Stride,
+                                       1,
+                                       reinterpret_cast<quint32*>(output),
+                                       width, height,
+                                       qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
-static void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<YUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
-    planarYUV422_to_ARGB32(plane1, plane1Stride,
-                           plane2, plane2Stride,
-                           plane3, plane3Stride,
-                           1,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
+    planarYUV422_to_ARGB32<convertRow>(plane1, plane1Stride,
+                                       plane2, plane2Stride,
+                                       plane3, plane3Stride,
+                                       1,
+                                       reinterpret_cast<quint32*>(output),
+                                       width, height,
+                                       qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 
-static void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<YUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_YV12_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
-    planarYUV420_to_ARGB32(plane1, plane1Stride,
-                           plane3, plane3Stride,
-                           plane2, plane2Stride,
-                           1,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
+    planarYUV420_to_ARGB32<convertRow>(plane1, plane1Stride,
+                                       plane3, plane3Stride,
+                                       plane2, plane2Stride,
+                                       1,
+                                       reinterpret_cast<quint32*>(output),
+                                       width, height,
+                                       qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
-static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
 
+    const YUVToRGBCoefficients &c = qYUVToRGBCoefficients(frame.surfaceFormat());
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
@@ -144,20 +238,19 @@ static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, ucha
             int u = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
-
-            *rgb++ = qPremultiply(qYUVToARGB32(y, rv, guv, bu, a));
+            *rgb++ = qPremultiply(qYUVToARGB32(c, y, qYUVExpandChroma(c, u, v), a));
         }
 
         src += stride;
     }
 }
 
-static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
 
+    const YUVToRGBCoefficients &c = qYUVToRGBCoefficients(frame.surfaceFormat());
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
@@ -169,146 +262,122 @@ static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const QVideoFram
             int u = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
-
-            *rgb++ = qYUVToARGB32(y, rv, guv, bu, a);
+            *rgb++ = qYUVToARGB32(c, y, qYUVExpandChroma(c, u, v), a);
         }
 
         src += stride;
     }
 }
 
-static void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<PackedYUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_packedYUV422_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
+    const YUVToRGBCoefficients &c = qYUVToRGBCoefficients(frame.surfaceFormat());
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
-        const uchar *lineSrc = src;
-
-        for (int j = 0; j < width; j += 2) {
-            int u = *lineSrc++;
-            int y0 = *lineSrc++;
-            int v = *lineSrc++;
-            int y1 = *lineSrc++;
-
-            EXPAND_UV(u, v);
-
-            *rgb++ = qYUVToARGB32(y0, rv, guv, bu);
-            *rgb++ = qYUVToARGB32(y1, rv, guv, bu);
-        }
-
-        src += stride;
-    }
-}
-
-static void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame &frame, uchar *output)
-{
-    FETCH_INFO_PACKED(frame)
-    MERGE_LOOPS(width, height, stride, 2)
-
-    quint32 *rgb = reinterpret_cast<quint32*>(output);
-
-    for (int i = 0; i < height; ++i) {
-        const uchar *lineSrc = src;
-
-        for (int j = 0; j < width; j += 2) {
-            int y0 = *lineSrc++;
-            int u = *lineSrc++;
-            int y1 = *lineSrc++;
-            int v = *lineSrc++;
-
-            EXPAND_UV(u, v);
-
-            *rgb++ = qYUVToARGB32(y0, rv, guv, bu);
-            *rgb++ = qYUVToARGB32(y1, rv, guv, bu);
-        }
+        convertRow(src, rgb, width, c);
 
         src += stride;
+        rgb += width;
     }
 }
 
-static void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<YUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_NV12_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
-    planarYUV420_to_ARGB32(plane1, plane1Stride,
-                           plane2, plane2Stride,
-                           plane2 + 1, plane2Stride,
-                           2,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
+    planarYUV420_to_ARGB32<convertRow>(plane1, plane1Stride,
+                                       plane2, plane2Stride,
+                                       plane2 + 1, plane2Stride,
+                                       2,
+                                       reinterpret_cast<quint32*>(output),
+                                       width, height,
+                                       qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
-static void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<YUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_NV21_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
-    planarYUV420_to_ARGB32(plane1, plane1Stride,
-                           plane2 + 1, plane2Stride,
-                           plane2, plane2Stride,
-                           2,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
+    planarYUV420_to_ARGB32<convertRow>(plane1, plane1Stride,
+                                       plane2 + 1, plane2Stride,
+                                       plane2, plane2Stride,
+                                       2,
+                                       reinterpret_cast<quint32*>(output),
+                                       width, height,
+                                       qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
-static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<YUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
     Q_ASSERT(plane1Stride == plane3Stride);
 
-    planarYUV420_to_ARGB32(plane1, plane1Stride,
-                           plane3, plane3Stride,
-                           plane2, plane2Stride,
-                           1,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
+    planarYUV420_to_ARGB32<convertRow>(plane1, plane1Stride,
+                                       plane3, plane3Stride,
+                                       plane2, plane2Stride,
+                                       1,
+                                       reinterpret_cast<quint32*>(output),
+                                       width, height,
+                                       qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
-static void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<YUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
 
-    planarYUV420_to_ARGB32(plane1, plane1Stride,
-                           plane2 + (plane1Stride >> 1), plane1Stride,
-                           plane2, plane1Stride,
-                           1,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
+    planarYUV420_to_ARGB32<convertRow>(plane1, plane1Stride,
+                                       plane2 + (plane1Stride >> 1), plane1Stride,
+                                       plane2, plane1Stride,
+                                       1,
+                                       reinterpret_cast<quint32*>(output),
+                                       width, height,
+                                       qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
-static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<YUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
     Q_ASSERT(plane1Stride == plane3Stride);
 
-    planarYUV420_to_ARGB32(plane1, plane1Stride,
-                           plane2, plane2Stride,
-                           plane3, plane3Stride,
-                           1,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
+    planarYUV420_to_ARGB32<convertRow>(plane1, plane1Stride,
+                                       plane2, plane2Stride,
+                                       plane3, plane3Stride,
+                                       1,
+                                       reinterpret_cast<quint32*>(output),
+                                       width, height,
+                                       qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
-static void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const QVideoFrame &frame, uchar *output)
+template<YUVRowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
 
-    planarYUV420_to_ARGB32(plane1, plane1Stride,
-                           plane2, plane1Stride,
-                           plane2 + (plane1Stride >> 1), plane1Stride,
-                           1,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
+    planarYUV420_to_ARGB32<convertRow>(plane1, plane1Stride,
+                                       plane2, plane1Stride,
+                                       plane2 + (plane1Stride >> 1), plane1Stride,
+                                       1,
+                                       reinterpret_cast<quint32*>(output),
+                                       width, height,
+                                       qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 
+
 template<typename Pixel>
-static void QT_FASTCALL qt_convert_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
@@ -342,7 +411,7 @@ static void QT_FASTCALL qt_convert_to_ARGB32(const QVideoFrame &frame, uchar *ou
 }
 
 template<typename Pixel>
-static void QT_FASTCALL qt_convert_premultiplied_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_premultiplied_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
@@ -375,60 +444,31 @@ static void QT_FASTCALL qt_convert_premultiplied_to_ARGB32(const QVideoFrame &fr
     }
 }
 
-static inline void planarYUV420_16bit_to_ARGB32(const uchar *y, int yStride,
-                                                  const uchar *u, int uStride,
-                                                  const uchar *v, int vStride,
-                                                  int uvPixelStride,
-                                          quint32 *rgb,
-                                          int width, int height)
+
+template<P016RowConvertFunc convertRow>
+static void QT_FASTCALL qt_convert_P016_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
+    FETCH_INFO_BIPLANAR(frame)
+    const YUVToRGBCoefficients &c = qYUVToRGBCoefficients(frame.surfaceFormat());
+    quint32 *rgb = reinterpret_cast<quint32*>(output);
+
     height &= ~1;
-    quint32 *rgb0 = rgb;
-    quint32 *rgb1 = rgb + width;
 
     for (int j = 0; j < height; j += 2) {
-        const uchar *lineY0 = y;
-        const uchar *lineY1 = y + yStride;
-        const uchar *lineU = u;
-        const uchar *lineV = v;
-
-        for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
-            lineU += uvPixelStride;
-            lineV += uvPixelStride;
-
-            *rgb0++ = qYUVToARGB32(*lineY0, rv, guv, bu);
-            lineY0 += 2;
-            *rgb0++ = qYUVToARGB32(*lineY0, rv, guv, bu);
-            lineY0 += 2;
-            *rgb1++ = qYUVToARGB32(*lineY1, rv, guv, bu);
-            lineY1 += 2;
-            *rgb1++ = qYUVToARGB32(*lineY1, rv, guv, bu);
-            lineY1 += 2;
-        }
-
-        y += yStride << 1; // stride * 2
-        u += uStride;
-        v += vStride;
-        rgb0 += width;
-        rgb1 += width;
+        const quint16 *uv = reinterpret_cast<const quint16 *>(plane2);
+        convertRow(reinterpret_cast<const quint16 *>(plane1), uv, rgb, width, c);
+        convertRow(reinterpret_cast<const quint16 *>(plane1 + plane1Stride), uv, rgb + width,
+                   width, c);
+
+        plane1 += plane1Stride << 1; // stride * 2
+        plane2 += plane2Stride;
+        rgb += width << 1;
     }
 }
 
-static void QT_FASTCALL qt_convert_P016_to_ARGB32(const QVideoFrame &frame, uchar *output)
-{
-    FETCH_INFO_BIPLANAR(frame)
-    planarYUV420_16bit_to_ARGB32(plane1 + 1, plane1Stride,
-                           plane2 + 1, plane2Stride,
-                           plane2 + 3, plane2Stride,
-                           4,
-                           reinterpret_cast<quint32*>(output),
-                           width, height);
-
-}
 
 template <typename Y>
-static void QT_FASTCALL qt_convert_Y_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_Y_to_ARGB32(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, (int)sizeof(Y))
@@ -462,6 +502,7 @@ static void QT_FASTCALL qt_convert_Y_to_ARGB32(const QVideoFrame &frame, uchar *
     MERGE_LOOPS(width, height, stride, 1)
 }
 
+
 static VideoFrameConvertFunc qConvertFuncs[QVideoFrameFormat::NPixelFormats] = {
     /* Format_Invalid */                nullptr, // Not needed
     /* Format_ARGB8888 */                 qt_convert_to_ARGB32<ARGB8888>,
@@ -476,31 +517,68 @@ static VideoFrameConvertFunc qConvertFuncs[QVideoFrameFormat::NPixelFormats] = {
     /* Format_RGBX8888 */                 qt_convert_premultiplied_to_ARGB32<RGBX8888>,
     /* Format_AYUV */                     qt_convert_AYUV_to_ARGB32,
     /* Format_AYUV_Premultiplied */       qt_convert_AYUV_Premultiplied_to_ARGB32,
-    /* Format_YUV420P */                qt_convert_YUV420P_to_ARGB32,
-    /* Format_YUV422P */                qt_convert_YUV422P_to_ARGB32,
-    /* Format_YV12 */                   qt_convert_YV12_to_ARGB32,
-    /* Format_UYVY */                   qt_convert_UYVY_to_ARGB32,
-    /* Format_YUYV */                   qt_convert_YUYV_to_ARGB32,
-    /* Format_NV12 */                   qt_convert_NV12_to_ARGB32,
-    /* Format_NV21 */                   qt_convert_NV21_to_ARGB32,
-    /* Format_IMC1 */                   qt_convert_IMC1_to_ARGB32,
-    /* Format_IMC2 */                   qt_convert_IMC2_to_ARGB32,
-    /* Format_IMC3 */                   qt_convert_IMC3_to_ARGB32,
-    /* Format_IMC4 */                   qt_convert_IMC4_to_ARGB32,
+    /* Format_YUV420P */                qt_convert_YUV420P_to_ARGB32<qt_convert_YUVRow_to_ARGB32>,
+    /* Format_YUV422P */                qt_convert_YUV422P_to_ARGB32<qt_convert_YUVRow_to_ARGB32>,
+    /* Format_YV12 */                   qt_convert_YV12_to_ARGB32<qt_convert_YUVRow_to_ARGB32>,
+    /* Format_UYVY */                   qt_convert_packedYUV422_to_ARGB32<qt_convert_UYVYRow_to_ARGB32>,
+    /* Format_YUYV */                   qt_convert_packedYUV422_to_ARGB32<qt_convert_YUYVRow_to_ARGB32>,
+    /* Format_NV12 */                   qt_convert_NV12_to_ARGB32<qt_convert_YUVRow_to_ARGB32>,
+    /* Format_NV21 */                   qt_convert_NV21_to_ARGB32<qt_convert_YUVRow_to_ARGB32>,
+    /* Format_IMC1 */                   qt_convert_IMC1_to_ARGB32<qt_convert_YUVRow_to_ARGB32>,
+    /* Format_IMC2 */                   qt_convert_IMC2_to_ARGB32<qt_convert_YUVRow_to_ARGB32>,
+    /* Format_IMC3 */                   qt_convert_IMC3_to_ARGB32<qt_convert_YUVRow_to_ARGB32>,
+    /* Format_IMC4 */                   qt_convert_IMC4_to_ARGB32<qt_convert_YUVRow_to_ARGB32>,
     /* Format_Y8 */                     qt_convert_Y_to_ARGB32<uchar>,
     /* Format_Y16 */                    qt_convert_Y_to_ARGB32<ushort>,
-    /* Format_P010 */                   qt_convert_P016_to_ARGB32,
-    /* Format_P016 */                   qt_convert_P016_to_ARGB32,
+    /* Format_P010 */                   qt_convert_P016_to_ARGB32<qt_convert_P016Row_to_ARGB32>,
+    /* Format_P016 */                   qt_convert_P016_to_ARGB32<qt_convert_P016Row_to_ARGB32>,
     /* Format_Jpeg */                   nullptr, // Not needed
 };
 
+template<YUVRowConvertFunc convertRow>
+static void qSetYUVRowConverter()
+{
+    qConvertFuncs[QVideoFrameFormat::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32<convertRow>;
+    qConvertFuncs[QVideoFrameFormat::Format_YUV422P] = qt_convert_YUV422P_to_ARGB32<convertRow>;
+    qConvertFuncs[QVideoFrameFormat::Format_YV12] = qt_convert_YV12_to_ARGB32<convertRow>;
+    qConvertFuncs[QVideoFrameFormat::Format_NV12] = qt_convert_NV12_to_ARGB32<convertRow>;
+    qConvertFuncs[QVideoFrameFormat::Format_NV21] = qt_convert_NV21_to_ARGB32<convertRow>;
+    qConvertFuncs[QVideoFrameFormat::Format_IMC1] = qt_convert_IMC1_to_ARGB32<convertRow>;
+    qConvertFuncs[QVideoFrameFormat::Format_IMC2] = qt_convert_IMC2_to_ARGB32<convertRow>;
+    qConvertFuncs[QVideoFrameFormat::Format_IMC3] = qt_convert_IMC3_to_ARGB32<convertRow>;
+    qConvertFuncs[QVideoFrameFormat::Format_IMC4] = qt_convert_IMC4_to_ARGB32<convertRow>;
+}
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+extern void QT_FASTCALL qt_convert_YUVRow_to_ARGB32_sse2(const uchar *y, const uchar *u, const uchar *v,
+                                                         int uvPixelStride, quint32 *rgb, int width,
+                                                         const YUVToRGBCoefficients &coefficients);
+extern void QT_FASTCALL qt_convert_UYVYRow_to_ARGB32_sse2(const uchar *src, quint32 *rgb, int width,
+                                                          const YUVToRGBCoefficients &coefficients);
+extern void QT_FASTCALL qt_convert_YUYVRow_to_ARGB32_sse2(const uchar *src, quint32 *rgb, int width,
+                                                          const YUVToRGBCoefficients &coefficients);
+extern void QT_FASTCALL qt_convert_P016Row_to_ARGB32_sse2(const quint16 *y, const quint16 *uv,
+                                                          quint32 *rgb, int width,
+                                                          const YUVToRGBCoefficients &coefficients);
+#endif
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+extern void QT_FASTCALL qt_convert_YUVRow_to_ARGB32_avx2(const uchar *y, const uchar *u, const uchar *v,
+                                                         int uvPixelStride, quint32 *rgb, int width,
+                                                         const YUVToRGBCoefficients &coefficients);
+#endif
+#if defined(__ARM_NEON__) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+extern void QT_FASTCALL qt_convert_YUVRow_to_ARGB32_neon(const uchar *y, const uchar *u, const uchar *v,
+                                                         int uvPixelStride, quint32 *rgb, int width,
+                                                         const YUVToRGBCoefficients &coefficients);
+#endif
+
 static void qInitConvertFuncsAsm()
 {
 #ifdef QT_COMPILER_SUPPORTS_SSE2
-    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_sse2(const VideoFrameSlice &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_sse2(const VideoFrameSlice &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_sse2(const VideoFrameSlice &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_sse2(const VideoFrameSlice &frame, uchar *output);
     if (qCpuHasFeature(SSE2)){
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888] = qt_convert_ARGB8888_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888_Premultiplied] = qt_convert_ARGB8888_to_ARGB32_sse2;
@@ -512,13 +590,19 @@ static void qInitConvertFuncsAsm()
         qConvertFuncs[QVideoFrameFormat::Format_XBGR8888] = qt_convert_ABGR8888_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrameFormat::Format_RGBA8888] = qt_convert_RGBA8888_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrameFormat::Format_RGBX8888] = qt_convert_RGBA8888_to_ARGB32_sse2;
+
+        qSetYUVRowConverter<qt_convert_YUVRow_to_ARGB32_sse2>();
+        qConvertFuncs[QVideoFrameFormat::Format_UYVY] = qt_convert_packedYUV422_to_ARGB32<qt_convert_UYVYRow_to_ARGB32_sse2>;
+        qConvertFuncs[QVideoFrameFormat::Format_YUYV] = qt_convert_packedYUV422_to_ARGB32<qt_convert_YUYVRow_to_ARGB32_sse2>;
+        qConvertFuncs[QVideoFrameFormat::Format_P010] = qt_convert_P016_to_ARGB32<qt_convert_P016Row_to_ARGB32_sse2>;
+        qConvertFuncs[QVideoFrameFormat::Format_P016] = qt_convert_P016_to_ARGB32<qt_convert_P016Row_to_ARGB32_sse2>;
     }
 #endif
 #ifdef QT_COMPILER_SUPPORTS_SSSE3
-    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_ssse3(const VideoFrameSlice &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_ssse3(const VideoFrameSlice &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_ssse3(const VideoFrameSlice &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_ssse3(const VideoFrameSlice &frame, uchar *output);
     if (qCpuHasFeature(SSSE3)){
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888] = qt_convert_ARGB8888_to_ARGB32_ssse3;
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888_Premultiplied] = qt_convert_ARGB8888_to_ARGB32_ssse3;
@@ -533,10 +617,10 @@ static void qInitConvertFuncsAsm()
     }
 #endif
 #ifdef QT_COMPILER_SUPPORTS_AVX2
-    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_avx2(const VideoFrameSlice &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_avx2(const VideoFrameSlice &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_avx2(const VideoFrameSlice &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_avx2(const VideoFrameSlice &frame, uchar *output);
     if (qCpuHasFeature(AVX2)){
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888] = qt_convert_ARGB8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888_Premultiplied] = qt_convert_ARGB8888_to_ARGB32_avx2;
@@ -548,8 +632,14 @@ static void qInitConvertFuncsAsm()
         qConvertFuncs[QVideoFrameFormat::Format_XBGR8888] = qt_convert_ABGR8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_RGBA8888] = qt_convert_RGBA8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_RGBX8888] = qt_convert_RGBA8888_to_ARGB32_avx2;
+
+        qSetYUVRowConverter<qt_convert_YUVRow_to_ARGB32_avx2>();
     }
 #endif
+#if defined(__ARM_NEON__) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    if (qCpuHasFeature(NEON))
+        qSetYUVRowConverter<qt_convert_YUVRow_to_ARGB32_neon>();
+#endif
 }
 
 VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format)
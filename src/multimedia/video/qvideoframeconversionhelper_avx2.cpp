@@ -10,7 +10,7 @@ QT_BEGIN_NAMESPACE
 namespace  {
 
 template<int a, int r, int g, int b>
-void convert_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void convert_to_ARGB32_avx2(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
@@ -70,29 +70,148 @@ void convert_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
     }
 }
 
+struct YUVToRGBCoefficientsAvx2
+{
+    explicit YUVToRGBCoefficientsAvx2(const YUVToRGBCoefficients &c)
+        : yOffset(_mm256_set1_epi16(c.yOffset)),
+          y(_mm256_set1_epi16(c.y)),
+          rv(_mm256_set1_epi16(c.rv)),
+          gu(_mm256_set1_epi16(c.gu)),
+          gv(_mm256_set1_epi16(c.gv)),
+          bu(_mm256_set1_epi16(c.bu))
+    {
+    }
+
+    const __m256i yOffset;
+    const __m256i y;
+    const __m256i rv;
+    const __m256i gu;
+    const __m256i gv;
+    const __m256i bu;
+    const __m256i chromaOffset = _mm256_set1_epi16(128);
+    const __m256i rounding = _mm256_set1_epi16(8);
+    const __m256i alpha = _mm256_set1_epi8(char(0xff));
+};
+
+// Duplicates each chroma sample for two luma samples. The unpack instructions work
+// within 128 bit lanes, the permute restores the linear order.
+inline __m256i expandChromaLow_avx2(__m256i c)
+{
+    return _mm256_permute2x128_si256(_mm256_unpacklo_epi16(c, c), _mm256_unpackhi_epi16(c, c), 0x20);
 }
 
+inline __m256i expandChromaHigh_avx2(__m256i c)
+{
+    return _mm256_permute2x128_si256(_mm256_unpacklo_epi16(c, c), _mm256_unpackhi_epi16(c, c), 0x31);
+}
 
-void QT_FASTCALL qt_convert_ARGB8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+// Converts 32 pixels. y0 and y1 hold 16 luma samples each, u and v hold 16 chroma
+// samples, each shared by two horizontally adjacent luma samples. All values are
+// zero extended to 16 bits. Gives the same result as qYUVToARGB32().
+inline void yuvToARGB32_avx2(const YUVToRGBCoefficientsAvx2 &c, __m256i y0, __m256i y1,
+                             __m256i u, __m256i v, quint32 *rgb)
+{
+    const __m256i uu = _mm256_slli_epi16(_mm256_sub_epi16(u, c.chromaOffset), 7);
+    const __m256i vv = _mm256_slli_epi16(_mm256_sub_epi16(v, c.chromaOffset), 7);
+    const __m256i rv = _mm256_mulhi_epi16(vv, c.rv);
+    const __m256i guv = _mm256_add_epi16(_mm256_mulhi_epi16(uu, c.gu), _mm256_mulhi_epi16(vv, c.gv));
+    const __m256i bu = _mm256_mulhi_epi16(uu, c.bu);
+
+    y0 = _mm256_add_epi16(_mm256_mulhi_epi16(_mm256_slli_epi16(_mm256_sub_epi16(y0, c.yOffset), 7), c.y),
+                          c.rounding);
+    y1 = _mm256_add_epi16(_mm256_mulhi_epi16(_mm256_slli_epi16(_mm256_sub_epi16(y1, c.yOffset), 7), c.y),
+                          c.rounding);
+
+    // packus clamps to [0, 255]. The resulting pixel order is 0-7, 16-23 | 8-15, 24-31
+    const __m256i r = _mm256_packus_epi16(
+            _mm256_srai_epi16(_mm256_add_epi16(y0, expandChromaLow_avx2(rv)), 4),
+            _mm256_srai_epi16(_mm256_add_epi16(y1, expandChromaHigh_avx2(rv)), 4));
+    const __m256i g = _mm256_packus_epi16(
+            _mm256_srai_epi16(_mm256_add_epi16(y0, expandChromaLow_avx2(guv)), 4),
+            _mm256_srai_epi16(_mm256_add_epi16(y1, expandChromaHigh_avx2(guv)), 4));
+    const __m256i b = _mm256_packus_epi16(
+            _mm256_srai_epi16(_mm256_add_epi16(y0, expandChromaLow_avx2(bu)), 4),
+            _mm256_srai_epi16(_mm256_add_epi16(y1, expandChromaHigh_avx2(bu)), 4));
+
+    // Pixels 0-7 | 8-15 and 16-23 | 24-31
+    const __m256i bgLow = _mm256_unpacklo_epi8(b, g);
+    const __m256i bgHigh = _mm256_unpackhi_epi8(b, g);
+    const __m256i raLow = _mm256_unpacklo_epi8(r, c.alpha);
+    const __m256i raHigh = _mm256_unpackhi_epi8(r, c.alpha);
+
+    // Pixels 0-3 | 8-11, 4-7 | 12-15, 16-19 | 24-27 and 20-23 | 28-31
+    const __m256i p0 = _mm256_unpacklo_epi16(bgLow, raLow);
+    const __m256i p1 = _mm256_unpackhi_epi16(bgLow, raLow);
+    const __m256i p2 = _mm256_unpacklo_epi16(bgHigh, raHigh);
+    const __m256i p3 = _mm256_unpackhi_epi16(bgHigh, raHigh);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgb), _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgb + 8), _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgb + 16), _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgb + 24), _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+}
+
+
+void QT_FASTCALL qt_convert_ARGB8888_to_ARGB32_avx2(const VideoFrameSlice &frame, uchar *output)
 {
     convert_to_ARGB32_avx2<0, 1, 2, 3>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_ABGR8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_ABGR8888_to_ARGB32_avx2(const VideoFrameSlice &frame, uchar *output)
 {
     convert_to_ARGB32_avx2<0, 3, 2, 1>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_RGBA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_RGBA8888_to_ARGB32_avx2(const VideoFrameSlice &frame, uchar *output)
 {
     convert_to_ARGB32_avx2<3, 0, 1, 2>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_BGRA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGRA8888_to_ARGB32_avx2(const VideoFrameSlice &frame, uchar *output)
 {
     convert_to_ARGB32_avx2<3, 2, 1, 0>(frame, output);
 }
 
+void QT_FASTCALL qt_convert_YUVRow_to_ARGB32_avx2(const uchar *y, const uchar *u, const uchar *v,
+                                                  int uvPixelStride, quint32 *rgb, int width,
+                                                  const YUVToRGBCoefficients &coefficients)
+{
+    const YUVToRGBCoefficientsAvx2 c(coefficients);
+
+    int x = 0;
+    if (uvPixelStride == 1) {
+        for (; x < width - 31; x += 32) {
+            const __m256i yy = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + x));
+            const __m128i uu = _mm_loadu_si128(reinterpret_cast<const __m128i *>(u + x / 2));
+            const __m128i vv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v + x / 2));
+            yuvToARGB32_avx2(c, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(yy)),
+                             _mm256_cvtepu8_epi16(_mm256_extracti128_si256(yy, 1)),
+                             _mm256_cvtepu8_epi16(uu), _mm256_cvtepu8_epi16(vv), rgb + x);
+        }
+    } else if (uvPixelStride == 2) {
+        // Semi-planar, u and v point into the same interleaved plane
+        const uchar *uv = qMin(u, v);
+        const bool vFirst = v < u;
+        const __m256i lowBytes = _mm256_set1_epi16(0x00ff);
+        for (; x < width - 31; x += 32) {
+            const __m256i yy = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + x));
+            const __m256i chroma = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(uv + x));
+            const __m256i first = _mm256_and_si256(chroma, lowBytes);
+            const __m256i second = _mm256_srli_epi16(chroma, 8);
+            yuvToARGB32_avx2(c, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(yy)),
+                             _mm256_cvtepu8_epi16(_mm256_extracti128_si256(yy, 1)),
+                             vFirst ? second : first, vFirst ? first : second, rgb + x);
+        }
+    }
+
+    // leftovers
+    const int uvOffset = x / 2 * uvPixelStride;
+    qt_convert_YUVRow_to_ARGB32(y + x, u + uvOffset, v + uvOffset, uvPixelStride,
+                                rgb + x, width - x, coefficients);
+}
+
 QT_END_NAMESPACE
 
 #endif
@@ -0,0 +1,90 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qvideoframeconversionhelper_p.h"
+
+#if defined(__ARM_NEON__) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+
+QT_BEGIN_NAMESPACE
+
+namespace  {
+
+// Same as _mm_mulhi_epi16
+inline int16x8_t mulhi_neon(int16x8_t a, int16x8_t b)
+{
+    return vcombine_s16(vshrn_n_s32(vmull_s16(vget_low_s16(a), vget_low_s16(b)), 16),
+                        vshrn_n_s32(vmull_s16(vget_high_s16(a), vget_high_s16(b)), 16));
+}
+
+inline int16x8_t expandLuma_neon(const YUVToRGBCoefficients &c, uint8x8_t y)
+{
+    const int16x8_t yy = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(c.yOffset));
+    return vaddq_s16(mulhi_neon(vshlq_n_s16(yy, 7), vdupq_n_s16(c.y)), vdupq_n_s16(8));
+}
+
+inline int16x8_t expandChroma_neon(uint8x8_t c)
+{
+    return vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(c)), vdupq_n_s16(128)), 7);
+}
+
+inline uint8x16_t combine_neon(int16x8_t y0, int16x8_t y1, int16x8_t c)
+{
+    // Each chroma sample covers two luma samples; vqshrun clamps to [0, 255]
+    const int16x8x2_t cc = vzipq_s16(c, c);
+    return vcombine_u8(vqshrun_n_s16(vaddq_s16(y0, cc.val[0]), 4),
+                       vqshrun_n_s16(vaddq_s16(y1, cc.val[1]), 4));
+}
+
+// Converts 16 pixels, gives the same result as qYUVToARGB32()
+inline void yuvToARGB32_neon(const YUVToRGBCoefficients &c, uint8x16_t y,
+                             uint8x8_t u, uint8x8_t v, quint32 *rgb)
+{
+    const int16x8_t uu = expandChroma_neon(u);
+    const int16x8_t vv = expandChroma_neon(v);
+    const int16x8_t rv = mulhi_neon(vv, vdupq_n_s16(c.rv));
+    const int16x8_t guv = vaddq_s16(mulhi_neon(uu, vdupq_n_s16(c.gu)),
+                                    mulhi_neon(vv, vdupq_n_s16(c.gv)));
+    const int16x8_t bu = mulhi_neon(uu, vdupq_n_s16(c.bu));
+
+    const int16x8_t y0 = expandLuma_neon(c, vget_low_u8(y));
+    const int16x8_t y1 = expandLuma_neon(c, vget_high_u8(y));
+
+    uint8x16x4_t argb;
+    argb.val[0] = combine_neon(y0, y1, bu);
+    argb.val[1] = combine_neon(y0, y1, guv);
+    argb.val[2] = combine_neon(y0, y1, rv);
+    argb.val[3] = vdupq_n_u8(0xff);
+    vst4q_u8(reinterpret_cast<uint8_t *>(rgb), argb);
+}
+
+}
+
+void QT_FASTCALL qt_convert_YUVRow_to_ARGB32_neon(const uchar *y, const uchar *u, const uchar *v,
+                                                  int uvPixelStride, quint32 *rgb, int width,
+                                                  const YUVToRGBCoefficients &coefficients)
+{
+    int x = 0;
+    if (uvPixelStride == 1) {
+        for (; x < width - 15; x += 16)
+            yuvToARGB32_neon(coefficients, vld1q_u8(y + x), vld1_u8(u + x / 2), vld1_u8(v + x / 2),
+                             rgb + x);
+    } else if (uvPixelStride == 2) {
+        // Semi-planar, u and v point into the same interleaved plane
+        const uchar *uv = qMin(u, v);
+        const bool vFirst = v < u;
+        for (; x < width - 15; x += 16) {
+            const uint8x8x2_t chroma = vld2_u8(uv + x);
+            yuvToARGB32_neon(coefficients, vld1q_u8(y + x),
+                             chroma.val[vFirst ? 1 : 0], chroma.val[vFirst ? 0 : 1], rgb + x);
+        }
+    }
+
+    // leftovers
+    const int uvOffset = x / 2 * uvPixelStride;
+    qt_convert_YUVRow_to_ARGB32(y + x, u + uvOffset, v + uvOffset, uvPixelStride,
+                                rgb + x, width - x, coefficients);
+}
+
+QT_END_NAMESPACE
+
+#endif
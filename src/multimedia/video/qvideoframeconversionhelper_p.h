@@ -20,8 +20,35 @@
 
 QT_BEGIN_NAMESPACE
 
+// A mapped video frame, or a horizontal band of one. Converters only access the frame
+// through this class, which allows converting a frame in several independent parts.
+class VideoFrameSlice
+{
+public:
+    explicit VideoFrameSlice(const QVideoFrame &mappedFrame);
+
+    // Returns the rows [firstRow, firstRow + rowCount) of this slice. firstRow has to be
+    // a multiple of the vertical chroma subsampling of the pixel format.
+    VideoFrameSlice band(int firstRow, int rowCount) const;
+
+    const uchar *bits(int plane) const { return m_bits[plane]; }
+    int bytesPerLine(int plane) const { return m_bytesPerLine[plane]; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    const QVideoFrameFormat &surfaceFormat() const { return m_format; }
+
+private:
+    static constexpr int MaxPlanes = 4;
+
+    QVideoFrameFormat m_format;
+    const uchar *m_bits[MaxPlanes] = {};
+    int m_bytesPerLine[MaxPlanes] = {};
+    int m_width = 0;
+    int m_height = 0;
+};
+
 // Converts to RGB32 or ARGB32_Premultiplied
-typedef void (QT_FASTCALL *VideoFrameConvertFunc)(const QVideoFrame &frame, uchar *output);
+typedef void (QT_FASTCALL *VideoFrameConvertFunc)(const VideoFrameSlice &frame, uchar *output);
 
 VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format);
 
@@ -82,6 +109,82 @@ struct YPixel
 };
 
 
+// YUV to RGB conversion coefficients in 3.13 fixed point. Luma and chroma are
+// scaled by 128 before multiplying, so that (value * coefficient) >> 16 yields
+// a result with 4 fractional bits. This maps directly onto 16 bit SIMD
+// multiply-high instructions.
+struct YUVToRGBCoefficients
+{
+    qint16 yOffset;
+    qint16 y;
+    qint16 rv;
+    qint16 gu;
+    qint16 gv;
+    qint16 bu;
+};
+
+Q_MULTIMEDIA_EXPORT const YUVToRGBCoefficients &qYUVToRGBCoefficients(const QVideoFrameFormat &format);
+
+inline int qYUVMulHi(int value, int coefficient)
+{
+    return (value * coefficient) >> 16;
+}
+
+inline int qYUVClamp(int n)
+{
+    return n > 255 ? 255 : (n < 0 ? 0 : n);
+}
+
+struct YUVChroma
+{
+    int rv;
+    int guv;
+    int bu;
+};
+
+inline YUVChroma qYUVExpandChroma(const YUVToRGBCoefficients &c, int u, int v)
+{
+    const int uu = (u - 128) * 128;
+    const int vv = (v - 128) * 128;
+    return { qYUVMulHi(vv, c.rv), qYUVMulHi(uu, c.gu) + qYUVMulHi(vv, c.gv), qYUVMulHi(uu, c.bu) };
+}
+
+inline quint32 qYUVToARGB32(const YUVToRGBCoefficients &c, int y, const YUVChroma &uv,
+                            int a = 0xff)
+{
+    const int yy = qYUVMulHi((y - c.yOffset) * 128, c.y) + 8;
+    return (a << 24)
+            | qYUVClamp((yy + uv.rv) >> 4) << 16
+            | qYUVClamp((yy + uv.guv) >> 4) << 8
+            | qYUVClamp((yy + uv.bu) >> 4);
+}
+
+// Converts one row of 8 bit luma with horizontally subsampled chroma.
+// uvPixelStride is 1 for planar and 2 for semi-planar (interleaved) chroma.
+typedef void (QT_FASTCALL *YUVRowConvertFunc)(const uchar *y, const uchar *u, const uchar *v,
+                                              int uvPixelStride, quint32 *rgb, int width,
+                                              const YUVToRGBCoefficients &coefficients);
+
+// Converts one row of packed 4:2:2 data (UYVY or YUYV)
+typedef void (QT_FASTCALL *PackedYUVRowConvertFunc)(const uchar *src, quint32 *rgb, int width,
+                                                    const YUVToRGBCoefficients &coefficients);
+
+// Converts one row of 16 bit luma with interleaved 16 bit chroma (P010, P016)
+typedef void (QT_FASTCALL *P016RowConvertFunc)(const quint16 *y, const quint16 *uv,
+                                               quint32 *rgb, int width,
+                                               const YUVToRGBCoefficients &coefficients);
+
+void QT_FASTCALL qt_convert_YUVRow_to_ARGB32(const uchar *y, const uchar *u, const uchar *v,
+                                             int uvPixelStride, quint32 *rgb, int width,
+                                             const YUVToRGBCoefficients &coefficients);
+void QT_FASTCALL qt_convert_UYVYRow_to_ARGB32(const uchar *src, quint32 *rgb, int width,
+                                              const YUVToRGBCoefficients &coefficients);
+void QT_FASTCALL qt_convert_YUYVRow_to_ARGB32(const uchar *src, quint32 *rgb, int width,
+                                              const YUVToRGBCoefficients &coefficients);
+void QT_FASTCALL qt_convert_P016Row_to_ARGB32(const quint16 *y, const quint16 *uv,
+                                              quint32 *rgb, int width,
+                                              const YUVToRGBCoefficients &coefficients);
+
 using ARGB8888 = ArgbPixel<0, 1, 2, 3>;
 using ABGR8888 = ArgbPixel<0, 3, 2, 1>;
 using RGBA8888 = ArgbPixel<3, 0, 1, 2>;
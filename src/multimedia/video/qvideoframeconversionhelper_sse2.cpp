@@ -10,7 +10,7 @@ QT_BEGIN_NAMESPACE
 namespace  {
 
 template<int a, int r, int b, int g>
-void convert_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void convert_to_ARGB32_sse2(const VideoFrameSlice &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
@@ -58,28 +58,196 @@ void convert_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
     }
 }
 
+struct YUVToRGBCoefficientsSse2
+{
+    explicit YUVToRGBCoefficientsSse2(const YUVToRGBCoefficients &c)
+        : yOffset(_mm_set1_epi16(c.yOffset)),
+          y(_mm_set1_epi16(c.y)),
+          rv(_mm_set1_epi16(c.rv)),
+          gu(_mm_set1_epi16(c.gu)),
+          gv(_mm_set1_epi16(c.gv)),
+          bu(_mm_set1_epi16(c.bu))
+    {
+    }
+
+    const __m128i yOffset;
+    const __m128i y;
+    const __m128i rv;
+    const __m128i gu;
+    const __m128i gv;
+    const __m128i bu;
+    const __m128i chromaOffset = _mm_set1_epi16(128);
+    const __m128i rounding = _mm_set1_epi16(8);
+    const __m128i alpha = _mm_set1_epi8(char(0xff));
+};
+
+// Converts 16 pixels. y0 and y1 hold 8 luma samples each, u and v hold 8 chroma
+// samples, each shared by two horizontally adjacent luma samples. All values are
+// zero extended to 16 bits. Gives the same result as qYUVToARGB32().
+inline void yuvToARGB32_sse2(const YUVToRGBCoefficientsSse2 &c, __m128i y0, __m128i y1,
+                             __m128i u, __m128i v, quint32 *rgb)
+{
+    const __m128i uu = _mm_slli_epi16(_mm_sub_epi16(u, c.chromaOffset), 7);
+    const __m128i vv = _mm_slli_epi16(_mm_sub_epi16(v, c.chromaOffset), 7);
+    const __m128i rv = _mm_mulhi_epi16(vv, c.rv);
+    const __m128i guv = _mm_add_epi16(_mm_mulhi_epi16(uu, c.gu), _mm_mulhi_epi16(vv, c.gv));
+    const __m128i bu = _mm_mulhi_epi16(uu, c.bu);
+
+    y0 = _mm_add_epi16(_mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(y0, c.yOffset), 7), c.y),
+                       c.rounding);
+    y1 = _mm_add_epi16(_mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(y1, c.yOffset), 7), c.y),
+                       c.rounding);
+
+    // packus clamps to [0, 255]
+    const __m128i r = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_add_epi16(y0, _mm_unpacklo_epi16(rv, rv)), 4),
+            _mm_srai_epi16(_mm_add_epi16(y1, _mm_unpackhi_epi16(rv, rv)), 4));
+    const __m128i g = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_add_epi16(y0, _mm_unpacklo_epi16(guv, guv)), 4),
+            _mm_srai_epi16(_mm_add_epi16(y1, _mm_unpackhi_epi16(guv, guv)), 4));
+    const __m128i b = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_add_epi16(y0, _mm_unpacklo_epi16(bu, bu)), 4),
+            _mm_srai_epi16(_mm_add_epi16(y1, _mm_unpackhi_epi16(bu, bu)), 4));
+
+    const __m128i bgLow = _mm_unpacklo_epi8(b, g);
+    const __m128i bgHigh = _mm_unpackhi_epi8(b, g);
+    const __m128i raLow = _mm_unpacklo_epi8(r, c.alpha);
+    const __m128i raHigh = _mm_unpackhi_epi8(r, c.alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(rgb), _mm_unpacklo_epi16(bgLow, raLow));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(rgb + 4), _mm_unpackhi_epi16(bgLow, raLow));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(rgb + 8), _mm_unpacklo_epi16(bgHigh, raHigh));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(rgb + 12), _mm_unpackhi_epi16(bgHigh, raHigh));
+}
+
+// Splits 16 bit pairs (as in u0 v0 u1 v1 ...) into two vectors of 8 samples each
+inline void deinterleave_sse2(__m128i pairs0, __m128i pairs1, __m128i &first, __m128i &second)
+{
+    const __m128i lowWords = _mm_set1_epi32(0x0000ffff);
+    first = _mm_packs_epi32(_mm_and_si128(pairs0, lowWords), _mm_and_si128(pairs1, lowWords));
+    second = _mm_packs_epi32(_mm_srli_epi32(pairs0, 16), _mm_srli_epi32(pairs1, 16));
+}
+
+template<bool uyvy>
+void packedYUV422Row_to_ARGB32_sse2(const uchar *src, quint32 *rgb, int width,
+                                    const YUVToRGBCoefficientsSse2 &c)
+{
+    const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+
+    int x = 0;
+    for (; x < width - 15; x += 16) {
+        const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * x));
+        const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * x + 16));
+        const __m128i y0 = uyvy ? _mm_srli_epi16(p0, 8) : _mm_and_si128(p0, lowBytes);
+        const __m128i y1 = uyvy ? _mm_srli_epi16(p1, 8) : _mm_and_si128(p1, lowBytes);
+        const __m128i uv0 = uyvy ? _mm_and_si128(p0, lowBytes) : _mm_srli_epi16(p0, 8);
+        const __m128i uv1 = uyvy ? _mm_and_si128(p1, lowBytes) : _mm_srli_epi16(p1, 8);
+        __m128i u, v;
+        deinterleave_sse2(uv0, uv1, u, v);
+        yuvToARGB32_sse2(c, y0, y1, u, v, rgb + x);
+    }
 }
 
-void QT_FASTCALL qt_convert_ARGB8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+}
+
+void QT_FASTCALL qt_convert_ARGB8888_to_ARGB32_sse2(const VideoFrameSlice &frame, uchar *output)
 {
     convert_to_ARGB32_sse2<0, 1, 2, 3>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_ABGR8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_ABGR8888_to_ARGB32_sse2(const VideoFrameSlice &frame, uchar *output)
 {
     convert_to_ARGB32_sse2<0, 3, 2, 1>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_RGBA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_RGBA8888_to_ARGB32_sse2(const VideoFrameSlice &frame, uchar *output)
 {
     convert_to_ARGB32_sse2<3, 0, 1, 2>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_BGRA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGRA8888_to_ARGB32_sse2(const VideoFrameSlice &frame, uchar *output)
 {
     convert_to_ARGB32_sse2<3, 2, 1, 0>(frame, output);
 }
 
+void QT_FASTCALL qt_convert_YUVRow_to_ARGB32_sse2(const uchar *y, const uchar *u, const uchar *v,
+                                                  int uvPixelStride, quint32 *rgb, int width,
+                                                  const YUVToRGBCoefficients &coefficients)
+{
+    const YUVToRGBCoefficientsSse2 c(coefficients);
+    const __m128i zero = _mm_setzero_si128();
+
+    int x = 0;
+    if (uvPixelStride == 1) {
+        for (; x < width - 15; x += 16) {
+            const __m128i yy = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+            const __m128i uu = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2));
+            const __m128i vv = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2));
+            yuvToARGB32_sse2(c, _mm_unpacklo_epi8(yy, zero), _mm_unpackhi_epi8(yy, zero),
+                             _mm_unpacklo_epi8(uu, zero), _mm_unpacklo_epi8(vv, zero), rgb + x);
+        }
+    } else if (uvPixelStride == 2) {
+        // Semi-planar, u and v point into the same interleaved plane
+        const uchar *uv = qMin(u, v);
+        const bool vFirst = v < u;
+        const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+        for (; x < width - 15; x += 16) {
+            const __m128i yy = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+            const __m128i chroma = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x));
+            const __m128i first = _mm_and_si128(chroma, lowBytes);
+            const __m128i second = _mm_srli_epi16(chroma, 8);
+            yuvToARGB32_sse2(c, _mm_unpacklo_epi8(yy, zero), _mm_unpackhi_epi8(yy, zero),
+                             vFirst ? second : first, vFirst ? first : second, rgb + x);
+        }
+    }
+
+    // leftovers
+    const int uvOffset = x / 2 * uvPixelStride;
+    qt_convert_YUVRow_to_ARGB32(y + x, u + uvOffset, v + uvOffset, uvPixelStride,
+                                rgb + x, width - x, coefficients);
+}
+
+void QT_FASTCALL qt_convert_UYVYRow_to_ARGB32_sse2(const uchar *src, quint32 *rgb, int width,
+                                                   const YUVToRGBCoefficients &coefficients)
+{
+    packedYUV422Row_to_ARGB32_sse2<true>(src, rgb, width, YUVToRGBCoefficientsSse2(coefficients));
+
+    // leftovers
+    const int x = width & ~15;
+    qt_convert_UYVYRow_to_ARGB32(src + 2 * x, rgb + x, width - x, coefficients);
+}
+
+void QT_FASTCALL qt_convert_YUYVRow_to_ARGB32_sse2(const uchar *src, quint32 *rgb, int width,
+                                                   const YUVToRGBCoefficients &coefficients)
+{
+    packedYUV422Row_to_ARGB32_sse2<false>(src, rgb, width, YUVToRGBCoefficientsSse2(coefficients));
+
+    // leftovers
+    const int x = width & ~15;
+    qt_convert_YUYVRow_to_ARGB32(src + 2 * x, rgb + x, width - x, coefficients);
+}
+
+void QT_FASTCALL qt_convert_P016Row_to_ARGB32_sse2(const quint16 *y, const quint16 *uv,
+                                                   quint32 *rgb, int width,
+                                                   const YUVToRGBCoefficients &coefficients)
+{
+    const YUVToRGBCoefficientsSse2 c(coefficients);
+
+    // Only the 8 most significant bits are used, as in the scalar version
+    int x = 0;
+    for (; x < width - 15; x += 16) {
+        const __m128i y0 = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x)), 8);
+        const __m128i y1 = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x + 8)), 8);
+        const __m128i uv0 = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x)), 8);
+        const __m128i uv1 = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x + 8)), 8);
+        __m128i u, v;
+        deinterleave_sse2(uv0, uv1, u, v);
+        yuvToARGB32_sse2(c, y0, y1, u, v, rgb + x);
+    }
+
+    // leftovers
+    qt_convert_P016Row_to_ARGB32(y + x, uv + x, rgb + x, width - x, coefficients);
+}
+
 QT_END_NAMESPACE
 
 #endif
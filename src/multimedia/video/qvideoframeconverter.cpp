@@ -10,6 +10,8 @@
 #include <QtCore/qhash.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qthreadstorage.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qsemaphore.h>
 #include <QtGui/qimage.h>
 #include <QtGui/qoffscreensurface.h>
 #include <qpa/qplatformintegration.h>
@@ -18,6 +20,8 @@
 #include <private/qguiapplication_p.h>
 #include <rhi/qrhi.h>
 
+#include <vector>
+
 #ifdef Q_OS_DARWIN
 #include <QtCore/private/qcore_mac_p.h>
 #endif
@@ -48,6 +52,139 @@ struct State
 static QThreadStorage<State> g_state;
 static QHash<QString, QShader> g_shaderCache;
 
+namespace {
+
+// The maximum number of threads used for converting a single frame on the CPU,
+// including the calling thread. Can be overridden with QT_MEDIA_CPU_CONVERSION_THREADS,
+// a value of 1 disables multithreaded conversion.
+int maxConversionThreads()
+{
+    static const int threads = [] {
+        bool ok = false;
+        const int value = qEnvironmentVariableIntValue("QT_MEDIA_CPU_CONVERSION_THREADS", &ok);
+        return ok && value > 0 ? value : QThread::idealThreadCount();
+    }();
+    return threads;
+}
+
+// Uses a dedicated pool, so that frame conversion neither waits for nor blocks the
+// application's tasks in the global pool.
+class ConversionThreadPool : public QThreadPool
+{
+public:
+    ConversionThreadPool()
+    {
+        setObjectName(QStringLiteral("QVideoFrameConverter"));
+        setMaxThreadCount(qMax(maxConversionThreads() - 1, 1));
+    }
+};
+
+// Maps source pixels to the destination image, equivalent to rasterTransform()
+class RasterTransform
+{
+public:
+    RasterTransform(int width, int height, QVideoFrame::RotationAngle rotation, bool mirrorX,
+                    bool mirrorY)
+        : m_width(width),
+          m_identity(rotation == QVideoFrame::Rotation0 && !mirrorX && !mirrorY)
+    {
+        const bool transposed =
+                rotation == QVideoFrame::Rotation90 || rotation == QVideoFrame::Rotation270;
+        m_size = transposed ? QSize(height, width) : QSize(width, height);
+
+        // Mirror vertically, rotate clockwise, then mirror horizontally. The result is
+        // affine, so three points are enough to describe it.
+        auto map = [&](int x, int y) -> qsizetype {
+            if (mirrorY)
+                y = height - 1 - y;
+            int rx = x;
+            int ry = y;
+            switch (rotation) {
+            case QVideoFrame::Rotation90:
+                rx = height - 1 - y;
+                ry = x;
+                break;
+            case QVideoFrame::Rotation180:
+                rx = width - 1 - x;
+                ry = height - 1 - y;
+                break;
+            case QVideoFrame::Rotation270:
+                rx = y;
+                ry = width - 1 - x;
+                break;
+            default:
+                break;
+            }
+            if (mirrorX)
+                rx = m_size.width() - 1 - rx;
+            return qsizetype(ry) * m_size.width() + rx;
+        };
+
+        m_origin = map(0, 0);
+        m_pixelStep = map(1, 0) - m_origin;
+        m_rowStep = map(0, 1) - m_origin;
+    }
+
+    QSize size() const { return m_size; }
+    bool isIdentity() const { return m_identity; }
+
+    // Writes rowCount converted rows starting at source row firstRow
+    void apply(const quint32 *src, int firstRow, int rowCount, quint32 *dst) const
+    {
+        for (int y = firstRow; y < firstRow + rowCount; ++y) {
+            qsizetype offset = m_origin + y * m_rowStep;
+            for (int x = 0; x < m_width; ++x, offset += m_pixelStep)
+                dst[offset] = *src++;
+        }
+    }
+
+private:
+    QSize m_size;
+    int m_width = 0;
+    bool m_identity = true;
+    qsizetype m_origin = 0;
+    qsizetype m_pixelStep = 1;
+    qsizetype m_rowStep = 0;
+};
+
+}
+
+Q_GLOBAL_STATIC(ConversionThreadPool, g_conversionThreadPool)
+
+// Splitting a frame has a fixed cost, don't bother for small frames
+static constexpr qint64 MinPixelsPerBand = 256 * 1024;
+
+// Rows converted at a time before being rotated or mirrored into the image. Even, as
+// bands have to start on even rows.
+static constexpr int ScratchRows = 16;
+
+static int conversionBandCount(int width, int height)
+{
+    const qint64 byPixels = qint64(width) * height / MinPixelsPerBand;
+    return int(qBound<qint64>(1, qMin<qint64>(byPixels, height / 2), maxConversionThreads()));
+}
+
+// Calls convertBand for each band, spread over the conversion thread pool
+template<typename Functor>
+static void runBands(int bandCount, const Functor &convertBand)
+{
+    if (bandCount <= 1) {
+        convertBand(0);
+        return;
+    }
+
+    QSemaphore done;
+    QThreadPool *pool = g_conversionThreadPool();
+    for (int band = 1; band < bandCount; ++band) {
+        pool->start([&convertBand, &done, band] {
+            convertBand(band);
+            done.release();
+        });
+    }
+    convertBand(0);
+    done.acquire(bandCount - 1);
+}
+
 static const float g_quad[] = {
     // Rotation 0 CW
     1.f, -1.f,   1.f, 1.f,
@@ -243,7 +380,7 @@ static QImage convertJPEG(const QVideoFrame &frame, QVideoFrame::RotationAngle r
     return image;
 }
 
-static QImage convertCPU(const QVideoFrame &frame, QVideoFrame::RotationAngle rotation, bool mirrorX, bool mirrorY)
+QImage qImageFromVideoFrameOnCpu(const QVideoFrame &frame, QVideoFrame::RotationAngle rotation, bool mirrorX, bool mirrorY)
 {
     VideoFrameConvertFunc convert = qConverterForFormat(frame.pixelFormat());
     if (!convert) {
@@ -255,11 +392,42 @@ static QImage convertCPU(const QVideoFrame &frame, QVideoFrame::RotationAngle ro
             qCDebug(qLcVideoFrameConverter) << Q_FUNC_INFO << ": frame mapping failed";
             return {};
         }
+        const VideoFrameSlice slice(varFrame);
+        const RasterTransform transform(slice.width(), slice.height(), rotation, mirrorX, mirrorY);
+
         auto format = pixelFormatHasAlpha(varFrame.pixelFormat()) ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
-        QImage image = QImage(varFrame.width(), varFrame.height(), format);
-        convert(varFrame, image.bits());
+        QImage image = QImage(transform.size(), format);
+        uchar *output = image.bits();
+
+        // Bands start on even rows to keep subsampled chroma planes aligned
+        const int bandCount = conversionBandCount(slice.width(), slice.height());
+        const int rowsPerBand = ((slice.height() + bandCount - 1) / bandCount + 1) & ~1;
+
+        auto convertBand = [&](int band) {
+            const int firstRow = band * rowsPerBand;
+            const int rowCount = qMin(rowsPerBand, slice.height() - firstRow);
+            if (rowCount <= 0)
+                return;
+
+            if (transform.isIdentity()) {
+                convert(slice.band(firstRow, rowCount),
+                        output + qsizetype(firstRow) * image.bytesPerLine());
+                return;
+            }
+
+            // Rotate/mirror a few rows at a time while they are still in the cache,
+            // instead of transforming the whole image in a second pass
+            const int scratchRows = qMin(rowCount, ScratchRows);
+            std::vector<quint32> scratch(size_t(slice.width()) * scratchRows);
+            for (int row = firstRow; row < firstRow + rowCount; row += scratchRows) {
+                const int rows = qMin(scratchRows, firstRow + rowCount - row);
+                convert(slice.band(row, rows), reinterpret_cast<uchar *>(scratch.data()));
+                transform.apply(scratch.data(), row, rows, reinterpret_cast<quint32 *>(output));
+            }
+        };
+        runBands((slice.height() + rowsPerBand - 1) / rowsPerBand, convertBand);
+
         varFrame.unmap();
-        rasterTransform(image, rotation, mirrorX, mirrorY);
         return image;
     }
 }
@@ -297,7 +465,7 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QVideoFrame::RotationAngle
         rhi = initializeRHI(rhi);
 
     if (!rhi || rhi->isRecordingFrame())
-        return convertCPU(frame, rotation, mirrorX, mirrorY);
+        return qImageFromVideoFrameOnCpu(frame, rotation, mirrorX, mirrorY);
 
     // Do conversion using shaders
 
@@ -322,7 +490,7 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QVideoFrame::RotationAngle
     targetTexture.reset(rhi->newTexture(QRhiTexture::RGBA8, frameSize, 1, QRhiTexture::RenderTarget));
     if (!targetTexture->create()) {
         qCDebug(qLcVideoFrameConverter) << "Failed to create target texture. Using CPU conversion.";
-        return convertCPU(frame, rotation, mirrorX, mirrorY);
+        return qImageFromVideoFrameOnCpu(frame, rotation, mirrorX, mirrorY);
     }
 
     renderTarget.reset(rhi->newTextureRenderTarget({ { targetTexture.get() } }));
@@ -334,7 +502,7 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QVideoFrame::RotationAngle
     QRhi::FrameOpResult r = rhi->beginOffscreenFrame(&cb);
     if (r != QRhi::FrameOpSuccess) {
         qCDebug(qLcVideoFrameConverter) << "Failed to set up offscreen frame. Using CPU conversion.";
-        return convertCPU(frame, rotation, mirrorX, mirrorY);
+        return qImageFromVideoFrameOnCpu(frame, rotation, mirrorX, mirrorY);
     }
 
     QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
@@ -345,13 +513,13 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QVideoFrame::RotationAngle
     auto videoFrameTextures = QVideoTextureHelper::createTextures(frameTmp, rhi, rub, {});
     if (!videoFrameTextures) {
         qCDebug(qLcVideoFrameConverter) << "Failed obtain textures. Using CPU conversion.";
-        return convertCPU(frame, rotation, mirrorX, mirrorY);
+        return qImageFromVideoFrameOnCpu(frame, rotation, mirrorX, mirrorY);
     }
 
     if (!updateTextures(rhi, uniformBuffer, textureSampler, shaderResourceBindings,
                         graphicsPipeline, renderPass, frameTmp, videoFrameTextures)) {
         qCDebug(qLcVideoFrameConverter) << "Failed to update textures. Using CPU conversion.";
-        return convertCPU(frame, rotation, mirrorX, mirrorY);
+        return qImageFromVideoFrameOnCpu(frame, rotation, mirrorX, mirrorY);
     }
 
     float xScale = mirrorX ? -1.0 : 1.0;
@@ -393,7 +561,7 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QVideoFrame::RotationAngle
 
     if (!readCompleted) {
         qCDebug(qLcVideoFrameConverter) << "Failed to read back texture. Using CPU conversion.";
-        return convertCPU(frame, rotation, mirrorX, mirrorY);
+        return qImageFromVideoFrameOnCpu(frame, rotation, mirrorX, mirrorY);
     }
 
     QByteArray *imageData = new QByteArray(readResult.data);
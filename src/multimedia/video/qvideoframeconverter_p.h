@@ -21,6 +21,9 @@ QT_BEGIN_NAMESPACE
 
 Q_MULTIMEDIA_EXPORT QImage qImageFromVideoFrame(const QVideoFrame &frame, QVideoFrame::RotationAngle rotation = QVideoFrame::Rotation0, bool mirrorX = false, bool mirrorY = false);
 
+// Converts without the RHI, as qImageFromVideoFrame() does when no RHI is available
+Q_MULTIMEDIA_EXPORT QImage qImageFromVideoFrameOnCpu(const QVideoFrame &frame, QVideoFrame::RotationAngle rotation = QVideoFrame::Rotation0, bool mirrorX = false, bool mirrorY = false);
+
 QT_END_NAMESPACE
 
 #endif
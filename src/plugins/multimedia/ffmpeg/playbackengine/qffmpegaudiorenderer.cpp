@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "playbackengine/qffmpegaudiorenderer_p.h"
+#include "playbackengine/qffmpegaudiotimestretcher_p.h"
 #include "qaudiosink.h"
 #include "qaudiooutput.h"
 #include "private/qplatformaudiooutput_p.h"
@@ -63,16 +64,25 @@ Renderer::RenderingResult AudioRenderer::renderInternal(Frame frame)
     if (frame.isValid())
         updateOutput(frame.codec());
 
-    if (!m_sink || !m_resampler || !m_ioDevice)
+    if (!m_sink || !m_resampler || !m_timeStretcher || !m_ioDevice)
         return {};
 
     if (!m_bufferedData.isValid()) {
-        if (!frame.isValid())
-            return {};
+        if (!frame.isValid()) {
+            // Play out what the time stretcher still holds back at the end of the stream
+            m_bufferedData = m_timeStretcher->flush();
+            m_bufferWritten = 0;
+            if (!m_bufferedData.isValid())
+                return {};
+        } else {
+            updateSampleCompensation(frame);
+            m_bufferedData = m_timeStretcher->process(m_resampler->resample(frame.avFrame()));
+            m_bufferWritten = 0;
 
-        updateSampleCompensation(frame);
-        m_bufferedData = m_resampler->resample(frame.avFrame());
-        m_bufferWritten = 0;
+            // The stretcher needs a full window of input before it produces output
+            if (!m_bufferedData.isValid())
+                return {};
+        }
     }
 
     if (m_bufferedData.isValid()) {
@@ -87,7 +97,9 @@ Renderer::RenderingResult AudioRenderer::renderInternal(Frame frame)
         }
 
         return Renderer::RenderingResult{ std::chrono::microseconds(m_format.durationForBytes(
-                m_sink->bufferSize() / 2 + m_bufferedData.byteCount() - m_bufferWritten)) };
+                                                  m_sink->bufferSize() / 2
+                                                  + m_bufferedData.byteCount() - m_bufferWritten))
+                                          + m_timeStretcher->delay() };
     }
 
     return {};
@@ -95,7 +107,31 @@ Renderer::RenderingResult AudioRenderer::renderInternal(Frame frame)
 
 void AudioRenderer::onPlaybackRateChanged()
 {
+    // The time stretcher keeps the pitch and picks up the new rate with the next window,
+    // so nothing has to be reinitialized
+    if (m_timeStretcher)
+        m_timeStretcher->setPlaybackRate(playbackRate());
+}
+
+void AudioRenderer::onSeek()
+{
+    // Don't play out what was written for the previous position, but keep the sink,
+    // which is expensive to set up again
+    if (m_sink) {
+        m_sink->reset();
+        // Some backends stop the sink when resetting it
+        if (m_sink->state() == QAudio::StoppedState)
+            m_ioDevice = m_sink->start();
+    }
+
+    m_bufferedData = {};
+    m_bufferWritten = 0;
+
+    // The resampler and the time stretcher hold back samples and timing of the previous
+    // position. The resampler is set up again with the next frame.
     m_resampler.reset();
+    if (m_timeStretcher)
+        m_timeStretcher->reset();
 }
 
 void AudioRenderer::initResempler(const Codec *codec)
@@ -114,9 +150,12 @@ void AudioRenderer::initResempler(const Codec *codec)
     #endif
     */
 
-    auto resamplerFormat = m_format;
-    resamplerFormat.setSampleRate(qRound(m_format.sampleRate() / playbackRate()));
-    m_resampler = std::make_unique<Resampler>(codec, resamplerFormat);
+    m_resampler = std::make_unique<Resampler>(codec, m_format);
+
+    if (!m_timeStretcher) {
+        m_timeStretcher = std::make_unique<AudioTimeStretcher>(m_format);
+        m_timeStretcher->setPlaybackRate(playbackRate());
+    }
 }
 
 void AudioRenderer::freeOutput()
@@ -142,6 +181,7 @@ void AudioRenderer::updateOutput(const Codec *codec)
         freeOutput();
         m_format = {};
         m_resampler.reset();
+        m_timeStretcher.reset();
     }
 
     if (!m_output) {
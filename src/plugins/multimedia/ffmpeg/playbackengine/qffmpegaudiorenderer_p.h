@@ -25,6 +25,7 @@ class QAudioSink;
 
 namespace QFFmpeg {
 class Resampler;
+class AudioTimeStretcher;
 };
 
 namespace QFFmpeg {
@@ -44,6 +45,8 @@ protected:
 
     void onPlaybackRateChanged() override;
 
+    void onSeek() override;
+
     void freeOutput();
 
     void updateOutput(const Codec *codec);
@@ -60,6 +63,7 @@ private:
     QPointer<QAudioOutput> m_output;
     std::unique_ptr<QAudioSink> m_sink;
     std::unique_ptr<Resampler> m_resampler;
+    std::unique_ptr<AudioTimeStretcher> m_timeStretcher;
     QAudioFormat m_format;
 
     QAudioBuffer m_bufferedData;
@@ -0,0 +1,325 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegaudiotimestretcher_p.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+namespace {
+// Windows are twice as long as the overlap. 10 ms of overlap keeps the pitch period of
+// voices and most instruments within one window.
+constexpr int OverlapMs = 10;
+constexpr int SearchRadiusMs = 5;
+
+// The search first looks at every CoarseStep-th offset, using every second sample only,
+// and then refines around the best match.
+constexpr int CoarseStep = 4;
+
+template<typename T>
+void toFloat(const T *src, float *dst, int samples, float scale, float offset)
+{
+    for (int i = 0; i < samples; ++i)
+        dst[i] = (float(src[i]) - offset) * scale;
+}
+
+template<typename T>
+void fromFloat(const float *src, T *dst, int samples, float scale, float offset, float min,
+               float max)
+{
+    for (int i = 0; i < samples; ++i)
+        dst[i] = T(qBound(min, src[i] * scale + offset, max));
+}
+} // namespace
+
+AudioTimeStretcher::AudioTimeStretcher(const QAudioFormat &format)
+    : m_format(format),
+      m_channels(qMax(format.channelCount(), 1)),
+      m_overlap(qMax(format.sampleRate() * OverlapMs / 1000, 1)),
+      m_searchRadius(format.sampleRate() * SearchRadiusMs / 1000)
+{
+    // Raised cosine, fadeIn + fadeOut == 1 for overlapping windows
+    m_fadeIn.resize(m_overlap);
+    for (int i = 0; i < m_overlap; ++i)
+        m_fadeIn[i] = float(0.5 - 0.5 * std::cos(M_PI * (i + 0.5) / m_overlap));
+}
+
+void AudioTimeStretcher::setPlaybackRate(float rate)
+{
+    m_rate = rate > 0.f ? rate : 1.f;
+}
+
+QAudioBuffer AudioTimeStretcher::process(const QAudioBuffer &buffer)
+{
+    if (m_rate == 1.f && !m_active && inputFrames() == 0)
+        return buffer;
+
+    appendInput(buffer);
+
+    const qint64 startTime = outputStartTime(m_position);
+    std::vector<float> output;
+    for (;;) {
+        const int nominal = int(m_position);
+        const int required = nominal + (m_active ? m_searchRadius : 0) + 2 * m_overlap;
+        if (inputFrames() < required)
+            break;
+
+        const int start = m_active ? findBestSegment(nominal) : nominal;
+        renderSegment(start, output);
+
+        if (m_rate == 1.f) {
+            // Back to normal speed: the input after the window continues it seamlessly,
+            // so we can drop the faded out tail and pass everything else through
+            output.insert(output.end(), inputAt(start + m_overlap), inputEnd());
+            m_input.clear();
+            m_inputStart = 0;
+            m_pending.clear();
+            m_position = 0.;
+            m_active = false;
+            break;
+        }
+
+        m_position += m_overlap * m_rate;
+        dropInput(qMax(int(m_position) - m_searchRadius, 0));
+    }
+
+    return toBuffer(output, startTime);
+}
+
+QAudioBuffer AudioTimeStretcher::flush()
+{
+    std::vector<float> output;
+    qint64 startTime = outputStartTime(0.);
+    if (m_active) {
+        const int start = qMin(int(m_position), inputFrames());
+        startTime = outputStartTime(start);
+        const int available = inputFrames() - start;
+        output = m_pending;
+        const float *in = inputAt(start);
+        for (int i = 0; i < qMin(available, m_overlap); ++i) {
+            for (int c = 0; c < m_channels; ++c)
+                output[i * m_channels + c] += in[i * m_channels + c] * m_fadeIn[i];
+        }
+        if (available > m_overlap)
+            output.insert(output.end(), inputAt(start + m_overlap), inputEnd());
+    } else {
+        output.assign(inputAt(0), inputEnd());
+    }
+
+    reset();
+
+    return toBuffer(output, startTime);
+}
+
+void AudioTimeStretcher::reset()
+{
+    // Keeps the capacity of the buffers
+    m_input.clear();
+    m_inputStart = 0;
+    m_inputStartTime = -1;
+    m_droppedFrames = 0;
+    m_pending.clear();
+    m_target.clear();
+    m_position = 0.;
+    m_active = false;
+}
+
+std::chrono::microseconds AudioTimeStretcher::delay() const
+{
+    if (!m_active && inputFrames() == 0)
+        return {};
+
+    const double frames = (inputFrames() - m_position) / m_rate + (m_active ? m_overlap : 0);
+    return std::chrono::microseconds(qint64(frames * 1000000 / m_format.sampleRate()));
+}
+
+void AudioTimeStretcher::appendInput(const QAudioBuffer &buffer)
+{
+    // Compacting only once the consumed frames outweigh the rest keeps the cost of
+    // moving the remaining frames constant per input frame
+    if (m_inputStart > 0 && m_inputStart >= inputFrames()) {
+        m_input.erase(m_input.begin(), m_input.begin() + m_inputStart * m_channels);
+        m_inputStart = 0;
+    }
+
+    // Following buffers are taken to continue the input without gaps
+    if (inputFrames() == 0) {
+        m_inputStartTime = buffer.startTime();
+        m_droppedFrames = 0;
+    }
+
+    const int samples = buffer.sampleCount();
+    const size_t offset = m_input.size();
+    m_input.resize(offset + samples);
+    float *dst = m_input.data() + offset;
+
+    switch (m_format.sampleFormat()) {
+    case QAudioFormat::UInt8:
+        toFloat(buffer.constData<quint8>(), dst, samples, 1.f / 128, 128.f);
+        break;
+    case QAudioFormat::Int16:
+        toFloat(buffer.constData<qint16>(), dst, samples, 1.f / 32768, 0.f);
+        break;
+    case QAudioFormat::Int32:
+        toFloat(buffer.constData<qint32>(), dst, samples, 1.f / 2147483648.f, 0.f);
+        break;
+    case QAudioFormat::Float:
+        std::copy_n(buffer.constData<float>(), samples, dst);
+        break;
+    default:
+        std::fill_n(dst, samples, 0.f);
+        break;
+    }
+}
+
+QAudioBuffer AudioTimeStretcher::toBuffer(const std::vector<float> &samples, qint64 startTime) const
+{
+    if (samples.empty())
+        return {};
+
+    const int count = int(samples.size());
+    QByteArray data(count * m_format.bytesPerSample(), Qt::Uninitialized);
+
+    switch (m_format.sampleFormat()) {
+    case QAudioFormat::UInt8:
+        fromFloat(samples.data(), reinterpret_cast<quint8 *>(data.data()), count, 128.f, 128.f,
+                  0.f, 255.f);
+        break;
+    case QAudioFormat::Int16:
+        fromFloat(samples.data(), reinterpret_cast<qint16 *>(data.data()), count, 32768.f, 0.f,
+                  -32768.f, 32767.f);
+        break;
+    case QAudioFormat::Int32:
+        // 2147483647 isn't representable as float, clamp to the largest float below it
+        fromFloat(samples.data(), reinterpret_cast<qint32 *>(data.data()), count, 2147483648.f,
+                  0.f, -2147483648.f, 2147483520.f);
+        break;
+    case QAudioFormat::Float:
+        std::copy_n(samples.data(), count, reinterpret_cast<float *>(data.data()));
+        break;
+    default:
+        data.fill(0);
+        break;
+    }
+
+    return QAudioBuffer(data, m_format, startTime);
+}
+
+// Writes the first half of the window at start, crossfaded with the tail of the previous
+// window, and keeps the faded out second half for the next one
+void AudioTimeStretcher::renderSegment(int start, std::vector<float> &output)
+{
+    const float *first = inputAt(start);
+    const float *second = first + m_overlap * m_channels;
+    const int samples = m_overlap * m_channels;
+
+    if (m_active) {
+        const size_t offset = output.size();
+        output.resize(offset + samples);
+        float *out = output.data() + offset;
+        for (int i = 0; i < m_overlap; ++i) {
+            for (int c = 0; c < m_channels; ++c) {
+                const int s = i * m_channels + c;
+                out[s] = m_pending[s] + first[s] * m_fadeIn[i];
+            }
+        }
+    } else {
+        output.insert(output.end(), first, first + samples);
+    }
+
+    m_pending.resize(samples);
+    m_target.resize(m_overlap);
+    for (int i = 0; i < m_overlap; ++i) {
+        float mono = 0.f;
+        for (int c = 0; c < m_channels; ++c) {
+            const int s = i * m_channels + c;
+            m_pending[s] = second[s] * (1.f - m_fadeIn[i]);
+            mono += second[s];
+        }
+        m_target[i] = mono;
+    }
+
+    m_active = true;
+}
+
+// Returns the start of the window around nominal that correlates best with m_target
+int AudioTimeStretcher::findBestSegment(int nominal)
+{
+    const int first = qMax(nominal - m_searchRadius, 0);
+    const int candidates = nominal + m_searchRadius - first + 1;
+
+    m_search.resize(candidates + m_overlap);
+    const float *in = inputAt(first);
+    for (size_t i = 0; i < m_search.size(); ++i) {
+        float mono = 0.f;
+        for (int c = 0; c < m_channels; ++c)
+            mono += in[i * m_channels + c];
+        m_search[i] = mono;
+    }
+
+    // Normalized cross correlation. The energy of the target is the same for every
+    // candidate and doesn't need to be taken into account.
+    const auto similarity = [this](int offset, int step) {
+        const float *s = m_search.data() + offset;
+        float correlation = 0.f;
+        float energy = 0.f;
+        for (int i = 0; i < m_overlap; i += step) {
+            correlation += s[i] * m_target[i];
+            energy += s[i] * s[i];
+        }
+        return correlation / std::sqrt(energy + 1e-9f);
+    };
+
+    int best = 0;
+    float bestSimilarity = -std::numeric_limits<float>::infinity();
+    for (int offset = 0; offset < candidates; offset += CoarseStep) {
+        const float value = similarity(offset, 2);
+        if (value > bestSimilarity) {
+            bestSimilarity = value;
+            best = offset;
+        }
+    }
+
+    const int refineFrom = qMax(best - CoarseStep + 1, 0);
+    const int refineTo = qMin(best + CoarseStep - 1, candidates - 1);
+    bestSimilarity = -std::numeric_limits<float>::infinity();
+    for (int offset = refineFrom; offset <= refineTo; ++offset) {
+        const float value = similarity(offset, 1);
+        if (value > bestSimilarity) {
+            bestSimilarity = value;
+            best = offset;
+        }
+    }
+
+    return first + best;
+}
+
+void AudioTimeStretcher::dropInput(int frames)
+{
+    if (frames <= 0)
+        return;
+
+    m_inputStart += frames;
+    m_droppedFrames += frames;
+    m_position -= frames;
+}
+
+// The input position is relative to m_inputStart
+qint64 AudioTimeStretcher::outputStartTime(double position) const
+{
+    if (m_inputStartTime < 0)
+        return -1;
+
+    const double inputTime =
+            m_inputStartTime + (m_droppedFrames + position) * 1000000. / m_format.sampleRate();
+    return qint64(inputTime / m_rate);
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
@@ -0,0 +1,104 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGAUDIOTIMESTRETCHER_P_H
+#define QFFMPEGAUDIOTIMESTRETCHER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qaudiobuffer.h"
+
+#include <chrono>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Changes the tempo of audio without changing its pitch.
+//
+// Uses WSOLA (waveform similarity based overlap-add): the input is cut into overlapping
+// windows that are taken at the playback rate but written out at the original hop size.
+// Every window is shifted within a small search range so that it lines up with the
+// waveform of the previous one, which avoids the phasing artifacts of plain overlap-add.
+class AudioTimeStretcher
+{
+public:
+    explicit AudioTimeStretcher(const QAudioFormat &format);
+
+    void setPlaybackRate(float rate);
+    float playbackRate() const { return m_rate; }
+
+    // Returns the buffer unchanged while the playback rate is 1. Otherwise, the start
+    // time of the output is the time of the input it begins with, divided by the rate.
+    QAudioBuffer process(const QAudioBuffer &buffer);
+
+    // Returns whatever is still buffered, e.g. at the end of the stream
+    QAudioBuffer flush();
+
+    // Drops whatever is buffered, e.g. after seeking
+    void reset();
+
+    // The time it takes until buffered input appears in the output
+    std::chrono::microseconds delay() const;
+
+private:
+    int inputFrames() const { return int(m_input.size()) / m_channels - m_inputStart; }
+    const float *inputAt(int frame) const
+    {
+        return m_input.data() + (m_inputStart + frame) * m_channels;
+    }
+    const float *inputEnd() const { return m_input.data() + m_input.size(); }
+
+    void appendInput(const QAudioBuffer &buffer);
+    QAudioBuffer toBuffer(const std::vector<float> &samples, qint64 startTime) const;
+
+    void renderSegment(int start, std::vector<float> &output);
+    int findBestSegment(int nominal);
+    void dropInput(int frames);
+    qint64 outputStartTime(double position) const;
+
+    QAudioFormat m_format;
+    int m_channels = 0;
+    float m_rate = 1.f;
+
+    // Frames in the overlap between two windows, which is also the output hop size
+    int m_overlap = 0;
+    // Maximal distance of a window from its nominal position
+    int m_searchRadius = 0;
+    std::vector<float> m_fadeIn;
+
+    // Interleaved input. Frames before m_inputStart are consumed already and get
+    // removed once they make up the larger part of the buffer.
+    std::vector<float> m_input;
+    int m_inputStart = 0;
+    // Start time of the input in microseconds, or -1 if unknown, and the frames
+    // dropped since then. The time of m_inputStart follows from both.
+    qint64 m_inputStartTime = -1;
+    qint64 m_droppedFrames = 0;
+    // Nominal start of the next window, relative to m_inputStart
+    double m_position = 0.;
+    // True after the first window has been rendered and until we went back to pass through
+    bool m_active = false;
+    // Faded out second half of the last window, to be added to the next one
+    std::vector<float> m_pending;
+    // Mono downmix of the input that followed the last window. The next window should
+    // resemble it as closely as possible.
+    std::vector<float> m_target;
+    // Scratch buffer for the mono downmix of the search range
+    std::vector<float> m_search;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGAUDIOTIMESTRETCHER_P_H
@@ -0,0 +1,156 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGCHANNEL_P_H
+#define QFFMPEGCHANNEL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "playbackengine/qffmpegplaybackengineobject_p.h"
+#include "playbackengine/qffmpegpacket_p.h"
+#include "playbackengine/qffmpegframe_p.h"
+#include "qffmpegboundedqueue_p.h"
+#include "qqueue.h"
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Passes packets or frames from one playback engine object to the next one.
+//
+// The items go through a lock-free queue, and the consumer acknowledges each one it
+// processed, so that the producer doesn't get ahead by more than a limited number of items.
+// Neither side is woken up per item: an object that runs out of work asks to be woken up
+// by the other side, which then posts a single event to it.
+template<typename T>
+class Channel
+{
+public:
+    Channel(const PlaybackEngineObject &producer, qsizetype limit)
+        : m_limit(limit),
+          m_queue(size_t(limit)),
+          m_producer(&producer),
+          m_producerWaker(producer.waker())
+    {
+    }
+
+    Q_DISABLE_COPY_MOVE(Channel)
+
+    const QObject *producer() const { return m_producer; }
+
+    // Can be called from any thread
+    void setConsumer(const PlaybackEngineObject &consumer)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_consumerWaker = consumer.waker();
+    }
+
+    // Producer side
+
+    // Never fails. A step of the producer may push more items than the limit lets through;
+    // they wait in the producer's thread until flush() is called.
+    void push(T item)
+    {
+        ++m_pushed;
+        if (!m_overflow.empty() || !m_queue.tryPush(std::move(item))) {
+            m_overflow.enqueue(std::move(item));
+            return;
+        }
+
+        if (m_consumerWaiting.exchange(false))
+            wake(m_consumerWaker);
+    }
+
+    void flush()
+    {
+        bool moved = false;
+        while (!m_overflow.empty() && m_queue.tryPush(std::move(m_overflow.head()))) {
+            m_overflow.dequeue();
+            moved = true;
+        }
+
+        if (moved && m_consumerWaiting.exchange(false))
+            wake(m_consumerWaker);
+    }
+
+    bool isFull() const { return !m_overflow.empty() || inFlight() >= m_limit; }
+
+    // The number of items acknowledged since the previous call
+    qint64 takeAcknowledged()
+    {
+        const qint64 acknowledged = m_acknowledged.load(std::memory_order_acquire);
+        return acknowledged - std::exchange(m_takenAcknowledged, acknowledged);
+    }
+
+    // Makes the next acknowledgement wake the producer up. Check the state of the channel
+    // again after calling it, as items might have been acknowledged meanwhile.
+    void requestProducerWake()
+    {
+        // Not a plain store, which later loads of the counters might be reordered with
+        m_producerWaiting.exchange(true);
+    }
+
+    // Consumer side
+
+    bool pop(T &item) { return m_queue.tryPop(item); }
+
+    void acknowledge()
+    {
+        m_acknowledged.fetch_add(1, std::memory_order_release);
+        if (m_producerWaiting.exchange(false))
+            wake(m_producerWaker);
+    }
+
+    // Makes the next push wake the consumer up. Pop again after calling it, as items
+    // might have been pushed meanwhile.
+    void requestConsumerWake() { m_consumerWaiting.exchange(true); }
+
+private:
+    qint64 inFlight() const { return m_pushed - m_acknowledged.load(std::memory_order_acquire); }
+
+    void wake(const std::shared_ptr<PlaybackEngineObject::Waker> &waker)
+    {
+        std::shared_ptr<PlaybackEngineObject::Waker> target;
+        {
+            QMutexLocker locker(&m_mutex);
+            target = waker;
+        }
+
+        if (target)
+            target->wake();
+    }
+
+    const qsizetype m_limit;
+    BoundedQueue<T> m_queue;
+
+    // Used by the producer only
+    QQueue<T> m_overflow;
+    qint64 m_pushed = 0;
+    qint64 m_takenAcknowledged = 0;
+
+    std::atomic<qint64> m_acknowledged = 0;
+    std::atomic_bool m_producerWaiting = false;
+    std::atomic_bool m_consumerWaiting = false;
+
+    const QObject *const m_producer;
+    QMutex m_mutex;
+    const std::shared_ptr<PlaybackEngineObject::Waker> m_producerWaker;
+    std::shared_ptr<PlaybackEngineObject::Waker> m_consumerWaker;
+};
+
+using PacketChannel = Channel<Packet>;
+using FrameChannel = Channel<Frame>;
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGCHANNEL_P_H
@@ -21,6 +21,8 @@
 #include "qffmpeg_p.h"
 #include "qffmpeghwaccel_p.h"
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
@@ -36,6 +38,11 @@ class Codec
         AVCodecContextUPtr context;
         AVStream *stream = nullptr;
         std::unique_ptr<QFFmpeg::HWAccel> hwAccel;
+
+        // Shared by the stream decoder and the renderer, in different threads
+        std::atomic_bool skipNonReferenceFrames = false;
+        std::atomic<qint64> droppedFrames = 0;
+        std::atomic<qint64> skippedFrames = 0;
     };
 
 public:
@@ -48,6 +55,18 @@ public:
     qint64 toMs(qint64 ts) const { return timeStampMs(ts, d->stream->time_base).value_or(0); }
     qint64 toUs(qint64 ts) const { return timeStampUs(ts, d->stream->time_base).value_or(0); }
 
+    // Set by the renderer while it's behind; the decoder applies it to the context
+    void setSkipNonReferenceFrames(bool skip) const { d->skipNonReferenceFrames = skip; }
+    bool skipNonReferenceFrames() const { return d->skipNonReferenceFrames; }
+
+    // Decoded frames the renderer dropped because they were late
+    void addDroppedFrame() const { ++d->droppedFrames; }
+    qint64 droppedFrames() const { return d->droppedFrames; }
+
+    // Estimated frames the decoder skipped while the renderer was behind
+    void addSkippedFrame() const { ++d->skippedFrames; }
+    qint64 skippedFrames() const { return d->skippedFrames; }
+
 private:
     Codec(Data *data) : d(data) { }
     QExplicitlySharedDataPointer<Data> d;
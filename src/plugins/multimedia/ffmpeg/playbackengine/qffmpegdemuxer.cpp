@@ -4,18 +4,19 @@
 #include "playbackengine/qffmpegdemuxer_p.h"
 #include <qloggingcategory.h>
 
-QT_BEGIN_NAMESPACE
-
-// 4 sec for buffering. TODO: maybe move to env var customization
-static constexpr qint64 MaxBufferingTimeUs = 4'000'000;
+#include <algorithm>
+#include <optional>
 
-// Currently, consider only time. TODO: maybe move to env var customization
-static constexpr qint64 MaxBufferingSize = std::numeric_limits<qint64>::max();
+QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
 
 static Q_LOGGING_CATEGORY(qLcDemuxer, "qt.multimedia.ffmpeg.demuxer");
 
+// The buffering policy limits the read-ahead; this only caps the memory taken by the
+// queues of streams with many tiny packets
+static constexpr qsizetype MaxPacketsInFlight = 4096;
+
 static qint64 streamTimeToUs(const AVStream *stream, qint64 time)
 {
     Q_ASSERT(stream);
@@ -25,8 +26,9 @@ static qint64 streamTimeToUs(const AVStream *stream, qint64 time)
 }
 
 Demuxer::Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffset,
-                 const StreamIndexes &streamIndexes, int loops)
-    : m_context(context), m_posWithOffset(posWithOffset)
+                 const StreamIndexes &streamIndexes, int loops,
+                 const QMediaBufferingPolicy &bufferingPolicy)
+    : m_context(context), m_posWithOffset(posWithOffset), m_bufferingPolicy(bufferingPolicy)
 {
     qCDebug(qLcDemuxer) << "Create demuxer."
                         << "pos:" << posWithOffset.pos << "loop offset:" << posWithOffset.offset.pos
@@ -40,7 +42,10 @@ Demuxer::Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffs
         if (streamIndexes[i] >= 0) {
             const auto trackType = static_cast<QPlatformMediaPlayer::TrackType>(i);
             qCDebug(qLcDemuxer) << "Activate demuxing stream" << i << ", trackType:" << trackType;
-            m_streams[streamIndexes[i]] = { trackType };
+            auto &stream = m_streams[streamIndexes[i]];
+            stream.trackType = trackType;
+            stream.output = std::make_shared<PacketChannel>(*this, MaxPacketsInFlight);
+            m_outputs[trackType] = stream.output;
         }
     }
 }
@@ -55,7 +60,13 @@ void Demuxer::doNextStep()
 
         if (m_loops >= 0 && m_posWithOffset.offset.index >= m_loops) {
             qCDebug(qLcDemuxer) << "finish demuxing";
+
+            // The decoders finish at the invalid packet, which isn't acknowledged
+            for (auto &[index, data] : m_streams)
+                data.output->push({});
+
             setAtEnd(true);
+            syncWithDecoders();
         } else {
             m_seeked = false;
             m_posWithOffset.pos = 0;
@@ -81,32 +92,21 @@ void Demuxer::doNextStep()
                 streamTimeToUs(stream, packet.avPacket()->pts + packet.avPacket()->duration);
         m_endPts = std::max(m_endPts, m_posWithOffset.offset.pos + packetEndPos);
 
-        it->second.bufferingTime += streamTimeToUs(stream, packet.avPacket()->duration);
-        it->second.bufferingSize += packet.avPacket()->size;
-
-        auto signal = signalByTrackType(it->second.trackType);
-        emit (this->*signal)(packet);
+        const SentPacket sentPacket{ streamTimeToUs(stream, packet.avPacket()->duration),
+                                     packet.avPacket()->size };
+        it->second.bufferingTime += sentPacket.duration;
+        it->second.bufferingSize += sentPacket.size;
+        it->second.sentPackets.enqueue(sentPacket);
+        it->second.output->push(std::move(packet));
     }
 
+    syncWithDecoders();
     scheduleNextStep(false);
 }
 
-void Demuxer::onPacketProcessed(Packet packet)
+void Demuxer::onWake()
 {
-    if (packet.isValid()) {
-        const auto streamIndex = packet.avPacket()->stream_index;
-        auto it = m_streams.find(streamIndex);
-
-        if (it != m_streams.end()) {
-            it->second.bufferingTime -=
-                    streamTimeToUs(m_context->streams[streamIndex], packet.avPacket()->duration);
-            it->second.bufferingSize -= packet.avPacket()->size;
-
-            Q_ASSERT(it->second.bufferingTime >= 0);
-            Q_ASSERT(it->second.bufferingSize >= 0);
-        }
-    }
-
+    syncWithDecoders();
     scheduleNextStep();
 }
 
@@ -115,12 +115,73 @@ bool Demuxer::canDoNextStep() const
     if (!PlaybackEngineObject::canDoNextStep() || isAtEnd() || m_streams.empty())
         return false;
 
-    auto checkBufferingTime = [](const auto &streamIndexToData) {
-        return streamIndexToData.second.bufferingTime < MaxBufferingTimeUs &&
-               streamIndexToData.second.bufferingSize < MaxBufferingSize;
-    };
+    return !m_bufferFull && !isOutputFull();
+}
+
+void Demuxer::syncWithDecoders()
+{
+    takeProcessedPackets();
+    updateBufferingState();
+
+    if (!m_bufferFull && !isOutputFull())
+        return;
+
+    // Blocked until the decoders process packets; count the ones processed meanwhile
+    for (auto &[index, data] : m_streams)
+        data.output->requestProducerWake();
+
+    takeProcessedPackets();
+    updateBufferingState();
+}
+
+void Demuxer::takeProcessedPackets()
+{
+    for (auto &[index, data] : m_streams) {
+        data.output->flush();
+
+        for (auto count = data.output->takeAcknowledged(); count > 0; --count) {
+            const SentPacket packet = data.sentPackets.dequeue();
+            data.bufferingTime -= packet.duration;
+            data.bufferingSize -= packet.size;
 
-    return std::all_of(m_streams.begin(), m_streams.end(), checkBufferingTime);
+            Q_ASSERT(data.bufferingTime >= 0);
+            Q_ASSERT(data.bufferingSize >= 0);
+        }
+    }
+}
+
+bool Demuxer::isOutputFull() const
+{
+    return std::any_of(m_streams.begin(), m_streams.end(),
+                       [](const auto &stream) { return stream.second.output->isFull(); });
+}
+
+void Demuxer::updateBufferingState()
+{
+    qint64 duration = 0;
+    qint64 bytes = 0;
+    for (const auto &[index, data] : m_streams) {
+        duration = std::max(duration, data.bufferingTime);
+        bytes += data.bufferingSize;
+    }
+
+    m_bufferedDuration = duration / 1000;
+    m_bufferedBytes = bytes;
+
+    const bool hasLimit =
+            m_bufferingPolicy.maximumDuration() > 0 || m_bufferingPolicy.maximumBytes() > 0;
+    const float fill = m_bufferingPolicy.fill(m_bufferedDuration, bytes);
+    const bool wasFull = m_bufferFull;
+    if (!hasLimit)
+        m_bufferFull = false;
+    else if (fill >= m_bufferingPolicy.highWatermark())
+        m_bufferFull = true;
+    else if (fill < m_bufferingPolicy.lowWatermark())
+        m_bufferFull = false;
+
+    if (wasFull != m_bufferFull)
+        qCDebug(qLcDemuxer) << "Buffer" << (m_bufferFull ? "full" : "resumed") << "at"
+                            << duration << "us," << bytes << "bytes";
 }
 
 void Demuxer::ensureSeeked()
@@ -141,20 +202,70 @@ void Demuxer::ensureSeeked()
     scheduleNextStep();
 }
 
-Demuxer::RequestingSignal Demuxer::signalByTrackType(QPlatformMediaPlayer::TrackType trackType)
+void Demuxer::seek(const PositionWithOffset &posWithOffset)
 {
-    switch (trackType) {
-    case QPlatformMediaPlayer::TrackType::VideoStream:
-        return &Demuxer::requestProcessVideoPacket;
-    case QPlatformMediaPlayer::TrackType::AudioStream:
-        return &Demuxer::requestProcessAudioPacket;
-    case QPlatformMediaPlayer::TrackType::SubtitleStream:
-        return &Demuxer::requestProcessSubtitlePacket;
-    default:
-        Q_ASSERT(!"Unknown track type");
+    for (auto &output : m_outputs)
+        if (output)
+            output = std::make_shared<PacketChannel>(*this, MaxPacketsInFlight);
+
+    QMetaObject::invokeMethod(this, [this, posWithOffset, outputs = m_outputs]() {
+        qCDebug(qLcDemuxer) << "Seek demuxer."
+                            << "pos:" << posWithOffset.pos
+                            << "loop offset:" << posWithOffset.offset.pos
+                            << "loop index:" << posWithOffset.offset.index;
+
+        for (auto &[index, data] : m_streams) {
+            data.output = outputs[data.trackType];
+            data.sentPackets.clear();
+            data.bufferingTime = 0;
+            data.bufferingSize = 0;
+        }
+
+        // m_endPts stays, as the end of the loop doesn't depend on where we seek to
+        m_posWithOffset = posWithOffset;
+        m_seeked = false;
+        updateBufferingState();
+
+        ensureSeeked();
+    });
+}
+
+void Demuxer::findKeyFrame(int streamIndex, qint64 pos, quint64 requestId)
+{
+    QMetaObject::invokeMethod(this, [this, streamIndex, pos, requestId]() {
+        emit keyFrameFound(requestId, nearestKeyFramePosition(m_context, streamIndex, pos));
+    });
+}
+
+qint64 Demuxer::nearestKeyFramePosition(AVFormatContext *context, int streamIndex, qint64 pos)
+{
+    Q_ASSERT(context);
+
+    // Only what the demuxer indexed so far is known, which is the whole stream for
+    // most containers
+    AVStream *stream = context->streams[streamIndex];
+    const qint64 timestamp = av_rescale_q(pos, AVRational{ 1, 1000000 }, stream->time_base);
+
+    std::optional<qint64> result;
+    for (const int flags : { AVSEEK_FLAG_BACKWARD, 0 }) {
+        const int index = av_index_search_timestamp(stream, timestamp, flags);
+        if (index < 0)
+            continue;
+
+#if QT_FFMPEG_HAS_INDEX_GET_ENTRY
+        const AVIndexEntry *entry = avformat_index_get_entry(stream, index);
+#else
+        const AVIndexEntry *entry = &stream->index_entries[index];
+#endif
+        const auto keyFramePos = entry ? timeStampUs(entry->timestamp, stream->time_base)
+                                       : std::nullopt;
+        if (keyFramePos && (!result || qAbs(*keyFramePos - pos) < qAbs(*result - pos)))
+            result = keyFramePos;
     }
 
-    return nullptr;
+    qCDebug(qLcDemuxer) << "Nearest key frame for" << pos << ":" << result.value_or(pos);
+
+    return result.value_or(pos);
 }
 
 void Demuxer::setLoops(int loopsCount)
@@ -163,6 +274,16 @@ void Demuxer::setLoops(int loopsCount)
     m_loops = loopsCount;
 }
 
+void Demuxer::setBufferingPolicy(const QMediaBufferingPolicy &policy)
+{
+    QMetaObject::invokeMethod(this, [this, policy]() {
+        qCDebug(qLcDemuxer) << "Set buffering policy" << policy;
+        m_bufferingPolicy = policy;
+        syncWithDecoders();
+        scheduleNextStep();
+    });
+}
+
 } // namespace QFFmpeg
 
 QT_END_NAMESPACE
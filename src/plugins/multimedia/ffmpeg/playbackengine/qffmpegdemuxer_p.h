@@ -16,9 +16,12 @@
 
 #include "playbackengine/qffmpegplaybackengineobject_p.h"
 #include "private/qplatformmediaplayer_p.h"
-#include "playbackengine/qffmpegpacket_p.h"
+#include "playbackengine/qffmpegchannel_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
+#include "qmediabufferingpolicy.h"
 
+#include <array>
+#include <memory>
 #include <unordered_map>
 
 QT_BEGIN_NAMESPACE
@@ -30,42 +33,88 @@ class Demuxer : public PlaybackEngineObject
     Q_OBJECT
 public:
     Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffset,
-            const StreamIndexes &streamIndexes, int loops);
+            const StreamIndexes &streamIndexes, int loops,
+            const QMediaBufferingPolicy &bufferingPolicy);
 
-    using RequestingSignal = void (Demuxer::*)(Packet);
-    static RequestingSignal signalByTrackType(QPlatformMediaPlayer::TrackType trackType);
+    // The packets of a track, or null if the track isn't demuxed.
+    // Called by the engine only, as seek() replaces the outputs.
+    std::shared_ptr<PacketChannel> output(QPlatformMediaPlayer::TrackType trackType) const
+    {
+        return m_outputs[trackType];
+    }
+
+    // Restarts demuxing at the position, into new outputs; the packets left in the previous
+    // ones are dropped with them. Called by the engine only.
+    void seek(const PositionWithOffset &posWithOffset);
+
+    // Looks the key frame nearest to the position up in the demuxer thread, as demuxing
+    // extends the index of the stream, and reports it with keyFrameFound().
+    void findKeyFrame(int streamIndex, qint64 pos, quint64 requestId);
+
+    // The key frame nearest to the position in us, among the ones indexed so far; the position
+    // if there's none. Must not be called while a demuxer reads from the context.
+    static qint64 nearestKeyFramePosition(AVFormatContext *context, int streamIndex, qint64 pos);
 
     void setLoops(int loopsCount);
 
-public slots:
-    void onPacketProcessed(Packet);
+    void setBufferingPolicy(const QMediaBufferingPolicy &policy);
+
+    // Can be called from any thread
+    qint64 bufferedDuration() const { return m_bufferedDuration; }
+    qint64 bufferedBytes() const { return m_bufferedBytes; }
 
 signals:
-    void requestProcessAudioPacket(Packet);
-    void requestProcessVideoPacket(Packet);
-    void requestProcessSubtitlePacket(Packet);
+    void keyFrameFound(quint64 requestId, qint64 pos);
 
 private:
     bool canDoNextStep() const override;
 
     void doNextStep() override;
 
+    void onWake() override;
+
     void ensureSeeked();
 
+    void syncWithDecoders();
+
+    void takeProcessedPackets();
+
+    bool isOutputFull() const;
+
+    void updateBufferingState();
+
 private:
+    struct SentPacket
+    {
+        qint64 duration = 0;
+        qint64 size = 0;
+    };
+
     struct StreamData
     {
         QPlatformMediaPlayer::TrackType trackType = QPlatformMediaPlayer::TrackType::NTrackTypes;
         qint64 bufferingTime = 0;
         qint64 bufferingSize = 0;
+        std::shared_ptr<PacketChannel> output;
+        // The packets in the output, in the order the decoder processes them
+        QQueue<SentPacket> sentPackets;
     };
 
     AVFormatContext *m_context = nullptr;
     bool m_seeked = false;
     std::unordered_map<int, StreamData> m_streams;
+    // As handed out to the engine, which may be ahead of the ones in m_streams
+    std::array<std::shared_ptr<PacketChannel>, QPlatformMediaPlayer::NTrackTypes> m_outputs;
     PositionWithOffset m_posWithOffset;
     qint64 m_endPts = 0;
     std::atomic<int> m_loops = QMediaPlayer::Once;
+
+    QMediaBufferingPolicy m_bufferingPolicy;
+    // Set when the high watermark was reached, cleared below the low watermark
+    bool m_bufferFull = false;
+    // Totals for reporting, in ms of the longest stream and bytes of all streams
+    std::atomic<qint64> m_bufferedDuration = 0;
+    std::atomic<qint64> m_bufferedBytes = 0;
 };
 
 } // namespace QFFmpeg
@@ -7,6 +7,31 @@ QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
 
+void PlaybackEngineObject::Waker::wake()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_object || m_object->m_wakePending.exchange(true))
+        return;
+
+    auto object = m_object;
+    QMetaObject::invokeMethod(
+            object,
+            [object]() {
+                object->m_wakePending = false;
+                if (!object->m_deleting)
+                    object->onWake();
+            },
+            Qt::QueuedConnection);
+}
+
+void PlaybackEngineObject::Waker::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_object = nullptr;
+}
+
+PlaybackEngineObject::PlaybackEngineObject() : m_waker(std::make_shared<Waker>(this)) { }
+
 bool PlaybackEngineObject::isPaused() const
 {
     return m_paused;
@@ -32,6 +57,7 @@ void PlaybackEngineObject::setPaused(bool isPaused)
 void PlaybackEngineObject::kill()
 {
     m_deleting = true;
+    m_waker->reset();
     setPaused(true);
 
     disconnect();
@@ -63,6 +89,11 @@ int PlaybackEngineObject::timerInterval() const
     return 0;
 }
 
+void PlaybackEngineObject::onWake()
+{
+    scheduleNextStep();
+}
+
 void PlaybackEngineObject::onPauseChanged()
 {
     scheduleNextStep();
@@ -17,8 +17,10 @@
 #include "playbackengine/qffmpegplaybackenginedefs_p.h"
 #include "qthread.h"
 #include "qtimer.h"
+#include "qmutex.h"
 
 #include <atomic>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -31,6 +33,27 @@ public:
     using TimePoint = std::chrono::steady_clock::time_point;
     using TimePointOpt = std::optional<TimePoint>;
 
+    // Schedules onWake() on the thread of an object, from any thread. Wake-ups coalesce
+    // until the object handles them. Outlives the object, and does nothing once the
+    // object is killed.
+    class Waker
+    {
+    public:
+        explicit Waker(PlaybackEngineObject *object) : m_object(object) { }
+
+        void wake();
+
+        void reset();
+
+    private:
+        QMutex m_mutex;
+        PlaybackEngineObject *m_object = nullptr;
+    };
+
+    PlaybackEngineObject();
+
+    const std::shared_ptr<Waker> &waker() const { return m_waker; }
+
     bool isPaused() const;
 
     bool isAtEnd() const;
@@ -59,8 +82,13 @@ protected:
 
     virtual void doNextStep() { }
 
+    // Called on the object's thread after a wake-up
+    virtual void onWake();
+
 private:
     QTimer *m_timer = nullptr;
+    const std::shared_ptr<Waker> m_waker;
+    std::atomic_bool m_wakePending = false;
 
     std::atomic_bool m_paused = true;
     std::atomic_bool m_atEnd = false;
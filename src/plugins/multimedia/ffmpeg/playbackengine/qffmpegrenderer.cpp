@@ -12,6 +12,7 @@ static Q_LOGGING_CATEGORY(qLcRenderer, "qt.multimedia.ffmpeg.renderer");
 
 Renderer::Renderer(const TimeController &tc, const std::chrono::microseconds &seekPosTimeOffset)
     : m_timeController(tc),
+      m_seekPosTimeOffset(seekPosTimeOffset),
       m_lastPosition(tc.currentPosition()),
       m_seekPos(tc.currentPosition(-seekPosTimeOffset))
 {
@@ -62,30 +63,93 @@ bool Renderer::isStepForced() const
     return m_isStepForced;
 }
 
-void Renderer::onFinalFrameReceived()
+void Renderer::setInput(std::shared_ptr<FrameChannel> input)
 {
-    render({});
+    QMetaObject::invokeMethod(this, [this, input = std::move(input)]() {
+        m_input = input;
+        if (m_input)
+            m_input->setConsumer(*this);
+
+        onWake();
+    });
 }
 
-void Renderer::render(Frame frame)
+qint64 Renderer::seek(const TimeController &tc)
 {
-    using namespace std::chrono;
+    const qint64 lastPosition = tc.currentPosition();
+    const qint64 seekPos = tc.currentPosition(-m_seekPosTimeOffset);
 
-    const auto isFrameOutdated = frame.isValid() && frame.absoluteEnd() < m_seekPos;
+    // Set here already for the engine to report the new position right away
+    m_lastPosition = lastPosition;
+    m_seekPos = seekPos;
 
-    if (isFrameOutdated) {
-        qCDebug(qLcRenderer) << "frame outdated! absEnd:" << frame.absoluteEnd() << "absPts"
-                             << frame.absolutePts() << "seekPos:" << m_seekPos;
-        emit frameProcessed(frame);
-        return;
-    }
+    QMetaObject::invokeMethod(this, [this, tc, lastPosition, seekPos]() {
+        qCDebug(qLcRenderer) << "Seek renderer to" << seekPos;
 
-    m_frames.enqueue(frame);
+        m_timeController = tc;
+        m_timeController.setPaused(isPaused());
+
+        // A step might have rendered an old frame meanwhile
+        m_lastPosition = lastPosition;
+        m_seekPos = seekPos;
+
+        m_input.reset();
+        m_frames.clear();
+
+        onSeek();
+        setAtEnd(false);
+    });
 
-    if (m_frames.size() == 1)
+    return seekPos;
+}
+
+void Renderer::onWake()
+{
+    const bool wasEmpty = m_frames.empty();
+
+    syncWithInput();
+
+    // Otherwise the next step is scheduled already
+    if (wasEmpty && !m_frames.empty())
         scheduleNextStep();
 }
 
+void Renderer::syncWithInput()
+{
+    takeFrames();
+    if (m_frames.empty() && m_input) {
+        m_input->requestConsumerWake();
+        takeFrames();
+    }
+}
+
+void Renderer::takeFrames()
+{
+    if (!m_input)
+        return;
+
+    Frame frame;
+    while (m_input->pop(frame)) {
+        const auto isFrameOutdated = frame.isValid() && frame.absoluteEnd() < m_seekPos;
+
+        if (isFrameOutdated) {
+            qCDebug(qLcRenderer) << "frame outdated! absEnd:" << frame.absoluteEnd() << "absPts"
+                                 << frame.absolutePts() << "seekPos:" << m_seekPos;
+            acknowledge(frame);
+            continue;
+        }
+
+        m_frames.enqueue(std::move(frame));
+    }
+}
+
+void Renderer::acknowledge(const Frame &frame)
+{
+    // Frames of a previous decoder may be left after the input changed
+    if (m_input && frame.source() == m_input->producer())
+        m_input->acknowledge();
+}
+
 void Renderer::onPauseChanged()
 {
     m_timeController.setPaused(isPaused());
@@ -156,12 +220,13 @@ void Renderer::doNextStep()
                 emit loopChanged(frame.loopOffset().pos, m_loopIndex);
             }
 
-            emit frameProcessed(frame);
+            acknowledge(frame);
         }
     }
 
     setAtEnd(done && !frame.isValid());
 
+    syncWithInput();
     scheduleNextStep(false);
 }
 
@@ -16,9 +16,10 @@
 
 #include "playbackengine/qffmpegplaybackengineobject_p.h"
 #include "playbackengine/qffmpegtimecontroller_p.h"
-#include "playbackengine/qffmpegframe_p.h"
+#include "playbackengine/qffmpegchannel_p.h"
 
 #include <chrono>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -43,14 +44,15 @@ public:
 
     bool isStepForced() const;
 
-public slots:
-    void onFinalFrameReceived();
+    // Can be called from any thread
+    void setInput(std::shared_ptr<FrameChannel> input);
 
-    void render(Frame);
+    // Restarts rendering at the current position of the time controller, dropping the
+    // pending frames; the frames are to come from the next setInput(). Returns the position
+    // from which frames are needed. Can be called from any thread.
+    qint64 seek(const TimeController &tc);
 
 signals:
-    void frameProcessed(Frame);
-
     void synchronized(TimePoint tp, qint64 pos);
 
     void forceStepDone();
@@ -64,8 +66,13 @@ protected:
 
     bool canDoNextStep() const override;
 
+    void onWake() override;
+
     virtual void onPlaybackRateChanged() { }
 
+    // Called on the renderer's thread when seeking, to drop what is buffered for the output
+    virtual void onSeek() { }
+
     struct RenderingResult
     {
         std::chrono::microseconds timeLeft = {};
@@ -96,11 +103,19 @@ private:
 
     int timerInterval() const override;
 
+    void syncWithInput();
+
+    void takeFrames();
+
+    void acknowledge(const Frame &frame);
+
 private:
     TimeController m_timeController;
+    const std::chrono::microseconds m_seekPosTimeOffset;
     std::atomic<qint64> m_lastPosition = 0;
     std::atomic<qint64> m_seekPos = 0;
     int m_loopIndex = 0;
+    std::shared_ptr<FrameChannel> m_input;
     QQueue<Frame> m_frames;
 
     std::atomic_bool m_isStepForced = false;
@@ -11,10 +11,25 @@ static Q_LOGGING_CATEGORY(qLcStreamDecoder, "qt.multimedia.ffmpeg.streamdecoder"
 
 namespace QFFmpeg {
 
+// The number of frames the decoder may get ahead of the renderer
+static qsizetype maxPendingFramesCount(QPlatformMediaPlayer::TrackType trackType)
+{
+    constexpr qsizetype maxPendingFramesCount = 3;
+    constexpr qsizetype maxPendingAudioFramesCount = 9;
+
+    return trackType == QPlatformMediaPlayer::AudioStream
+            ? maxPendingAudioFramesCount
+            : trackType == QPlatformMediaPlayer::SubtitleStream
+            ? maxPendingFramesCount * 2 /*main packet and closing packet*/
+            : maxPendingFramesCount;
+}
+
 StreamDecoder::StreamDecoder(const Codec &codec, qint64 absSeekPos)
     : m_codec(codec),
       m_absSeekPos(absSeekPos),
-      m_trackType(MediaDataHolder::trackTypeFromMediaType(codec.context()->codec_type))
+      m_trackType(MediaDataHolder::trackTypeFromMediaType(codec.context()->codec_type)),
+      m_currentOutput(std::make_shared<FrameChannel>(*this, maxPendingFramesCount(m_trackType))),
+      m_output(m_currentOutput)
 {
     qCDebug(qLcStreamDecoder) << "Create stream decoder, trackType" << m_trackType
                               << "absSeekPos:" << absSeekPos;
@@ -26,18 +41,68 @@ StreamDecoder::~StreamDecoder()
     avcodec_flush_buffers(m_codec.context());
 }
 
-void StreamDecoder::onFinalPacketReceived()
+void StreamDecoder::setInput(std::shared_ptr<PacketChannel> input)
 {
-    decode({});
+    QMetaObject::invokeMethod(this, [this, input = std::move(input)]() {
+        m_input = input;
+        if (m_input)
+            m_input->setConsumer(*this);
+
+        syncWithChannels();
+        scheduleNextStep();
+    });
 }
 
-void StreamDecoder::decode(Packet packet)
+void StreamDecoder::seek(qint64 absSeekPos)
 {
-    m_packets.enqueue(packet);
+    m_output = std::make_shared<FrameChannel>(*this, maxPendingFramesCount(m_trackType));
+
+    QMetaObject::invokeMethod(this, [this, absSeekPos, output = m_output]() {
+        qCDebug(qLcStreamDecoder) << "Seek stream decoder, trackType" << m_trackType
+                                  << "absSeekPos:" << absSeekPos;
+
+        m_absSeekPos = absSeekPos;
+        m_input.reset();
+        m_packets.clear();
+        m_currentOutput = output;
+
+        // Much cheaper than opening the codec again, and keeps the hw decoding context
+        avcodec_flush_buffers(m_codec.context());
+        // The renderer asks for skipping again if it's still behind
+        m_codec.setSkipNonReferenceFrames(false);
+        setAtEnd(false);
+    });
+}
 
+void StreamDecoder::onWake()
+{
+    syncWithChannels();
     scheduleNextStep();
 }
 
+void StreamDecoder::syncWithChannels()
+{
+    m_currentOutput->flush();
+    if (m_currentOutput->isFull())
+        m_currentOutput->requestProducerWake();
+
+    takePackets();
+    if (m_packets.empty() && m_input) {
+        m_input->requestConsumerWake();
+        takePackets();
+    }
+}
+
+void StreamDecoder::takePackets()
+{
+    if (!m_input)
+        return;
+
+    Packet packet;
+    while (m_input->pop(packet))
+        m_packets.enqueue(std::move(packet));
+}
+
 void StreamDecoder::doNextStep()
 {
     auto packet = m_packets.dequeue();
@@ -60,11 +125,16 @@ void StreamDecoder::doNextStep()
 
     decodePacket(packet);
 
+    // The renderer finishes at the invalid frame, which isn't acknowledged
+    if (!packet.isValid())
+        m_currentOutput->push({});
+
     setAtEnd(!packet.isValid());
 
     if (packet.isValid())
-        emit packetProcessed(packet);
+        m_input->acknowledge();
 
+    syncWithChannels();
     scheduleNextStep(false);
 }
 
@@ -73,29 +143,9 @@ QPlatformMediaPlayer::TrackType StreamDecoder::trackType() const
     return m_trackType;
 }
 
-void StreamDecoder::onFrameProcessed(Frame frame)
-{
-    if (frame.source() != this)
-        return;
-
-    --m_pendingFramesCount;
-    Q_ASSERT(m_pendingFramesCount >= 0);
-
-    scheduleNextStep();
-}
-
 bool StreamDecoder::canDoNextStep() const
 {
-    constexpr qint32 maxPendingFramesCount = 3;
-    constexpr qint32 maxPendingAudioFramesCount = 9;
-
-    const auto maxCount = m_trackType == QPlatformMediaPlayer::AudioStream
-            ? maxPendingAudioFramesCount
-            : m_trackType == QPlatformMediaPlayer::SubtitleStream
-            ? maxPendingFramesCount * 2 /*main packet and closing packet*/
-            : maxPendingFramesCount;
-
-    return !m_packets.empty() && m_pendingFramesCount < maxCount
+    return !m_packets.empty() && !m_currentOutput->isFull()
             && PlaybackEngineObject::canDoNextStep();
 }
 
@@ -104,13 +154,15 @@ void StreamDecoder::onFrameFound(Frame frame)
     if (frame.isValid() && frame.absoluteEnd() < m_absSeekPos)
         return;
 
-    Q_ASSERT(m_pendingFramesCount >= 0);
-    ++m_pendingFramesCount;
-    emit requestHandleFrame(frame);
+    m_currentOutput->push(std::move(frame));
 }
 
 void StreamDecoder::decodeMedia(Packet packet)
 {
+    updateFrameSkipping();
+    const bool isSkipping = m_codec.context()->skip_frame != AVDISCARD_DEFAULT;
+    int frameCount = 0;
+
     auto sendPacketResult = sendAVPacket(packet);
 
     if (sendPacketResult == AVERROR(EAGAIN)) {
@@ -119,7 +171,7 @@ void StreamDecoder::decodeMedia(Packet packet)
         //                   must read output with avcodec_receive_frame() (once
         //                   all output is read, the packet should be resent, and
         //                   the call will not fail with EAGAIN).
-        receiveAVFrames();
+        frameCount += receiveAVFrames();
         sendPacketResult = sendAVPacket(packet);
 
         if (sendPacketResult != AVERROR(EAGAIN))
@@ -127,16 +179,45 @@ void StreamDecoder::decodeMedia(Packet packet)
     }
 
     if (sendPacketResult == 0)
-        receiveAVFrames();
+        frameCount += receiveAVFrames();
+
+    // The decoder discards skipped frames silently; as it outputs about one frame per
+    // packet, a packet without output is taken for a skipped frame. This is an estimate:
+    // packets whose frames are only delayed, e.g. by frame threading, are counted as well.
+    if (isSkipping && packet.isValid() && frameCount == 0)
+        m_codec.addSkippedFrame();
+}
+
+void StreamDecoder::updateFrameSkipping()
+{
+    if (m_trackType != QPlatformMediaPlayer::VideoStream)
+        return;
+
+    AVCodecContext *context = m_codec.context();
+    const bool skip = m_codec.skipNonReferenceFrames();
+    const AVDiscard discard = skip ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    if (context->skip_frame == discard)
+        return;
+
+    qCDebug(qLcStreamDecoder) << (skip ? "Skip non-reference frames to catch up"
+                                       : "Decode all frames again");
+
+    // Both are picked up by the decoder for the next packet, even with frame threading.
+    // Without deblocking, the picture degrades until the next keyframe, which is better
+    // than falling further behind.
+    context->skip_frame = discard;
+    context->skip_loop_filter = skip ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
 }
 
+
 int StreamDecoder::sendAVPacket(Packet packet)
 {
     return avcodec_send_packet(m_codec.context(), packet.isValid() ? packet.avPacket() : nullptr);
 }
 
-void StreamDecoder::receiveAVFrames()
+int StreamDecoder::receiveAVFrames()
 {
+    int frameCount = 0;
     while (true) {
         auto avFrame = makeAVFrame();
 
@@ -150,8 +231,11 @@ void StreamDecoder::receiveAVFrames()
             break;
         }
 
+        ++frameCount;
         onFrameFound({ m_offset, std::move(avFrame), m_codec, 0, this });
     }
+
+    return frameCount;
 }
 
 void StreamDecoder::decodeSubtitle(Packet packet)
@@ -14,11 +14,11 @@
 // We mean it.
 //
 #include "playbackengine/qffmpegplaybackengineobject_p.h"
-#include "playbackengine/qffmpegframe_p.h"
-#include "playbackengine/qffmpegpacket_p.h"
+#include "playbackengine/qffmpegchannel_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
 #include "private/qplatformmediaplayer_p.h"
 
+#include <memory>
 #include <optional>
 
 QT_BEGIN_NAMESPACE
@@ -35,44 +35,54 @@ public:
 
     QPlatformMediaPlayer::TrackType trackType() const;
 
-public slots:
-    void decode(Packet);
+    // The decoded frames. Called by the engine only, as seek() replaces the output.
+    const std::shared_ptr<FrameChannel> &output() const { return m_output; }
 
-    void onFinalPacketReceived();
+    // Can be called from any thread
+    void setInput(std::shared_ptr<PacketChannel> input);
 
-    void onFrameProcessed(Frame frame);
-
-signals:
-    void requestHandleFrame(Frame frame);
-
-    void packetProcessed(Packet);
+    // Drops the pending packets and frames, and flushes the codec, which is reused.
+    // Frames ending before the position are dropped from then on. The packets are to
+    // come from the next setInput(). Called by the engine only.
+    void seek(qint64 absSeekPos);
 
 protected:
     bool canDoNextStep() const override;
 
     void doNextStep() override;
 
+    void onWake() override;
+
 private:
+    void syncWithChannels();
+
+    void takePackets();
+
     void decodeMedia(Packet);
 
     void decodeSubtitle(Packet);
 
     void onFrameFound(Frame frame);
 
+    void updateFrameSkipping();
+
     int sendAVPacket(Packet);
 
-    void receiveAVFrames();
+    // Returns the number of frames received
+    int receiveAVFrames();
 
 private:
     Codec m_codec;
-    const qint64 m_absSeekPos = 0;
+    qint64 m_absSeekPos = 0;
     const QPlatformMediaPlayer::TrackType m_trackType;
 
-    qint32 m_pendingFramesCount = 0;
-
     LoopOffset m_offset;
 
+    std::shared_ptr<PacketChannel> m_input;
     QQueue<Packet> m_packets;
+    std::shared_ptr<FrameChannel> m_currentOutput;
+    // As handed out to the engine, which may be ahead of m_currentOutput
+    std::shared_ptr<FrameChannel> m_output;
 };
 
 } // namespace QFFmpeg
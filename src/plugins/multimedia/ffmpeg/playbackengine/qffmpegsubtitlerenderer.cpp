@@ -29,6 +29,13 @@ SubtitleRenderer::~SubtitleRenderer()
         m_sink->setSubtitleText({});
 }
 
+void SubtitleRenderer::onSeek()
+{
+    // The subtitle of the new position comes with its frame, if there is one
+    if (m_sink)
+        m_sink->setSubtitleText({});
+}
+
 Renderer::RenderingResult SubtitleRenderer::renderInternal(Frame frame)
 {
     if (m_sink)
@@ -35,6 +35,8 @@ public:
 protected:
     RenderingResult renderInternal(Frame frame) override;
 
+    void onSeek() override;
+
 private:
     QPointer<QVideoSink> m_sink;
 };
@@ -4,11 +4,25 @@
 #include "playbackengine/qffmpegvideorenderer_p.h"
 #include "qffmpegvideobuffer_p.h"
 #include "qvideosink.h"
+#include <qloggingcategory.h>
 
 QT_BEGIN_NAMESPACE
 
+static Q_LOGGING_CATEGORY(qLcVideoRenderer, "qt.multimedia.ffmpeg.videorenderer");
+
 namespace QFFmpeg {
 
+using namespace std::chrono_literals;
+
+// A frame is late if it's shown later than this, or than its duration if that's longer
+static constexpr auto MinLateness = 10ms;
+// Skip decoding non-reference frames after that many late frames in a row...
+static constexpr int LateFramesToSkip = 8;
+// ...and decode all frames again after that many in time
+static constexpr int OnTimeFramesToResume = 60;
+// Show a late frame anyway after dropping that many, so that the picture doesn't freeze
+static constexpr int MaxDroppedFramesInRow = 5;
+
 VideoRenderer::VideoRenderer(const TimeController &tc, QVideoSink *sink)
     : Renderer(tc), m_sink(sink)
 {
@@ -32,6 +46,10 @@ VideoRenderer::RenderingResult VideoRenderer::renderInternal(Frame frame)
         return {};
     }
 
+    // Dropping before the conversion saves most of the work of late frames
+    if (handleLateness(frame))
+        return {};
+
     //        qCDebug(qLcVideoRenderer) << "RHI:" << accel.isNull() << accel.rhi() << sink->rhi();
 
 #ifdef Q_OS_ANDROID
@@ -52,7 +70,7 @@ VideoRenderer::RenderingResult VideoRenderer::renderInternal(Frame frame)
     }
 #endif
 
-    auto buffer = std::make_unique<QFFmpegVideoBuffer>(frame.takeAVFrame());
+    auto buffer = std::make_unique<QFFmpegVideoBuffer>(frame.takeAVFrame(), m_converter);
     QVideoFrameFormat format(buffer->size(), buffer->pixelFormat());
     format.setColorSpace(buffer->colorSpace());
     format.setColorTransfer(buffer->colorTransfer());
@@ -66,6 +84,54 @@ VideoRenderer::RenderingResult VideoRenderer::renderInternal(Frame frame)
     return {};
 }
 
+void VideoRenderer::onSeek()
+{
+    // Being late before the seek says nothing about the frames to come
+    m_lateFrames = 0;
+    m_onTimeFrames = 0;
+    m_droppedFrames = 0;
+    m_skipNonReferenceFrames = false;
+}
+
+bool VideoRenderer::handleLateness(const Frame &frame)
+{
+    // Paused, the renderer only shows frames by steps, which mustn't be dropped
+    if (isPaused())
+        return false;
+
+    const auto threshold = std::max<std::chrono::microseconds>(
+            std::chrono::microseconds(frame.duration()), MinLateness);
+    const bool isLate = frameDelay(frame) > threshold;
+
+    if (isLate) {
+        m_onTimeFrames = 0;
+        ++m_lateFrames;
+    } else {
+        m_lateFrames = 0;
+        ++m_onTimeFrames;
+    }
+
+    if (!m_skipNonReferenceFrames && m_lateFrames >= LateFramesToSkip) {
+        qCDebug(qLcVideoRenderer) << "Persistently late, skip decoding frames";
+        m_skipNonReferenceFrames = true;
+    } else if (m_skipNonReferenceFrames && m_onTimeFrames >= OnTimeFramesToResume) {
+        qCDebug(qLcVideoRenderer) << "In time again, decode all frames";
+        m_skipNonReferenceFrames = false;
+    }
+
+    // Set for every frame, as the codec outlives the renderer
+    frame.codec()->setSkipNonReferenceFrames(m_skipNonReferenceFrames);
+
+    if (!isLate || m_droppedFrames >= MaxDroppedFramesInRow) {
+        m_droppedFrames = 0;
+        return false;
+    }
+
+    ++m_droppedFrames;
+    frame.codec()->addDroppedFrame();
+    return true;
+}
+
 } // namespace QFFmpeg
 
 QT_END_NAMESPACE
@@ -15,6 +15,9 @@
 //
 
 #include "playbackengine/qffmpegrenderer_p.h"
+#include "qffmpegswsframeconverter_p.h"
+
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -33,8 +36,20 @@ public:
 protected:
     RenderingResult renderInternal(Frame frame) override;
 
+    void onSeek() override;
+
 private:
+    // Returns true if the frame is to be dropped
+    bool handleLateness(const Frame &frame);
+
     QPointer<QVideoSink> m_sink;
+    // In a row, for deciding when to skip decoding frames
+    int m_lateFrames = 0;
+    int m_onTimeFrames = 0;
+    int m_droppedFrames = 0;
+    bool m_skipNonReferenceFrames = false;
+    // Reused by the frames of the stream, which may need it later when being mapped
+    std::shared_ptr<SwsFrameConverter> m_converter = std::make_shared<SwsFrameConverter>();
 };
 
 } // namespace QFFmpeg
@@ -22,6 +22,10 @@ extern "C" {
   (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(59, 18, 100)) // since ffmpeg n5.0
 #define QT_FFMPEG_HAS_FRAME_DURATION \
   (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(60, 3, 100)) // since ffmpeg n6.0
+#define QT_FFMPEG_HAS_SWS_THREADS \
+  (LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)) // since ffmpeg n5.0
+#define QT_FFMPEG_HAS_INDEX_GET_ENTRY \
+  (LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100)) // since ffmpeg n4.4
 
 QT_BEGIN_NAMESPACE
 
@@ -131,6 +135,10 @@ using AVCodecContextUPtr =
 using AVBufferUPtr =
         std::unique_ptr<AVBufferRef, AVDeleter<decltype(&av_buffer_unref), &av_buffer_unref>>;
 
+using AVBufferPoolUPtr =
+        std::unique_ptr<AVBufferPool, AVDeleter<decltype(&av_buffer_pool_uninit),
+                                                &av_buffer_pool_uninit>>;
+
 using AVHWFramesConstraintsUPtr = std::unique_ptr<
         AVHWFramesConstraints,
         AVDeleter<decltype(&av_hwframe_constraints_free), &av_hwframe_constraints_free>>;
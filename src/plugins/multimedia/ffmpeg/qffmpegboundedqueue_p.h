@@ -0,0 +1,141 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGBOUNDEDQUEUE_P_H
+#define QFFMPEGBOUNDEDQUEUE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Lock-free bounded queue with any number of producers and consumers.
+//
+// Every cell carries a sequence number telling whether it is ready to be written or read
+// in the current lap, so pushing and popping take a single compare-and-swap and never
+// block or allocate. Queued values are destroyed with the queue.
+template <typename T>
+class BoundedQueue
+{
+public:
+    // The capacity is at least 2, which the sequence numbering needs
+    explicit BoundedQueue(size_t capacity)
+        : m_capacity(qMax(capacity, size_t(2))), m_cells(new Cell[m_capacity])
+    {
+        for (size_t i = 0; i < m_capacity; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    Q_DISABLE_COPY_MOVE(BoundedQueue)
+
+    size_t capacity() const { return m_capacity; }
+
+    // Returns false if the queue is full
+    bool tryPush(const T &value)
+    {
+        T copy = value;
+        return tryPush(std::move(copy));
+    }
+
+    // Moves from value only if it returns true, i.e. if the queue isn't full
+    bool tryPush(T &&value)
+    {
+        size_t pos = m_pushPos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = m_cells[pos % m_capacity];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = qptrdiff(sequence) - qptrdiff(pos);
+            if (diff == 0) {
+                if (m_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The cell still holds the value of the previous lap
+                return false;
+            } else {
+                pos = m_pushPos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty
+    bool tryPop(T &value)
+    {
+        size_t pos = m_popPos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = m_cells[pos % m_capacity];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = qptrdiff(sequence) - qptrdiff(pos + 1);
+            if (diff == 0) {
+                if (m_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    // Don't keep the data of frames and packets alive in the cell
+                    value = std::exchange(cell.value, T());
+                    cell.sequence.store(pos + m_capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_popPos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // True if the next tryPop() would fail, unless a producer completes a push meanwhile
+    bool isEmpty() const
+    {
+        const size_t pos = m_popPos.load(std::memory_order_relaxed);
+        return m_cells[pos % m_capacity].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    // True if the next tryPush() would fail, unless a consumer completes a pop meanwhile
+    bool isFull() const
+    {
+        const size_t pos = m_pushPos.load(std::memory_order_relaxed);
+        return m_cells[pos % m_capacity].sequence.load(std::memory_order_acquire) != pos;
+    }
+
+    // Approximate while other threads push or pop
+    size_t size() const
+    {
+        const size_t popPos = m_popPos.load(std::memory_order_relaxed);
+        const size_t pushPos = m_pushPos.load(std::memory_order_relaxed);
+        return pushPos > popPos ? pushPos - popPos : 0;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t m_capacity;
+    const std::unique_ptr<Cell[]> m_cells;
+    // Free running positions, kept on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> m_pushPos = 0;
+    alignas(64) std::atomic<size_t> m_popPos = 0;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGBOUNDEDQUEUE_P_H
@@ -21,6 +21,7 @@
 extern "C" {
 #include <libavutil/pixdesc.h>
 #include <libavutil/common.h>
+#include <libavutil/samplefmt.h>
 }
 
 QT_BEGIN_NAMESPACE
@@ -30,6 +31,17 @@ static Q_LOGGING_CATEGORY(qLcFFmpegEncoder, "qt.multimedia.ffmpeg.encoder")
 namespace QFFmpeg
 {
 
+// Arbitrarily chosen to limit memory usage (332 MB @ 4K)
+static constexpr size_t DefaultVideoQueueDepth = 10;
+// A few seconds of audio with the usual codec frame sizes
+static constexpr size_t AudioQueueDepth = 256;
+// Packets are small, and the encoders wait for the muxer if it falls behind
+static constexpr size_t MuxerQueueDepth = 512;
+// Converted frames waiting for the codec; a deeper queue would only add latency
+static constexpr size_t CodecQueueDepth = 2;
+// Samples per frame for the audio codecs that accept any number, like PCM
+static constexpr int DefaultAudioFrameSize = 1024;
+
 Encoder::Encoder(const QMediaEncoderSettings &settings, const QUrl &url)
     : settings(settings)
 {
@@ -174,29 +186,28 @@ void Encoder::newTimeStamp(qint64 time)
     }
 }
 
+// Counts video frames and audio buffers that couldn't be encoded
+void Encoder::frameDropped()
+{
+    const qint64 count = ++droppedFrameCount;
+    qCDebug(qLcFFmpegEncoder) << "Encoder can't keep up. Frame lost, total:" << count;
+    emit droppedFramesChanged(count);
+}
+
 Muxer::Muxer(Encoder *encoder)
-    : encoder(encoder)
+    : packetQueue(MuxerQueueDepth), encoder(encoder)
 {
     setObjectName(QLatin1String("Muxer"));
 }
 
-void Muxer::addPacket(AVPacket *packet)
+void Muxer::addPacket(AVPacketUPtr packet)
 {
 //    qCDebug(qLcFFmpegEncoder) << "Muxer::addPacket" << packet->pts << packet->stream_index;
-    QMutexLocker locker(&queueMutex);
-    packetQueue.enqueue(packet);
+    // The queue is only full if writing stalls; the muxer runs until all the encoders are done
+    spaceWaiter.push([&] { return packetQueue.tryPush(std::move(packet)); }, [this] { wake(); });
     wake();
 }
 
-AVPacket *Muxer::takePacket()
-{
-    QMutexLocker locker(&queueMutex);
-    if (packetQueue.isEmpty())
-        return nullptr;
-//    qCDebug(qLcFFmpegEncoder) << "Muxer::takePacket" << packetQueue.first()->pts;
-    return packetQueue.dequeue();
-}
-
 void Muxer::init()
 {
     qCDebug(qLcFFmpegEncoder) << "Muxer::init started thread.";
@@ -204,20 +215,24 @@ void Muxer::init()
 
 void Muxer::cleanup()
 {
+    while (!packetQueue.isEmpty())
+        loop();
 }
 
 bool QFFmpeg::Muxer::shouldWait() const
 {
-    QMutexLocker locker(&queueMutex);
     return packetQueue.isEmpty();
 }
 
 void Muxer::loop()
 {
-    auto *packet = takePacket();
+    AVPacketUPtr packet;
+    if (!packetQueue.tryPop(packet))
+        return;
+    spaceWaiter.notifyPopped();
     //   qCDebug(qLcFFmpegEncoder) << "writing packet to file" << packet->pts << packet->duration <<
     //   packet->stream_index;
-    av_interleaved_write_frame(encoder->formatContext, packet);
+    av_interleaved_write_frame(encoder->formatContext, packet.get());
 }
 
 
@@ -252,7 +267,8 @@ static AVSampleFormat bestMatchingSampleFormat(AVSampleFormat requested, const A
 }
 
 AudioEncoder::AudioEncoder(Encoder *encoder, QFFmpegAudioInput *input, const QMediaEncoderSettings &settings)
-    : input(input)
+    : audioBufferQueue(AudioQueueDepth)
+    , input(input)
     , settings(settings)
 {
     this->encoder = encoder;
@@ -345,26 +361,31 @@ void AudioEncoder::open()
 
 void AudioEncoder::addBuffer(const QAudioBuffer &buffer)
 {
-    QMutexLocker locker(&queueMutex);
-    if (!paused.loadRelaxed()) {
-        audioBufferQueue.enqueue(buffer);
+    if (paused.loadRelaxed())
+        return;
+
+    if (audioBufferQueue.tryPush(buffer)) {
         wake();
+    } else {
+        qCWarning(qLcFFmpegEncoder) << "Audio encoder queue full. Audio buffer lost.";
+        encoder->frameDropped();
     }
 }
 
-QAudioBuffer AudioEncoder::takeBuffer()
-{
-    QMutexLocker locker(&queueMutex);
-    if (audioBufferQueue.isEmpty())
-        return QAudioBuffer();
-    return audioBufferQueue.dequeue();
-}
-
 void AudioEncoder::init()
 {
     open();
+
+    fifo.reset(av_audio_fifo_alloc(codec->sample_fmt, channelCount(), 2 * frameSize()));
+    int bufferSize = av_samples_get_buffer_size(nullptr, channelCount(), frameSize(),
+                                                codec->sample_fmt, 0);
+    if (bufferSize > 0)
+        framePool.reset(av_buffer_pool_init(bufferSize, nullptr));
+    if (!fifo || !framePool)
+        qWarning() << "Cannot allocate the audio frames of the encoder";
+
     if (input) {
-        input->setFrameSize(codec->frame_size);
+        input->setFrameSize(frameSize());
     }
     qCDebug(qLcFFmpegEncoder) << "AudioEncoder::init started audio device thread.";
 }
@@ -373,6 +394,8 @@ void AudioEncoder::cleanup()
 {
     while (!audioBufferQueue.isEmpty())
         loop();
+    drainResampler();
+    sendFrames(true);
     while (avcodec_send_frame(codec, nullptr) == AVERROR(EAGAIN))
         retrievePackets();
     retrievePackets();
@@ -380,17 +403,15 @@ void AudioEncoder::cleanup()
 
 bool AudioEncoder::shouldWait() const
 {
-    QMutexLocker locker(&queueMutex);
     return audioBufferQueue.isEmpty();
 }
 
 void AudioEncoder::retrievePackets()
 {
     while (1) {
-        AVPacket *packet = av_packet_alloc();
-        int ret = avcodec_receive_packet(codec, packet);
+        AVPacketUPtr packet(av_packet_alloc());
+        int ret = avcodec_receive_packet(codec, packet.get());
         if (ret < 0) {
-            av_packet_unref(packet);
             if (ret != AVERROR(EOF))
                 break;
             if (ret != AVERROR(EAGAIN)) {
@@ -403,62 +424,191 @@ void AudioEncoder::retrievePackets()
 
         // qCDebug(qLcFFmpegEncoder) << "writing audio packet" << packet->size << packet->pts << packet->dts;
         packet->stream_index = stream->id;
-        encoder->muxer->addPacket(packet);
+        encoder->muxer->addPacket(std::move(packet));
     }
 }
 
-void AudioEncoder::loop()
+int AudioEncoder::frameSize() const
 {
-    QAudioBuffer buffer = takeBuffer();
-    if (!buffer.isValid() || paused.loadAcquire())
-        return;
+    // Codecs taking any number of samples, like PCM, don't tell a frame size
+    return codec->frame_size > 0 ? codec->frame_size : DefaultAudioFrameSize;
+}
 
-//    qCDebug(qLcFFmpegEncoder) << "new audio buffer" << buffer.byteCount() << buffer.format() << buffer.frameCount() << codec->frame_size;
-    retrievePackets();
+int AudioEncoder::channelCount() const
+{
+#if QT_FFMPEG_OLD_CHANNEL_LAYOUT
+    return codec->channels;
+#else
+    return codec->ch_layout.nb_channels;
+#endif
+}
 
-    auto frame = makeAVFrame();
-    frame->format = codec->sample_fmt;
+void AudioEncoder::initFrame(AVFrame &frame, int samples) const
+{
+    frame.format = codec->sample_fmt;
 #if QT_FFMPEG_OLD_CHANNEL_LAYOUT
-    frame->channel_layout = codec->channel_layout;
-    frame->channels = codec->channels;
+    frame.channel_layout = codec->channel_layout;
+    frame.channels = codec->channels;
 #else
-    frame->ch_layout = codec->ch_layout;
+    av_channel_layout_copy(&frame.ch_layout, &codec->ch_layout);
 #endif
-    frame->sample_rate = codec->sample_rate;
-    frame->nb_samples = buffer.frameCount();
-    if (frame->nb_samples)
-        av_frame_get_buffer(frame.get(), 0);
-
-    if (resampler) {
-        const uint8_t *data = buffer.constData<uint8_t>();
-        swr_convert(resampler, frame->extended_data, frame->nb_samples, &data, frame->nb_samples);
-    } else {
-        memcpy(frame->buf[0]->data, buffer.constData<uint8_t>(), buffer.byteCount());
+    frame.sample_rate = codec->sample_rate;
+    frame.nb_samples = samples;
+}
+
+AVFrameUPtr AudioEncoder::allocateFrame()
+{
+    auto frame = makeAVFrame();
+    initFrame(*frame, frameSize());
+
+    // Planar data with more channels than AVFrame has pointers needs a separate array
+    // of them, which is too rare to be worth pooling
+    if (!framePool
+        || (av_sample_fmt_is_planar(codec->sample_fmt) && channelCount() > AV_NUM_DATA_POINTERS)) {
+        if (av_frame_get_buffer(frame.get(), 0) < 0)
+            return {};
+        return frame;
     }
 
-    const auto &timeBase = stream->time_base;
-    const auto pts = timeBase.den && timeBase.num
-            ? timeBase.den * samplesWritten / (codec->sample_rate * timeBase.num)
-            : samplesWritten;
-    setAVFrameTime(*frame, pts, timeBase);
-    samplesWritten += buffer.frameCount();
+    frame->buf[0] = av_buffer_pool_get(framePool.get());
+    if (!frame->buf[0])
+        return {};
 
-    qint64 time = format.durationForFrames(samplesWritten);
-    encoder->newTimeStamp(time/1000);
+    if (av_samples_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data, channelCount(),
+                               frame->nb_samples, codec->sample_fmt, 0)
+        < 0)
+        return {};
+    frame->extended_data = frame->data;
 
-    //    qCDebug(qLcFFmpegEncoder) << "sending audio frame" << buffer.byteCount() << frame->pts <<
-    //    ((double)buffer.frameCount()/frame->sample_rate);
+    return frame;
+}
 
-    int ret = avcodec_send_frame(codec, frame.get());
-    if (ret < 0) {
-        char errStr[1024];
-        av_strerror(ret, errStr, 1024);
-//        qCDebug(qLcFFmpegEncoder) << "error sending frame" << ret << errStr;
+bool AudioEncoder::writeToFifo(const QAudioBuffer &buffer)
+{
+    if (!fifo)
+        return false;
+
+    const int samples = buffer.frameCount();
+    const uint8_t *data = buffer.constData<uint8_t>();
+
+    if (!resampler) {
+        // The codec takes the sample format of the input, which is interleaved
+        void *planes[] = { const_cast<uint8_t *>(data) };
+        return av_audio_fifo_write(fifo.get(), planes, samples) == samples;
+    }
+
+    return resampleToFifo(&data, samples) >= 0;
+}
+
+int AudioEncoder::resampleToFifo(const uint8_t **data, int samples)
+{
+    const int maxSamples = swr_get_out_samples(resampler, samples);
+    if (maxSamples <= 0)
+        return maxSamples;
+
+    if (!conversionFrame || conversionFrame->nb_samples < maxSamples) {
+        conversionFrame = makeAVFrame();
+        initFrame(*conversionFrame, maxSamples);
+        if (av_frame_get_buffer(conversionFrame.get(), 0) < 0) {
+            conversionFrame.reset();
+            return -1;
+        }
+    }
+
+    const int converted = swr_convert(resampler, conversionFrame->extended_data, maxSamples,
+                                      data, samples);
+    if (converted <= 0)
+        return converted;
+
+    if (av_audio_fifo_write(fifo.get(), reinterpret_cast<void **>(conversionFrame->extended_data),
+                            converted)
+        != converted)
+        return -1;
+
+    return converted;
+}
+
+void AudioEncoder::drainResampler()
+{
+    if (!resampler || !fifo)
+        return;
+
+    // Without input, swr_convert returns the samples it held back for its filter
+    while (resampleToFifo(nullptr, 0) > 0) { }
+}
+
+void AudioEncoder::sendFrames(bool flush)
+{
+    if (!fifo)
+        return;
+
+    while (av_audio_fifo_size(fifo.get()) >= frameSize()
+           || (flush && av_audio_fifo_size(fifo.get()) > 0)) {
+        auto frame = allocateFrame();
+        if (!frame) {
+            qWarning() << "Cannot allocate an audio frame; dropping the buffered samples";
+            av_audio_fifo_reset(fifo.get());
+            return;
+        }
+
+        const int samples = av_audio_fifo_read(fifo.get(),
+                                               reinterpret_cast<void **>(frame->extended_data),
+                                               frameSize());
+        if (samples <= 0)
+            return;
+
+        if (samples < frameSize()) {
+            // Only the last frame may be shorter, and only if the codec allows it
+            if (codec->codec->capabilities
+                & (AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_VARIABLE_FRAME_SIZE))
+                frame->nb_samples = samples;
+            else
+                av_samples_set_silence(frame->extended_data, samples, frameSize() - samples,
+                                       channelCount(), codec->sample_fmt);
+        }
+
+        const auto &timeBase = stream->time_base;
+        const auto pts = timeBase.den && timeBase.num
+                ? timeBase.den * samplesWritten / (codec->sample_rate * timeBase.num)
+                : samplesWritten;
+        setAVFrameTime(*frame, pts, timeBase);
+        samplesWritten += samples;
+
+        int ret = avcodec_send_frame(codec, frame.get());
+        while (ret == AVERROR(EAGAIN)) {
+            retrievePackets();
+            ret = avcodec_send_frame(codec, frame.get());
+        }
+        if (ret < 0)
+            qCDebug(qLcFFmpegEncoder) << "error sending audio frame" << err2str(ret);
+    }
+}
+
+void AudioEncoder::loop()
+{
+    QAudioBuffer buffer;
+    if (!audioBufferQueue.tryPop(buffer) || !buffer.isValid() || paused.loadAcquire())
+        return;
+
+//    qCDebug(qLcFFmpegEncoder) << "new audio buffer" << buffer.byteCount() << buffer.format() << buffer.frameCount() << codec->frame_size;
+    retrievePackets();
+
+    if (!writeToFifo(buffer)) {
+        qCWarning(qLcFFmpegEncoder) << "Cannot buffer audio for encoding. Audio buffer lost.";
+        encoder->frameDropped();
+        return;
     }
+
+    sendFrames(false);
+
+    qint64 time = format.durationForFrames(samplesWritten);
+    encoder->newTimeStamp(time/1000);
 }
 
 VideoEncoder::VideoEncoder(Encoder *encoder, const QMediaEncoderSettings &settings,
                            const QVideoFrameFormat &format, std::optional<AVPixelFormat> hwFormat)
+    : videoFrameQueue(settings.encodingQueueDepth() > 0 ? size_t(settings.encodingQueueDepth())
+                                                        : DefaultVideoQueueDepth)
 {
     this->encoder = encoder;
 
@@ -475,6 +625,7 @@ VideoEncoder::VideoEncoder(Encoder *encoder, const QMediaEncoderSettings &settin
         frameRate = 30.;
     }
 
+    threadCount = settings.encodingThreadCount();
     frameEncoder = new VideoFrameEncoder(settings, format.frameSize(), frameRate, ffmpegPixelFormat,
                                          swFormat);
     frameEncoder->initWithFormatContext(encoder->formatContext);
@@ -487,20 +638,14 @@ VideoEncoder::~VideoEncoder()
 
 void VideoEncoder::addFrame(const QVideoFrame &frame)
 {
-    QMutexLocker locker(&queueMutex);
+    if (paused.loadRelaxed())
+        return;
 
     // Drop frames if encoder can not keep up with the video source data rate
-    const bool queueFull = videoFrameQueue.size() >= maxQueueSize;
-
-    if (queueFull) {
-        qCDebug(qLcFFmpegEncoder) << "Encoder frame queue full. Frame lost.";
-    } else if (!paused.loadRelaxed()) {
-        videoFrameQueue.enqueue(frame);
-
-        locker.unlock(); // Avoid context switch on wake wake-up
-
+    if (videoFrameQueue.tryPush(frame))
         wake();
-    }
+    else
+        encoder->frameDropped();
 }
 
 bool VideoEncoder::isValid() const
@@ -508,38 +653,42 @@ bool VideoEncoder::isValid() const
     return !frameEncoder->isNull();
 }
 
-QVideoFrame VideoEncoder::takeFrame()
-{
-    QMutexLocker locker(&queueMutex);
-
-    QVideoFrame frame;
-    if (!videoFrameQueue.isEmpty())
-        frame = videoFrameQueue.dequeue();
-
-    return frame;
-}
-
 void VideoEncoder::retrievePackets()
 {
     if (!frameEncoder)
         return;
-    while (AVPacket *packet = frameEncoder->retrievePacket())
-        encoder->muxer->addPacket(packet);
+    while (AVPacketUPtr packet = frameEncoder->retrievePacket())
+        encoder->muxer->addPacket(std::move(packet));
 }
 
 void VideoEncoder::init()
 {
     qCDebug(qLcFFmpegEncoder) << "VideoEncoder::init started video device thread.";
     bool ok = frameEncoder->open();
-    if (!ok)
+    if (!ok) {
         emit encoder->error(QMediaRecorder::ResourceError, "Could not initialize encoder");
+        return;
+    }
+
+    if (frameEncoder->needsConversion() && threadCount != 1) {
+        qCDebug(qLcFFmpegEncoder) << "VideoEncoder::init pipelining conversion and encoding.";
+        codecThread = new VideoCodecThread(encoder, this, frameEncoder);
+        codecThread->start();
+    }
 }
 
 void VideoEncoder::cleanup()
 {
     while (!videoFrameQueue.isEmpty())
         loop();
-    if (frameEncoder) {
+    if (codecThread) {
+        // encodes the remaining frames and flushes the codec. The codec thread may take
+        // our mutex in codecQueuePopped(), so we can't hold it while joining the thread.
+        mutex.unlock();
+        codecThread->kill();
+        mutex.lock();
+        codecThread = nullptr;
+    } else if (frameEncoder) {
         while (frameEncoder->sendFrame(nullptr) == AVERROR(EAGAIN))
             retrievePackets();
         retrievePackets();
@@ -548,8 +697,30 @@ void VideoEncoder::cleanup()
 
 bool VideoEncoder::shouldWait() const
 {
-    QMutexLocker locker(&queueMutex);
-    return videoFrameQueue.isEmpty();
+    if (videoFrameQueue.isEmpty())
+        return true;
+    if (!codecThread)
+        return false;
+
+    waitingForCodec.store(true, std::memory_order_relaxed);
+    // Pairs with the fence in codecQueuePopped(): either the codec thread sees that we
+    // wait, or we see the room it made
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const bool full = codecThread->isFull();
+    if (!full)
+        waitingForCodec.store(false, std::memory_order_relaxed);
+    return full;
+}
+
+void VideoEncoder::codecQueuePopped()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waitingForCodec.exchange(false, std::memory_order_relaxed)) {
+        // We get the mutex only once the encoder waits, so the wakeup can't get lost
+        // between its check of the queue and the wait
+        QMutexLocker locker(&mutex);
+        wake();
+    }
 }
 
 struct QVideoFrameHolder
@@ -563,15 +734,23 @@ static void freeQVideoFrame(void *opaque, uint8_t *)
     delete reinterpret_cast<QVideoFrameHolder *>(opaque);
 }
 
+// Releases the reference to the buffer of the first plane, which owns the video frame
+static void unrefPlaneOwner(void *opaque, uint8_t *)
+{
+    auto *owner = reinterpret_cast<AVBufferRef *>(opaque);
+    av_buffer_unref(&owner);
+}
+
 void VideoEncoder::loop()
 {
     if (paused.loadAcquire())
         return;
 
-    retrievePackets();
+    if (!codecThread)
+        retrievePackets();
 
-    auto frame = takeFrame();
-    if (!frame.isValid())
+    QVideoFrame frame;
+    if (!videoFrameQueue.tryPop(frame) || !frame.isValid())
         return;
 
     if (frameEncoder->isNull())
@@ -611,8 +790,28 @@ void VideoEncoder::loop()
         }
 
         Q_ASSERT(avFrame->data[0]);
-        // ensure the video frame and it's data is alive as long as it's being used in the encoder
-        avFrame->opaque_ref = av_buffer_create(nullptr, 0, freeQVideoFrame, new QVideoFrameHolder{frame, img}, 0);
+        // ensure the video frame and it's data is alive as long as it's being used in the encoder.
+        // The buffers wrap the mapped planes, so that ffmpeg can reference them instead of
+        // copying the data, and are read-only, as the data belongs to the video frame.
+        auto *holder = new QVideoFrameHolder{ frame, img };
+        const int bufferSize = img.isNull() ? frame.mappedBytes(0) : int(img.sizeInBytes());
+        avFrame->buf[0] = av_buffer_create(avFrame->data[0], bufferSize, freeQVideoFrame, holder,
+                                           AV_BUFFER_FLAG_READONLY);
+        if (!avFrame->buf[0]) {
+            delete holder;
+            return;
+        }
+
+        for (int i = 1; i < frame.planeCount(); ++i) {
+            AVBufferRef *owner = av_buffer_ref(avFrame->buf[0]);
+            if (owner)
+                avFrame->buf[i] = av_buffer_create(avFrame->data[i], frame.mappedBytes(i),
+                                                   unrefPlaneOwner, owner, AV_BUFFER_FLAG_READONLY);
+            if (!avFrame->buf[i]) {
+                av_buffer_unref(&owner);
+                return;
+            }
+        }
     }
 
     if (baseTime.loadAcquire() == std::numeric_limits<qint64>::min()) {
@@ -628,12 +827,80 @@ void VideoEncoder::loop()
 
     encoder->newTimeStamp(time/1000);
 
-    qCDebug(qLcFFmpegEncoder) << ">>> sending frame" << avFrame->pts << time << lastFrameTime;
-    int ret = frameEncoder->sendFrame(std::move(avFrame));
+    int ret = 0;
+    if (codecThread) {
+        ret = frameEncoder->convertFrame(avFrame);
+        if (ret >= 0) {
+            qCDebug(qLcFFmpegEncoder) << ">>> queuing frame" << avFrame->pts << time << lastFrameTime;
+            // Only blocks while cleaning up; otherwise we wait in shouldWait()
+            codecThread->addFrame(std::move(avFrame));
+        }
+    } else {
+        qCDebug(qLcFFmpegEncoder) << ">>> sending frame" << avFrame->pts << time << lastFrameTime;
+        ret = frameEncoder->sendFrame(std::move(avFrame));
+    }
+
+    if (ret < 0) {
+        qCDebug(qLcFFmpegEncoder) << "error sending frame" << ret << err2str(ret);
+        encoder->error(QMediaRecorder::ResourceError, err2str(ret));
+    }
+}
+
+VideoCodecThread::VideoCodecThread(Encoder *encoder, VideoEncoder *videoEncoder,
+                                   VideoFrameEncoder *frameEncoder)
+    : frameQueue(CodecQueueDepth),
+      encoder(encoder),
+      videoEncoder(videoEncoder),
+      frameEncoder(frameEncoder)
+{
+    setObjectName(QLatin1String("VideoCodecThread"));
+}
+
+void VideoCodecThread::addFrame(AVFrameUPtr frame)
+{
+    spaceWaiter.push([&] { return frameQueue.tryPush(std::move(frame)); }, [this] { wake(); });
+    wake();
+}
+
+void VideoCodecThread::retrievePackets()
+{
+    while (AVPacketUPtr packet = frameEncoder->retrievePacket())
+        encoder->muxer->addPacket(std::move(packet));
+}
+
+void VideoCodecThread::cleanup()
+{
+    while (!frameQueue.isEmpty())
+        loop();
+    while (frameEncoder->sendConvertedFrame(nullptr) == AVERROR(EAGAIN))
+        retrievePackets();
+    retrievePackets();
+}
+
+bool VideoCodecThread::shouldWait() const
+{
+    return frameQueue.isEmpty();
+}
+
+void VideoCodecThread::loop()
+{
+    AVFrameUPtr frame;
+    if (!frameQueue.tryPop(frame))
+        return;
+
+    // the video encoder may wait for space in the queue, either in shouldWait() or in addFrame()
+    spaceWaiter.notifyPopped();
+    videoEncoder->codecQueuePopped();
+
+    retrievePackets();
+
+    const int ret = frameEncoder->sendConvertedFrame(std::move(frame));
     if (ret < 0) {
         qCDebug(qLcFFmpegEncoder) << "error sending frame" << ret << err2str(ret);
         encoder->error(QMediaRecorder::ResourceError, err2str(ret));
     }
+
+    retrievePackets();
 }
 
 }
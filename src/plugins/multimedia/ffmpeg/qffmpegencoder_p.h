@@ -17,17 +17,22 @@
 #include "qffmpegthread_p.h"
 #include "qffmpeg_p.h"
 #include "qffmpeghwaccel_p.h"
+#include "qffmpegboundedqueue_p.h"
 
 #include <private/qplatformmediarecorder_p.h>
 #include <qaudioformat.h>
 #include <qaudiobuffer.h>
+#include <qvideoframe.h>
 
-#include <qqueue.h>
+#include <atomic>
+
+extern "C" {
+#include <libavutil/audio_fifo.h>
+}
 
 QT_BEGIN_NAMESPACE
 
 class QFFmpegAudioInput;
-class QVideoFrame;
 class QPlatformVideoSource;
 
 namespace QFFmpeg
@@ -37,6 +42,7 @@ class Encoder;
 class Muxer;
 class AudioEncoder;
 class VideoEncoder;
+class VideoCodecThread;
 class VideoFrameEncoder;
 
 class EncodingFinalizer : public QThread
@@ -73,14 +79,18 @@ public Q_SLOTS:
 
 Q_SIGNALS:
     void durationChanged(qint64 duration);
+    void droppedFramesChanged(qint64 droppedFrames);
     void error(QMediaRecorder::Error code, const QString &description);
     void finalizationDone();
 
 private:
+    void frameDropped();
+
     // TODO: improve the encasulation
     friend class EncodingFinalizer;
     friend class AudioEncoder;
     friend class VideoEncoder;
+    friend class VideoCodecThread;
     friend class Muxer;
 
     QMediaEncoderSettings settings;
@@ -95,27 +105,71 @@ private:
 
     QMutex timeMutex;
     qint64 timeRecorded = 0;
+
+    // Video frames dropped by all the video encoders
+    std::atomic<qint64> droppedFrameCount = 0;
 };
 
 
+// Lets the producers of a BoundedQueue sleep while it is full, instead of polling it
+class QueueSpaceWaiter
+{
+public:
+    // Retries tryPush until it succeeds. wakeConsumer is called before each wait, so that
+    // a sleeping consumer makes room.
+    template <typename TryPush, typename WakeConsumer>
+    void push(TryPush tryPush, WakeConsumer wakeConsumer)
+    {
+        if (tryPush())
+            return;
+
+        QMutexLocker locker(&mutex);
+        ++waitingProducers;
+        // Pairs with the fence in notifyPopped(): either the consumer sees the waiting
+        // producer, or the retry sees the popped cell
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!tryPush()) {
+            wakeConsumer();
+            spaceAvailable.wait(&mutex);
+        }
+        --waitingProducers;
+    }
+
+    // Called by the consumer after each successful pop
+    void notifyPopped()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waitingProducers.load(std::memory_order_relaxed) > 0) {
+            QMutexLocker locker(&mutex);
+            spaceAvailable.wakeAll();
+        }
+    }
+
+private:
+    QMutex mutex;
+    QWaitCondition spaceAvailable;
+    std::atomic<int> waitingProducers = 0;
+};
+
 class Muxer : public Thread
 {
-    mutable QMutex queueMutex;
-    QQueue<AVPacket *> packetQueue;
+    // Written by all the encoder threads
+    BoundedQueue<AVPacketUPtr> packetQueue;
 public:
     Muxer(Encoder *encoder);
 
-    void addPacket(AVPacket *);
+    // Blocks until the muxer makes room if the queue is full, as a packet can't be dropped
+    void addPacket(AVPacketUPtr packet);
 
 private:
-    AVPacket *takePacket();
-
     void init() override;
     void cleanup() override;
     bool shouldWait() const override;
     void loop() override;
 
     Encoder *encoder;
+    // Lets the encoder threads sleep while the queue is full
+    QueueSpaceWaiter spaceWaiter;
 };
 
 class EncoderThread : public Thread
@@ -133,8 +187,7 @@ protected:
 
 class AudioEncoder : public EncoderThread
 {
-    mutable QMutex queueMutex;
-    QQueue<QAudioBuffer> audioBufferQueue;
+    BoundedQueue<QAudioBuffer> audioBufferQueue;
 public:
     AudioEncoder(Encoder *encoder, QFFmpegAudioInput *input, const QMediaEncoderSettings &settings);
 
@@ -144,9 +197,27 @@ public:
     QFFmpegAudioInput *audioInput() const { return input; }
 
 private:
-    QAudioBuffer takeBuffer();
+    struct AVAudioFifoDeleter
+    {
+        void operator()(AVAudioFifo *fifo) const { av_audio_fifo_free(fifo); }
+    };
+    using AVAudioFifoUPtr = std::unique_ptr<AVAudioFifo, AVAudioFifoDeleter>;
+
     void retrievePackets();
 
+    int frameSize() const;
+    int channelCount() const;
+    void initFrame(AVFrame &frame, int samples) const;
+    AVFrameUPtr allocateFrame();
+    bool writeToFifo(const QAudioBuffer &buffer);
+    // Returns the number of samples written to the FIFO, or a negative value on errors
+    int resampleToFifo(const uint8_t **data, int samples);
+    // Writes the samples still buffered in the resampler to the FIFO
+    void drainResampler();
+    // Sends the samples of the FIFO in frames of the codec's frame size. When flushing, the
+    // remaining samples are sent as a last, shorter frame.
+    void sendFrames(bool flush);
+
     void init() override;
     void cleanup() override;
     bool shouldWait() const override;
@@ -158,6 +229,13 @@ private:
     QAudioFormat format;
 
     SwrContext *resampler = nullptr;
+    // Converted samples wait here until they fill a frame of the codec
+    AVAudioFifoUPtr fifo;
+    // Output of the resampler; only grows, and never leaves the encoder thread
+    AVFrameUPtr conversionFrame;
+    // The frames sent to the codec take their data from here, as the codec may keep
+    // references to it after avcodec_send_frame returns
+    AVBufferPoolUPtr framePool;
     qint64 samplesWritten = 0;
     const AVCodec *avCodec = nullptr;
     QMediaEncoderSettings settings;
@@ -166,9 +244,7 @@ private:
 
 class VideoEncoder : public EncoderThread
 {
-    mutable QMutex queueMutex;
-    QQueue<QVideoFrame> videoFrameQueue;
-    const qsizetype maxQueueSize = 10; // Arbitrarily chosen to limit memory usage (332 MB @ 4K)
+    BoundedQueue<QVideoFrame> videoFrameQueue;
 
 public:
     VideoEncoder(Encoder *encoder, const QMediaEncoderSettings &settings,
@@ -179,6 +255,9 @@ public:
 
     bool isValid() const;
 
+    // Called by the codec thread after it made room in its queue
+    void codecQueuePopped();
+
     void setPaused(bool b) override
     {
         EncoderThread::setPaused(b);
@@ -187,7 +266,6 @@ public:
     }
 
 private:
-    QVideoFrame takeFrame();
     void retrievePackets();
 
     void init() override;
@@ -196,11 +274,43 @@ private:
     void loop() override;
 
     VideoFrameEncoder *frameEncoder = nullptr;
+    // Set if the frames are converted before encoding and more than one thread is allowed
+    VideoCodecThread *codecThread = nullptr;
+    // Set while shouldWait() waits for room in the queue of the codec thread
+    mutable std::atomic<bool> waitingForCodec = false;
+    int threadCount = -1;
 
     QAtomicInteger<qint64> baseTime = std::numeric_limits<qint64>::min();
     qint64 lastFrameTime = 0;
 };
 
+// Sends the converted frames of a VideoEncoder to the codec and passes the packets to the
+// muxer, so that the conversion of a frame overlaps the encoding of the previous one
+class VideoCodecThread : public Thread
+{
+    BoundedQueue<AVFrameUPtr> frameQueue;
+
+public:
+    VideoCodecThread(Encoder *encoder, VideoEncoder *videoEncoder,
+                     VideoFrameEncoder *frameEncoder);
+
+    // Blocks until the codec thread makes room if the queue is full
+    void addFrame(AVFrameUPtr frame);
+    bool isFull() const { return frameQueue.isFull(); }
+
+private:
+    void retrievePackets();
+
+    void cleanup() override;
+    bool shouldWait() const override;
+    void loop() override;
+
+    Encoder *encoder;
+    VideoEncoder *videoEncoder;
+    VideoFrameEncoder *frameEncoder;
+    QueueSpaceWaiter spaceWaiter;
+};
+
 }
 
 QT_END_NAMESPACE
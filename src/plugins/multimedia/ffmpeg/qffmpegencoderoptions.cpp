@@ -298,9 +298,38 @@ const struct {
     { nullptr, nullptr }
 };
 
+static int avThreadType(QMediaRecorder::EncodingThreadType type)
+{
+    switch (type) {
+    case QMediaRecorder::FrameThreading:
+        return FF_THREAD_FRAME;
+    case QMediaRecorder::SliceThreading:
+        return FF_THREAD_SLICE;
+    case QMediaRecorder::AutomaticThreading:
+        break;
+    }
+    return 0;
+}
+
+static void applyThreadingOptions(const QMediaEncoderSettings &settings, AVCodecContext *codec,
+                                  AVDictionary **opts)
+{
+    // we want automatic threading unless the user asks for a specific thread count
+    const int threadCount = settings.encodingThreadCount();
+    if (threadCount > 0)
+        av_dict_set_int(opts, "threads", threadCount, 0);
+    else
+        av_dict_set(opts, "threads", "auto", 0);
+
+    // Frame threading gives the best throughput, slice threading the lowest latency;
+    // by default, the codec chooses among the types it supports
+    if (const int threadType = avThreadType(settings.encodingThreadType()))
+        codec->thread_type = threadType;
+}
+
 void applyVideoEncoderOptions(const QMediaEncoderSettings &settings, const QByteArray &codecName, AVCodecContext *codec, AVDictionary **opts)
 {
-    av_dict_set(opts, "threads", "auto", 0); // we always want automatic threading
+    applyThreadingOptions(settings, codec, opts);
 
     auto *table = videoCodecOptionTable;
     while (table->name) {
@@ -35,7 +35,7 @@ qint64 QFFmpegMediaPlayer::duration() const
 void QFFmpegMediaPlayer::setPosition(qint64 position)
 {
     if (m_playbackEngine) {
-        m_playbackEngine->seek(position * 1000);
+        m_playbackEngine->seek(position * 1000, seekMode());
         updatePosition();
     }
     if (state() == QMediaPlayer::StoppedState)
@@ -134,6 +134,8 @@ void QFFmpegMediaPlayer::setMedia(const QUrl &media, QIODevice *stream)
             &QFFmpegMediaPlayer::error);
     connect(m_playbackEngine.get(), &PlaybackEngine::loopChanged, this,
             &QFFmpegMediaPlayer::onLoopChanged);
+    connect(m_playbackEngine.get(), &PlaybackEngine::seekedToKeyFrame, this,
+            &QFFmpegMediaPlayer::updatePosition);
 
     if (!m_playbackEngine->setMedia(media, stream)) {
         m_playbackEngine.reset();
@@ -144,6 +146,7 @@ void QFFmpegMediaPlayer::setMedia(const QUrl &media, QIODevice *stream)
     m_playbackEngine->setAudioSink(m_audioOutput);
     m_playbackEngine->setVideoSink(m_videoSink);
     m_playbackEngine->setLoops(loops());
+    m_playbackEngine->setBufferingPolicy(bufferingPolicy());
     m_playbackEngine->setPlaybackRate(m_playbackRate);
 
     durationChanged(duration());
@@ -270,6 +273,34 @@ void QFFmpegMediaPlayer::setLoops(int loops)
     QPlatformMediaPlayer::setLoops(loops);
 }
 
+void QFFmpegMediaPlayer::setBufferingPolicy(const QMediaBufferingPolicy &policy)
+{
+    if (m_playbackEngine)
+        m_playbackEngine->setBufferingPolicy(policy);
+
+    QPlatformMediaPlayer::setBufferingPolicy(policy);
+}
+
+qint64 QFFmpegMediaPlayer::bufferedDuration() const
+{
+    return m_playbackEngine ? m_playbackEngine->bufferedDuration() : 0;
+}
+
+qint64 QFFmpegMediaPlayer::bufferedBytes() const
+{
+    return m_playbackEngine ? m_playbackEngine->bufferedBytes() : 0;
+}
+
+qint64 QFFmpegMediaPlayer::droppedVideoFrames() const
+{
+    return m_playbackEngine ? m_playbackEngine->droppedVideoFrames() : 0;
+}
+
+qint64 QFFmpegMediaPlayer::skippedVideoFrames() const
+{
+    return m_playbackEngine ? m_playbackEngine->skippedVideoFrames() : 0;
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qffmpegmediaplayer_p.cpp"
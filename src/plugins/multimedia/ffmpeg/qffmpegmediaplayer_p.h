@@ -66,6 +66,11 @@ public:
     int activeTrack(TrackType) override;
     void setActiveTrack(TrackType, int streamNumber) override;
     void setLoops(int loops) override;
+    void setBufferingPolicy(const QMediaBufferingPolicy &policy) override;
+    qint64 bufferedDuration() const override;
+    qint64 bufferedBytes() const override;
+    qint64 droppedVideoFrames() const override;
+    qint64 skippedVideoFrames() const override;
 
     Q_INVOKABLE void delayedLoadedStatus() {
         if (mediaStatus() == QMediaPlayer::LoadingMedia)
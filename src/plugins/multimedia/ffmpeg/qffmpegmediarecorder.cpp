@@ -73,6 +73,8 @@ void QFFmpegMediaRecorder::record(QMediaEncoderSettings &settings)
     encoder = new QFFmpeg::Encoder(settings, actualSink);
     encoder->setMetaData(m_metaData);
     connect(encoder, &QFFmpeg::Encoder::durationChanged, this, &QFFmpegMediaRecorder::newDuration);
+    connect(encoder, &QFFmpeg::Encoder::droppedFramesChanged, this,
+            &QFFmpegMediaRecorder::newDroppedFrames);
     connect(encoder, &QFFmpeg::Encoder::finalizationDone, this, &QFFmpegMediaRecorder::finalizationDone);
     connect(encoder, &QFFmpeg::Encoder::error, this, &QFFmpegMediaRecorder::handleSessionError);
 
@@ -88,6 +90,7 @@ void QFFmpegMediaRecorder::record(QMediaEncoderSettings &settings)
         encoder->addVideoSource(source);
 
     durationChanged(0);
+    droppedFramesChanged(0);
     stateChanged(QMediaRecorder::RecordingState);
     actualLocationChanged(QUrl::fromLocalFile(location));
 
@@ -53,6 +53,7 @@ public:
 
 private Q_SLOTS:
     void newDuration(qint64 d) { durationChanged(d); }
+    void newDroppedFrames(qint64 n) { droppedFramesChanged(n); }
     void finalizationDone();
     void handleSessionError(QMediaRecorder::Error code, const QString &description);
 
@@ -0,0 +1,220 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qffmpegmjpegdecoder_p.h"
+#include "qffmpegvideobuffer_p.h"
+#include <qloggingcategory.h>
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcMJpegDecoder, "qt.multimedia.ffmpeg.mjpegdecoder")
+
+namespace QFFmpeg {
+
+static constexpr int MaxDefaultThreadCount = 4;
+
+bool MJpegDecoder::isAvailable()
+{
+    return avcodec_find_decoder(AV_CODEC_ID_MJPEG) != nullptr;
+}
+
+MJpegDecoder::MJpegDecoder(FrameCallback callback, DropCallback dropCallback, int threadCount)
+    : m_callback(std::move(callback)),
+      m_dropCallback(std::move(dropCallback)),
+      m_maxPendingFrames(2 * threadCount)
+{
+    m_threadPool.setMaxThreadCount(threadCount);
+    m_threadPool.setObjectName(QLatin1String("MJpegDecoder"));
+    qCDebug(qLcMJpegDecoder) << "Decode MJPEG with" << threadCount << "threads";
+}
+
+MJpegDecoder::~MJpegDecoder()
+{
+    m_threadPool.waitForDone();
+}
+
+int MJpegDecoder::threadCountFor(int requestedCount)
+{
+    bool ok = false;
+    const int count = qEnvironmentVariableIntValue("QT_FFMPEG_MJPEG_DECODING_THREADS", &ok);
+    if (ok && count > 0)
+        return count;
+
+    if (requestedCount > 0)
+        return requestedCount;
+
+    return qBound(1, QThread::idealThreadCount(), MaxDefaultThreadCount);
+}
+
+void MJpegDecoder::decode(QVideoFrame frame)
+{
+    quint64 sequence = 0;
+    bool drop = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_pendingFrames >= m_maxPendingFrames) {
+            // Rather drop a frame than accumulate latency
+            ++m_droppedFrames;
+            qCDebug(qLcMJpegDecoder) << "Drop a frame, total:" << m_droppedFrames;
+            drop = true;
+        } else {
+            ++m_pendingFrames;
+            sequence = m_nextSequence++;
+        }
+    }
+
+    if (drop) {
+        if (m_dropCallback)
+            m_dropCallback();
+        return;
+    }
+
+    m_threadPool.start([this, sequence, frame = std::move(frame)]() mutable {
+        auto context = takeContext();
+        QVideoFrame result = context ? decodeFrame(*context, std::move(frame)) : QVideoFrame();
+        if (context)
+            returnContext(std::move(context));
+        if (!result.isValid() && m_dropCallback)
+            m_dropCallback();
+
+        deliver(sequence, std::move(result));
+    });
+}
+
+std::unique_ptr<MJpegDecoder::Context> MJpegDecoder::takeContext()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_contexts.empty()) {
+            auto result = std::move(m_contexts.back());
+            m_contexts.pop_back();
+            return result;
+        }
+    }
+
+    const AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+    if (!codec)
+        return {};
+
+    auto context = std::make_unique<Context>();
+    context->codecContext.reset(avcodec_alloc_context3(codec));
+    context->packet.reset(av_packet_alloc());
+    if (!context->codecContext || !context->packet)
+        return {};
+
+    // We parallelize over frames ourselves
+    context->codecContext->thread_count = 1;
+    if (avcodec_open2(context->codecContext.get(), codec, nullptr) < 0) {
+        qWarning() << "Cannot open the MJPEG decoder";
+        return {};
+    }
+
+    return context;
+}
+
+void MJpegDecoder::returnContext(std::unique_ptr<Context> context)
+{
+    QMutexLocker locker(&m_mutex);
+    m_contexts.push_back(std::move(context));
+}
+
+QVideoFrame MJpegDecoder::decodeFrame(Context &context, QVideoFrame frame)
+{
+    const qint64 startTime = frame.startTime();
+    const qint64 endTime = frame.endTime();
+
+    if (!frame.map(QVideoFrame::ReadOnly))
+        return {};
+
+    // The decoder needs zeroed padding after the data, which the camera buffers don't
+    // have, so we copy. Compared to decoding, copying compressed data is cheap.
+    const int size = frame.mappedBytes(0);
+    const int paddedSize = size + AV_INPUT_BUFFER_PADDING_SIZE;
+    if (!context.data || context.data->size < paddedSize
+        || !av_buffer_is_writable(context.data.get())) {
+        context.data.reset(av_buffer_alloc(paddedSize));
+        if (!context.data) {
+            frame.unmap();
+            return {};
+        }
+    }
+
+    memcpy(context.data->data, frame.bits(0), size);
+    memset(context.data->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    frame.unmap();
+    // Give the buffer back to the camera
+    frame = {};
+
+    AVPacket *packet = context.packet.get();
+    packet->buf = av_buffer_ref(context.data.get());
+    packet->data = context.data->data;
+    packet->size = size;
+
+    AVCodecContext *codecContext = context.codecContext.get();
+    int ret = avcodec_send_packet(codecContext, packet);
+    av_packet_unref(packet);
+
+    auto decoded = makeAVFrame();
+    if (ret >= 0)
+        ret = avcodec_receive_frame(codecContext, decoded.get());
+
+    if (ret < 0) {
+        qCDebug(qLcMJpegDecoder) << "Cannot decode a frame:" << err2str(ret);
+        return {};
+    }
+
+    // JPEG is full range, which the deprecated YUVJ formats imply. The frames of most
+    // cameras are 4:2:2 and have the layout of YUV422P already.
+    if (decoded->format != AV_PIX_FMT_YUVJ422P && decoded->format != AV_PIX_FMT_YUV422P) {
+        decoded->color_range = AVCOL_RANGE_JPEG;
+        auto converted = context.converter.convert(decoded.get(), AV_PIX_FMT_YUVJ422P);
+        if (!converted)
+            return {};
+
+        converted->colorspace = decoded->colorspace;
+        decoded = std::move(converted);
+    }
+    decoded->format = AV_PIX_FMT_YUV422P;
+    decoded->color_range = AVCOL_RANGE_JPEG;
+
+    auto buffer = std::make_unique<QFFmpegVideoBuffer>(std::move(decoded));
+    QVideoFrameFormat format(buffer->size(), buffer->pixelFormat());
+    format.setColorSpace(buffer->colorSpace());
+    format.setColorRange(buffer->colorRange());
+
+    QVideoFrame result(buffer.release(), format);
+    result.setStartTime(startTime);
+    result.setEndTime(endTime);
+    return result;
+}
+
+void MJpegDecoder::deliver(quint64 sequence, QVideoFrame frame)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_decodedFrames.emplace(sequence, std::move(frame));
+    }
+
+    QMutexLocker deliveryLocker(&m_deliveryMutex);
+    for (;;) {
+        QVideoFrame next;
+        {
+            QMutexLocker locker(&m_mutex);
+            auto it = m_decodedFrames.find(m_nextDelivery);
+            if (it == m_decodedFrames.end())
+                break;
+
+            next = std::move(it->second);
+            m_decodedFrames.erase(it);
+            ++m_nextDelivery;
+            --m_pendingFrames;
+        }
+
+        if (next.isValid())
+            m_callback(next);
+    }
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
@@ -0,0 +1,105 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGMJPEGDECODER_P_H
+#define QFFMPEGMJPEGDECODER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+#include "qffmpegswsframeconverter_p.h"
+
+#include <qvideoframe.h>
+#include <qthreadpool.h>
+#include <qmutex.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Decodes the Format_Jpeg frames of a camera into full range Format_YUV422P frames.
+//
+// The decoder output is passed on as is for the usual 4:2:2 JPEG frames. Other chroma
+// subsamplings are converted.
+//
+// JPEG frames are independent from each other, so they are decoded in parallel on a pool
+// of threads, each using its own codec context. The decoded frames are passed to the
+// callback in the order of the input, on one of the pool threads. Frames that are
+// dropped or can't be decoded are reported to the drop callback, on the thread that
+// dropped them.
+class MJpegDecoder
+{
+public:
+    using FrameCallback = std::function<void(const QVideoFrame &)>;
+    using DropCallback = std::function<void()>;
+
+    static bool isAvailable();
+
+    MJpegDecoder(FrameCallback callback, DropCallback dropCallback,
+                 int threadCount = threadCountFor(-1));
+    // Waits for the frames being decoded, and delivers them
+    ~MJpegDecoder();
+
+    // QT_FFMPEG_MJPEG_DECODING_THREADS overrides the requested count. Without a request,
+    // the count is limited to 4, which is enough for 4K at 30 fps on common hardware.
+    static int threadCountFor(int requestedCount);
+
+    // Must be called from one thread only. The frame is released as soon as its data is
+    // copied, which happens right at the start of decoding.
+    void decode(QVideoFrame frame);
+
+private:
+    struct Context
+    {
+        AVCodecContextUPtr codecContext;
+        AVPacketUPtr packet;
+        AVBufferUPtr data;
+        // For JPEG frames that aren't 4:2:2. Not shared, the contexts are used in parallel.
+        SwsFrameConverter converter;
+    };
+
+    std::unique_ptr<Context> takeContext();
+    void returnContext(std::unique_ptr<Context> context);
+
+    QVideoFrame decodeFrame(Context &context, QVideoFrame frame);
+    void deliver(quint64 sequence, QVideoFrame frame);
+
+    FrameCallback m_callback;
+    DropCallback m_dropCallback;
+    const int m_maxPendingFrames;
+
+    QMutex m_mutex;
+    std::vector<std::unique_ptr<Context>> m_contexts;
+    // Decoded frames that wait for their predecessors; invalid if decoding failed
+    std::map<quint64, QVideoFrame> m_decodedFrames;
+    quint64 m_nextSequence = 0;
+    quint64 m_nextDelivery = 0;
+    int m_pendingFrames = 0;
+    // The frames dropped because the decoding couldn't keep up with the camera
+    quint64 m_droppedFrames = 0;
+
+    // Held while passing frames to the callback, to keep them in order
+    QMutex m_deliveryMutex;
+
+    // Destroyed first, to wait for the running tasks
+    QThreadPool m_threadPool;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGMJPEGDECODER_P_H
@@ -223,14 +223,67 @@ void PlaybackEngine::forEachExistingObject(Action &&action)
     forEachExistingObject<PlaybackEngineObject>(std::forward<Action>(action));
 }
 
-void PlaybackEngine::seek(qint64 pos)
+void PlaybackEngine::seek(qint64 pos, QMediaPlayer::SeekMode mode)
 {
     pos = qBound(0, pos, duration());
 
+    // Any seek supersedes the key frame lookups still on the way
+    const quint64 seekId = ++m_keyFrameSeekId;
+
+    const auto streamIndex = m_currentAVStreamIndex[QPlatformMediaPlayer::VideoStream];
+    if (mode == QMediaPlayer::KeyFrameSeek && streamIndex >= 0) {
+        // Demuxing extends the index of the stream, so only the demuxer thread may read it
+        // meanwhile; the seek is done once the key frame is known
+        if (m_demuxer) {
+            m_demuxer->findKeyFrame(streamIndex, pos, seekId);
+            return;
+        }
+
+        pos = qBound(0, Demuxer::nearestKeyFramePosition(m_context.get(), streamIndex, pos),
+                     duration());
+    }
+
+    seekTo(pos);
+}
+
+void PlaybackEngine::onKeyFrameFound(quint64 seekId, qint64 pos)
+{
+    if (seekId != m_keyFrameSeekId)
+        return;
+
+    seekTo(qBound(0, pos, duration()));
+    emit seekedToKeyFrame();
+}
+
+void PlaybackEngine::seekTo(qint64 pos)
+{
     m_timeController.setPaused(true);
     m_timeController.sync(m_currentLoopOffset.pos + pos);
 
-    forceUpdate();
+    if (m_demuxer)
+        seekObjects(pos);
+    else
+        forceUpdate();
+}
+
+void PlaybackEngine::seekObjects(qint64 pos)
+{
+    // The objects keep their threads and the codecs their contexts; only the packets and
+    // frames on the way are dropped, with the channels they are queued in
+    m_demuxer->seek({ pos, m_currentLoopOffset });
+
+    forEachExistingObject<StreamDecoder>([&](auto &stream) {
+        const auto trackType = stream->trackType();
+        auto &renderer = m_renderers[trackType];
+        Q_ASSERT(renderer);
+
+        stream->seek(renderer->seek(m_timeController));
+        stream->setInput(m_demuxer->output(trackType));
+        renderer->setInput(stream->output());
+    });
+
+    triggerStepIfNeeded();
+    updateObjectsPausedState();
 }
 
 void PlaybackEngine::setLoops(int loops)
@@ -250,6 +303,37 @@ void PlaybackEngine::setLoops(int loops)
         m_demuxer->setLoops(loops);
 }
 
+void PlaybackEngine::setBufferingPolicy(const QMediaBufferingPolicy &policy)
+{
+    if (std::exchange(m_bufferingPolicy, policy) == policy)
+        return;
+
+    if (m_demuxer)
+        m_demuxer->setBufferingPolicy(policy);
+}
+
+qint64 PlaybackEngine::bufferedDuration() const
+{
+    return m_demuxer ? m_demuxer->bufferedDuration() : 0;
+}
+
+qint64 PlaybackEngine::bufferedBytes() const
+{
+    return m_demuxer ? m_demuxer->bufferedBytes() : 0;
+}
+
+qint64 PlaybackEngine::droppedVideoFrames() const
+{
+    const auto &codec = m_codecs[QPlatformMediaPlayer::VideoStream];
+    return codec ? codec->droppedFrames() : 0;
+}
+
+qint64 PlaybackEngine::skippedVideoFrames() const
+{
+    const auto &codec = m_codecs[QPlatformMediaPlayer::VideoStream];
+    return codec ? codec->skippedFrames() : 0;
+}
+
 void PlaybackEngine::triggerStepIfNeeded()
 {
     if (m_state != QMediaPlayer::PausedState)
@@ -345,11 +429,7 @@ void PlaybackEngine::createStreamAndRenderer(QPlatformMediaPlayer::TrackType tra
 
     Q_ASSERT(trackType == stream->trackType());
 
-    connect(stream.get(), &StreamDecoder::requestHandleFrame, renderer.get(), &Renderer::render);
-    connect(stream.get(), &PlaybackEngineObject::atEnd, renderer.get(),
-            &Renderer::onFinalFrameReceived);
-    connect(renderer.get(), &Renderer::frameProcessed, stream.get(),
-            &StreamDecoder::onFrameProcessed);
+    renderer->setInput(stream->output());
 
     constexpr auto masterStreamType = QPlatformMediaPlayer::AudioStream;
 
@@ -413,16 +493,11 @@ void PlaybackEngine::createDemuxer()
     const PositionWithOffset positionWithOffset{ currentPosition(false), m_currentLoopOffset };
 
     m_demuxer = createPlaybackEngineObject<Demuxer>(m_context.get(), positionWithOffset,
-                                                    streamIndexes, m_loops);
+                                                    streamIndexes, m_loops, m_bufferingPolicy);
+    connect(m_demuxer.get(), &Demuxer::keyFrameFound, this, &PlaybackEngine::onKeyFrameFound);
 
-    forEachExistingObject<StreamDecoder>([&](auto &stream) {
-        connect(m_demuxer.get(), Demuxer::signalByTrackType(stream->trackType()), stream.get(),
-                &StreamDecoder::decode);
-        connect(m_demuxer.get(), &PlaybackEngineObject::atEnd, stream.get(),
-                &StreamDecoder::onFinalPacketReceived);
-        connect(stream.get(), &StreamDecoder::packetProcessed, m_demuxer.get(),
-                &Demuxer::onPacketProcessed);
-    });
+    forEachExistingObject<StreamDecoder>(
+            [&](auto &stream) { stream->setInput(m_demuxer->output(stream->trackType())); });
 }
 
 void PlaybackEngine::deleteFreeThreads() {
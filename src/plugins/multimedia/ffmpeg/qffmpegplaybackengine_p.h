@@ -38,7 +38,16 @@
  * OBJECTS WEAK CONNECTIVITY
  *
  * - The objects know nothing about others and about PlaybackEngine.
- *   For any interractions the objects use slots/signals.
+ *   Packets and frames go through channels (see Channel), which the engine hands over
+ *   from the producing object to the consuming one. The end of the stream is an invalid
+ *   packet or frame at the end of a channel. For any other interractions the
+ *   objects use slots/signals.
+ *
+ * SEEKING
+ *
+ * - Seeking keeps the objects and their codecs. Each object drops the packets or frames
+ *   it holds and gets new channels, so that nothing queued before the seek reaches it.
+ *   The objects are only recreated when starting, stopping or changing outputs.
  *
  * - PlaybackEngine knows the objects object and is able to create/delete them and
  *   call their public methods.
@@ -50,6 +59,7 @@
 #include "playbackengine/qffmpegmediadataholder_p.h"
 #include "playbackengine/qffmpegcodec_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
+#include "qmediabufferingpolicy.h"
 
 #include <unordered_map>
 
@@ -91,10 +101,21 @@ public:
         setState(QMediaPlayer::StoppedState);
     }
 
-    void seek(qint64 pos);
+    void seek(qint64 pos, QMediaPlayer::SeekMode mode = QMediaPlayer::AccurateSeek);
 
     void setLoops(int loopsCount);
 
+    void setBufferingPolicy(const QMediaBufferingPolicy &policy);
+
+    // Duration in ms of the longest stream and bytes of all streams read ahead by the demuxer
+    qint64 bufferedDuration() const;
+    qint64 bufferedBytes() const;
+
+    // Video frames dropped by the renderer or skipped by the decoder for being late,
+    // since the video codec was created
+    qint64 droppedVideoFrames() const;
+    qint64 skippedVideoFrames() const;
+
     void setPlaybackRate(float rate);
 
     float playbackRate() const;
@@ -109,6 +130,8 @@ signals:
     void endOfStream();
     void errorOccured(int, const QString &);
     void loopChanged();
+    // A key frame seek finished, which is done asynchronously
+    void seekedToKeyFrame();
 
 protected: // objects managing
     struct ObjectDeleter
@@ -150,6 +173,12 @@ private:
 
     void recreateObjects();
 
+    void seekTo(qint64 pos);
+
+    void seekObjects(qint64 pos);
+
+    void onKeyFrameFound(quint64 seekId, qint64 pos);
+
     void createObjectsIfNeeded();
 
     void updateObjectsPausedState();
@@ -191,7 +220,10 @@ private:
 
     std::array<std::optional<Codec>, QPlatformMediaPlayer::NTrackTypes> m_codecs;
     int m_loops = QMediaPlayer::Once;
+    QMediaBufferingPolicy m_bufferingPolicy;
     LoopOffset m_currentLoopOffset;
+    // Identifies the latest seek, so that the key frames found for earlier ones are ignored
+    quint64 m_keyFrameSeekId = 0;
 };
 
 template<typename T, typename... Args>
@@ -0,0 +1,131 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGRECYCLINGPOOL_P_H
+#define QFFMPEGRECYCLINGPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Bookkeeping of a pool of reusable items, of which at most maxInUse may be handed out
+// at a time. Items come back with release() from any thread.
+//
+// reset() starts a new generation, e.g. when the format of the items changes. Items of
+// older generations aren't reused; they count as in use until they come back, and are
+// then retired. The owner disposes of the items that reset(), takeRetired() and close()
+// return, on its own thread.
+template <typename T>
+class RecyclingPool
+{
+public:
+    using Ptr = std::unique_ptr<T>;
+
+    explicit RecyclingPool(int maxInUse) : m_maxInUse(maxInUse) { }
+
+    // Returns a free item, or one made by create() if the limit allows. Returns nullptr
+    // if too many items are in use, or if create() fails.
+    template <typename Create>
+    Ptr acquire(Create create)
+    {
+        std::lock_guard locker(m_mutex);
+        Ptr result;
+        if (!m_free.empty()) {
+            result = std::move(m_free.back());
+            m_free.pop_back();
+        } else if (m_inUse < m_maxInUse) {
+            result = create();
+        }
+
+        if (result)
+            ++m_inUse;
+        return result;
+    }
+
+    void release(Ptr item, quint64 generation)
+    {
+        std::lock_guard locker(m_mutex);
+        Q_ASSERT(m_inUse > 0);
+        --m_inUse;
+        if (m_closed)
+            return; // the owner has already cleaned up everything that needs it
+        if (generation == m_generation)
+            m_free.push_back(std::move(item));
+        else
+            m_retired.push_back(std::move(item));
+    }
+
+    // Starts a new generation, and returns the free items of the old one
+    std::vector<Ptr> reset()
+    {
+        std::lock_guard locker(m_mutex);
+        ++m_generation;
+        return std::exchange(m_free, {});
+    }
+
+    // Returns the items of older generations that came back
+    std::vector<Ptr> takeRetired()
+    {
+        std::lock_guard locker(m_mutex);
+        return std::exchange(m_retired, {});
+    }
+
+    // Returns the free and retired items. Items in use are dropped when they come back.
+    std::vector<Ptr> close()
+    {
+        std::lock_guard locker(m_mutex);
+        m_closed = true;
+        ++m_generation;
+        auto result = std::exchange(m_free, {});
+        for (auto &item : m_retired)
+            result.push_back(std::move(item));
+        m_retired.clear();
+        return result;
+    }
+
+    quint64 generation() const
+    {
+        std::lock_guard locker(m_mutex);
+        return m_generation;
+    }
+
+    // The items handed out, of all generations
+    int inUse() const
+    {
+        std::lock_guard locker(m_mutex);
+        return m_inUse;
+    }
+
+private:
+    const int m_maxInUse;
+
+    mutable std::mutex m_mutex;
+    quint64 m_generation = 0;
+    int m_inUse = 0;
+    bool m_closed = false;
+    std::vector<Ptr> m_free;
+    std::vector<Ptr> m_retired;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGRECYCLINGPOOL_P_H
@@ -318,6 +318,7 @@ public:
         setFrameRate(screen->refreshRate());
         addFrameCallback(screenCapture, &QFFmpegScreenCaptureDxgi::newVideoFrame);
         connect(this, &Grabber::errorUpdated, &screenCapture, &QFFmpegScreenCaptureDxgi::updateError);
+        connect(this, &Grabber::statisticsUpdated, &screenCapture, &QFFmpegScreenCaptureDxgi::updateStatistics);
     }
 
     ~Grabber() {
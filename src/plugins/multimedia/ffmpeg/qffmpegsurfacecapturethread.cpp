@@ -9,6 +9,13 @@
 QT_BEGIN_NAMESPACE
 
 static Q_LOGGING_CATEGORY(qLcScreenCaptureThread, "qt.multimedia.ffmpeg.surfacecapturethread");
+static Q_LOGGING_CATEGORY(qLcScreenCaptureProfiling,
+                          "qt.multimedia.ffmpeg.surfacecapturethread.profiling");
+
+// How often the grabbing statistics are reported to the surface capture
+static constexpr qint64 StatisticsIntervalMs = 1000;
+// How often the grabbing statistics are logged
+static constexpr qint64 ProfilingReportIntervalMs = 5000;
 
 namespace {
 
@@ -30,6 +37,9 @@ public:
         });
     }
 
+    // Counts the grabbings that didn't produce a frame, e.g. because nothing has changed
+    void addSkipped() { ++m_skipped; }
+
     qreal avgTime() const
     {
         return m_number ? m_wholeTime / (m_number * 1000000.) : 0.;
@@ -40,10 +50,13 @@ public:
         return m_number;
     }
 
+    qint64 skipped() const { return m_skipped; }
+
 private:
     QElapsedTimer m_elapsedTimer;
     qint64 m_wholeTime = 0;
     qint64 m_number = 0;
+    qint64 m_skipped = 0;
 };
 
 } // namespace
@@ -92,20 +105,41 @@ void QFFmpegSurfaceCaptureThread::run()
     qint64 lastFrameTime = 0;
 
     GrabbingProfiler profiler;
+    qint64 lastStatisticsTime = 0;
+    qint64 lastReportTime = 0;
 
     auto doGrab = [&]() {
-        auto measure = profiler.measure();
+        {
+            auto measure = profiler.measure();
+
+            auto frame = grabFrame();
 
-        auto frame = grabFrame();
+            if (frame.isValid()) {
+                frame.setStartTime(lastFrameTime);
+                frame.setEndTime(elapsedTimer.nsecsElapsed() / 1000);
+                lastFrameTime = frame.endTime();
 
-        if (frame.isValid()) {
-            frame.setStartTime(lastFrameTime);
-            frame.setEndTime(elapsedTimer.nsecsElapsed() / 1000);
-            lastFrameTime = frame.endTime();
+                updateError(QPlatformSurfaceCapture::NoError);
 
-            updateError(QPlatformSurfaceCapture::NoError);
+                emit frameGrabbed(frame);
+            } else {
+                profiler.addSkipped();
+            }
+        }
+
+        if (elapsedTimer.elapsed() - lastStatisticsTime >= StatisticsIntervalMs) {
+            lastStatisticsTime = elapsedTimer.elapsed();
+            emit statisticsUpdated(profiler.number() - profiler.skipped(), profiler.skipped(),
+                                   profiler.avgTime());
+        }
 
-            emit frameGrabbed(frame);
+        if (qLcScreenCaptureProfiling().isDebugEnabled()
+            && elapsedTimer.elapsed() - lastReportTime >= ProfilingReportIntervalMs) {
+            lastReportTime = elapsedTimer.elapsed();
+            qCDebug(qLcScreenCaptureProfiling)
+                    << "avg grabbing time:" << profiler.avgTime()
+                    << "ms, grabbings number:" << profiler.number()
+                    << "without frame:" << profiler.skipped();
         }
     };
 
@@ -118,7 +152,8 @@ void QFFmpegSurfaceCaptureThread::run()
 
     qCDebug(qLcScreenCaptureThread)
             << "end screen capture thread; avg grabbing time:" << profiler.avgTime()
-            << "ms, grabbings number:" << profiler.number();
+            << "ms, grabbings number:" << profiler.number()
+            << "without frame:" << profiler.skipped();
 }
 
 void QFFmpegSurfaceCaptureThread::updateError(QPlatformSurfaceCapture::Error error,
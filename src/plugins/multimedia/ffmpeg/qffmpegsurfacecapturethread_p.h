@@ -56,6 +56,9 @@ public:
 signals:
     void frameGrabbed(const QVideoFrame&);
     void errorUpdated(QPlatformSurfaceCapture::Error error, const QString &description);
+    // The average grabbing time is in milliseconds
+    void statisticsUpdated(qint64 capturedFrames, qint64 skippedFrames,
+                           qreal averageGrabbingTime);
 
 protected:
     void run() override;
@@ -0,0 +1,157 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qffmpegswsframeconverter_p.h"
+#include <qloggingcategory.h>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcSwsFrameConverter, "qt.multimedia.ffmpeg.swsframeconverter")
+
+namespace QFFmpeg {
+
+// Same alignment and padding as av_frame_get_buffer uses, so that SIMD code in
+// swscale and in the video sinks may read whole vectors
+static constexpr int LineAlignment = 64;
+static constexpr int BufferPadding = 64;
+
+SwsFrameConverter::SwsFrameConverter(int flags) : m_flags(flags) { }
+
+int SwsFrameConverter::defaultFlags()
+{
+    static const int flags = []() {
+        const QByteArray name = qgetenv("QT_FFMPEG_SWS_FLAGS");
+        if (name.isEmpty() || name == "bilinear")
+            return SWS_BILINEAR;
+        if (name == "fast_bilinear")
+            return SWS_FAST_BILINEAR;
+        if (name == "point")
+            return SWS_POINT;
+        if (name == "area")
+            return SWS_AREA;
+        if (name == "bicubic")
+            return SWS_BICUBIC;
+
+        qWarning() << "Unknown value of QT_FFMPEG_SWS_FLAGS:" << name;
+        return SWS_BILINEAR;
+    }();
+
+    return flags;
+}
+
+AVFrameUPtr SwsFrameConverter::convert(const AVFrame *frame, AVPixelFormat targetFormat)
+{
+    const auto sourceFormat = AVPixelFormat(frame->format);
+    const QSize size(frame->width, frame->height);
+
+    SwsContextUPtr context = { nullptr, &sws_freeContext };
+    AVFrameUPtr result;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_idleContexts.empty()) {
+            context = std::move(m_idleContexts.back());
+            m_idleContexts.pop_back();
+        }
+        result = allocateFrame(targetFormat, size);
+    }
+    if (!result)
+        return {};
+
+    // Returns the given context if the parameters didn't change, and frees it otherwise
+    context.reset(sws_getCachedContext(context.release(), size.width(), size.height(),
+                                       sourceFormat, size.width(), size.height(), targetFormat,
+                                       m_flags, nullptr, nullptr, nullptr));
+    if (!context) {
+        qWarning() << "Cannot create a scaler from" << sourceFormat << "to" << targetFormat;
+        return {};
+    }
+
+    // swscale derives the range from the pixel format, which is only right for the
+    // deprecated YUVJ formats, so we follow the frame if it tells the range
+    int *inverseTable = nullptr;
+    int *table = nullptr;
+    int sourceRange = 0, targetRange = 0, brightness = 0, contrast = 0, saturation = 0;
+    if (frame->color_range != AVCOL_RANGE_UNSPECIFIED
+        && sws_getColorspaceDetails(context.get(), &inverseTable, &sourceRange, &table,
+                                    &targetRange, &brightness, &contrast, &saturation)
+                >= 0) {
+        const int range = frame->color_range == AVCOL_RANGE_JPEG ? 1 : 0;
+        if (range != sourceRange)
+            sws_setColorspaceDetails(context.get(), inverseTable, range, table, targetRange,
+                                     brightness, contrast, saturation);
+    }
+
+    sws_scale(context.get(), frame->data, frame->linesize, 0, size.height(), result->data,
+              result->linesize);
+
+    QMutexLocker locker(&m_mutex);
+    m_idleContexts.push_back(std::move(context));
+
+    return result;
+}
+
+AVFrameUPtr SwsFrameConverter::allocateFrame(AVPixelFormat format, const QSize &size)
+{
+    auto result = makeAVFrame();
+    result->width = size.width();
+    result->height = size.height();
+    result->format = format;
+
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    if (!desc || (desc->flags & AV_PIX_FMT_FLAG_PAL)) {
+        // Palettes need a separate buffer, they're too rare to be worth pooling
+        if (av_frame_get_buffer(result.get(), 0) < 0)
+            return {};
+        return result;
+    }
+
+    if (!m_pool || m_poolFormat != format || m_poolSize != size) {
+        m_pool.reset();
+
+        if (av_image_fill_linesizes(m_linesizes, format, FFALIGN(size.width(), LineAlignment))
+            < 0)
+            return {};
+
+        int bufferSize = 0;
+        for (int i = 0; i < 4; ++i) {
+            m_linesizes[i] = FFALIGN(m_linesizes[i], LineAlignment);
+            m_planeOffsets[i] = bufferSize;
+
+            const bool isChroma = i == 1 || i == 2;
+            const int height =
+                    isChroma ? AV_CEIL_RSHIFT(size.height(), desc->log2_chroma_h) : size.height();
+            bufferSize += m_linesizes[i] * height;
+        }
+
+        m_pool.reset(av_buffer_pool_init(bufferSize + BufferPadding, nullptr));
+        if (!m_pool)
+            return {};
+
+        m_poolFormat = format;
+        m_poolSize = size;
+
+        qCDebug(qLcSwsFrameConverter)
+                << "Create frame pool for" << av_get_pix_fmt_name(format) << size << "with"
+                << bufferSize << "bytes per frame";
+    }
+
+    result->buf[0] = av_buffer_pool_get(m_pool.get());
+    if (!result->buf[0])
+        return {};
+
+    for (int i = 0; i < 4 && m_linesizes[i]; ++i) {
+        result->data[i] = result->buf[0]->data + m_planeOffsets[i];
+        result->linesize[i] = m_linesizes[i];
+    }
+
+    return result;
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
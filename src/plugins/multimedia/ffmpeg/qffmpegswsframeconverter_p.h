@@ -0,0 +1,73 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGSWSFRAMECONVERTER_P_H
+#define QFFMPEGSWSFRAMECONVERTER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qsize.h>
+
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+using SwsContextUPtr = std::unique_ptr<SwsContext, decltype(&sws_freeContext)>;
+
+// Converts software frames into another pixel format of the same size.
+//
+// The scaler context is kept as long as the source and target formats don't change, and
+// the converted frames are allocated from a pool, so that converting the frames of a
+// stream doesn't allocate anything once the pool is warmed up. The pool stays valid
+// while converted frames are still referenced, even after the converter is destroyed.
+//
+// The converter can be shared by several threads. Each conversion that runs at the same
+// time uses a scaler context of its own, so they don't wait for each other.
+class SwsFrameConverter
+{
+public:
+    // By default, uses the flags given by QT_FFMPEG_SWS_FLAGS, or SWS_BILINEAR.
+    // Without resizing, the flags only affect the chroma resampling, so the more
+    // expensive filters bring little benefit here.
+    explicit SwsFrameConverter(int flags = defaultFlags());
+
+    static int defaultFlags();
+
+    AVFrameUPtr convert(const AVFrame *frame, AVPixelFormat targetFormat);
+
+private:
+    AVFrameUPtr allocateFrame(AVPixelFormat format, const QSize &size);
+
+    // Guards the idle contexts and the pool
+    QMutex m_mutex;
+    const int m_flags;
+
+    // Contexts not in use by a conversion right now, at most one per thread that
+    // converted at the same time
+    std::vector<SwsContextUPtr> m_idleContexts;
+
+    AVBufferPoolUPtr m_pool;
+    AVPixelFormat m_poolFormat = AV_PIX_FMT_NONE;
+    QSize m_poolSize;
+    int m_linesizes[4] = {};
+    int m_planeOffsets[4] = {};
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGSWSFRAMECONVERTER_P_H
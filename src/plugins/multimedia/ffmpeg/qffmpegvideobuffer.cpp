@@ -22,8 +22,11 @@ static bool isFrameFlipped(const AVFrame& frame) {
 
 QT_BEGIN_NAMESPACE
 
-QFFmpegVideoBuffer::QFFmpegVideoBuffer(AVFrameUPtr frame)
-    : QAbstractVideoBuffer(QVideoFrame::NoHandle), frame(frame.get())
+QFFmpegVideoBuffer::QFFmpegVideoBuffer(AVFrameUPtr frame,
+                                       std::shared_ptr<QFFmpeg::SwsFrameConverter> converter)
+    : QAbstractVideoBuffer(QVideoFrame::NoHandle),
+      frame(frame.get()),
+      m_converter(std::move(converter))
 {
     if (frame->hw_frames_ctx) {
         hwFrame = std::move(frame);
@@ -45,23 +48,19 @@ void QFFmpegVideoBuffer::convertSWFrame()
     bool needsConversion = false;
     auto pixelFormat = toQtPixelFormat(AVPixelFormat(swFrame->format), &needsConversion);
     if (pixelFormat != m_pixelFormat || isFrameFlipped(*swFrame)) {
-        AVPixelFormat newFormat = toAVPixelFormat(m_pixelFormat);
-        // convert the format into something we can handle
-        SwsContext *c = sws_getContext(swFrame->width, swFrame->height, AVPixelFormat(swFrame->format),
-                                       swFrame->width, swFrame->height, newFormat,
-                                       SWS_BICUBIC, nullptr, nullptr, nullptr);
+        if (!m_converter)
+            m_converter = std::make_shared<QFFmpeg::SwsFrameConverter>();
 
-        auto newFrame = QFFmpeg::makeAVFrame();
-        newFrame->width = swFrame->width;
-        newFrame->height = swFrame->height;
-        newFrame->format = newFormat;
-        av_frame_get_buffer(newFrame.get(), 0);
+        // convert the format into something we can handle
+        auto newFrame = m_converter->convert(swFrame.get(), toAVPixelFormat(m_pixelFormat));
+        if (!newFrame) {
+            qWarning() << "Cannot convert the frame to" << m_pixelFormat;
+            return;
+        }
 
-        sws_scale(c, swFrame->data, swFrame->linesize, 0, swFrame->height, newFrame->data, newFrame->linesize);
         if (frame == swFrame.get())
             frame = newFrame.get();
         swFrame = std::move(newFrame);
-        sws_freeContext(c);
     }
 }
 
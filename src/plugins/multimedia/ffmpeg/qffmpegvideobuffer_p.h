@@ -22,6 +22,9 @@
 
 #include "qffmpeg_p.h"
 #include "qffmpeghwaccel_p.h"
+#include "qffmpegswsframeconverter_p.h"
+
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -30,7 +33,10 @@ class QFFmpegVideoBuffer : public QAbstractVideoBuffer
 public:
     using AVFrameUPtr = QFFmpeg::AVFrameUPtr;
 
-    QFFmpegVideoBuffer(AVFrameUPtr frame);
+    // Frames that need a pixel format conversion are converted with the given
+    // converter, which should be shared by all frames of a stream
+    QFFmpegVideoBuffer(AVFrameUPtr frame,
+                       std::shared_ptr<QFFmpeg::SwsFrameConverter> converter = {});
     ~QFFmpegVideoBuffer() override;
 
     QVideoFrame::MapMode mapMode() const override;
@@ -63,6 +69,7 @@ private:
     AVFrame *frame = nullptr;
     AVFrameUPtr hwFrame;
     AVFrameUPtr swFrame;
+    std::shared_ptr<QFFmpeg::SwsFrameConverter> m_converter;
     QFFmpeg::TextureConverter textureConverter;
     QVideoFrame::MapMode m_mode = QVideoFrame::NotMapped;
     std::unique_ptr<QFFmpeg::TextureSet> textures;
@@ -10,6 +10,10 @@
 #include "private/qmultimediautils_p.h"
 #include <qloggingcategory.h>
 
+extern "C" {
+#include <libavutil/opt.h>
+}
+
 QT_BEGIN_NAMESPACE
 
 static Q_LOGGING_CATEGORY(qLcVideoFrameEncoder, "qt.multimedia.ffmpeg.videoencoder")
@@ -22,6 +26,39 @@ VideoFrameEncoder::Data::~Data()
         sws_freeContext(converter);
 }
 
+static SwsContext *createConverter(const QSize &sourceSize, AVPixelFormat sourceFormat,
+                                   const QSize &targetSize, AVPixelFormat targetFormat,
+                                   int threadCount)
+{
+#if QT_FFMPEG_HAS_SWS_THREADS
+    SwsContext *converter = sws_alloc_context();
+    if (!converter)
+        return nullptr;
+
+    av_opt_set_int(converter, "srcw", sourceSize.width(), 0);
+    av_opt_set_int(converter, "srch", sourceSize.height(), 0);
+    av_opt_set_int(converter, "src_format", sourceFormat, 0);
+    av_opt_set_int(converter, "dstw", targetSize.width(), 0);
+    av_opt_set_int(converter, "dsth", targetSize.height(), 0);
+    av_opt_set_int(converter, "dst_format", targetFormat, 0);
+    av_opt_set_int(converter, "sws_flags", SWS_FAST_BILINEAR, 0);
+    // swscale converts horizontal slices of the frame in parallel; 0 is automatic
+    av_opt_set_int(converter, "threads", threadCount, 0);
+
+    if (sws_init_context(converter, nullptr, nullptr) < 0) {
+        sws_freeContext(converter);
+        return nullptr;
+    }
+
+    return converter;
+#else
+    Q_UNUSED(threadCount);
+    return sws_getContext(sourceSize.width(), sourceSize.height(), sourceFormat,
+                          targetSize.width(), targetSize.height(), targetFormat,
+                          SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+#endif
+}
+
 VideoFrameEncoder::VideoFrameEncoder(const QMediaEncoderSettings &encoderSettings,
                                      const QSize &sourceSize, float frameRate,
                                      AVPixelFormat sourceFormat, AVPixelFormat sourceSWFormat)
@@ -105,10 +142,15 @@ VideoFrameEncoder::VideoFrameEncoder(const QMediaEncoderSettings &encoderSetting
                 << "camera and encoder use different formats:" << d->sourceSWFormat
                 << d->targetSWFormat << "or sizes:" << d->sourceSize << targetSize;
 
-        d->converter =
-                sws_getContext(d->sourceSize.width(), d->sourceSize.height(), d->sourceSWFormat,
-                               targetSize.width(), targetSize.height(), d->targetSWFormat,
-                               SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+        const int threadCount = qMax(d->settings.encodingThreadCount(), 0);
+        d->converter = createConverter(d->sourceSize, d->sourceSWFormat, targetSize,
+                                       d->targetSWFormat, threadCount);
+        if (!d->converter) {
+            qWarning() << "Cannot create a converter from" << d->sourceSWFormat << "to"
+                       << d->targetSWFormat;
+            d = {};
+            return;
+        }
     }
 
     qCDebug(qLcVideoFrameEncoder) << "VideoFrameEncoder conversions initialized:"
@@ -223,16 +265,24 @@ const AVRational &VideoFrameEncoder::getTimeBase() const
     return d->stream->time_base;
 }
 
+bool VideoFrameEncoder::needsConversion() const
+{
+    return d && (d->downloadFromHW || d->converter || d->uploadToHW);
+}
+
 int VideoFrameEncoder::sendFrame(AVFrameUPtr frame)
 {
-    if (!d->codecContext) {
-        qWarning() << "codec context is not initialized!";
-        return AVERROR(EINVAL);
+    if (frame) {
+        const int err = convertFrame(frame);
+        if (err < 0)
+            return err;
     }
 
-    if (!frame)
-        return avcodec_send_frame(d->codecContext.get(), frame.get());
+    return sendConvertedFrame(std::move(frame));
+}
 
+int VideoFrameEncoder::convertFrame(AVFrameUPtr &frame)
+{
     int64_t pts = 0;
     AVRational timeBase = {};
     getAVFrameTime(*frame, pts, timeBase);
@@ -256,12 +306,21 @@ int VideoFrameEncoder::sendFrame(AVFrameUPtr frame)
         f->width = d->settings.videoResolution().width();
         f->height = d->settings.videoResolution().height();
 
+#if QT_FFMPEG_HAS_SWS_THREADS
+        // Unlike sws_scale, it uses the slice threads of the converter
+        const int err = sws_scale_frame(d->converter, f.get(), frame.get());
+        if (err < 0) {
+            qCWarning(qLcVideoFrameEncoder) << "Error scaling the frame" << err2str(err);
+            return err;
+        }
+#else
         av_frame_get_buffer(f.get(), 0);
         const auto scaledHeight = sws_scale(d->converter, frame->data, frame->linesize, 0,
                                             frame->height, f->data, f->linesize);
 
         if (scaledHeight != f->height)
             qCWarning(qLcVideoFrameEncoder) << "Scaled height" << scaledHeight << "!=" << f->height;
+#endif
 
         frame = std::move(f);
     }
@@ -292,21 +351,35 @@ int VideoFrameEncoder::sendFrame(AVFrameUPtr frame)
         frame = std::move(f);
     }
 
-    qCDebug(qLcVideoFrameEncoder) << "sending frame" << pts << "*" << timeBase.num << "/"
-                                  << timeBase.den;
-
     setAVFrameTime(*frame, pts, timeBase);
+    return 0;
+}
+
+int VideoFrameEncoder::sendConvertedFrame(AVFrameUPtr frame)
+{
+    if (!d->codecContext) {
+        qWarning() << "codec context is not initialized!";
+        return AVERROR(EINVAL);
+    }
+
+    if (frame) {
+        int64_t pts = 0;
+        AVRational timeBase = {};
+        getAVFrameTime(*frame, pts, timeBase);
+        qCDebug(qLcVideoFrameEncoder) << "sending frame" << pts << "*" << timeBase.num << "/"
+                                      << timeBase.den;
+    }
+
     return avcodec_send_frame(d->codecContext.get(), frame.get());
 }
 
-AVPacket *VideoFrameEncoder::retrievePacket()
+AVPacketUPtr VideoFrameEncoder::retrievePacket()
 {
     if (!d || !d->codecContext)
         return nullptr;
-    AVPacket *packet = av_packet_alloc();
-    int ret = avcodec_receive_packet(d->codecContext.get(), packet);
+    AVPacketUPtr packet(av_packet_alloc());
+    int ret = avcodec_receive_packet(d->codecContext.get(), packet.get());
     if (ret < 0) {
-        av_packet_free(&packet);
         if (ret != AVERROR(EOF) && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
             qCDebug(qLcVideoFrameEncoder) << "Error receiving packet" << ret << err2str(ret);
         return nullptr;
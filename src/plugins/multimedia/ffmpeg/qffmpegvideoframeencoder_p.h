@@ -65,8 +65,17 @@ public:
 
     const AVRational &getTimeBase() const;
 
+    // True if frames need a download, scaling, conversion or upload before encoding
+    bool needsConversion() const;
+
+    // Converts the frame to the format and size of the codec. It doesn't touch the codec,
+    // so it may run on another thread than sendConvertedFrame() and retrievePacket().
+    int convertFrame(AVFrameUPtr &frame);
+    int sendConvertedFrame(AVFrameUPtr frame);
+
+    // Converts and sends the frame; a null frame flushes the codec
     int sendFrame(AVFrameUPtr frame);
-    AVPacket *retrievePacket();
+    AVPacketUPtr retrievePacket();
 };
 
 
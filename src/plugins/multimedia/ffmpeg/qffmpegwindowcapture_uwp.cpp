@@ -140,6 +140,7 @@ public:
         setFrameRate(maxFrameRate);
         addFrameCallback(capture, &QFFmpegWindowCaptureUwp::newVideoFrame);
         connect(this, &Grabber::errorUpdated, &capture, &QFFmpegWindowCaptureUwp::updateError);
+        connect(this, &Grabber::statisticsUpdated, &capture, &QFFmpegWindowCaptureUwp::updateStatistics);
     }
 
     ~Grabber() override { stop(); }
@@ -96,6 +96,7 @@ private:
         connect(qApp, &QGuiApplication::screenRemoved, this, &Grabber::onScreenRemoved);
         addFrameCallback(m_capture, &QGrabWindowSurfaceCapture::newVideoFrame);
         connect(this, &Grabber::errorUpdated, &m_capture, &QGrabWindowSurfaceCapture::updateError);
+        connect(this, &Grabber::statisticsUpdated, &m_capture, &QGrabWindowSurfaceCapture::updateStatistics);
     }
 
     void onScreenRemoved(QScreen *screen)
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "qv4l2camera_p.h"
+#include "qffmpegmjpegdecoder_p.h"
 
 #include <qdir.h>
 #include <qmutex.h>
@@ -19,15 +20,55 @@
 #include <fcntl.h>
 #include <private/qcore_unix_p.h>
 #include <sys/mman.h>
+#include <poll.h>
 
 #include <linux/videodev2.h>
 
+#ifdef QT_V4L2_CAMERA_DMABUF_IMPORT
+#include <rhi/qrhi.h>
+#include <qguiapplication.h>
+#include <qopenglcontext.h>
+#include <qopenglfunctions.h>
+#include <qpa/qplatformnativeinterface.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 #include <qloggingcategory.h>
 
 QT_BEGIN_NAMESPACE
 
 static Q_LOGGING_CATEGORY(qLV4L2Camera, "qt.multimedia.ffmpeg.v4l2camera");
 
+static constexpr int DefaultBufferCount = 4;
+static constexpr int MaxBufferCount = 32;
+
+// VIDIOC_DQBUF fails with EIO on temporary problems like a signal loss. We retry with
+// a growing delay, and give up after MaxIoErrors errors in a row.
+static constexpr int MaxIoErrors = 10;
+static constexpr int MaxIoErrorDelayMs = 500;
+
+// The environment variable overrides QCamera::frameBufferCount
+static int requestedBufferCount(int frameBufferCount)
+{
+    bool ok = false;
+    const int count = qEnvironmentVariableIntValue("QT_V4L2_CAMERA_BUFFER_COUNT", &ok);
+    if (ok)
+        return qBound(2, count, MaxBufferCount);
+    return frameBufferCount > 0 ? qBound(2, frameBufferCount, MaxBufferCount)
+                                : DefaultBufferCount;
+}
+
+// Decode JPEG frames by default, so that the consumers get YUV frames
+static bool isMJpegDecodingEnabled()
+{
+    static const bool enabled =
+            qEnvironmentVariableIntValue("QT_V4L2_CAMERA_DECODE_MJPEG") != 0
+            || !qEnvironmentVariableIsSet("QT_V4L2_CAMERA_DECODE_MJPEG");
+    return enabled && QFFmpeg::MJpegDecoder::isAvailable();
+}
+
 static bool areCamerasEqual(QList<QCameraDevice> a, QList<QCameraDevice> b) {
     auto areCamerasDataEqual = [](const QCameraDevice& a, const QCameraDevice& b) {
         Q_ASSERT(QCameraDevicePrivate::handle(a));
@@ -215,34 +256,174 @@ bool QV4L2CameraDevices::doCheckCameras()
     return true;
 }
 
-class QV4L2VideoBuffer : public QAbstractVideoBuffer
+QV4L2VideoBuffer::QV4L2VideoBuffer(QV4L2CameraBuffers *d, int index)
+    : QAbstractVideoBuffer(QVideoFrame::NoHandle, nullptr), index(index), d(d)
+{
+}
+
+QV4L2VideoBuffer::~QV4L2VideoBuffer()
+{
+    d->release(index);
+}
+
+QAbstractVideoBuffer::MapData QV4L2VideoBuffer::map(QVideoFrame::MapMode mode)
+{
+    m_mode = mode;
+    return d->v4l2FileDescriptor >= 0 ? data : MapData{};
+}
+
+#ifdef QT_V4L2_CAMERA_DMABUF_IMPORT
+
+#define fourcc_code(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | \
+                                 ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+static quint32 drmFourccForTextureFormat(QRhiTexture::Format format)
+{
+    switch (format) {
+    case QRhiTexture::RGBA8:
+        return fourcc_code('A', 'B', '2', '4'); // DRM_FORMAT_ABGR8888
+    case QRhiTexture::BGRA8:
+        return fourcc_code('A', 'R', '2', '4'); // DRM_FORMAT_ARGB8888
+    case QRhiTexture::R8:
+        return fourcc_code('R', '8', ' ', ' '); // DRM_FORMAT_R8
+    case QRhiTexture::RG8:
+        return fourcc_code('G', 'R', '8', '8'); // DRM_FORMAT_GR88
+    case QRhiTexture::R16:
+        return fourcc_code('R', '1', '6', ' '); // DRM_FORMAT_R16
+    case QRhiTexture::RG16:
+        return fourcc_code('G', 'R', '3', '2'); // DRM_FORMAT_GR1616
+    default:
+        return 0;
+    }
+}
+
+#undef fourcc_code
+
+namespace {
+
+struct EglImport
+{
+    EGLDisplay display = nullptr;
+    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC imageTargetTexture2D = nullptr;
+};
+
+const EglImport &eglImport()
+{
+    static const EglImport import = []() {
+        EglImport result;
+        if (auto *nativeInterface = QGuiApplication::platformNativeInterface())
+            result.display = nativeInterface->nativeResourceForIntegration("egldisplay");
+        if (result.display)
+            result.imageTargetTexture2D = reinterpret_cast<PFNGLEGLIMAGETARGETTEXTURE2DOESPROC>(
+                    eglGetProcAddress("glEGLImageTargetTexture2DOES"));
+        qCDebug(qLV4L2Camera) << "EGL display for DMA-BUF import:" << result.display;
+        return result;
+    }();
+    return import;
+}
+
+class QV4L2DmaBufTextures : public QVideoFrameTextures
 {
 public:
-    QV4L2VideoBuffer(QV4L2CameraBuffers *d, int index)
-        : QAbstractVideoBuffer(QVideoFrame::NoHandle, nullptr)
-        , index(index)
-        , d(d)
-    {}
-    ~QV4L2VideoBuffer()
+    QV4L2DmaBufTextures(QRhi *rhi, QSize size, QRhiTexture::Format format, GLuint glTexture)
+        : m_rhi(rhi), m_glTexture(glTexture)
     {
-        d->release(index);
+        m_texture.reset(rhi->newTexture(format, size, 1, {}));
+        m_texture->createFrom({ glTexture, 0 });
     }
 
-    QVideoFrame::MapMode mapMode() const override { return m_mode; }
-    MapData map(QVideoFrame::MapMode mode) override {
-        m_mode = mode;
-        return d->v4l2FileDescriptor >= 0 ? data : MapData{};
+    ~QV4L2DmaBufTextures() override
+    {
+        m_texture.reset();
+        m_rhi->makeThreadLocalNativeContextCurrent();
+        if (auto *context = QOpenGLContext::currentContext())
+            context->functions()->glDeleteTextures(1, &m_glTexture);
     }
-    void unmap() override {
-        m_mode = QVideoFrame::NotMapped;
+
+    QRhiTexture *texture(uint plane) const override
+    {
+        return plane == 0 ? m_texture.get() : nullptr;
     }
 
-    QVideoFrame::MapMode m_mode = QVideoFrame::NotMapped;
-    MapData data;
-    int index = 0;
-    QExplicitlySharedDataPointer<QV4L2CameraBuffers> d;
+private:
+    QRhi *m_rhi = nullptr;
+    GLuint m_glTexture = 0;
+    std::unique_ptr<QRhiTexture> m_texture;
 };
 
+} // namespace
+
+#endif
+
+// Imports the exported DMA-BUF of the V4L2 buffer as a GL texture, so that the frame
+// doesn't get copied on its way to the GPU. Returns nothing if the buffer can't be
+// imported, and the frame is uploaded from the mapped memory instead.
+std::unique_ptr<QVideoFrameTextures> QV4L2VideoBuffer::mapTextures(QRhi *rhi)
+{
+#ifdef QT_V4L2_CAMERA_DMABUF_IMPORT
+    if (!rhi || rhi->backend() != QRhi::OpenGLES2 || d->dmaBufImportFailed.loadRelaxed()
+        || pixelFormat == QVideoFrameFormat::Format_Jpeg)
+        return {};
+
+    // Planar formats would need an image per plane; only packed formats are imported
+    const auto *desc = QVideoTextureHelper::textureDescription(pixelFormat);
+    if (!desc || desc->nplanes != 1)
+        return {};
+    const quint32 fourcc = drmFourccForTextureFormat(desc->textureFormat[0]);
+    if (!fourcc)
+        return {};
+
+    const EglImport &egl = eglImport();
+    if (!egl.display || !egl.imageTargetTexture2D)
+        return {};
+
+    QMutexLocker locker(&d->mutex);
+    if (d->v4l2FileDescriptor < 0 || index >= d->mappedBuffers.size())
+        return {};
+    const int fd = d->mappedBuffers.at(index).dmaBufFileDescriptor;
+    if (fd < 0)
+        return {};
+
+    rhi->makeThreadLocalNativeContextCurrent();
+    auto *context = QOpenGLContext::currentContext();
+    if (!context)
+        return {};
+
+    const QSize planeSize(desc->widthForPlane(size.width(), 0),
+                          desc->heightForPlane(size.height(), 0));
+    const EGLAttrib attributes[] = {
+        EGL_LINUX_DRM_FOURCC_EXT,      EGLAttrib(fourcc),
+        EGL_WIDTH,                     planeSize.width(),
+        EGL_HEIGHT,                    planeSize.height(),
+        EGL_DMA_BUF_PLANE0_FD_EXT,     fd,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT, 0,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT,  data.bytesPerLine[0],
+        EGL_NONE
+    };
+    EGLImage image = eglCreateImage(egl.display, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr,
+                                    attributes);
+    if (image == EGL_NO_IMAGE_KHR) {
+        qCDebug(qLV4L2Camera) << "Can't import the camera buffer, uploading frames from memory"
+                              << Qt::hex << eglGetError();
+        d->dmaBufImportFailed.storeRelaxed(true);
+        return {};
+    }
+
+    QOpenGLFunctions *functions = context->functions();
+    GLuint glTexture = 0;
+    functions->glGenTextures(1, &glTexture);
+    functions->glBindTexture(GL_TEXTURE_2D, glTexture);
+    egl.imageTargetTexture2D(GL_TEXTURE_2D, image);
+    functions->glBindTexture(GL_TEXTURE_2D, 0);
+    eglDestroyImage(egl.display, image);
+
+    return std::make_unique<QV4L2DmaBufTextures>(rhi, planeSize, desc->textureFormat[0], glTexture);
+#else
+    Q_UNUSED(rhi);
+    return {};
+#endif
+}
+
 QV4L2CameraBuffers::~QV4L2CameraBuffers()
 {
     QMutexLocker locker(&mutex);
@@ -270,9 +451,13 @@ void QV4L2CameraBuffers::release(int index)
 
 void QV4L2CameraBuffers::unmapBuffers()
 {
-    for (const auto &b : std::as_const(mappedBuffers))
+    for (const auto &b : std::as_const(mappedBuffers)) {
         munmap(b.data, b.size);
+        if (b.dmaBufFileDescriptor >= 0)
+            qt_safe_close(b.dmaBufFileDescriptor);
+    }
     mappedBuffers.clear();
+    dmaBufImportFailed.storeRelaxed(false);
 }
 
 QV4L2Camera::QV4L2Camera(QCamera *camera)
@@ -575,11 +760,27 @@ void QV4L2Camera::setColorTemperature(int temperature)
         colorTemperatureChanged(t);
 }
 
-void QV4L2Camera::readFrame()
+void QV4L2Camera::captureLoop()
 {
-    if (!d)
-        return;
+    pollfd fds[2] = { { d->v4l2FileDescriptor, POLLIN, 0 }, { m_wakeUpPipe[0], POLLIN, 0 } };
+
+    for (;;) {
+        if (qt_safe_poll(fds, 2, nullptr) < 0) {
+            qWarning() << "Polling the camera failed" << qt_error_string(errno);
+            return;
+        }
+
+        if (fds[1].revents)
+            return;
 
+        if (fds[0].revents && !readFrame())
+            return;
+    }
+}
+
+// Runs on the capture thread. Returns false if capturing can't continue.
+bool QV4L2Camera::readFrame()
+{
     v4l2_buffer buf = {};
     buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     buf.memory = V4L2_MEMORY_MMAP;
@@ -587,17 +788,43 @@ void QV4L2Camera::readFrame()
     if (ioctl(d->v4l2FileDescriptor, VIDIOC_DQBUF, &buf) < 0) {
         if (errno == ENODEV) {
             // camera got removed while being active
-            stopCapturing();
-            closeV4L2Fd();
-            return;
+            QMetaObject::invokeMethod(this, [this]() {
+                stopCapturing();
+                closeV4L2Fd();
+            });
+            return false;
+        }
+        const int error = errno;
+        if (error == EAGAIN)
+            return true;
+
+        if (error == EIO && ++m_ioErrors < MaxIoErrors) {
+            if (m_ioErrors == 1)
+                qWarning() << "error calling VIDIOC_DQBUF" << error << strerror(error);
+            return waitBeforeRetry(qMin(10 << m_ioErrors, MaxIoErrorDelayMs));
         }
-        if (errno != EAGAIN)
-            qWarning() << "error calling VIDIOC_DQBUF" << errno << strerror(errno);
+
+        qWarning() << "error calling VIDIOC_DQBUF" << error << strerror(error);
+        QMetaObject::invokeMethod(this, [this, error]() {
+            this->error(QCamera::CameraError,
+                        tr("Cannot capture a frame from the camera: %1")
+                                .arg(qt_error_string(error)));
+            setActive(false);
+        });
+        return false;
     }
+    m_ioErrors = 0;
 
     Q_ASSERT(qsizetype(buf.index) < d->mappedBuffers.size());
     int i = buf.index;
 
+    if (m_lastSequence && buf.sequence > *m_lastSequence + 1) {
+        const quint32 dropped = buf.sequence - *m_lastSequence - 1;
+        qCDebug(qLV4L2Camera) << "the driver dropped" << dropped << "frames";
+        framesDropped(dropped);
+    }
+    m_lastSequence = buf.sequence;
+
 //    auto textureDesc = QVideoTextureHelper::textureDescription(m_format.pixelFormat());
 
     QV4L2VideoBuffer *buffer = new QV4L2VideoBuffer(d.get(), i);
@@ -605,6 +832,11 @@ void QV4L2Camera::readFrame()
     buffer->data.bytesPerLine[0] = bytesPerLine;
     buffer->data.data[0] = (uchar *)d->mappedBuffers.at(i).data;
     buffer->data.size[0] = d->mappedBuffers.at(i).size;
+    // Compressed frames are smaller than the buffer
+    if (m_cameraFormat.pixelFormat() == QVideoFrameFormat::Format_Jpeg && buf.bytesused)
+        buffer->data.size[0] = buf.bytesused;
+    buffer->pixelFormat = m_cameraFormat.pixelFormat();
+    buffer->size = m_cameraFormat.resolution();
     QVideoFrameFormat fmt(m_cameraFormat.resolution(), m_cameraFormat.pixelFormat());
     fmt.setColorSpace(colorSpace);
 //    qCDebug(qLV4L2Camera) << "got a frame" << d->mappedBuffers.at(i).data << d->mappedBuffers.at(i).size << fmt << i;
@@ -617,7 +849,31 @@ void QV4L2Camera::readFrame()
     frame.setStartTime(secs*1000000 + usecs);
     frame.setEndTime(frame.startTime() + frameDuration);
 
-    emit newVideoFrame(frame);
+    if (m_mjpegDecoder)
+        m_mjpegDecoder->decode(std::move(frame));
+    else
+        emit newVideoFrame(frame);
+
+    return true;
+}
+
+void QV4L2Camera::framesDropped(quint64 count)
+{
+    const quint64 total = m_droppedFrames.fetchAndAddRelaxed(count) + count;
+    QMetaObject::invokeMethod(this, [this, session = m_captureSession, total]() {
+        // Ignore reports from a previous capture session. Reports from different threads
+        // may arrive out of order, so the count only grows.
+        if (session == m_captureSession && qint64(total) > droppedFrames())
+            droppedFramesChanged(total);
+    });
+}
+
+// Runs on the capture thread. Returns false if the camera is being stopped meanwhile.
+bool QV4L2Camera::waitBeforeRetry(int ms)
+{
+    pollfd fd = { m_wakeUpPipe[0], POLLIN, 0 };
+    const timespec timeout = { ms / 1000, (ms % 1000) * 1000000 };
+    return qt_safe_poll(&fd, 1, &timeout) == 0;
 }
 
 void QV4L2Camera::setCameraBusy()
@@ -820,6 +1076,11 @@ void QV4L2Camera::setV4L2CameraFormat()
 
     bytesPerLine = fmt.fmt.pix.bytesperline;
 
+    const bool decodeMJpeg = m_cameraFormat.pixelFormat() == QVideoFrameFormat::Format_Jpeg
+            && isMJpegDecodingEnabled();
+    m_framePixelFormat =
+            decodeMJpeg ? QVideoFrameFormat::Format_YUV422P : QVideoFrameFormat::Format_Invalid;
+
     switch (v4l2_colorspace(fmt.fmt.pix.colorspace)) {
     default:
     case V4L2_COLORSPACE_DCI_P3:
@@ -858,7 +1119,7 @@ void QV4L2Camera::initMMap()
         return;
 
     v4l2_requestbuffers req = {};
-    req.count = 4;
+    req.count = requestedBufferCount(frameBufferCount());
     req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     req.memory = V4L2_MEMORY_MMAP;
 
@@ -895,9 +1156,22 @@ void QV4L2Camera::initMMap()
             return;
         }
 
+        // The exported buffer lets the renderer import frames without copying them;
+        // without it, frames are uploaded from the mapped memory
+        v4l2_exportbuffer expbuf = {};
+        expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        expbuf.index = n;
+        expbuf.flags = O_RDONLY | O_CLOEXEC;
+        if (ioctl(d->v4l2FileDescriptor, VIDIOC_EXPBUF, &expbuf) == 0)
+            buffer.dmaBufFileDescriptor = expbuf.fd;
+        else
+            qCDebug(qLV4L2Camera) << "Can't export buffer" << n << strerror(errno);
+
         d->mappedBuffers.append(buffer);
     }
 
+    qCDebug(qLV4L2Camera) << "mapped" << req.count << "buffers";
+
 }
 
 void QV4L2Camera::stopCapturing()
@@ -905,8 +1179,18 @@ void QV4L2Camera::stopCapturing()
     if (!d)
         return;
 
-    delete notifier;
-    notifier = nullptr;
+    if (m_captureThread) {
+        qt_safe_write(m_wakeUpPipe[1], "", 1);
+        m_captureThread->wait();
+        m_captureThread.reset();
+
+        qt_safe_close(m_wakeUpPipe[0]);
+        qt_safe_close(m_wakeUpPipe[1]);
+        m_wakeUpPipe[0] = m_wakeUpPipe[1] = -1;
+    }
+
+    // Waits for the frames being decoded
+    m_mjpegDecoder.reset();
 
     enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
@@ -940,10 +1224,29 @@ void QV4L2Camera::startCapturing()
     if (ioctl(d->v4l2FileDescriptor, VIDIOC_STREAMON, &type) < 0)
         qWarning() << "failed to start capture";
 
-    notifier = new QSocketNotifier(d->v4l2FileDescriptor, QSocketNotifier::Read);
-    connect(notifier, &QSocketNotifier::activated, this, &QV4L2Camera::readFrame);
-
     firstFrameTime = { -1, -1 };
+    m_lastSequence.reset();
+    ++m_captureSession;
+    m_droppedFrames.storeRelaxed(0);
+    droppedFramesChanged(0);
+    m_ioErrors = 0;
+
+    if (qt_safe_pipe(m_wakeUpPipe) < 0) {
+        qWarning() << "Cannot create a pipe for the capture thread" << qt_error_string(errno);
+        return;
+    }
+
+    if (m_cameraFormat.pixelFormat() == QVideoFrameFormat::Format_Jpeg
+        && m_framePixelFormat != QVideoFrameFormat::Format_Invalid) {
+        m_mjpegDecoder = std::make_unique<QFFmpeg::MJpegDecoder>(
+                [this](const QVideoFrame &frame) { emit newVideoFrame(frame); },
+                [this]() { framesDropped(1); },
+                QFFmpeg::MJpegDecoder::threadCountFor(decodingThreadCount()));
+    }
+
+    m_captureThread.reset(QThread::create([this]() { captureLoop(); }));
+    m_captureThread->setObjectName(QLatin1String("QV4L2CameraCapture"));
+    m_captureThread->start(QThread::HighPriority);
 }
 
 QT_END_NAMESPACE
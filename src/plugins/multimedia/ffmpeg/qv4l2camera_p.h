@@ -18,13 +18,21 @@
 #include <private/qplatformcamera_p.h>
 #include <private/qplatformvideodevices_p.h>
 #include <private/qplatformmediaintegration_p.h>
+#include <private/qabstractvideobuffer_p.h>
 
 #include <qfilesystemwatcher.h>
-#include <qsocketnotifier.h>
 #include <qmutex.h>
+#include <qthread.h>
+
+#include <memory>
+#include <optional>
 
 QT_BEGIN_NAMESPACE
 
+namespace QFFmpeg {
+class MJpegDecoder;
+}
+
 class QV4L2CameraDevices : public QPlatformVideoDevices
 {
     Q_OBJECT
@@ -57,9 +65,33 @@ public:
     struct MappedBuffer {
         void *data;
         qsizetype size;
+        // Exported with VIDIOC_EXPBUF, -1 if the driver can't export buffers
+        int dmaBufFileDescriptor = -1;
     };
     QList<MappedBuffer> mappedBuffers;
     int v4l2FileDescriptor = -1;
+    // Set after the first failed import, the frames are then uploaded from memory
+    QAtomicInteger<bool> dmaBufImportFailed = false;
+};
+
+class QV4L2VideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    QV4L2VideoBuffer(QV4L2CameraBuffers *d, int index);
+    ~QV4L2VideoBuffer() override;
+
+    QVideoFrame::MapMode mapMode() const override { return m_mode; }
+    MapData map(QVideoFrame::MapMode mode) override;
+    void unmap() override { m_mode = QVideoFrame::NotMapped; }
+
+    std::unique_ptr<QVideoFrameTextures> mapTextures(QRhi *rhi) override;
+
+    QVideoFrame::MapMode m_mode = QVideoFrame::NotMapped;
+    MapData data;
+    QVideoFrameFormat::PixelFormat pixelFormat = QVideoFrameFormat::Format_Invalid;
+    QSize size;
+    int index = 0;
+    QExplicitlySharedDataPointer<QV4L2CameraBuffers> d;
 };
 
 class Q_MULTIMEDIA_EXPORT QV4L2Camera : public QPlatformCamera
@@ -105,11 +137,14 @@ public:
 
     void releaseBuffer(int index);
 
-private Q_SLOTS:
-    void readFrame();
-
 private:
     void setCameraBusy();
+    // Called by the capture thread and the MJPEG decoder
+    void framesDropped(quint64 count);
+
+    void captureLoop();
+    bool readFrame();
+    bool waitBeforeRetry(int ms);
 
     bool m_active = false;
 
@@ -126,7 +161,12 @@ private:
     void startCapturing();
     void stopCapturing();
 
-    QSocketNotifier *notifier = nullptr;
+    // Dequeues the frames, so that stalls of the camera's thread don't make us lose any
+    std::unique_ptr<QThread> m_captureThread;
+    // Set up if the camera delivers JPEG frames and decoding isn't disabled
+    std::unique_ptr<QFFmpeg::MJpegDecoder> m_mjpegDecoder;
+    // Wakes up the capture thread to stop it
+    int m_wakeUpPipe[2] = { -1, -1 };
     QExplicitlySharedDataPointer<QV4L2CameraBuffers> d;
 
     bool v4l2AutoWhiteBalanceSupported = false;
@@ -151,6 +191,12 @@ private:
     QVideoFrameFormat::ColorSpace colorSpace = QVideoFrameFormat::ColorSpace_Undefined;
     qint64 frameDuration = -1;
     bool cameraBusy = false;
+    // Only used by the capture thread while it runs
+    std::optional<quint32> m_lastSequence;
+    int m_ioErrors = 0;
+    QAtomicInteger<quint64> m_droppedFrames = 0;
+    // Changed only while the capture thread doesn't run
+    quint32 m_captureSession = 0;
 };
 
 QT_END_NAMESPACE
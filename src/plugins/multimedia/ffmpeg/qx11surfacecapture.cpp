@@ -3,6 +3,7 @@
 
 #include "qx11surfacecapture_p.h"
 #include "qffmpegsurfacecapturethread_p.h"
+#include "qffmpegrecyclingpool_p.h"
 
 #include <qvideoframe.h>
 #include <qscreen.h>
@@ -13,14 +14,20 @@
 
 #include "private/qabstractvideobuffer_p.h"
 #include "private/qcapturablewindow_p.h"
+#include "private/qtmultimediaglobal_p.h"
 
 #include <X11/Xlib.h>
 #include <sys/shm.h>
 #include <X11/extensions/XShm.h>
 #include <X11/Xutil.h>
 #include <X11/extensions/Xrandr.h>
+#if QT_CONFIG(xdamage)
+#include <X11/extensions/Xdamage.h>
+#endif
 
+#include <mutex>
 #include <optional>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 
@@ -79,6 +86,158 @@ QVideoFrameFormat::PixelFormat xImagePixelFormat(const XImage &image)
     return QVideoFrameFormat::Format_Invalid;
 }
 
+// The number of images that can be in use by video frames at the same time. If the
+// consumers hold more frames, the grabber copies the image as a fallback.
+constexpr int MaxPooledImages = 4;
+
+struct ShmImage
+{
+    ~ShmImage()
+    {
+        if (shmInfo.shmaddr)
+            shmdt(shmInfo.shmaddr);
+    }
+
+    std::unique_ptr<XImage, decltype(&destroyXImage)> xImage{ nullptr, &destroyXImage };
+    XShmSegmentInfo shmInfo = {};
+    bool attached = false;
+};
+
+using ShmImagePtr = std::unique_ptr<ShmImage>;
+
+// Owns the shared memory images of a grabber, including the ones that are handed out as
+// video frames. The frames give their images back on destruction, from any thread; all
+// calls to X are done from the grabber thread. The bookkeeping is in RecyclingPool.
+class ShmImagePool
+{
+public:
+    explicit ShmImagePool(Display *display) : m_display(display) { }
+
+    ShmImagePtr create(Visual *visual, int depth, const QSize &size) const
+    {
+        auto result = std::make_unique<ShmImage>();
+        result->xImage.reset(XShmCreateImage(m_display, visual, depth, ZPixmap, nullptr,
+                                             &result->shmInfo, size.width(), size.height()));
+        if (!result->xImage)
+            return {};
+
+        XImage &xImage = *result->xImage;
+        result->shmInfo.shmid =
+                shmget(IPC_PRIVATE, xImage.bytes_per_line * xImage.height, IPC_CREAT | 0600);
+        if (result->shmInfo.shmid == -1)
+            return {};
+
+        auto address = shmat(result->shmInfo.shmid, nullptr, 0);
+        if (address == reinterpret_cast<void *>(-1)) {
+            shmctl(result->shmInfo.shmid, IPC_RMID, nullptr);
+            return {};
+        }
+
+        result->shmInfo.shmaddr = xImage.data = static_cast<char *>(address);
+        result->shmInfo.readOnly = false;
+        result->attached = XShmAttach(m_display, &result->shmInfo);
+        XSync(m_display, false);
+
+        // The segment is removed as soon as both we and the X server have detached it
+        shmctl(result->shmInfo.shmid, IPC_RMID, nullptr);
+
+        return result->attached ? std::move(result) : nullptr;
+    }
+
+    // Sets the format of the images to hand out, and forgets the images of the old one
+    void reset(Visual *visual, int depth, const QSize &size)
+    {
+        m_visual = visual;
+        m_depth = depth;
+        m_size = size;
+        // Images still in use belong to the old generation, and are retired on release
+        detachAll(m_pool.reset());
+        detachAll(m_pool.takeRetired());
+    }
+
+    // Returns a free image, or nullptr if too many images are in use
+    ShmImagePtr acquire()
+    {
+        detachAll(m_pool.takeRetired());
+        return m_pool.acquire([this]() { return create(m_visual, m_depth, m_size); });
+    }
+
+    // Called from any thread. Images of older generations are detached on the next
+    // acquire() or reset(); after close(), the server has detached them already.
+    void release(ShmImagePtr image, quint64 generation)
+    {
+        m_pool.release(std::move(image), generation);
+    }
+
+    quint64 generation() const { return m_pool.generation(); }
+
+    // Detaches all images from the server; the ones in use stay valid until released
+    void close() { detachAll(m_pool.close()); }
+
+    void detach(ShmImage &image) const
+    {
+        if (std::exchange(image.attached, false))
+            XShmDetach(m_display, &image.shmInfo);
+    }
+
+private:
+    void detachAll(const std::vector<ShmImagePtr> &images) const
+    {
+        for (auto &image : images)
+            detach(*image);
+    }
+
+    Display *const m_display;
+    // Only used on the grabber thread
+    Visual *m_visual = nullptr;
+    int m_depth = 0;
+    QSize m_size;
+
+    QFFmpeg::RecyclingPool<ShmImage> m_pool{ MaxPooledImages };
+};
+
+// Maps a pooled image without copying it, and returns the image to the pool when the
+// last video frame referencing it is gone
+class ShmVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    ShmVideoBuffer(std::shared_ptr<ShmImagePool> pool, ShmImagePtr image, quint64 generation)
+        : QAbstractVideoBuffer(QVideoFrame::NoHandle),
+          m_pool(std::move(pool)),
+          m_image(std::move(image)),
+          m_generation(generation)
+    {
+    }
+
+    ~ShmVideoBuffer() override { m_pool->release(std::move(m_image), m_generation); }
+
+    QVideoFrame::MapMode mapMode() const override { return m_mapMode; }
+
+    MapData map(QVideoFrame::MapMode mode) override
+    {
+        MapData mapData;
+        if (m_mapMode == QVideoFrame::NotMapped) {
+            m_mapMode = mode;
+
+            const XImage &xImage = *m_image->xImage;
+            mapData.nPlanes = 1;
+            mapData.bytesPerLine[0] = xImage.bytes_per_line;
+            mapData.data[0] = reinterpret_cast<uchar *>(xImage.data);
+            mapData.size[0] = xImage.bytes_per_line * xImage.height;
+        }
+
+        return mapData;
+    }
+
+    void unmap() override { m_mapMode = QVideoFrame::NotMapped; }
+
+private:
+    std::shared_ptr<ShmImagePool> m_pool;
+    ShmImagePtr m_image;
+    quint64 m_generation;
+    QVideoFrame::MapMode m_mapMode = QVideoFrame::NotMapped;
+};
+
 class DataVideoBuffer : public QAbstractVideoBuffer
 {
 public:
@@ -137,7 +296,16 @@ public:
     {
         stop();
 
-        detachShm();
+#if QT_CONFIG(xdamage)
+        if (m_damage)
+            XDamageDestroy(m_display.get(), m_damage);
+#endif
+
+        if (m_pool) {
+            m_pool->close();
+            if (m_xImage)
+                m_pool->detach(*m_xImage);
+        }
     }
 
     const QVideoFrameFormat &format() const { return m_format; }
@@ -147,6 +315,7 @@ private:
     {
         addFrameCallback(capture, &QX11SurfaceCapture::newVideoFrame);
         connect(this, &Grabber::errorUpdated, &capture, &QX11SurfaceCapture::updateError);
+        connect(this, &Grabber::statisticsUpdated, &capture, &QX11SurfaceCapture::updateStatistics);
     }
 
     bool createDisplay()
@@ -157,6 +326,8 @@ private:
         if (!m_display)
             updateError(QPlatformSurfaceCapture::InternalError,
                         QLatin1String("Cannot open X11 display"));
+        else if (!m_pool)
+            m_pool = std::make_shared<ShmImagePool>(m_display.get());
 
         return m_display != nullptr;
     }
@@ -194,6 +365,7 @@ private:
         m_xid = xid;
 
         if (update()) {
+            initDamage();
             start();
             return true;
         }
@@ -201,29 +373,41 @@ private:
         return false;
     }
 
-    void detachShm()
+    void initDamage()
     {
-        if (std::exchange(m_attached, false)) {
-            XShmDetach(m_display.get(), &m_shmInfo);
-            shmdt(m_shmInfo.shmaddr);
-            shmctl(m_shmInfo.shmid, IPC_RMID, 0);
+#if QT_CONFIG(xdamage)
+        int errorBase = 0;
+        if (!XDamageQueryExtension(m_display.get(), &m_damageEventBase, &errorBase)) {
+            qCDebug(qLcX11SurfaceCapture) << "XDamage is not available, grab every frame";
+            return;
         }
+
+        m_damage = XDamageCreate(m_display.get(), m_xid, XDamageReportNonEmpty);
+#endif
     }
 
-    void attachShm()
+    // Returns false if nothing has been drawn since the last call
+    bool checkDamage()
     {
-        Q_ASSERT(!m_attached);
-
-        m_shmInfo.shmid =
-                shmget(IPC_PRIVATE, m_xImage->bytes_per_line * m_xImage->height, IPC_CREAT | 0777);
+#if QT_CONFIG(xdamage)
+        if (!m_damage)
+            return true;
 
-        if (m_shmInfo.shmid == -1)
-            return;
+        while (XPending(m_display.get())) {
+            XEvent event;
+            XNextEvent(m_display.get(), &event);
+            if (event.type == m_damageEventBase + XDamageNotify)
+                m_damaged = true;
+        }
 
-        m_shmInfo.readOnly = false;
-        m_shmInfo.shmaddr = m_xImage->data = (char *)shmat(m_shmInfo.shmid, 0, 0);
+        if (!m_damaged)
+            return false;
 
-        m_attached = XShmAttach(m_display.get(), &m_shmInfo);
+        // Drawing between here and the grab causes one more grab, which is harmless
+        XDamageSubtract(m_display.get(), m_damage, None, None);
+        m_damaged = false;
+#endif
+        return true;
     }
 
     bool update()
@@ -242,48 +426,51 @@ private:
 
         // check window params for the root window as well since
         // it potentially can be changed (e.g. on VM with resizing)
-        if (!m_xImage || wndattr.width != m_xImage->width || wndattr.height != m_xImage->height
-            || wndattr.depth != m_xImage->depth || wndattr.visual->visualid != m_visualID) {
+        if (!m_xImage || wndattr.width != m_xImage->xImage->width
+            || wndattr.height != m_xImage->xImage->height
+            || wndattr.depth != m_xImage->xImage->depth
+            || wndattr.visual->visualid != m_visualID) {
 
             qCDebug(qLcX11SurfaceCapture) << "recreate ximage: " << wndattr.width << wndattr.height
                                           << wndattr.depth << wndattr.visual->visualid;
 
-            detachShm();
+            if (m_xImage)
+                m_pool->detach(*m_xImage);
             m_xImage.reset();
 
+            const QSize size(wndattr.width, wndattr.height);
             m_visualID = wndattr.visual->visualid;
-            m_xImage.reset(XShmCreateImage(m_display.get(), wndattr.visual, wndattr.depth, ZPixmap,
-                                           nullptr, &m_shmInfo, wndattr.width, wndattr.height));
+            m_pool->reset(wndattr.visual, wndattr.depth, size);
+
+            // The image to copy from if all pooled images are in use. It also
+            // tells us the pixel format and whether shared memory works at all.
+            m_xImage = m_pool->create(wndattr.visual, wndattr.depth, size);
 
             if (!m_xImage) {
                 updateError(QPlatformSurfaceCapture::CaptureFailed,
-                            QLatin1String("Cannot create image"));
+                            QLatin1String("Cannot create image with shared memory"));
                 return false;
             }
 
-            const auto pixelFormat = xImagePixelFormat(*m_xImage);
+            const auto pixelFormat = xImagePixelFormat(*m_xImage->xImage);
 
             // TODO: probably, add a converter instead
             if (pixelFormat == QVideoFrameFormat::Format_Invalid) {
                 updateError(QPlatformSurfaceCapture::CaptureFailed,
                             QLatin1String("Not handled pixel format, bpp=")
-                                    + QString::number(m_xImage->bits_per_pixel));
-                return false;
-            }
-
-            attachShm();
-
-            if (!m_attached) {
-                updateError(QPlatformSurfaceCapture::CaptureFailed,
-                            QLatin1String("Cannot attach shared memory"));
+                                    + QString::number(m_xImage->xImage->bits_per_pixel));
+                m_pool->detach(*m_xImage);
+                m_xImage.reset();
                 return false;
             }
 
-            m_format = QVideoFrameFormat(QSize(m_xImage->width, m_xImage->height), pixelFormat);
+            m_format = QVideoFrameFormat(size, pixelFormat);
             m_format.setFrameRate(frameRate());
+
+            m_damaged = true;
         }
 
-        return m_attached;
+        return true;
     }
 
 protected:
@@ -292,16 +479,29 @@ protected:
         if (!update())
             return {};
 
-        if (!XShmGetImage(m_display.get(), m_xid, m_xImage.get(), m_xOffset, m_yOffset,
-                          AllPlanes)) {
+        if (!checkDamage())
+            return {};
+
+        const auto generation = m_pool->generation();
+        auto image = m_pool->acquire();
+        XImage *target = image ? image->xImage.get() : m_xImage->xImage.get();
+
+        if (!XShmGetImage(m_display.get(), m_xid, target, m_xOffset, m_yOffset, AllPlanes)) {
+            if (image)
+                m_pool->release(std::move(image), generation);
+            m_damaged = true;
             updateError(QPlatformSurfaceCapture::CaptureFailed,
                         QLatin1String(
                                 "Cannot get ximage; the window may be out of the screen borders"));
             return {};
         }
 
-        auto buffer = new DataVideoBuffer(m_xImage->data, m_xImage->bytes_per_line,
-                                          m_xImage->bytes_per_line * m_xImage->height);
+        if (image)
+            return QVideoFrame(new ShmVideoBuffer(m_pool, std::move(image), generation), m_format);
+
+        qCDebug(qLcX11SurfaceCapture) << "all pooled images are in use, copy the frame";
+        auto buffer = new DataVideoBuffer(target->data, target->bytes_per_line,
+                                          target->bytes_per_line * target->height);
 
         return QVideoFrame(buffer, m_format);
     }
@@ -313,11 +513,16 @@ private:
     int m_xOffset = 0;
     int m_yOffset = 0;
     std::unique_ptr<Display, decltype(&XCloseDisplay)> m_display{ nullptr, &XCloseDisplay };
-    std::unique_ptr<XImage, decltype(&destroyXImage)> m_xImage{ nullptr, &destroyXImage };
-    XShmSegmentInfo m_shmInfo;
-    bool m_attached = false;
+    std::shared_ptr<ShmImagePool> m_pool;
+    ShmImagePtr m_xImage;
     VisualID m_visualID = None;
     QVideoFrameFormat m_format;
+    // Grab the first frame and the frames after failures regardless of the damage
+    bool m_damaged = true;
+#if QT_CONFIG(xdamage)
+    Damage m_damage = None;
+    int m_damageEventBase = 0;
+#endif
 };
 
 QX11SurfaceCapture::QX11SurfaceCapture(Source initialSource)
@@ -166,6 +166,12 @@ QMediaTimeRange QGstreamerMediaPlayer::availablePlaybackRanges() const
     return QMediaTimeRange();
 }
 
+qint64 QGstreamerMediaPlayer::droppedVideoFrames() const
+{
+    auto *sink = gstVideoOutput ? gstVideoOutput->gstreamerVideoSink() : nullptr;
+    return sink ? sink->droppedFrames() : 0;
+}
+
 qreal QGstreamerMediaPlayer::playbackRate() const
 {
     return playerPipeline.playbackRate();
@@ -54,6 +54,8 @@ public:
 
     QMediaTimeRange availablePlaybackRanges() const override;
 
+    qint64 droppedVideoFrames() const override;
+
     qreal playbackRate() const override;
     void setPlaybackRate(qreal rate) override;
 
@@ -103,6 +103,14 @@ void QGstreamerVideoSink::setRhi(QRhi *rhi)
     }
 }
 
+qint64 QGstreamerVideoSink::droppedFrames() const
+{
+    if (gstQtSink.isNull())
+        return 0;
+    auto *sink = reinterpret_cast<QGstVideoRendererSink *>(gstQtSink.element());
+    return sink->videoRenderer()->frameStatistics().dropped;
+}
+
 void QGstreamerVideoSink::createQtSink()
 {
     gstQtSink = QGstElement(reinterpret_cast<GstElement *>(QGstVideoRendererSink::createSink(this)));
@@ -48,6 +48,9 @@ public:
     void setPipeline(QGstPipeline pipeline);
     bool inStoppedState() const;
 
+    // Frames that the renderer dropped since it started, because newer ones replaced them
+    qint64 droppedFrames() const;
+
     GstContext *gstGlDisplayContext() const { return m_gstGlDisplayContext; }
     GstContext *gstGlLocalContext() const { return m_gstGlLocalContext; }
     Qt::HANDLE eglDisplay() const { return m_eglDisplay; }
@@ -38,6 +38,10 @@ static Q_LOGGING_CATEGORY(qLcGstVideoRenderer, "qt.multimedia.gstvideorenderer")
 
 QT_BEGIN_NAMESPACE
 
+// Enough to bridge a hiccup of the GUI thread without holding on to many buffers of the
+// upstream buffer pool, which might be small for hardware decoders
+static constexpr qsizetype MaxPendingBuffers = 2;
+
 QGstVideoRenderer::QGstVideoRenderer(QGstreamerVideoSink *sink)
     : m_sink(sink)
 {
@@ -46,6 +50,7 @@ QGstVideoRenderer::QGstVideoRenderer(QGstreamerVideoSink *sink)
 
 QGstVideoRenderer::~QGstVideoRenderer()
 {
+    clearPendingBuffers();
 }
 
 void QGstVideoRenderer::createSurfaceCaps()
@@ -124,6 +129,9 @@ bool QGstVideoRenderer::start(const QGstCaps& caps)
     m_frameMirrored = false;
     m_frameRotationAngle = QVideoFrame::Rotation0;
 
+    // Buffers of the previous caps must not be shown with the new format
+    clearPendingBuffers();
+
     if (m_active) {
         m_flush = true;
         m_stop = true;
@@ -157,10 +165,17 @@ void QGstVideoRenderer::stop()
     if (!m_active)
         return;
 
+    qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::stop, frames rendered:"
+                                 << m_frameStatistics.rendered
+                                 << "dropped:" << m_frameStatistics.dropped;
+    // The sink stops when the pipeline gets a new source
+    m_frameStatistics = {};
+
     m_flush = true;
     m_stop = true;
 
     m_startCaps = {};
+    clearPendingBuffers();
 
     waitForAsyncEvent(&locker, &m_setupCondition, 500);
 }
@@ -170,7 +185,6 @@ void QGstVideoRenderer::unlock()
     QMutexLocker locker(&m_mutex);
 
     m_setupCondition.wakeAll();
-    m_renderCondition.wakeAll();
 }
 
 bool QGstVideoRenderer::proposeAllocation(GstQuery *query)
@@ -185,8 +199,7 @@ void QGstVideoRenderer::flush()
     QMutexLocker locker(&m_mutex);
 
     m_flush = true;
-    m_renderBuffer = nullptr;
-    m_renderCondition.wakeAll();
+    clearPendingBuffers();
 
     notify();
 }
@@ -196,14 +209,18 @@ GstFlowReturn QGstVideoRenderer::render(GstBuffer *buffer)
     QMutexLocker locker(&m_mutex);
     qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::render";
 
-    m_renderReturn = GST_FLOW_OK;
-    m_renderBuffer = buffer;
+    if (!m_active)
+        return GST_FLOW_ERROR;
 
-    waitForAsyncEvent(&locker, &m_renderCondition, 300);
+    if (m_pendingBuffers.size() >= MaxPendingBuffers) {
+        gst_buffer_unref(m_pendingBuffers.dequeue());
+        ++m_frameStatistics.dropped;
+    }
 
-    m_renderBuffer = nullptr;
+    m_pendingBuffers.enqueue(gst_buffer_ref(buffer));
+    notify();
 
-    return m_renderReturn;
+    return GST_FLOW_OK;
 }
 
 bool QGstVideoRenderer::query(GstQuery *query)
@@ -230,6 +247,12 @@ bool QGstVideoRenderer::query(GstQuery *query)
     return false;
 }
 
+QGstVideoRenderer::FrameStatistics QGstVideoRenderer::frameStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frameStatistics;
+}
+
 void QGstVideoRenderer::gstEvent(GstEvent *event)
 {
     if (GST_EVENT_TYPE(event) != GST_EVENT_TAG)
@@ -326,14 +349,15 @@ bool QGstVideoRenderer::handleEvent(QMutexLocker<QMutex> *locker)
             m_flushed = true;
         }
 
-    } else if (m_renderBuffer) {
-        GstBuffer *buffer = m_renderBuffer;
-        m_renderBuffer = nullptr;
-        m_renderReturn = GST_FLOW_ERROR;
+    } else if (!m_pendingBuffers.isEmpty()) {
+        // Only the latest buffer is shown, the older ones are late already
+        GstBuffer *buffer = m_pendingBuffers.takeLast();
+        m_frameStatistics.dropped += m_pendingBuffers.size();
+        clearPendingBuffers();
 
         qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::handleEvent(renderBuffer)" << m_active << m_sink;
         if (m_active && m_sink) {
-            gst_buffer_ref(buffer);
+            ++m_frameStatistics.rendered;
 
             locker->unlock();
 
@@ -366,11 +390,9 @@ bool QGstVideoRenderer::handleEvent(QMutexLocker<QMutex> *locker)
             gst_buffer_unref(buffer);
 
             locker->relock();
-
-            m_renderReturn = GST_FLOW_OK;
+        } else {
+            gst_buffer_unref(buffer);
         }
-
-        m_renderCondition.wakeAll();
     } else {
         m_setupCondition.wakeAll();
 
@@ -379,6 +401,13 @@ bool QGstVideoRenderer::handleEvent(QMutexLocker<QMutex> *locker)
     return true;
 }
 
+void QGstVideoRenderer::clearPendingBuffers()
+{
+    for (GstBuffer *buffer : std::as_const(m_pendingBuffers))
+        gst_buffer_unref(buffer);
+    m_pendingBuffers.clear();
+}
+
 void QGstVideoRenderer::notify()
 {
     if (!m_notified) {
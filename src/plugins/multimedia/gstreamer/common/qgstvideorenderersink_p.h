@@ -32,10 +32,23 @@
 QT_BEGIN_NAMESPACE
 class QVideoSink;
 
+// Hands the buffers of the streaming thread over to the thread of the video sink.
+//
+// render() doesn't wait for the frame to be shown: it queues the buffer and returns, so
+// that a busy GUI thread doesn't stall the pipeline. The queue is bounded; when it's full
+// the oldest buffer is dropped, and the GUI thread only shows the latest queued buffer,
+// dropping the older ones it didn't get to.
 class QGstVideoRenderer : public QObject
 {
     Q_OBJECT
 public:
+    // Since the renderer started; reported as the dropped frames of the media player
+    struct FrameStatistics
+    {
+        qint64 rendered = 0;
+        qint64 dropped = 0;
+    };
+
     QGstVideoRenderer(QGstreamerVideoSink *sink);
     ~QGstVideoRenderer();
 
@@ -54,6 +67,8 @@ public:
     bool query(GstQuery *query);
     void gstEvent(GstEvent *event);
 
+    FrameStatistics frameStatistics();
+
 private slots:
     bool handleEvent(QMutexLocker<QMutex> *locker);
 
@@ -61,21 +76,21 @@ private:
     void notify();
     bool waitForAsyncEvent(QMutexLocker<QMutex> *locker, QWaitCondition *condition, unsigned long time);
     void createSurfaceCaps();
+    void clearPendingBuffers();
 
     QPointer<QGstreamerVideoSink> m_sink;
 
     QMutex m_mutex;
     QWaitCondition m_setupCondition;
-    QWaitCondition m_renderCondition;
 
     // --- accessed from multiple threads, need to hold mutex to access
-    GstFlowReturn m_renderReturn = GST_FLOW_OK;
     bool m_active = false;
 
     QGstCaps m_surfaceCaps;
 
     QGstCaps m_startCaps;
-    GstBuffer *m_renderBuffer = nullptr;
+    QQueue<GstBuffer *> m_pendingBuffers; // Referenced, oldest first
+    FrameStatistics m_frameStatistics;
 
     bool m_notified = false;
     bool m_stop = false;
@@ -98,6 +113,8 @@ public:
     static QGstVideoRendererSink *createSink(QGstreamerVideoSink *surface);
     static void setSink(QGstreamerVideoSink *surface);
 
+    QGstVideoRenderer *videoRenderer() const { return renderer; }
+
 private:
     static GType get_type();
     static void class_init(gpointer g_class, gpointer class_data);
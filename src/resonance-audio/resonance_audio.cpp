@@ -4,6 +4,8 @@
 #include "graph/resonance_audio_api_impl.h"
 #include "graph/graph_manager.h"
 
+#include <algorithm>
+
 namespace vraudio
 {
 
@@ -18,6 +20,11 @@ ResonanceAudio::~ResonanceAudio()
     delete api;
 }
 
+void ResonanceAudio::setNumWorkerThreads(int nThreads, std::function<void()> threadInit)
+{
+    impl->SetNumWorkerThreads(size_t(std::max(nThreads, 0)), std::move(threadInit));
+}
+
 int ResonanceAudio::getAmbisonicOutput(const float *buffers[], const float *reverb[], int nChannels)
 {
     impl->ProcessNextBuffer();
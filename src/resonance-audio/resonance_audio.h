@@ -5,6 +5,8 @@
 
 #include <api/resonance_audio_api.h>
 
+#include <functional>
+
 namespace vraudio
 {
 
@@ -21,6 +23,11 @@ public:
     // decoder will then add it to the generated surround signal.
     int getAmbisonicOutput(const float *buffers[], const float *reverb[], int nChannels);
 
+    // Processes the per source parts of the audio graph on additional worker threads.
+    // Has to be called before the audio thread starts processing. threadInit is
+    // called first thing on each worker thread.
+    void setNumWorkerThreads(int nThreads, std::function<void()> threadInit = {});
+
     ResonanceAudioApi *api = nullptr;
     ResonanceAudioApiImpl *impl = nullptr;
     bool roomEffectsEnabled = true;
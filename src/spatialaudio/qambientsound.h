@@ -20,6 +20,7 @@ class Q_SPATIALAUDIO_EXPORT QAmbientSound : public QObject
     Q_PROPERTY(float volume READ volume WRITE setVolume NOTIFY volumeChanged)
     Q_PROPERTY(int loops READ loops WRITE setLoops NOTIFY loopsChanged)
     Q_PROPERTY(bool autoPlay READ autoPlay WRITE setAutoPlay NOTIFY autoPlayChanged)
+    Q_PROPERTY(int underrunCount READ underrunCount NOTIFY underrunCountChanged)
 
 public:
     explicit QAmbientSound(QAudioEngine *engine);
@@ -41,6 +42,8 @@ public:
     bool autoPlay() const;
     void setAutoPlay(bool autoPlay);
 
+    int underrunCount() const;
+
     void setVolume(float volume);
     float volume() const;
 
@@ -50,6 +53,7 @@ Q_SIGNALS:
     void sourceChanged();
     void loopsChanged();
     void autoPlayChanged();
+    void underrunCountChanged();
     void volumeChanged();
 
 public Q_SLOTS:
@@ -5,6 +5,7 @@
 #include "qambisonicdecoderdata_p.h"
 #include <cmath>
 #include <qdebug.h>
+#include <private/qsimd_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -98,32 +99,94 @@ public:
         b1_hf = -2.f*b0_hf;
     }
 
-    struct Output
+    // Splits a block of samples into its low and high frequency parts
+    void process(const float *x, float *lf, float *hf, int nSamples)
     {
-        float lf;
-        float hf;
-    };
+        float x1 = prevX[0], x2 = prevX[1];
+        float lf1 = prevR_lf[0], lf2 = prevR_lf[1];
+        float hf1 = prevR_hf[0], hf2 = prevR_hf[1];
+        for (int i = 0; i < nSamples; ++i) {
+            const float x0 = x[i];
+            const float r_lf = x0*b0_lf + x1*b1_lf + x2*b0_lf - lf1*a1 - lf2*a2;
+            const float r_hf = x0*b0_hf + x1*b1_hf + x2*b0_hf - hf1*a1 - hf2*a2;
+            x2 = x1;
+            x1 = x0;
+            lf2 = lf1;
+            lf1 = r_lf;
+            hf2 = hf1;
+            hf1 = r_hf;
+            lf[i] = r_lf;
+            hf[i] = r_hf;
+        }
+        prevX[0] = x1; prevX[1] = x2;
+        prevR_lf[0] = lf1; prevR_lf[1] = lf2;
+        prevR_hf[0] = hf1; prevR_hf[1] = hf2;
+    }
 
-    Output next(float x)
+#if defined(__SSE2__)
+    // Runs four filters configured with the same sample rate side by side, one channel
+    // per SIMD lane. Processes a multiple of 4 samples and returns the number processed.
+    static int processFour(QAmbisonicDecoderFilter *f, const float *const x[4], float *lf,
+                           float *hf, int stride, int nSamples)
     {
-        float r_lf = x*b0_lf +
-                  prevX[0]*b1_lf +
-                  prevX[1]*b0_lf -
-                  prevR_lf[0]*a1 -
-                  prevR_lf[1]*a2;
-        float r_hf = x*b0_hf +
-                  prevX[0]*b1_hf +
-                  prevX[1]*b0_hf -
-                  prevR_hf[0]*a1 -
-                  prevR_hf[1]*a2;
-        prevX[1] = prevX[0];
-        prevX[0] = x;
-        prevR_lf[1] = prevR_lf[0];
-        prevR_lf[0] = r_lf;
-        prevR_hf[1] = prevR_hf[0];
-        prevR_hf[0] = r_hf;
-        return { r_lf, r_hf };
+        const __m128 b0_lf = _mm_set1_ps(f->b0_lf), b1_lf = _mm_set1_ps(f->b1_lf);
+        const __m128 b0_hf = _mm_set1_ps(f->b0_hf), b1_hf = _mm_set1_ps(f->b1_hf);
+        const __m128 a1 = _mm_set1_ps(f->a1), a2 = _mm_set1_ps(f->a2);
+        __m128 x1 = _mm_setr_ps(f[0].prevX[0], f[1].prevX[0], f[2].prevX[0], f[3].prevX[0]);
+        __m128 x2 = _mm_setr_ps(f[0].prevX[1], f[1].prevX[1], f[2].prevX[1], f[3].prevX[1]);
+        __m128 lf1 = _mm_setr_ps(f[0].prevR_lf[0], f[1].prevR_lf[0], f[2].prevR_lf[0], f[3].prevR_lf[0]);
+        __m128 lf2 = _mm_setr_ps(f[0].prevR_lf[1], f[1].prevR_lf[1], f[2].prevR_lf[1], f[3].prevR_lf[1]);
+        __m128 hf1 = _mm_setr_ps(f[0].prevR_hf[0], f[1].prevR_hf[0], f[2].prevR_hf[0], f[3].prevR_hf[0]);
+        __m128 hf2 = _mm_setr_ps(f[0].prevR_hf[1], f[1].prevR_hf[1], f[2].prevR_hf[1], f[3].prevR_hf[1]);
+
+        const int n = nSamples & ~3;
+        for (int i = 0; i < n; i += 4) {
+            // Transpose four samples of four channels into one vector per sample
+            __m128 in[4] = { _mm_loadu_ps(x[0] + i), _mm_loadu_ps(x[1] + i),
+                             _mm_loadu_ps(x[2] + i), _mm_loadu_ps(x[3] + i) };
+            _MM_TRANSPOSE4_PS(in[0], in[1], in[2], in[3]);
+            __m128 outLf[4];
+            __m128 outHf[4];
+            for (int s = 0; s < 4; ++s) {
+                const __m128 x0 = in[s];
+                const __m128 r_lf = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(_mm_add_ps(
+                        _mm_mul_ps(x0, b0_lf), _mm_mul_ps(x1, b1_lf)), _mm_mul_ps(x2, b0_lf)),
+                        _mm_mul_ps(lf1, a1)), _mm_mul_ps(lf2, a2));
+                const __m128 r_hf = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(_mm_add_ps(
+                        _mm_mul_ps(x0, b0_hf), _mm_mul_ps(x1, b1_hf)), _mm_mul_ps(x2, b0_hf)),
+                        _mm_mul_ps(hf1, a1)), _mm_mul_ps(hf2, a2));
+                x2 = x1;
+                x1 = x0;
+                lf2 = lf1;
+                lf1 = r_lf;
+                hf2 = hf1;
+                hf1 = r_hf;
+                outLf[s] = r_lf;
+                outHf[s] = r_hf;
+            }
+            _MM_TRANSPOSE4_PS(outLf[0], outLf[1], outLf[2], outLf[3]);
+            _MM_TRANSPOSE4_PS(outHf[0], outHf[1], outHf[2], outHf[3]);
+            for (int c = 0; c < 4; ++c) {
+                _mm_storeu_ps(lf + c*stride + i, outLf[c]);
+                _mm_storeu_ps(hf + c*stride + i, outHf[c]);
+            }
+        }
+
+        float state[6][4];
+        _mm_storeu_ps(state[0], x1);
+        _mm_storeu_ps(state[1], x2);
+        _mm_storeu_ps(state[2], lf1);
+        _mm_storeu_ps(state[3], lf2);
+        _mm_storeu_ps(state[4], hf1);
+        _mm_storeu_ps(state[5], hf2);
+        for (int c = 0; c < 4; ++c) {
+            f[c].prevX[0] = state[0][c]; f[c].prevX[1] = state[1][c];
+            f[c].prevR_lf[0] = state[2][c]; f[c].prevR_lf[1] = state[3][c];
+            f[c].prevR_hf[0] = state[4][c]; f[c].prevR_hf[1] = state[5][c];
+        }
+        return n;
     }
+#endif
 
 private:
     float a1 = 0.;
@@ -141,6 +204,100 @@ private:
 };
 
 
+// dst[i] += a[i]*fa + b[i]*fb
+static void addScaled(float *dst, const float *a, float fa, const float *b, float fb, int n)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 va = _mm_set1_ps(fa);
+    const __m128 vb = _mm_set1_ps(fb);
+    for (; i < n - 3; i += 4) {
+        __m128 d = _mm_loadu_ps(dst + i);
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(a + i), va));
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(b + i), vb));
+        _mm_storeu_ps(dst + i, d);
+    }
+#elif defined(__ARM_NEON__)
+    for (; i < n - 3; i += 4) {
+        float32x4_t d = vld1q_f32(dst + i);
+        d = vmlaq_n_f32(d, vld1q_f32(a + i), fa);
+        d = vmlaq_n_f32(d, vld1q_f32(b + i), fb);
+        vst1q_f32(dst + i, d);
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] += a[i]*fa + b[i]*fb;
+}
+
+// dst[i] += sum over j of lf[j][i]*lo[j] + hf[j][i]*hi[j], with the channels of lf and hf
+// being stride floats apart. Accumulates in registers over all channels.
+static void addMatrixRow(float *dst, const float *lf, const float *lo, const float *hf,
+                         const float *hi, int nChannels, int stride, int n)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i < n - 7; i += 8) {
+        __m128 d0 = _mm_loadu_ps(dst + i);
+        __m128 d1 = _mm_loadu_ps(dst + i + 4);
+        for (int j = 0; j < nChannels; ++j) {
+            const __m128 l = _mm_set1_ps(lo[j]);
+            const __m128 h = _mm_set1_ps(hi[j]);
+            const float *pl = lf + j*stride + i;
+            const float *ph = hf + j*stride + i;
+            d0 = _mm_add_ps(d0, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pl), l), _mm_mul_ps(_mm_loadu_ps(ph), h)));
+            d1 = _mm_add_ps(d1, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pl + 4), l), _mm_mul_ps(_mm_loadu_ps(ph + 4), h)));
+        }
+        _mm_storeu_ps(dst + i, d0);
+        _mm_storeu_ps(dst + i + 4, d1);
+    }
+#elif defined(__ARM_NEON__)
+    for (; i < n - 7; i += 8) {
+        float32x4_t d0 = vld1q_f32(dst + i);
+        float32x4_t d1 = vld1q_f32(dst + i + 4);
+        for (int j = 0; j < nChannels; ++j) {
+            const float *pl = lf + j*stride + i;
+            const float *ph = hf + j*stride + i;
+            d0 = vaddq_f32(d0, vaddq_f32(vmulq_n_f32(vld1q_f32(pl), lo[j]), vmulq_n_f32(vld1q_f32(ph), hi[j])));
+            d1 = vaddq_f32(d1, vaddq_f32(vmulq_n_f32(vld1q_f32(pl + 4), lo[j]), vmulq_n_f32(vld1q_f32(ph + 4), hi[j])));
+        }
+        vst1q_f32(dst + i, d0);
+        vst1q_f32(dst + i + 4, d1);
+    }
+#endif
+    for (; i < n; ++i) {
+        float d = dst[i];
+        for (int j = 0; j < nChannels; ++j)
+            d += lf[j*stride + i]*lo[j] + hf[j*stride + i]*hi[j];
+        dst[i] = d;
+    }
+}
+
+// Converts to 16 bit, truncating towards zero and saturating at the limits of the range
+static void convertToInt16(const float *src, short *dst, int n)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 scale = _mm_set1_ps(32768.f);
+    const __m128 max = _mm_set1_ps(32767.f);
+    const __m128 min = _mm_set1_ps(-32768.f);
+    for (; i < n - 7; i += 8) {
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), min), max);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), min), max);
+        const __m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+    }
+#elif defined(__ARM_NEON__)
+    for (; i < n - 7; i += 8) {
+        // vcvtq_s32_f32 truncates and saturates, vqmovn_s32 saturates as well
+        const int32x4_t a = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), 32768.f));
+        const int32x4_t b = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32768.f));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = static_cast<short>(qBound(-32768.f, src[i]*32768.f, 32767.f));
+}
+
 QAmbisonicDecoder::QAmbisonicDecoder(AmbisonicLevel ambisonicLevel, const QAudioFormat &format)
     : level(ambisonicLevel)
 {
@@ -199,6 +356,8 @@ QAmbisonicDecoder::QAmbisonicDecoder(AmbisonicLevel ambisonicLevel, const QAudio
         Q_ASSERT((f - simpleDecoderFactors) == 4*outputChannels);
         Q_ASSERT((r - reverbFactors) == 2*outputChannels);
 
+        blockBuffers.reset(new float[outputChannels*blockSize]);
+        decoded = blockBuffers.get();
         return;
     }
 
@@ -218,46 +377,84 @@ QAmbisonicDecoder::QAmbisonicDecoder(AmbisonicLevel ambisonicLevel, const QAudio
     filters = new QAmbisonicDecoderFilter[inputChannels];
     for (int i = 0; i < inputChannels; ++i)
         filters[i].configure(format.sampleRate());
+
+    blockBuffers.reset(new float[(2*inputChannels + outputChannels)*blockSize]);
+    lowFrequencies = blockBuffers.get();
+    highFrequencies = lowFrequencies + inputChannels*blockSize;
+    decoded = highFrequencies + inputChannels*blockSize;
 }
 
 QAmbisonicDecoder::~QAmbisonicDecoder()
 {
     if (simpleDecoderFactors) {
-        delete simpleDecoderFactors;
-        delete reverbFactors;
+        delete[] simpleDecoderFactors;
+        delete[] reverbFactors;
     }
+    delete[] filters;
 }
 
-void QAmbisonicDecoder::processBuffer(const float *input[], float *output, int nSamples)
+// Decodes nSamples <= blockSize frames starting at offset into the planar decoded buffer
+void QAmbisonicDecoder::decodeBlock(const float *input[], const float *reverb[2], int offset, int nSamples)
 {
-    float *o = output;
-    memset(o, 0, nSamples*outputChannels*sizeof(float));
+    Q_ASSERT(nSamples <= blockSize);
+    memset(decoded, 0, outputChannels*blockSize*sizeof(float));
 
     if (simpleDecoderFactors) {
-        for (int i = 0; i < nSamples; ++i) {
-            for (int j = 0; j < 4; ++j) {
-                for (int k = 0; k < outputChannels; ++k)
-                    o[k] += simpleDecoderFactors[k*4 + j]*input[j][i];
-            }
-            o += outputChannels;
+        for (int k = 0; k < outputChannels; ++k) {
+            float *o = decoded + k*blockSize;
+            const float *f = simpleDecoderFactors + k*4;
+            addScaled(o, input[0] + offset, f[0], input[1] + offset, f[1], nSamples);
+            addScaled(o, input[2] + offset, f[2], input[3] + offset, f[3], nSamples);
         }
-        return;
+    } else {
+        int j = 0;
+#if defined(__SSE2__)
+        for (; j < inputChannels - 3; j += 4) {
+            const float *x[4] = { input[j] + offset, input[j + 1] + offset,
+                                  input[j + 2] + offset, input[j + 3] + offset };
+            float *lf = lowFrequencies + j*blockSize;
+            float *hf = highFrequencies + j*blockSize;
+            const int done = QAmbisonicDecoderFilter::processFour(filters + j, x, lf, hf,
+                                                                  blockSize, nSamples);
+            for (int c = 0; c < 4; ++c)
+                filters[j + c].process(x[c] + done, lf + c*blockSize + done,
+                                       hf + c*blockSize + done, nSamples - done);
+        }
+#endif
+        for (; j < inputChannels; ++j)
+            filters[j].process(input[j] + offset, lowFrequencies + j*blockSize,
+                               highFrequencies + j*blockSize, nSamples);
+
+        const float *matrix_hi = decoderData->hf[level - 1];
+        const float *matrix_lo = decoderData->lf[level - 1];
+        for (int k = 0; k < outputChannels; ++k)
+            addMatrixRow(decoded + k*blockSize, lowFrequencies, matrix_lo + k*inputChannels,
+                         highFrequencies, matrix_hi + k*inputChannels, inputChannels, blockSize,
+                         nSamples);
+    }
+
+    if (reverb[0]) {
+        for (int k = 0; k < outputChannels; ++k)
+            addScaled(decoded + k*blockSize, reverb[0] + offset, reverbFactors[2*k],
+                      reverb[1] + offset, reverbFactors[2*k + 1], nSamples);
     }
+}
 
-    const float *matrix_hi = decoderData->hf[level - 1];
-    const float *matrix_lo = decoderData->lf[level - 1];
+void QAmbisonicDecoder::interleaveBlock(float *output, int nSamples) const
+{
     for (int i = 0; i < nSamples; ++i) {
-        QAmbisonicDecoderFilter::Output buf[maxAmbisonicChannels];
-        for (int j = 0; j < inputChannels; ++j)
-            buf[j] = filters[j].next(input[j][i]);
-        for (int j = 0; j < inputChannels; ++j) {
-            for (int k = 0; k < outputChannels; ++k)
-                o[k] += matrix_lo[k*inputChannels + j]*buf[j].lf + matrix_hi[k*inputChannels + j]*buf[j].hf;
-        }
-        o += outputChannels;
+        for (int k = 0; k < outputChannels; ++k)
+            output[k] = decoded[k*blockSize + i];
+        output += outputChannels;
     }
 }
 
+void QAmbisonicDecoder::processBuffer(const float *input[], float *output, int nSamples)
+{
+    const float *reverb[] = { nullptr, nullptr };
+    return processBufferWithReverb(input, reverb, output, nSamples);
+}
+
 void QAmbisonicDecoder::processBuffer(const float *input[], short *output, int nSamples)
 {
     const float *reverb[] = { nullptr, nullptr };
@@ -266,48 +463,25 @@ void QAmbisonicDecoder::processBuffer(const float *input[], short *output, int n
 
 void QAmbisonicDecoder::processBufferWithReverb(const float *input[], const float *reverb[2], short *output, int nSamples)
 {
-    if (simpleDecoderFactors) {
-        for (int i = 0; i < nSamples; ++i) {
-            float o[4] = {};
-            for (int k = 0; k < outputChannels; ++k) {
-                for (int j = 0; j < 4; ++j)
-                    o[k] += simpleDecoderFactors[k*4 + j]*input[j][i];
-            }
-            if (reverb[0]) {
-                for (int k = 0; k < outputChannels; ++k) {
-                    o[k] += reverb[0][i]*reverbFactors[2*k] + reverb[1][i]*reverbFactors[2*k+1];
-                }
-            }
-
-            for (int k = 0; k < outputChannels; ++k)
-                output[k] = static_cast<short>(o[k]*32768.);
-            output += outputChannels;
-        }
-        return;
+    // Interleave first, so that the conversion to int16 can run over contiguous memory.
+    // Our decoding matrices have at most 8 output channels.
+    Q_ASSERT(outputChannels <= maxAmbisonicChannels);
+    float interleaved[maxAmbisonicChannels*blockSize];
+    for (int offset = 0; offset < nSamples; offset += blockSize) {
+        const int n = qMin(blockSize, nSamples - offset);
+        decodeBlock(input, reverb, offset, n);
+        interleaveBlock(interleaved, n);
+        convertToInt16(interleaved, output + offset*outputChannels, n*outputChannels);
     }
+}
 
-    //    qDebug() << "XXX" << inputChannels << outputChannels;
-    const float *matrix_hi = decoderData->hf[level - 1];
-    const float *matrix_lo = decoderData->lf[level - 1];
-    for (int i = 0; i < nSamples; ++i) {
-        QAmbisonicDecoderFilter::Output buf[maxAmbisonicChannels];
-        for (int j = 0; j < inputChannels; ++j)
-            buf[j] = filters[j].next(input[j][i]);
-        float o[32] = {}; // we can't support more than 32 channels from our API
-        for (int j = 0; j < inputChannels; ++j) {
-            for (int k = 0; k < outputChannels; ++k)
-                o[k] += matrix_lo[k*inputChannels + j]*buf[j].lf + matrix_hi[k*inputChannels + j]*buf[j].hf;
-        }
-        if (reverb[0]) {
-            for (int k = 0; k < outputChannels; ++k) {
-                o[k] += reverb[0][i]*reverbFactors[2*k] + reverb[1][i]*reverbFactors[2*k+1];
-            }
-        }
-        for (int k = 0; k < outputChannels; ++k)
-            output[k] = static_cast<short>(o[k]*32768.);
-        output += outputChannels;
+void QAmbisonicDecoder::processBufferWithReverb(const float *input[], const float *reverb[2], float *output, int nSamples)
+{
+    for (int offset = 0; offset < nSamples; offset += blockSize) {
+        const int n = qMin(blockSize, nSamples - offset);
+        decodeBlock(input, reverb, offset, n);
+        interleaveBlock(output + offset*outputChannels, n);
     }
-
 }
 
 QT_END_NAMESPACE
@@ -17,12 +17,14 @@
 #include <qtspatialaudioglobal_p.h>
 #include <qaudioformat.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 struct QAmbisonicDecoderData;
 class QAmbisonicDecoderFilter;
 
-class QAmbisonicDecoder
+class Q_SPATIALAUDIO_EXPORT QAmbisonicDecoder
 {
 public:
     enum AmbisonicLevel
@@ -49,10 +51,17 @@ public:
     void processBuffer(const float *input[], short *output, int nSamples);
 
     void processBufferWithReverb(const float *input[], const float *reverb[2], short *output, int nSamples);
+    void processBufferWithReverb(const float *input[], const float *reverb[2], float *output, int nSamples);
 
     static constexpr int maxAmbisonicChannels = 16;
     static constexpr int maxAmbisonicLevel = 3;
 private:
+    // Number of frames decoded in one go
+    static constexpr int blockSize = 128;
+
+    void decodeBlock(const float *input[], const float *reverb[2], int offset, int nSamples);
+    void interleaveBlock(float *output, int nSamples) const;
+
     QAudioFormat::ChannelConfig channelConfig;
     AmbisonicLevel level = AmbisonicLevel1;
     int inputChannels = 0;
@@ -61,6 +70,13 @@ private:
     QAmbisonicDecoderFilter *filters = nullptr;
     float *simpleDecoderFactors = nullptr;
     const float *reverbFactors = nullptr;
+
+    // Planar scratch buffers of blockSize frames each: the low and high frequency parts
+    // of every input channel, followed by the decoded output channels
+    std::unique_ptr<float[]> blockBuffers;
+    float *lowFrequencies = nullptr;
+    float *highFrequencies = nullptr;
+    float *decoded = nullptr;
 };
 
 
@@ -13,6 +13,7 @@
 #include <qaudiosink.h>
 #include <qdebug.h>
 #include <qelapsedtimer.h>
+#include <qloggingcategory.h>
 
 #include <QFile>
 
@@ -23,6 +24,8 @@ QT_BEGIN_NAMESPACE
 // It might be possible to set this value lower on other OSes.
 const int bufferTimeMs = 100;
 
+static Q_LOGGING_CATEGORY(qLcSpatialSound, "qt.spatialaudio.sound")
+
 class QAudioOutputStream : public QIODevice
 {
     Q_OBJECT
@@ -59,10 +62,15 @@ public:
         format.setChannelConfig(d->outputMode == QAudioEngine::Surround ?
                                     d->device.channelConfiguration() : QAudioFormat::ChannelConfigStereo);
         format.setSampleRate(d->sampleRate);
-        format.setSampleFormat(QAudioFormat::Int16);
+        // The engine renders in float, so prefer handing that to the device directly and
+        // only quantize to 16 bit if the device can't take it
+        format.setSampleFormat(QAudioFormat::Float);
+        if (!d->device.isFormatSupported(format))
+            format.setSampleFormat(QAudioFormat::Int16);
+        sampleFormat = format.sampleFormat();
         d->ambisonicDecoder.reset(new QAmbisonicDecoder(QAmbisonicDecoder::HighQuality, format));
         sink.reset(new QAudioSink(d->device, format));
-        sink->setBufferSize(d->sampleRate*bufferTimeMs/1000*sizeof(qint16)*format.channelCount());
+        sink->setBufferSize(d->sampleRate*bufferTimeMs/1000*format.bytesPerFrame());
         sink->start(this);
     }
 
@@ -86,6 +94,7 @@ public:
 
 private:
     qint64 m_pos = 0;
+    QAudioFormat::SampleFormat sampleFormat = QAudioFormat::Int16;
     QAudioEnginePrivate *d = nullptr;
     std::unique_ptr<QAudioSink> sink;
 };
@@ -108,11 +117,13 @@ qint64 QAudioOutputStream::readData(char *data, qint64 len)
     d->updateRooms();
 
     int nChannels = d->ambisonicDecoder ? d->ambisonicDecoder->nOutputChannels() : 2;
-    if (len < nChannels*int(sizeof(float))*QAudioEnginePrivate::bufferSize)
+    const bool renderFloat = sampleFormat == QAudioFormat::Float;
+    const int bytesPerFrame = nChannels*int(renderFloat ? sizeof(float) : sizeof(short));
+    if (len < bytesPerFrame*QAudioEnginePrivate::bufferSize)
         return 0;
 
-    short *fd = (short *)data;
-    qint64 frames = len / nChannels / sizeof(short);
+    char *fd = data;
+    qint64 frames = len / bytesPerFrame;
     bool ok = true;
     while (frames >= qint64(QAudioEnginePrivate::bufferSize)) {
         // Fill input buffers
@@ -134,18 +145,24 @@ qint64 QAudioOutputStream::readData(char *data, qint64 len)
             const float *reverbBuffers[2];
             int nSamples = d->resonanceAudio->getAmbisonicOutput(channels, reverbBuffers, d->ambisonicDecoder->nInputChannels());
             Q_ASSERT(d->ambisonicDecoder->nOutputChannels() <= 8);
-            d->ambisonicDecoder->processBufferWithReverb(channels, reverbBuffers, fd, nSamples);
+            if (renderFloat)
+                d->ambisonicDecoder->processBufferWithReverb(channels, reverbBuffers, reinterpret_cast<float *>(fd), nSamples);
+            else
+                d->ambisonicDecoder->processBufferWithReverb(channels, reverbBuffers, reinterpret_cast<short *>(fd), nSamples);
         } else {
-            ok = d->resonanceAudio->api->FillInterleavedOutputBuffer(2, QAudioEnginePrivate::bufferSize, fd);
+            if (renderFloat)
+                ok = d->resonanceAudio->api->FillInterleavedOutputBuffer(2, QAudioEnginePrivate::bufferSize, reinterpret_cast<float *>(fd));
+            else
+                ok = d->resonanceAudio->api->FillInterleavedOutputBuffer(2, QAudioEnginePrivate::bufferSize, reinterpret_cast<short *>(fd));
             if (!ok) {
                 qWarning() << "    Reading failed!";
                 break;
             }
         }
-        fd += nChannels*QAudioEnginePrivate::bufferSize;
+        fd += bytesPerFrame*QAudioEnginePrivate::bufferSize;
         frames -= QAudioEnginePrivate::bufferSize;
     }
-    const int bytesProcessed = ((char *)fd - data);
+    const int bytesProcessed = fd - data;
     m_pos += bytesProcessed;
     return bytesProcessed;
 }
@@ -278,6 +295,42 @@ QVector3D QAudioEnginePrivate::listenerPosition() const
     return listener ? listener->position() : QVector3D();
 }
 
+std::shared_ptr<QSharedSoundData> QAudioEnginePrivate::cachedSoundData(const QUrl &url, int nchannels) const
+{
+    auto data = soundDataCache.value({ url, nchannels }).lock();
+    // Give new sounds a chance to decode the source again
+    if (data && data->error != QAudioDecoder::NoError)
+        return {};
+    return data;
+}
+
+void QAudioEnginePrivate::addSoundData(const QUrl &url, int nchannels,
+                                       const std::shared_ptr<QSharedSoundData> &data)
+{
+    soundDataCache.removeIf([](const auto &it) { return it.value().expired(); });
+    soundDataCache.insert({ url, nchannels }, data);
+}
+
+QSharedSoundData::QSharedSoundData(std::unique_ptr<QAudioDecoder> audioDecoder,
+                                   std::unique_ptr<QFile> file)
+    : sourceDeviceFile(std::move(file))
+    , decoder(std::move(audioDecoder))
+{
+    auto *d = decoder.get();
+    if (d->bufferAvailable())
+        buffers.append(d->read());
+    QObject::connect(d, &QAudioDecoder::bufferReady, d, [this, d] {
+        if (auto b = d->read(); b.isValid())
+            buffers.append(b);
+    });
+    QObject::connect(d, &QAudioDecoder::finished, d, [this] { loading = false; });
+    QObject::connect(d, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), d,
+                     [this](QAudioDecoder::Error e) {
+        error = e;
+        loading = false;
+    });
+}
+
 
 /*!
     \class QAudioEngine
@@ -452,6 +505,17 @@ void QAudioEngine::start()
     d->resonanceAudio->api->SetStereoSpeakerMode(d->outputMode != Headphone);
     d->resonanceAudio->api->SetMasterVolume(d->masterVolume);
 
+    // The audio thread waits for the workers, so they get the same priority.
+    // The environment variable overrides the property, for tuning existing applications.
+    const int workerThreads = qEnvironmentVariableIsSet("QT_SPATIALAUDIO_WORKER_THREADS")
+            ? qEnvironmentVariableIntValue("QT_SPATIALAUDIO_WORKER_THREADS")
+            : d->workerThreadCount;
+    if (workerThreads > 0) {
+        d->resonanceAudio->setNumWorkerThreads(workerThreads, [] {
+            QThread::currentThread()->setPriority(QThread::TimeCriticalPriority);
+        });
+    }
+
     d->outputStream.reset(new QAudioOutputStream(d));
     d->outputStream->moveToThread(&d->audioThread);
     d->audioThread.start();
@@ -544,16 +608,131 @@ float QAudioEngine::distanceScale() const
     return d->distanceScale*100.f;
 }
 
+/*!
+    \property QAudioEngine::underrunCount
+    \since 6.7
+
+    Holds the number of times a sound had no audio data ready when the engine
+    rendered it, because decoding did not keep up with playback. Each underrun
+    is audible as a short gap in the sound.
 
-void QAmbientSoundPrivate::load()
+    The count is the sum over all sounds of the engine, and is never reset.
+*/
+int QAudioEngine::underrunCount() const
 {
-    decoder.reset(new QAudioDecoder);
-    buffers.clear();
+    return d->underrunCount;
+}
+
+/*!
+    \property QAudioEngine::workerThreadCount
+    \since 6.7
+
+    Holds the number of additional threads processing the parts of the sound
+    field that belong to the individual sounds, like their spatialization.
+    This can reduce the rendering time of scenes with many sounds on multi-core
+    systems. The rendered output is the same with and without worker threads.
+
+    The default is \c 0, where everything is rendered on the audio thread.
+    The property can only be changed before the engine is started.
+
+    The \c QT_SPATIALAUDIO_WORKER_THREADS environment variable overrides the
+    property, if it is set.
+*/
+void QAudioEngine::setWorkerThreadCount(int count)
+{
+    count = qMax(count, 0);
+    if (d->workerThreadCount == count)
+        return;
+    if (d->outputStream) {
+        qWarning() << "Changing the worker threads of a running engine not implemented";
+        return;
+    }
+    d->workerThreadCount = count;
+    emit workerThreadCountChanged();
+}
+
+int QAudioEngine::workerThreadCount() const
+{
+    return d->workerThreadCount;
+}
+
+void QAudioEnginePrivate::addUnderruns(QAudioEngine *engine, int underruns)
+{
+    underrunCount += underruns;
+    emit engine->underrunCountChanged();
+}
+
+
+void QAmbientSoundPrivate::play()
+{
+    m_playing = true;
+    refillTimer.start();
+    refill();
+}
+
+void QAmbientSoundPrivate::pause()
+{
+    m_playing = false;
+    refillTimer.stop();
+}
+
+void QAmbientSoundPrivate::stop()
+{
+    m_playing = false;
+    refillTimer.stop();
+    rewind();
+}
+
+void QAmbientSoundPrivate::rewind()
+{
+    // The audio thread discards whatever is left in the ring buffer. We must not
+    // write to it again before that has happened.
+    m_flushPending = true;
+    m_endOfData = false;
+    m_hasData = false;
     currentBuffer = 0;
-    sourceDeviceFile.reset(nullptr);
     bufPos = 0;
-    m_playing = false;
+    m_currentLoop = 0;
+    if (m_streaming)
+        restartStream();
+}
+
+void QAmbientSoundPrivate::releaseData()
+{
+    if (sharedData)
+        disconnect(sharedData->decoder.get(), nullptr, this, nullptr);
+    sharedData.reset();
+    decoder.reset();
+    sourceDeviceFile.reset();
+    buffers.clear();
+    m_streaming = false;
+    m_restartPending = false;
+    m_loading = false;
+    m_decodingFailed = false;
+}
+
+void QAmbientSoundPrivate::load()
+{
+    releaseData();
+    stop();
+    m_autoPlayPending = true;
+
+    auto *ep = QAudioEnginePrivate::get(engine);
+    sharedData = ep->cachedSoundData(url, nchannels);
+    if (sharedData) {
+        connectSharedData();
+        if (!sharedData->buffers.isEmpty())
+            sharedDataReady();
+        return;
+    }
+
     m_loading = true;
+    startDecoder();
+}
+
+void QAmbientSoundPrivate::startDecoder()
+{
+    decoder.reset(new QAudioDecoder);
     auto *ep = QAudioEnginePrivate::get(engine);
     QAudioFormat f;
     f.setSampleFormat(QAudioFormat::Float);
@@ -562,8 +741,12 @@ void QAmbientSoundPrivate::load()
     decoder->setAudioFormat(f);
     if (url.scheme().compare(u"qrc", Qt::CaseInsensitive) == 0) {
         auto qrcFile = std::make_unique<QFile>(u':' + url.path());
-        if (!qrcFile->open(QFile::ReadOnly))
+        if (!qrcFile->open(QFile::ReadOnly)) {
+            qCWarning(qLcSpatialSound) << "can't open" << url << qrcFile->errorString();
+            m_loading = false;
+            m_decodingFailed = true;
             return;
+        }
         sourceDeviceFile = std::move(qrcFile);
         decoder->setSourceDevice(sourceDeviceFile.get());
     } else {
@@ -571,69 +754,242 @@ void QAmbientSoundPrivate::load()
     }
     connect(decoder.get(), &QAudioDecoder::bufferReady, this, &QAmbientSoundPrivate::bufferReady);
     connect(decoder.get(), &QAudioDecoder::finished, this, &QAmbientSoundPrivate::finished);
+    connect(decoder.get(), qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this,
+            &QAmbientSoundPrivate::decodingFailed);
     decoder->start();
 }
 
+// Hands our decoder over to the engine's cache, or switches to data another sound
+// is already decoding from the same source.
+void QAmbientSoundPrivate::shareDecoder()
+{
+    auto *ep = QAudioEnginePrivate::get(engine);
+    disconnect(decoder.get(), nullptr, this, nullptr);
+    m_loading = false;
+
+    sharedData = ep->cachedSoundData(url, nchannels);
+    if (sharedData) {
+        // We are called from a signal of the decoder, so we can't delete it right away
+        if (sourceDeviceFile)
+            sourceDeviceFile.release()->setParent(decoder.get());
+        decoder.release()->deleteLater();
+    } else {
+        sharedData = std::make_shared<QSharedSoundData>(std::move(decoder),
+                                                        std::move(sourceDeviceFile));
+        ep->addSoundData(url, nchannels, sharedData);
+    }
+
+    connectSharedData();
+    sharedDataReady();
+}
+
+void QAmbientSoundPrivate::connectSharedData()
+{
+    auto *d = sharedData->decoder.get();
+    connect(d, &QAudioDecoder::bufferReady, this, &QAmbientSoundPrivate::sharedDataReady);
+    connect(d, &QAudioDecoder::finished, this, &QAmbientSoundPrivate::refill);
+    connect(d, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this,
+            &QAmbientSoundPrivate::decodingFailed);
+}
+
+void QAmbientSoundPrivate::restartStream()
+{
+    buffers.clear();
+    m_decodedLoops = 0;
+    m_loading = true;
+    m_decodingFailed = false;
+    restartDecoder();
+}
+
+void QAmbientSoundPrivate::restartDecoder()
+{
+    // We might get called from a signal of the decoder, so restart it asynchronously.
+    // Until then, anything the decoder still delivers belongs to the previous run.
+    m_restartPending = true;
+    QMetaObject::invokeMethod(decoder.get(), [this] {
+        decoder->stop();
+        while (decoder->bufferAvailable())
+            decoder->read();
+        if (sourceDeviceFile)
+            sourceDeviceFile->seek(0);
+        m_restartPending = false;
+        decoder->start();
+    }, Qt::QueuedConnection);
+}
+
+void QAmbientSoundPrivate::readDecodedBuffers()
+{
+    if (m_restartPending)
+        return;
+
+    const int windowFrames = decoder->audioFormat().sampleRate() * streamingWindowMs / 1000;
+    int frames = -bufPos;
+    for (const auto &b : std::as_const(buffers))
+        frames += b.frameCount();
+
+    // Leave further buffers in the decoder, so that it doesn't decode ahead of us
+    while (frames < windowFrames && decoder->bufferAvailable()) {
+        auto b = decoder->read();
+        if (!b.isValid())
+            break;
+        frames += b.frameCount();
+        buffers.append(b);
+    }
+}
+
 void QAmbientSoundPrivate::getBuffer(float *buf, int nframes, int channels)
 {
     Q_ASSERT(channels == nchannels);
-    QMutexLocker l(&mutex);
-    if (!m_playing || currentBuffer >= buffers.size()) {
-        memset(buf, 0, channels * nframes * sizeof(float));
-    } else {
-        int frames = nframes;
-        float *ff = buf;
-        while (frames) {
-            if (currentBuffer < buffers.size()) {
-                const QAudioBuffer &b = buffers.at(currentBuffer);
-//            qDebug() << s << b.format().sampleRate() << b.format().channelCount() << b.format().sampleFormat();
-                auto *f = b.constData<float>() + bufPos*nchannels;
-                int toCopy = qMin(b.frameCount() - bufPos, frames);
-                memcpy(ff, f, toCopy*sizeof(float)*nchannels);
-                ff += toCopy*nchannels;
-                frames -= toCopy;
-                bufPos += toCopy;
-                Q_ASSERT(bufPos <= b.frameCount());
-                if (bufPos == b.frameCount()) {
-                    ++currentBuffer;
-                    bufPos = 0;
-                }
-            } else {
-                // no more data available
-                if (m_loading)
-                    qDebug() << "underrun" << frames << "frames when loading" << url;
-                memset(ff, 0, frames * channels * sizeof(float));
-                ff += frames * channels;
-                frames = 0;
+    if (m_flushPending.loadAcquire()) {
+        ring.skip(ring.available());
+        m_flushPending.storeRelease(false);
+    }
+
+    const int samples = nframes * channels;
+    const int read = m_playing ? ring.read(buf, samples) : 0;
+    if (read < samples) {
+        memset(buf + read, 0, (samples - read) * sizeof(float));
+        if (m_playing && m_hasData.loadAcquire() && !m_endOfData.loadAcquire())
+            m_underruns.ref();
+    }
+}
+
+void QAmbientSoundPrivate::refill()
+{
+    const int underruns = m_underruns.loadRelaxed();
+    if (underruns != m_reportedUnderruns) {
+        qCDebug(qLcSpatialSound) << "underrun of" << url << (m_loading ? "while loading" : "")
+                                 << "total:" << underruns;
+        if (auto *ep = QAudioEnginePrivate::get(engine))
+            ep->addUnderruns(engine, underruns - m_reportedUnderruns);
+        m_reportedUnderruns = underruns;
+        if (auto *sound = qobject_cast<QAmbientSound *>(parent()))
+            emit sound->underrunCountChanged();
+        else if (auto *sound = qobject_cast<QSpatialSound *>(parent()))
+            emit sound->underrunCountChanged();
+    }
+
+    if (!m_playing || m_flushPending.loadAcquire())
+        return;
+
+    const QList<QAudioBuffer> &data = sharedData ? sharedData->buffers : buffers;
+    const bool loading = sharedData ? sharedData->loading : m_loading;
+    const bool failed = sharedData ? sharedData->error != QAudioDecoder::NoError : m_decodingFailed;
+
+    while (!m_endOfData.loadRelaxed()) {
+        const int freeFrames = ring.freeSpace() / nchannels;
+        if (!freeFrames)
+            break;
+        if (currentBuffer < data.size()) {
+            const QAudioBuffer &b = data.at(currentBuffer);
+            if (!b.isValid()) {
+                // end of a loop in the stream
+                buffers.removeFirst();
+                ++m_currentLoop;
+                if (m_loops > 0 && m_currentLoop >= m_loops)
+                    m_endOfData.storeRelease(true);
+                continue;
             }
-            if (!m_loading) {
-                if (currentBuffer == buffers.size()) {
-                    currentBuffer = 0;
-                    ++m_currentLoop;
-                }
-                if (m_loops > 0 && m_currentLoop >= m_loops) {
-                    m_playing = false;
-                    m_currentLoop = 0;
-                }
+            const int toCopy = qMin(b.frameCount() - bufPos, freeFrames);
+            ring.write(b.constData<float>() + bufPos * nchannels, toCopy * nchannels);
+            m_hasData.storeRelease(true);
+            bufPos += toCopy;
+            Q_ASSERT(bufPos <= b.frameCount());
+            if (bufPos == b.frameCount()) {
+                if (m_streaming)
+                    buffers.removeFirst();
+                else
+                    ++currentBuffer;
+                bufPos = 0;
             }
+        } else if (failed && (data.isEmpty() || m_streaming)) {
+            // Nothing more is going to be decoded
+            m_endOfData.storeRelease(true);
+        } else if (loading || data.isEmpty() || m_streaming) {
+            // wait for the decoder
+            break;
+        } else {
+            currentBuffer = 0;
+            ++m_currentLoop;
+            if (m_loops > 0 && m_currentLoop >= m_loops)
+                m_endOfData.storeRelease(true);
         }
-        Q_ASSERT(ff - buf == channels*nframes);
+    }
+
+    if (m_streaming)
+        readDecodedBuffers();
+
+    // Everything has been played back once the audio thread has drained the ring buffer
+    if (m_endOfData.loadRelaxed() && ring.freeSpace() == ring.capacity()) {
+        m_playing = false;
+        refillTimer.stop();
+        m_endOfData = false;
+        m_currentLoop = 0;
+        // A failed stream only gets decoded again when the sound is stopped and played
+        if (m_streaming && !m_decodingFailed)
+            restartStream();
     }
 }
 
 void QAmbientSoundPrivate::bufferReady()
 {
-    QMutexLocker l(&mutex);
-    auto b = decoder->read();
-//    qDebug() << "read buffer" << b.format() << b.startTime() << b.duration();
-    buffers.append(b);
-    if (m_autoPlay)
-        m_playing = true;
+    if (m_restartPending)
+        return;
+
+    if (!m_streaming) {
+        // First decoded buffer. Long sounds get streamed, everything else is
+        // decoded completely and shared with other sounds using the same source.
+        // Sounds of unknown duration might be endless, so they are streamed too.
+        const qint64 duration = decoder->duration();
+        if (duration >= 0 && duration <= streamingThresholdMs) {
+            shareDecoder();
+            return;
+        }
+        m_streaming = true;
+    }
+
+    readDecodedBuffers();
+    if (std::exchange(m_autoPlayPending, false) && m_autoPlay)
+        play();
+    else
+        refill();
+}
+
+void QAmbientSoundPrivate::sharedDataReady()
+{
+    if (std::exchange(m_autoPlayPending, false) && m_autoPlay)
+        play();
+    else
+        refill();
+}
+
+void QAmbientSoundPrivate::decodingFailed()
+{
+    const auto *d = sharedData ? sharedData->decoder.get() : decoder.get();
+    qCWarning(qLcSpatialSound) << "failed to decode" << url << d->errorString();
+    if (!sharedData) {
+        m_loading = false;
+        m_decodingFailed = true;
+    }
+    refill();
 }
 
 void QAmbientSoundPrivate::finished()
 {
+    if (m_restartPending || m_decodingFailed)
+        return;
+
+    if (m_streaming) {
+        buffers.append(QAudioBuffer());
+        ++m_decodedLoops;
+        if (m_loops <= 0 || m_decodedLoops < m_loops) {
+            // Start decoding the next loop right away, so that it continues seamlessly
+            restartDecoder();
+            return;
+        }
+    }
     m_loading = false;
+    refill();
 }
 
 /*!
@@ -20,6 +20,8 @@ class Q_SPATIALAUDIO_EXPORT QAudioEngine : public QObject
     Q_PROPERTY(float masterVolume READ masterVolume WRITE setMasterVolume NOTIFY masterVolumeChanged)
     Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
     Q_PROPERTY(float distanceScale READ distanceScale WRITE setDistanceScale NOTIFY distanceScaleChanged)
+    Q_PROPERTY(int underrunCount READ underrunCount NOTIFY underrunCountChanged)
+    Q_PROPERTY(int workerThreadCount READ workerThreadCount WRITE setWorkerThreadCount NOTIFY workerThreadCountChanged)
 public:
     QAudioEngine() : QAudioEngine(nullptr) {};
     explicit QAudioEngine(QObject *parent) : QAudioEngine(44100, parent) {}
@@ -56,12 +58,19 @@ public:
     void setDistanceScale(float scale);
     float distanceScale() const;
 
+    int underrunCount() const;
+
+    void setWorkerThreadCount(int count);
+    int workerThreadCount() const;
+
 Q_SIGNALS:
     void outputModeChanged();
     void outputDeviceChanged();
     void masterVolumeChanged();
     void pausedChanged();
     void distanceScaleChanged();
+    void underrunCountChanged();
+    void workerThreadCountChanged();
 
 public Q_SLOTS:
     void start();
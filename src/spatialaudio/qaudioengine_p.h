@@ -25,6 +25,9 @@
 #include <qaudiobuffer.h>
 #include <qvector3d.h>
 #include <qfile.h>
+#include <qhash.h>
+#include <qtimer.h>
+#include <qaudioringbuffer_p.h>
 
 namespace vraudio {
 class ResonanceAudio;
@@ -41,6 +44,21 @@ class QAudioDecoder;
 class QAudioRoom;
 class QAudioListener;
 
+// A completely decoded sound. All sounds of an engine using the same source
+// share one copy of the decoded data.
+class QSharedSoundData
+{
+public:
+    QSharedSoundData(std::unique_ptr<QAudioDecoder> decoder, std::unique_ptr<QFile> sourceDeviceFile);
+
+    std::unique_ptr<QFile> sourceDeviceFile;
+    std::unique_ptr<QAudioDecoder> decoder;
+    QList<QAudioBuffer> buffers;
+    bool loading = true;
+    // Set if decoding stopped with an error. buffers holds what was decoded until then.
+    QAudioDecoder::Error error = QAudioDecoder::NoError;
+};
+
 class QAudioEnginePrivate
 {
 public:
@@ -64,6 +82,9 @@ public:
     QMutex mutex;
     QAudioDevice device;
     QAtomicInteger<bool> paused = false;
+    // Sum of the underruns of all sounds
+    int underrunCount = 0;
+    int workerThreadCount = 0;
 
     QThread audioThread;
     std::unique_ptr<QAudioOutputStream> outputStream;
@@ -76,6 +97,9 @@ public:
     mutable bool listenerPositionDirty = true;
     QAudioRoom *currentRoom = nullptr;
 
+    // Decoded data of all non streaming sounds, by source and channel count
+    QHash<QPair<QUrl, int>, std::weak_ptr<QSharedSoundData>> soundDataCache;
+
     void addSpatialSound(QSpatialSound *sound);
     void removeSpatialSound(QSpatialSound *sound);
     void addStereoSound(QAmbientSound *sound);
@@ -86,15 +110,32 @@ public:
     void updateRooms();
 
     QVector3D listenerPosition() const;
+
+    void addUnderruns(QAudioEngine *engine, int underruns);
+
+    std::shared_ptr<QSharedSoundData> cachedSoundData(const QUrl &url, int nchannels) const;
+    void addSoundData(const QUrl &url, int nchannels, const std::shared_ptr<QSharedSoundData> &data);
 };
 
 class QAmbientSoundPrivate : public QObject
 {
 public:
+    // Size of the ring buffer between the decoded data and the audio thread
+    static constexpr int ringBufferFrames = 16384;
+    static constexpr int refillIntervalMs = 20;
+    // Sounds longer than this are streamed instead of being decoded completely
+    static constexpr qint64 streamingThresholdMs = 10000;
+    // How much decoded audio to keep ahead of the playback position when streaming
+    static constexpr int streamingWindowMs = 2000;
+
     QAmbientSoundPrivate(QObject *parent, int nchannels = 2)
         : QObject(parent)
         , nchannels(nchannels)
-    {}
+        , ring(ringBufferFrames * nchannels)
+    {
+        refillTimer.setInterval(refillIntervalMs);
+        connect(&refillTimer, &QTimer::timeout, this, &QAmbientSoundPrivate::refill);
+    }
 
     template<typename T>
     static QAmbientSoundPrivate *get(T *soundSource) { return soundSource ? soundSource->d : nullptr; }
@@ -102,43 +143,72 @@ public:
     QUrl url;
     float volume = 1.;
     int nchannels = 2;
-    std::unique_ptr<QAudioDecoder> decoder;
-    std::unique_ptr<QFile> sourceDeviceFile;
     QAudioEngine *engine = nullptr;
 
-    QMutex mutex;
+    // Our own decoder. Used until the first buffer has been decoded, and afterwards
+    // only if the sound is being streamed.
+    std::unique_ptr<QFile> sourceDeviceFile;
+    std::unique_ptr<QAudioDecoder> decoder;
+    // Set if the sound has been decoded completely
+    std::shared_ptr<QSharedSoundData> sharedData;
+    bool m_streaming = false;
+    bool m_restartPending = false;
+    int m_decodedLoops = 0;
+
+    // The read position into the decoded data. Only accessed from the thread
+    // the sound lives in, which feeds the ring buffer. When streaming, buffers holds
+    // the decoded look-ahead window, with invalid buffers marking the end of a loop.
     int currentBuffer = 0;
     int bufPos = 0;
     int m_currentLoop = 0;
     QList<QAudioBuffer> buffers;
     int sourceId = -1; // kInvalidSourceId
 
+    // Written by the thread the sound lives in, read by the audio thread
+    QAudioRingBuffer ring;
+    QTimer refillTimer;
+    QAtomicInteger<bool> m_flushPending = false;
+    QAtomicInteger<bool> m_endOfData = false;
+    // Set once the ring buffer got its first data. Running dry before that is
+    // the startup latency of the sound, and no underrun.
+    QAtomicInteger<bool> m_hasData = false;
+    QAtomicInt m_underruns = 0;
+    int m_reportedUnderruns = 0;
+
     QAtomicInteger<bool> m_autoPlay = true;
     QAtomicInteger<bool> m_playing = false;
     QAtomicInt m_loops = 1;
     bool m_loading = false;
+    bool m_decodingFailed = false;
+    bool m_autoPlayPending = false;
 
-    void play() {
-        m_playing = true;
-    }
-    void pause() {
-        m_playing = false;
-    }
-    void stop() {
-        QMutexLocker locker(&mutex);
-        m_playing = false;
-        currentBuffer = 0;
-        bufPos = 0;
-        m_currentLoop = 0;
-    }
+    void play();
+    void pause();
+    void stop();
 
     void load();
+    // Called from the audio thread. Never blocks.
     void getBuffer(float *buf, int frames, int channels);
 
+    // Number of times the audio thread did not find enough data in the ring buffer
+    int underrunCount() const { return m_underruns.loadRelaxed(); }
+
 private Q_SLOTS:
     void bufferReady();
     void finished();
-
+    void sharedDataReady();
+    void decodingFailed();
+    void refill();
+
+private:
+    void rewind();
+    void releaseData();
+    void connectSharedData();
+    void startDecoder();
+    void shareDecoder();
+    void restartStream();
+    void restartDecoder();
+    void readDecodedBuffers();
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,110 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+
+#ifndef QAUDIORINGBUFFER_P_H
+#define QAUDIORINGBUFFER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <qtspatialaudioglobal_p.h>
+#include <qatomic.h>
+
+#include <cstring>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+// Wait-free single producer, single consumer ring buffer of float samples.
+//
+// Exactly one thread may call the producer functions (write(), freeSpace()) and exactly one
+// other thread may call the consumer functions (read(), skip(), available()). Neither side
+// ever blocks or allocates, so the consumer can safely run on the audio thread.
+class QAudioRingBuffer
+{
+public:
+    // The capacity gets rounded up to the next power of two
+    explicit QAudioRingBuffer(int capacity)
+    {
+        int size = 1;
+        while (size < capacity)
+            size *= 2;
+        m_mask = size - 1;
+        m_data.reset(new float[size]);
+    }
+
+    int capacity() const { return m_mask + 1; }
+
+    // Producer side
+    int freeSpace() const
+    {
+        return capacity() - int(m_writePos.loadRelaxed() - m_readPos.loadAcquire());
+    }
+
+    int write(const float *data, int count)
+    {
+        const quint32 writePos = m_writePos.loadRelaxed();
+        count = qMin(count, capacity() - int(writePos - m_readPos.loadAcquire()));
+        copyIn(data, writePos, count);
+        m_writePos.storeRelease(writePos + count);
+        return count;
+    }
+
+    // Consumer side
+    int available() const
+    {
+        return int(m_writePos.loadAcquire() - m_readPos.loadRelaxed());
+    }
+
+    int read(float *data, int count)
+    {
+        const quint32 readPos = m_readPos.loadRelaxed();
+        count = qMin(count, int(m_writePos.loadAcquire() - readPos));
+        copyOut(data, readPos, count);
+        m_readPos.storeRelease(readPos + count);
+        return count;
+    }
+
+    int skip(int count)
+    {
+        const quint32 readPos = m_readPos.loadRelaxed();
+        count = qMin(count, int(m_writePos.loadAcquire() - readPos));
+        m_readPos.storeRelease(readPos + count);
+        return count;
+    }
+
+private:
+    void copyIn(const float *data, quint32 pos, int count)
+    {
+        const int start = int(pos & m_mask);
+        const int first = qMin(count, capacity() - start);
+        memcpy(m_data.get() + start, data, first * sizeof(float));
+        memcpy(m_data.get(), data + first, (count - first) * sizeof(float));
+    }
+
+    void copyOut(float *data, quint32 pos, int count) const
+    {
+        const int start = int(pos & m_mask);
+        const int first = qMin(count, capacity() - start);
+        memcpy(data, m_data.get() + start, first * sizeof(float));
+        memcpy(data + first, m_data.get(), (count - first) * sizeof(float));
+    }
+
+    std::unique_ptr<float[]> m_data;
+    int m_mask = 0;
+    // Free running positions, kept on separate cache lines to avoid false sharing
+    alignas(64) QAtomicInteger<quint32> m_writePos = 0;
+    alignas(64) QAtomicInteger<quint32> m_readPos = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIORINGBUFFER_P_H
@@ -528,6 +528,24 @@ void QSpatialSound::setAutoPlay(bool autoPlay)
         emit autoPlayChanged();
 }
 
+/*!
+    \property QSpatialSound::underrunCount
+    \since 6.7
+
+    Holds the number of times the sound had no audio data ready while it was
+    playing, because decoding did not keep up with playback. Each underrun is
+    audible as a short gap in the sound.
+
+    The time until the first data of the sound has been decoded is not counted.
+    The count is never reset.
+
+    \sa QAudioEngine::underrunCount
+ */
+int QSpatialSound::underrunCount() const
+{
+    return d->underrunCount();
+}
+
 /*!
     Starts playing back the sound. Does nothing if the sound is already playing.
  */
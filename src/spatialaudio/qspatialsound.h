@@ -31,6 +31,7 @@ class Q_SPATIALAUDIO_EXPORT QSpatialSound : public QObject
     Q_PROPERTY(float nearFieldGain READ nearFieldGain WRITE setNearFieldGain NOTIFY nearFieldGainChanged)
     Q_PROPERTY(int loops READ loops WRITE setLoops NOTIFY loopsChanged)
     Q_PROPERTY(bool autoPlay READ autoPlay WRITE setAutoPlay NOTIFY autoPlayChanged)
+    Q_PROPERTY(int underrunCount READ underrunCount NOTIFY underrunCountChanged)
 
 public:
     explicit QSpatialSound(QAudioEngine *engine);
@@ -52,6 +53,8 @@ public:
     bool autoPlay() const;
     void setAutoPlay(bool autoPlay);
 
+    int underrunCount() const;
+
     void setPosition(QVector3D pos);
     QVector3D position() const;
 
@@ -98,6 +101,7 @@ Q_SIGNALS:
     void sourceChanged();
     void loopsChanged();
     void autoPlayChanged();
+    void underrunCountChanged();
     void positionChanged();
     void rotationChanged();
     void volumeChanged();
@@ -31,6 +31,7 @@ QQuick3DAmbientSound::QQuick3DAmbientSound()
     connect(m_sound, &QAmbientSound::volumeChanged, this, &QQuick3DAmbientSound::volumeChanged);
     connect(m_sound, &QAmbientSound::loopsChanged, this, &QQuick3DAmbientSound::loopsChanged);
     connect(m_sound, &QAmbientSound::autoPlayChanged, this, &QQuick3DAmbientSound::autoPlayChanged);
+    connect(m_sound, &QAmbientSound::underrunCountChanged, this, &QQuick3DAmbientSound::underrunCountChanged);
 }
 
 QQuick3DAmbientSound::~QQuick3DAmbientSound()
@@ -112,6 +113,19 @@ void QQuick3DAmbientSound::setAutoPlay(bool autoPlay)
     m_sound->setAutoPlay(autoPlay);
 }
 
+/*!
+    \qmlproperty int AmbientSound::underrunCount
+    \since 6.7
+
+    Holds the number of times the sound had no audio data ready while it was
+    playing. Each underrun is audible as a short gap. The time until the first
+    data of the sound has been decoded is not counted.
+ */
+int QQuick3DAmbientSound::underrunCount() const
+{
+    return m_sound->underrunCount();
+}
+
 /*!
     \qmlmethod AmbientSound::play()
 
@@ -29,6 +29,7 @@ class QQuick3DAmbientSound : public QObject
     Q_PROPERTY(float volume READ volume WRITE setVolume NOTIFY volumeChanged)
     Q_PROPERTY(int loops READ loops WRITE setLoops NOTIFY loopsChanged)
     Q_PROPERTY(bool autoPlay READ autoPlay WRITE setAutoPlay NOTIFY autoPlayChanged)
+    Q_PROPERTY(int underrunCount READ underrunCount NOTIFY underrunCountChanged)
     QML_NAMED_ELEMENT(AmbientSound)
 
 public:
@@ -54,6 +55,8 @@ public:
     bool autoPlay() const;
     void setAutoPlay(bool autoPlay);
 
+    int underrunCount() const;
+
 public Q_SLOTS:
     void play();
     void pause();
@@ -64,6 +67,7 @@ Q_SIGNALS:
     void volumeChanged();
     void loopsChanged();
     void autoPlayChanged();
+    void underrunCountChanged();
 
 private:
     QAmbientSound *m_sound = nullptr;
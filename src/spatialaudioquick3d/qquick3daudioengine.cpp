@@ -47,6 +47,7 @@ QQuick3DAudioEngine::QQuick3DAudioEngine()
     connect(e, &QAudioEngine::outputModeChanged, this, &QQuick3DAudioEngine::outputModeChanged);
     connect(e, &QAudioEngine::outputDeviceChanged, this, &QQuick3DAudioEngine::outputDeviceChanged);
     connect(e, &QAudioEngine::masterVolumeChanged, this, &QQuick3DAudioEngine::masterVolumeChanged);
+    connect(e, &QAudioEngine::underrunCountChanged, this, &QQuick3DAudioEngine::underrunCountChanged);
 }
 
 QQuick3DAudioEngine::~QQuick3DAudioEngine()
@@ -114,6 +115,18 @@ float QQuick3DAudioEngine::masterVolume() const
     return globalEngine->masterVolume();
 }
 
+/*!
+    \qmlproperty int AudioEngine::underrunCount
+    \since 6.7
+
+    Holds the number of times a sound had no audio data ready when the engine
+    rendered it, summed over all sounds. Each underrun is audible as a short gap.
+ */
+int QQuick3DAudioEngine::underrunCount() const
+{
+    return globalEngine->underrunCount();
+}
+
 QAudioEngine *QQuick3DAudioEngine::getEngine()
 {
     if (!globalEngine) {
@@ -29,6 +29,7 @@ class QQuick3DAudioEngine : public QObject
     Q_PROPERTY(OutputMode outputMode READ outputMode WRITE setOutputMode NOTIFY outputModeChanged)
     Q_PROPERTY(QAudioDevice outputDevice READ outputDevice WRITE setOutputDevice NOTIFY outputDeviceChanged)
     Q_PROPERTY(float masterVolume READ masterVolume WRITE setMasterVolume NOTIFY masterVolumeChanged)
+    Q_PROPERTY(int underrunCount READ underrunCount NOTIFY underrunCountChanged)
 
 public:
     // Keep in sync with QAudioEngine::OutputMode
@@ -51,12 +52,15 @@ public:
     void setMasterVolume(float volume);
     float masterVolume() const;
 
+    int underrunCount() const;
+
     static QAudioEngine *getEngine();
 
 Q_SIGNALS:
     void outputModeChanged();
     void outputDeviceChanged();
     void masterVolumeChanged();
+    void underrunCountChanged();
 };
 
 QT_END_NAMESPACE
@@ -44,6 +44,7 @@ QQuick3DSpatialSound::QQuick3DSpatialSound()
     connect(m_sound, &QSpatialSound::nearFieldGainChanged, this, &QQuick3DSpatialSound::nearFieldGainChanged);
     connect(m_sound, &QSpatialSound::loopsChanged, this, &QQuick3DSpatialSound::loopsChanged);
     connect(m_sound, &QSpatialSound::autoPlayChanged, this, &QQuick3DSpatialSound::autoPlayChanged);
+    connect(m_sound, &QSpatialSound::underrunCountChanged, this, &QQuick3DSpatialSound::underrunCountChanged);
 }
 
 QQuick3DSpatialSound::~QQuick3DSpatialSound()
@@ -289,6 +290,19 @@ void QQuick3DSpatialSound::setAutoPlay(bool autoPlay)
     m_sound->setAutoPlay(autoPlay);
 }
 
+/*!
+    \qmlproperty int SpatialSound::underrunCount
+    \since 6.7
+
+    Holds the number of times the sound had no audio data ready while it was
+    playing. Each underrun is audible as a short gap. The time until the first
+    data of the sound has been decoded is not counted.
+ */
+int QQuick3DSpatialSound::underrunCount() const
+{
+    return m_sound->underrunCount();
+}
+
 /*!
     \qmlmethod SpatialSound::play()
 
@@ -36,6 +36,7 @@ class QQuick3DSpatialSound : public QQuick3DNode
     Q_PROPERTY(float nearFieldGain READ nearFieldGain WRITE setNearFieldGain NOTIFY nearFieldGainChanged)
     Q_PROPERTY(int loops READ loops WRITE setLoops NOTIFY loopsChanged)
     Q_PROPERTY(bool autoPlay READ autoPlay WRITE setAutoPlay NOTIFY autoPlayChanged)
+    Q_PROPERTY(int underrunCount READ underrunCount NOTIFY underrunCountChanged)
     QML_NAMED_ELEMENT(SpatialSound)
 
 public:
@@ -92,6 +93,8 @@ public:
     bool autoPlay() const;
     void setAutoPlay(bool autoPlay);
 
+    int underrunCount() const;
+
 public Q_SLOTS:
     void play();
     void pause();
@@ -110,6 +113,7 @@ Q_SIGNALS:
     void nearFieldGainChanged();
     void loopsChanged();
     void autoPlayChanged();
+    void underrunCountChanged();
 
 private Q_SLOTS:
     void updatePosition();
@@ -21,8 +21,11 @@
 //TESTED_COMPONENT=src/multimedia
 
 #include <QtMultimedia/private/qtmultimedia-config_p.h>
+#include <QtMultimedia/private/qmediaplayer_p.h>
+#include <QtMultimedia/private/qplatformmediaplayer_p.h>
 #include "private/qquickvideooutput_p.h"
 
+#include <algorithm>
 #include <array>
 
 QT_USE_NAMESPACE
@@ -84,6 +87,14 @@ private slots:
     void lazyLoadVideo();
     void videoSinkSignals();
     void nonAsciiFileName();
+    void degenerateBufferingPolicies_data();
+    void degenerateBufferingPolicies();
+    void dropsFramesOfStarvedRenderer();
+    void renderingDoesNotWaitForBlockedGuiThread();
+    void keyFrameSeekSnapsToKeyFrame();
+    void repeatedSeeks_data();
+    void repeatedSeeks();
+    void seekAfterEndOfMedia();
 
 private:
     QUrl selectVideoFile(const QStringList& mediaCandidates);
@@ -154,6 +165,28 @@ private:
     bool m_storeFrames;
 };
 
+// Some tests check the behavior of the FFmpeg backend, which other backends don't have
+static bool isFFmpegPlayer(QMediaPlayer &player)
+{
+    auto *d = static_cast<QMediaPlayerPrivate *>(QObjectPrivate::get(&player));
+    auto *control = dynamic_cast<QObject *>(d->control);
+    return control && control->inherits("QFFmpegMediaPlayer");
+}
+
+static bool isGStreamerPlayer(QMediaPlayer &player)
+{
+    auto *d = static_cast<QMediaPlayerPrivate *>(QObjectPrivate::get(&player));
+    auto *control = dynamic_cast<QObject *>(d->control);
+    return control && control->inherits("QGstreamerMediaPlayer");
+}
+
+static bool hasFrameNear(const QList<QVideoFrame> &frames, qint64 position)
+{
+    return std::any_of(frames.begin(), frames.end(), [position](const QVideoFrame &frame) {
+        return frame.isValid() && qAbs(frame.startTime() / 1000 - position) < 500;
+    });
+}
+
 static void setVideoSinkAsyncFramesCounter(QVideoSink &sink, std::atomic_int &counter)
 {
     QObject::connect(&sink, &QVideoSink::videoFrameChanged, [&counter]() { ++counter; });
@@ -2114,6 +2147,238 @@ void tst_QMediaPlayerBackend::nonAsciiFileName()
     QCOMPARE(errorOccurredSpy.size(), 0);
 }
 
+void tst_QMediaPlayerBackend::degenerateBufferingPolicies_data()
+{
+    QTest::addColumn<QMediaBufferingPolicy>("policy");
+
+    QMediaBufferingPolicy noLimits;
+    noLimits.setMaximumDuration(0);
+    noLimits.setMaximumBytes(0);
+    QTest::newRow("no limits") << noLimits;
+
+    QMediaBufferingPolicy zeroWatermarks;
+    zeroWatermarks.setLowWatermark(0.f);
+    zeroWatermarks.setHighWatermark(0.f);
+    QTest::newRow("zero watermarks") << zeroWatermarks;
+
+    QMediaBufferingPolicy tinyBuffer;
+    tinyBuffer.setMaximumDuration(1);
+    tinyBuffer.setMaximumBytes(1);
+    QTest::newRow("tiny buffer") << tinyBuffer;
+}
+
+void tst_QMediaPlayerBackend::degenerateBufferingPolicies()
+{
+    if (localVideoFile3ColorsWithSound.isEmpty())
+        QSKIP("Video format is not supported");
+
+    QFETCH(QMediaBufferingPolicy, policy);
+
+    // None of these policies may stall the player
+    TestVideoSink surface(false);
+    QMediaPlayer player;
+    player.setVideoOutput(&surface);
+    player.setBufferingPolicy(policy);
+    player.setSource(localVideoFile3ColorsWithSound);
+    player.play();
+
+    QTRY_COMPARE_WITH_TIMEOUT(player.mediaStatus(), QMediaPlayer::EndOfMedia, 5000);
+    QCOMPARE(player.error(), QMediaPlayer::NoError);
+}
+
+void tst_QMediaPlayerBackend::dropsFramesOfStarvedRenderer()
+{
+    if (localVideoFile2.isEmpty())
+        QSKIP("Video format is not supported");
+
+    QVideoSink sink;
+    QMediaPlayer player;
+    if (!isFFmpegPlayer(player))
+        QSKIP("Only the FFmpeg backend drops late frames");
+    player.setVideoSink(&sink);
+
+    // Every shown frame blocks the thread that renders video for the duration of a few frames,
+    // so that the following frames are late
+    std::atomic_int shownFrames = 0;
+    connect(
+            &sink, &QVideoSink::videoFrameChanged, &sink,
+            [&shownFrames](const QVideoFrame &frame) {
+                if (!frame.isValid())
+                    return;
+                ++shownFrames;
+                QThread::msleep(100);
+            },
+            Qt::DirectConnection);
+
+    player.setSource(localVideoFile2);
+    QCOMPARE(player.droppedVideoFrames(), qint64(0));
+    player.play();
+
+    QTRY_VERIFY_WITH_TIMEOUT(player.droppedVideoFrames() > 0, 5000);
+    QCOMPARE_GE(player.skippedVideoFrames(), 0);
+
+    // Late frames are still shown now and then, so that the picture keeps moving
+    const int shownBefore = shownFrames;
+    QTRY_VERIFY_WITH_TIMEOUT(shownFrames > shownBefore, 2000);
+    QCOMPARE(player.error(), QMediaPlayer::NoError);
+
+    player.stop();
+}
+
+void tst_QMediaPlayerBackend::renderingDoesNotWaitForBlockedGuiThread()
+{
+    if (localVideoFile2.isEmpty())
+        QSKIP("Video format is not supported");
+
+    QVideoSink sink;
+    QMediaPlayer player;
+    if (!isGStreamerPlayer(player))
+        QSKIP("Only the GStreamer backend hands frames over to the GUI thread while rendering");
+    player.setVideoSink(&sink);
+
+    player.setSource(localVideoFile2);
+    player.play();
+    QTRY_VERIFY(sink.videoFrame().isValid());
+
+    // The frames are shown in the GUI thread. While it's blocked, the streaming thread keeps
+    // rendering frames, which replace the ones that weren't shown yet.
+    const qint64 droppedBefore = player.droppedVideoFrames();
+    QThread::msleep(1000);
+    QCOMPARE_GT(player.droppedVideoFrames(), droppedBefore);
+
+    // The latest frame is shown once the GUI thread is back, and playback goes on
+    const qint64 shownStartTime = sink.videoFrame().startTime();
+    QTRY_VERIFY(sink.videoFrame().startTime() > shownStartTime);
+    QCOMPARE(player.error(), QMediaPlayer::NoError);
+
+    player.stop();
+}
+
+void tst_QMediaPlayerBackend::keyFrameSeekSnapsToKeyFrame()
+{
+    if (localVideoFile2.isEmpty())
+        QSKIP("Video format is not supported");
+
+    TestVideoSink surface;
+    QMediaPlayer player;
+    if (!isFFmpegPlayer(player))
+        QSKIP("Only the FFmpeg backend seeks to key frames");
+    player.setVideoOutput(&surface);
+    player.setSeekMode(QMediaPlayer::KeyFrameSeek);
+
+    player.setSource(localVideoFile2);
+    QTRY_COMPARE(player.mediaStatus(), QMediaPlayer::LoadedMedia);
+    player.pause();
+    QTRY_COMPARE(player.mediaStatus(), QMediaPlayer::BufferedMedia);
+
+    // The key frame is looked up in the demuxer thread, so the position snaps to it later
+    QSignalSpy positionSpy(&player, &QMediaPlayer::positionChanged);
+    surface.m_frameList.clear();
+    player.setPosition(player.duration() / 2);
+    QTRY_VERIFY(positionSpy.count() > 0 && surface.m_frameList.size() > 0
+                && surface.m_frameList.back().isValid());
+    const qint64 keyFrame = player.position();
+
+    // The frame shown is the key frame the position snapped to
+    const qint64 frameTime = surface.m_frameList.back().startTime() / 1000;
+    QVERIFY2(qAbs(frameTime - keyFrame) <= 1, QByteArray::number(frameTime - keyFrame));
+
+    // Any position just after a key frame snaps back to it, where an accurate seek wouldn't
+    player.setPosition(keyFrame + 10);
+    QTRY_COMPARE(player.position(), keyFrame);
+
+    player.setSeekMode(QMediaPlayer::AccurateSeek);
+    player.setPosition(keyFrame + 10);
+    QCOMPARE(player.position(), keyFrame + 10);
+    QCOMPARE(player.error(), QMediaPlayer::NoError);
+}
+
+void tst_QMediaPlayerBackend::repeatedSeeks_data()
+{
+    QTest::addColumn<QMediaPlayer::PlaybackState>("state");
+
+    QTest::newRow("playing") << QMediaPlayer::PlayingState;
+    QTest::newRow("paused") << QMediaPlayer::PausedState;
+}
+
+void tst_QMediaPlayerBackend::repeatedSeeks()
+{
+    if (localVideoFile3ColorsWithSound.isEmpty())
+        QSKIP("Video format is not supported");
+
+    QFETCH(QMediaPlayer::PlaybackState, state);
+
+    TestVideoSink surface;
+    QAudioOutput output;
+    QMediaPlayer player;
+    if (!isFFmpegPlayer(player))
+        QSKIP("Only the FFmpeg backend seeks the playback objects in place");
+    player.setVideoOutput(&surface);
+    player.setAudioOutput(&output);
+
+    player.setSource(localVideoFile3ColorsWithSound);
+    QTRY_COMPARE(player.mediaStatus(), QMediaPlayer::LoadedMedia);
+    if (state == QMediaPlayer::PlayingState)
+        player.play();
+    else
+        player.pause();
+    QTRY_COMPARE(player.mediaStatus(), QMediaPlayer::BufferedMedia);
+
+    // Each seek drops what the previous one queued, before anything of it is shown
+    const qint64 duration = player.duration();
+    for (int i = 0; i < 20; ++i)
+        player.setPosition((i * 7 % 10) * duration / 10);
+
+    const qint64 position = duration / 2;
+    surface.m_frameList.clear();
+    player.setPosition(position);
+    QCOMPARE(player.position(), position);
+
+    // Frames of the earlier seeks may still be on their way to the sink
+    QTRY_VERIFY(hasFrameNear(surface.m_frameList, position));
+
+    if (state == QMediaPlayer::PlayingState)
+        QTRY_VERIFY(player.position() > position + 100);
+    else
+        QCOMPARE(player.position(), position);
+
+    QCOMPARE(player.playbackState(), state);
+    QCOMPARE(player.error(), QMediaPlayer::NoError);
+}
+
+void tst_QMediaPlayerBackend::seekAfterEndOfMedia()
+{
+    if (localVideoFile3ColorsWithSound.isEmpty())
+        QSKIP("Video format is not supported");
+
+    TestVideoSink surface;
+    QAudioOutput output;
+    QMediaPlayer player;
+    if (!isFFmpegPlayer(player))
+        QSKIP("Only the FFmpeg backend ends the stream with a marker in the channels");
+    player.setVideoOutput(&surface);
+    player.setAudioOutput(&output);
+
+    player.setSource(localVideoFile3ColorsWithSound);
+    player.play();
+    QTRY_COMPARE_WITH_TIMEOUT(player.mediaStatus(), QMediaPlayer::EndOfMedia, 10000);
+
+    // The end of the previous playback must not end the playback from the new position
+    for (int i = 0; i < 2; ++i) {
+        const qint64 position = player.duration() / 2;
+        player.setPosition(position);
+        QTRY_COMPARE(player.mediaStatus(), QMediaPlayer::LoadedMedia);
+
+        surface.m_frameList.clear();
+        player.play();
+        QTRY_VERIFY(hasFrameNear(surface.m_frameList, position));
+
+        QTRY_COMPARE_WITH_TIMEOUT(player.mediaStatus(), QMediaPlayer::EndOfMedia, 10000);
+        QCOMPARE(player.position(), player.duration());
+        QCOMPARE(player.error(), QMediaPlayer::NoError);
+    }
+}
+
 QTEST_MAIN(tst_QMediaPlayerBackend)
 #include "tst_qmediaplayerbackend.moc"
 
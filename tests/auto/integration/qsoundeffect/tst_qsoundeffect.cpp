@@ -9,6 +9,7 @@
 #include <qaudio.h>
 #include "qsoundeffect.h"
 #include "qmediadevices.h"
+#include <private/qsoundeffect_p.h>
 
 class tst_QSoundEffect : public QObject
 {
@@ -38,6 +39,7 @@ private slots:
     void testSupportedMimeTypes_data();
     void testSupportedMimeTypes();
     void testCorruptFile();
+    void testPreload();
 
 private:
     QSoundEffect* sound;
@@ -393,6 +395,31 @@ void tst_QSoundEffect::testCorruptFile()
     }
 }
 
+void tst_QSoundEffect::testPreload()
+{
+    // test.wav under a URL that the other tests didn't load into the shared cache
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("preloaded.wav"));
+    QVERIFY(QFile::copy(url.toLocalFile(), fileName));
+    const QUrl preloaded = QUrl::fromLocalFile(fileName);
+
+    QSampleCache *cache = QSoundEffectSampleCache::instance();
+    const QSampleCache::Statistics before = cache->statistics();
+
+    QSoundEffect::preload({ preloaded });
+    QTRY_VERIFY(!cache->isLoading());
+    QVERIFY(cache->isCached(preloaded));
+    QCOMPARE(cache->statistics().misses, before.misses + 1);
+
+    // The effect takes the loaded sample over
+    QSoundEffect effect;
+    effect.setSource(preloaded);
+    QCOMPARE(effect.status(), QSoundEffect::Ready);
+    QCOMPARE(cache->statistics().hits, before.hits + 1);
+    QCOMPARE(cache->statistics().misses, before.misses + 1);
+}
+
 QTEST_MAIN(tst_QSoundEffect)
 
 #include "tst_qsoundeffect.moc"
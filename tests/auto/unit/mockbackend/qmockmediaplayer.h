@@ -59,6 +59,9 @@ public:
         bufferProgressChanged(status);
     }
 
+    qint64 droppedVideoFrames() const override { return _droppedVideoFrames; }
+    qint64 skippedVideoFrames() const override { return _skippedVideoFrames; }
+
     bool isAudioAvailable() const override { return _audioAvailable; }
     bool isVideoAvailable() const override { return _videoAvailable; }
 
@@ -129,6 +132,8 @@ public:
         _duration = 0;
         _position = 0;
         _bufferProgress = 0;
+        _droppedVideoFrames = 0;
+        _skippedVideoFrames = 0;
         _videoAvailable = false;
         _isSeekable = false;
         _playbackRate = 0.0;
@@ -144,6 +149,8 @@ public:
     qint64 _duration;
     qint64 _position;
     float _bufferProgress;
+    qint64 _droppedVideoFrames = 0;
+    qint64 _skippedVideoFrames = 0;
     bool _audioAvailable;
     bool _videoAvailable;
     bool _isSeekable;
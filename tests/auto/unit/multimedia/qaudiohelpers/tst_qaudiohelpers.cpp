@@ -0,0 +1,269 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <private/qaudiohelpers_p.h>
+
+#include <limits>
+#include <vector>
+
+using namespace QAudioHelperInternal;
+
+// Longer than the widest vector and not a multiple of it, so that both the vectorized
+// code and the scalar code for the leftover samples run
+static constexpr int SampleCount = 71;
+
+template<typename T>
+static std::vector<T> testSamples()
+{
+    constexpr qint64 min = std::numeric_limits<T>::min();
+    constexpr qint64 max = std::numeric_limits<T>::max();
+
+    // The extremes, values around zero, where rounding is easy to get wrong, and the rest
+    std::vector<T> samples = { T(min), T(max), T(0), T(1), T(-1), T(2), T(-2), T(3), T(-3) };
+    for (int i = int(samples.size()); i < SampleCount; ++i)
+        samples.push_back(T(min + (max - min) / SampleCount * i + i % 7));
+    return samples;
+}
+
+static QAudioFormat audioFormat(QAudioFormat::SampleFormat sampleFormat)
+{
+    QAudioFormat format;
+    format.setSampleFormat(sampleFormat);
+    format.setSampleRate(48000);
+    format.setChannelCount(1);
+    return format;
+}
+
+class tst_QAudioHelpers : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void multiplyInt16_data();
+    void multiplyInt16();
+    void multiplyInt32_data();
+    void multiplyInt32();
+    void multiplyFloat();
+    void accumulateFloat_data();
+    void accumulateFloat();
+    void saturation_data();
+    void saturation();
+    void ramp_data();
+    void ramp();
+};
+
+void tst_QAudioHelpers::multiplyInt16_data()
+{
+    QTest::addColumn<qreal>("factor");
+
+    QTest::newRow("0") << 0.;
+    QTest::newRow("0.5") << 0.5;
+    QTest::newRow("0.3") << 0.3;
+    QTest::newRow("0.999") << 0.999;
+}
+
+void tst_QAudioHelpers::multiplyInt16()
+{
+    QFETCH(qreal, factor);
+
+    const std::vector<qint16> src = testSamples<qint16>();
+    std::vector<qint16> dst(src.size());
+    qMultiplySamples(factor, audioFormat(QAudioFormat::Int16), src.data(), dst.data(),
+                     int(src.size() * sizeof(qint16)));
+
+    // Q15, rounded to nearest with ties towards positive infinity
+    const int gain = qRound(factor * (1 << 15));
+    for (size_t i = 0; i < src.size(); ++i)
+        QCOMPARE(dst[i], qint16((int(src[i]) * gain + (1 << 14)) >> 15));
+}
+
+void tst_QAudioHelpers::multiplyInt32_data()
+{
+    multiplyInt16_data();
+}
+
+void tst_QAudioHelpers::multiplyInt32()
+{
+    QFETCH(qreal, factor);
+
+    const std::vector<qint32> src = testSamples<qint32>();
+    std::vector<qint32> dst(src.size());
+    qMultiplySamples(factor, audioFormat(QAudioFormat::Int32), src.data(), dst.data(),
+                     int(src.size() * sizeof(qint32)));
+
+    // Q31, rounded to nearest with ties towards positive infinity
+    const qint64 gain = qRound64(factor * (Q_INT64_C(1) << 31));
+    for (size_t i = 0; i < src.size(); ++i)
+        QCOMPARE(dst[i], qint32((qint64(src[i]) * gain + (Q_INT64_C(1) << 30)) >> 31));
+}
+
+void tst_QAudioHelpers::multiplyFloat()
+{
+    std::vector<float> src;
+    for (int i = 0; i < SampleCount; ++i)
+        src.push_back(float(i - SampleCount / 2) / SampleCount);
+
+    std::vector<float> dst(src.size());
+    qMultiplySamples(0.25, audioFormat(QAudioFormat::Float), src.data(), dst.data(),
+                     int(src.size() * sizeof(float)));
+
+    for (size_t i = 0; i < src.size(); ++i)
+        QCOMPARE(dst[i], src[i] * 0.25f);
+}
+
+void tst_QAudioHelpers::accumulateFloat_data()
+{
+    QTest::addColumn<float>("gain");
+    QTest::addColumn<int>("offset");
+
+    // Offsets that leave the vectors unaligned, and all the remainders of the scalar code
+    for (const float gain : { 0.f, 0.25f, 1.f, 1.7f }) {
+        for (int offset = 0; offset < 8; ++offset)
+            QTest::addRow("gain %g, offset %d", gain, offset) << gain << offset;
+    }
+}
+
+void tst_QAudioHelpers::accumulateFloat()
+{
+    QFETCH(float, gain);
+    QFETCH(int, offset);
+
+    std::vector<float> src;
+    std::vector<float> dst;
+    for (int i = 0; i < SampleCount; ++i) {
+        src.push_back(float(i - SampleCount / 2) / SampleCount);
+        dst.push_back(float(i % 5) / 4 - 0.5f);
+    }
+
+    // The SIMD code must give what the scalar code would, and leave the rest alone
+    std::vector<float> expected = dst;
+    const int samples = SampleCount - offset - 3;
+    for (int i = offset; i < offset + samples; ++i)
+        expected[i] += src[i] * gain;
+
+    qAccumulateSamplesFloat(gain, src.data() + offset, dst.data() + offset, samples);
+
+    for (int i = 0; i < SampleCount; ++i)
+        QVERIFY2(qAbs(dst[i] - expected[i]) <= 1e-6f, qPrintable(QString::number(i)));
+}
+
+void tst_QAudioHelpers::saturation_data()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("sampleFormat");
+    QTest::addColumn<qint64>("sample");
+    QTest::addColumn<qreal>("factor");
+    QTest::addColumn<qint64>("expected");
+
+    QTest::newRow("UInt8 positive") << QAudioFormat::UInt8 << 200ll << 2. << 255ll;
+    QTest::newRow("UInt8 negative") << QAudioFormat::UInt8 << 50ll << 2. << 0ll;
+    QTest::newRow("Int16 positive") << QAudioFormat::Int16 << 30000ll << 1.5 << 32767ll;
+    QTest::newRow("Int16 negative") << QAudioFormat::Int16 << -30000ll << 1.5 << -32768ll;
+    QTest::newRow("Int16 unity") << QAudioFormat::Int16 << -32768ll << 1. << -32768ll;
+    QTest::newRow("Int16 in range") << QAudioFormat::Int16 << 1000ll << 4. << 4000ll;
+    QTest::newRow("Int32 positive") << QAudioFormat::Int32 << 2000000000ll << 1.5
+                                    << 2147483647ll;
+    QTest::newRow("Int32 negative") << QAudioFormat::Int32 << -2000000000ll << 1.5
+                                    << -2147483648ll;
+    QTest::newRow("Int32 unity") << QAudioFormat::Int32 << 2147483647ll << 1. << 2147483647ll;
+}
+
+void tst_QAudioHelpers::saturation()
+{
+    QFETCH(QAudioFormat::SampleFormat, sampleFormat);
+    QFETCH(qint64, sample);
+    QFETCH(qreal, factor);
+    QFETCH(qint64, expected);
+
+    const QAudioFormat format = audioFormat(sampleFormat);
+    QByteArray src(format.bytesPerSample() * SampleCount, Qt::Uninitialized);
+    for (int i = 0; i < SampleCount; ++i) {
+        switch (sampleFormat) {
+        case QAudioFormat::UInt8:
+            reinterpret_cast<quint8 *>(src.data())[i] = quint8(sample);
+            break;
+        case QAudioFormat::Int16:
+            reinterpret_cast<qint16 *>(src.data())[i] = qint16(sample);
+            break;
+        default:
+            reinterpret_cast<qint32 *>(src.data())[i] = qint32(sample);
+            break;
+        }
+    }
+
+    QByteArray dst(src.size(), Qt::Uninitialized);
+    qMultiplySamples(factor, format, src.constData(), dst.data(), int(src.size()));
+
+    for (int i = 0; i < SampleCount; ++i) {
+        switch (sampleFormat) {
+        case QAudioFormat::UInt8:
+            QCOMPARE(qint64(reinterpret_cast<const quint8 *>(dst.constData())[i]), expected);
+            break;
+        case QAudioFormat::Int16:
+            QCOMPARE(qint64(reinterpret_cast<const qint16 *>(dst.constData())[i]), expected);
+            break;
+        default:
+            QCOMPARE(qint64(reinterpret_cast<const qint32 *>(dst.constData())[i]), expected);
+            break;
+        }
+    }
+}
+
+void tst_QAudioHelpers::ramp_data()
+{
+    QTest::addColumn<qreal>("startFactor");
+    QTest::addColumn<qreal>("endFactor");
+
+    QTest::newRow("fade in") << 0. << 1.;
+    QTest::newRow("fade out") << 1. << 0.;
+    QTest::newRow("up") << 0.25 << 0.75;
+    QTest::newRow("down") << 0.75 << 0.25;
+}
+
+void tst_QAudioHelpers::ramp()
+{
+    QFETCH(qreal, startFactor);
+    QFETCH(qreal, endFactor);
+
+    // Stereo, to check that both channels of a frame get the same gain
+    QAudioFormat format = audioFormat(QAudioFormat::Int16);
+    format.setChannelCount(2);
+    const int rampFrames = format.framesForDuration(5000);
+    const int frames = rampFrames * 2 + 3;
+
+    constexpr qint16 Amplitude = 16000;
+    const std::vector<qint16> src(frames * 2, Amplitude);
+    std::vector<qint16> dst(src.size());
+    qMultiplySamples(startFactor, endFactor, format, src.data(), dst.data(),
+                     int(src.size() * sizeof(qint16)));
+
+    const bool rising = endFactor > startFactor;
+    const int startValue = qRound(Amplitude * startFactor);
+    const int endValue = qRound(Amplitude * endFactor);
+    for (int frame = 0; frame < frames; ++frame) {
+        const qint16 left = dst[2 * frame];
+        const qint16 right = dst[2 * frame + 1];
+        QCOMPARE(left, right);
+
+        if (frame >= rampFrames - 1) {
+            // The ramp ends at the end factor, and it's kept from there on
+            QVERIFY2(qAbs(left - endValue) <= 1, qPrintable(QString::number(frame)));
+            continue;
+        }
+
+        // Moves from the start to the end factor without overshooting either, and the
+        // first frame doesn't jump far from the start factor
+        QVERIFY(rising ? left >= startValue - 1 && left <= endValue + 1
+                       : left <= startValue + 1 && left >= endValue - 1);
+        if (frame > 0) {
+            const qint16 previous = dst[2 * (frame - 1)];
+            QVERIFY(rising ? left >= previous : left <= previous);
+        } else {
+            QVERIFY(qAbs(left - startValue) <= qAbs(endValue - startValue) / 8);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_QAudioHelpers)
+
+#include "tst_qaudiohelpers.moc"
@@ -73,6 +73,10 @@ private slots:
     void testSignalShutterSpeedChanged();
     void testSignalFlashReady();
 
+    void testDroppedFrames();
+    void testFrameBufferCount();
+    void testDecodingThreadCount();
+
 private:
     QMockIntegrationFactory mockIntegrationFactory;
 };
@@ -838,6 +842,69 @@ void tst_QCamera::testSignalFlashReady()
     QCOMPARE(spyflashReady.size(), 1);
 }
 
+void tst_QCamera::testDroppedFrames()
+{
+    QMediaCaptureSession session;
+    QCamera camera;
+    session.setCamera(&camera);
+    QMockCamera *mock = QMockIntegration::instance()->lastCamera();
+
+    QCOMPARE(camera.droppedFrames(), qint64(0));
+
+    QSignalSpy spy(&camera, &QCamera::droppedFramesChanged);
+    mock->droppedFramesChanged(3);
+    QCOMPARE(camera.droppedFrames(), qint64(3));
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(spy.at(0).at(0).value<qint64>(), qint64(3));
+
+    mock->droppedFramesChanged(3);
+    QCOMPARE(spy.size(), 1);
+}
+
+void tst_QCamera::testFrameBufferCount()
+{
+    QMediaCaptureSession session;
+    QCamera camera;
+    session.setCamera(&camera);
+    QMockCamera *mock = QMockIntegration::instance()->lastCamera();
+
+    QCOMPARE(camera.frameBufferCount(), -1);
+
+    QSignalSpy spy(&camera, &QCamera::frameBufferCountChanged);
+    camera.setFrameBufferCount(8);
+    QCOMPARE(camera.frameBufferCount(), 8);
+    QCOMPARE(mock->frameBufferCount(), 8);
+    QCOMPARE(spy.size(), 1);
+
+    camera.setFrameBufferCount(8);
+    QCOMPARE(spy.size(), 1);
+
+    // Values below 1 let the backend choose
+    camera.setFrameBufferCount(0);
+    QCOMPARE(camera.frameBufferCount(), -1);
+    QCOMPARE(spy.size(), 2);
+}
+
+void tst_QCamera::testDecodingThreadCount()
+{
+    QMediaCaptureSession session;
+    QCamera camera;
+    session.setCamera(&camera);
+    QMockCamera *mock = QMockIntegration::instance()->lastCamera();
+
+    QCOMPARE(camera.decodingThreadCount(), -1);
+
+    QSignalSpy spy(&camera, &QCamera::decodingThreadCountChanged);
+    camera.setDecodingThreadCount(2);
+    QCOMPARE(camera.decodingThreadCount(), 2);
+    QCOMPARE(mock->decodingThreadCount(), 2);
+    QCOMPARE(spy.size(), 1);
+
+    camera.setDecodingThreadCount(-5);
+    QCOMPARE(camera.decodingThreadCount(), -1);
+    QCOMPARE(spy.size(), 2);
+}
+
 QTEST_MAIN(tst_QCamera)
 
 #include "tst_qcamera.moc"
@@ -0,0 +1,247 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <qaudiobuffer.h>
+
+#include "playbackengine/qffmpegaudiotimestretcher_p.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace QFFmpeg;
+
+class tst_QFFmpegAudioTimeStretcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void durationMatchesRate_data();
+    void durationMatchesRate();
+    void pitchIsPreserved_data();
+    void pitchIsPreserved();
+    void rateOneIsPassThrough();
+    void startTimeFollowsConsumedInput_data();
+    void startTimeFollowsConsumedInput();
+    void resetDropsBufferedInput();
+
+private:
+    static QAudioFormat format(QAudioFormat::SampleFormat sampleFormat);
+    static std::vector<float> stretch(AudioTimeStretcher &stretcher, const QAudioFormat &format,
+                                      int frames, float frequency);
+};
+
+static constexpr int SampleRate = 48000;
+static constexpr int Channels = 2;
+static constexpr int ChunkFrames = 1024;
+
+QAudioFormat tst_QFFmpegAudioTimeStretcher::format(QAudioFormat::SampleFormat sampleFormat)
+{
+    QAudioFormat format;
+    format.setSampleFormat(sampleFormat);
+    format.setSampleRate(SampleRate);
+    format.setChannelConfig(QAudioFormat::ChannelConfigStereo);
+    return format;
+}
+
+// Feeds a sine of frames frames through the stretcher in chunks, as the audio renderer
+// does, and returns the left channel of the output as float
+std::vector<float> tst_QFFmpegAudioTimeStretcher::stretch(AudioTimeStretcher &stretcher,
+                                                          const QAudioFormat &format,
+                                                          int frames, float frequency)
+{
+    std::vector<float> output;
+    const auto append = [&](const QAudioBuffer &buffer) {
+        if (!buffer.isValid())
+            return;
+        const int bytesPerSample = format.bytesPerSample();
+        const char *data = buffer.constData<char>();
+        for (int i = 0; i < buffer.frameCount(); ++i)
+            output.push_back(format.normalizedSampleValue(data + i * Channels * bytesPerSample));
+    };
+
+    for (int offset = 0; offset < frames; offset += ChunkFrames) {
+        const int n = qMin(ChunkFrames, frames - offset);
+        QByteArray data(format.bytesForFrames(n), Qt::Uninitialized);
+        for (int i = 0; i < n; ++i) {
+            const float value =
+                    0.5f * float(std::sin(2. * M_PI * frequency * (offset + i) / SampleRate));
+            for (int c = 0; c < Channels; ++c) {
+                const int sample = i * Channels + c;
+                if (format.sampleFormat() == QAudioFormat::Int16)
+                    reinterpret_cast<qint16 *>(data.data())[sample] = qint16(value * 32767);
+                else
+                    reinterpret_cast<float *>(data.data())[sample] = value;
+            }
+        }
+        append(stretcher.process(QAudioBuffer(data, format, offset * 1000000ll / SampleRate)));
+    }
+    append(stretcher.flush());
+    return output;
+}
+
+// The frequency of the strongest component between 100 Hz and 2 kHz, in 1 Hz steps
+static double dominantFrequency(const float *samples, int count)
+{
+    double best = 0.;
+    double bestPower = -1.;
+    for (int frequency = 100; frequency <= 2000; ++frequency) {
+        // Goertzel
+        const double coefficient = 2. * std::cos(2. * M_PI * frequency / SampleRate);
+        double s1 = 0., s2 = 0.;
+        for (int i = 0; i < count; ++i) {
+            const double s0 = samples[i] + coefficient * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        const double power = s1 * s1 + s2 * s2 - coefficient * s1 * s2;
+        if (power > bestPower) {
+            bestPower = power;
+            best = frequency;
+        }
+    }
+    return best;
+}
+
+void tst_QFFmpegAudioTimeStretcher::durationMatchesRate_data()
+{
+    QTest::addColumn<float>("rate");
+    QTest::addColumn<int>("sampleFormat");
+
+    for (const float rate : { 0.5f, 1.f, 2.f }) {
+        QTest::addRow("%.1fx float", rate) << rate << int(QAudioFormat::Float);
+        QTest::addRow("%.1fx int16", rate) << rate << int(QAudioFormat::Int16);
+    }
+}
+
+void tst_QFFmpegAudioTimeStretcher::durationMatchesRate()
+{
+    QFETCH(float, rate);
+    QFETCH(int, sampleFormat);
+
+    const QAudioFormat f = format(QAudioFormat::SampleFormat(sampleFormat));
+    AudioTimeStretcher stretcher(f);
+    stretcher.setPlaybackRate(rate);
+
+    const int inputFrames = 2 * SampleRate;
+    const std::vector<float> output = stretch(stretcher, f, inputFrames, 440.f);
+
+    // The windows are taken at the playback rate, so the end of the stream may be off
+    // by up to two windows of 20 ms
+    const double expected = inputFrames / rate;
+    QVERIFY2(std::abs(double(output.size()) - expected) <= SampleRate / 25.,
+             qPrintable(QStringLiteral("%1 frames instead of %2").arg(output.size()).arg(expected)));
+}
+
+void tst_QFFmpegAudioTimeStretcher::pitchIsPreserved_data()
+{
+    QTest::addColumn<float>("rate");
+    QTest::addColumn<float>("frequency");
+
+    for (const float rate : { 0.5f, 1.f, 2.f }) {
+        QTest::addRow("%.1fx 220 Hz", rate) << rate << 220.f;
+        QTest::addRow("%.1fx 440 Hz", rate) << rate << 440.f;
+        QTest::addRow("%.1fx 1000 Hz", rate) << rate << 1000.f;
+    }
+}
+
+void tst_QFFmpegAudioTimeStretcher::pitchIsPreserved()
+{
+    QFETCH(float, rate);
+    QFETCH(float, frequency);
+
+    const QAudioFormat f = format(QAudioFormat::Float);
+    AudioTimeStretcher stretcher(f);
+    stretcher.setPlaybackRate(rate);
+
+    const std::vector<float> output = stretch(stretcher, f, 2 * SampleRate, frequency);
+    QCOMPARE_GT(output.size(), size_t(SampleRate / 2));
+
+    // Analyze half a second from the middle of the output. Plain resampling would move
+    // the frequency by the playback rate.
+    const int analyzed = SampleRate / 2;
+    const double measured =
+            dominantFrequency(output.data() + (output.size() - analyzed) / 2, analyzed);
+    QVERIFY2(std::abs(measured - frequency) <= frequency * 0.01,
+             qPrintable(QStringLiteral("measured %1 Hz").arg(measured)));
+}
+
+void tst_QFFmpegAudioTimeStretcher::rateOneIsPassThrough()
+{
+    const QAudioFormat f = format(QAudioFormat::Int16);
+    AudioTimeStretcher stretcher(f);
+
+    QByteArray data(f.bytesForFrames(ChunkFrames), 0x12);
+    const QAudioBuffer buffer(data, f, 1000);
+    const QAudioBuffer output = stretcher.process(buffer);
+    QCOMPARE(output.byteCount(), buffer.byteCount());
+    QCOMPARE(output.constData<qint16>(), buffer.constData<qint16>());
+    QVERIFY(stretcher.delay() == std::chrono::microseconds(0));
+}
+
+void tst_QFFmpegAudioTimeStretcher::startTimeFollowsConsumedInput_data()
+{
+    QTest::addColumn<float>("rate");
+
+    QTest::addRow("0.5x") << 0.5f;
+    QTest::addRow("2.0x") << 2.f;
+}
+
+void tst_QFFmpegAudioTimeStretcher::startTimeFollowsConsumedInput()
+{
+    QFETCH(float, rate);
+
+    const QAudioFormat f = format(QAudioFormat::Float);
+    AudioTimeStretcher stretcher(f);
+    stretcher.setPlaybackRate(rate);
+
+    // The input starts at 1 s. At a constant rate, every output buffer starts where
+    // the previous one ended on the stretched timeline.
+    constexpr qint64 InputStartTime = 1000000;
+    qint64 outputFrames = 0;
+    int outputBuffers = 0;
+    const auto check = [&](const QAudioBuffer &buffer) {
+        if (!buffer.isValid())
+            return;
+        const qint64 expected = qint64(InputStartTime / rate) + f.durationForFrames(outputFrames);
+        QVERIFY2(std::abs(buffer.startTime() - expected) <= 100,
+                 qPrintable(QStringLiteral("start time %1, expected %2")
+                                    .arg(buffer.startTime())
+                                    .arg(expected)));
+        outputFrames += buffer.frameCount();
+        ++outputBuffers;
+    };
+
+    QByteArray data(f.bytesForFrames(ChunkFrames), 0);
+    for (int chunk = 0; chunk < 50; ++chunk) {
+        const qint64 startTime = InputStartTime + f.durationForFrames(chunk * ChunkFrames);
+        check(stretcher.process(QAudioBuffer(data, f, startTime)));
+    }
+    check(stretcher.flush());
+    QVERIFY(outputBuffers > 10);
+}
+
+void tst_QFFmpegAudioTimeStretcher::resetDropsBufferedInput()
+{
+    const QAudioFormat f = format(QAudioFormat::Float);
+    AudioTimeStretcher stretcher(f);
+    stretcher.setPlaybackRate(2.f);
+
+    // Less than a window, which the stretcher holds back
+    QByteArray data(f.bytesForFrames(ChunkFrames / 4), 0);
+    QVERIFY(!stretcher.process(QAudioBuffer(data, f, 0)).isValid());
+    QVERIFY(stretcher.delay() > std::chrono::microseconds(0));
+
+    stretcher.reset();
+    QVERIFY(stretcher.delay() == std::chrono::microseconds(0));
+    QVERIFY(!stretcher.flush().isValid());
+    QCOMPARE(stretcher.playbackRate(), 2.f);
+
+    // Stretching starts over as with a new stretcher
+    const std::vector<float> output = stretch(stretcher, f, SampleRate, 440.f);
+    QVERIFY(std::abs(double(output.size()) - SampleRate / 2.) <= SampleRate / 25.);
+}
+
+QTEST_APPLESS_MAIN(tst_QFFmpegAudioTimeStretcher)
+
+#include "tst_qffmpegaudiotimestretcher.moc"
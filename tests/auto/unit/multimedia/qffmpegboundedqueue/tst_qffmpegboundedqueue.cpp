@@ -0,0 +1,164 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "qffmpegboundedqueue_p.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace QFFmpeg;
+
+class tst_QFFmpegBoundedQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void pushAndPopInOrder();
+    void rejectsWhenFullOrEmpty();
+    void releasesPoppedValues();
+    void deliversEveryItemOnce_data();
+    void deliversEveryItemOnce();
+};
+
+void tst_QFFmpegBoundedQueue::pushAndPopInOrder()
+{
+    BoundedQueue<int> queue(4);
+
+    // Several laps over the cells
+    for (int i = 0; i < 20; ++i) {
+        QVERIFY(queue.tryPush(i));
+        QVERIFY(queue.tryPush(i + 100));
+        QCOMPARE(queue.size(), size_t(2));
+
+        int value = -1;
+        QVERIFY(queue.tryPop(value));
+        QCOMPARE(value, i);
+        QVERIFY(queue.tryPop(value));
+        QCOMPARE(value, i + 100);
+        QVERIFY(queue.isEmpty());
+    }
+}
+
+void tst_QFFmpegBoundedQueue::rejectsWhenFullOrEmpty()
+{
+    BoundedQueue<int> queue(3);
+    QCOMPARE(queue.capacity(), size_t(3));
+
+    int value = -1;
+    QVERIFY(!queue.tryPop(value));
+    QCOMPARE(value, -1);
+
+    for (int i = 0; i < 3; ++i)
+        QVERIFY(queue.tryPush(i));
+    QVERIFY(queue.isFull());
+    QVERIFY(!queue.tryPush(3));
+
+    QVERIFY(queue.tryPop(value));
+    QCOMPARE(value, 0);
+    QVERIFY(!queue.isFull());
+    QVERIFY(queue.tryPush(3));
+}
+
+void tst_QFFmpegBoundedQueue::releasesPoppedValues()
+{
+    BoundedQueue<std::shared_ptr<int>> queue(2);
+    auto data = std::make_shared<int>(42);
+
+    QVERIFY(queue.tryPush(data));
+    QCOMPARE(data.use_count(), 2);
+
+    std::shared_ptr<int> popped;
+    QVERIFY(queue.tryPop(popped));
+    QCOMPARE(data.use_count(), 2);
+    popped.reset();
+    QCOMPARE(data.use_count(), 1);
+
+    // A failed push of an rvalue leaves the value alone
+    QVERIFY(queue.tryPush(std::make_shared<int>(1)));
+    QVERIFY(queue.tryPush(std::make_shared<int>(2)));
+    auto rejected = std::make_shared<int>(3);
+    QVERIFY(!queue.tryPush(std::move(rejected)));
+    QVERIFY(rejected);
+}
+
+void tst_QFFmpegBoundedQueue::deliversEveryItemOnce_data()
+{
+    QTest::addColumn<int>("producers");
+    QTest::addColumn<int>("consumers");
+    QTest::addColumn<int>("capacity");
+
+    QTest::newRow("1 to 1") << 1 << 1 << 8;
+    QTest::newRow("4 to 1") << 4 << 1 << 8;
+    QTest::newRow("1 to 4") << 1 << 4 << 8;
+    QTest::newRow("4 to 4, small") << 4 << 4 << 2;
+    QTest::newRow("8 to 3") << 8 << 3 << 64;
+}
+
+// Every item is pushed by exactly one producer and has to be popped by exactly one consumer.
+// The items of a producer stay in order, which each consumer can check for what it gets.
+void tst_QFFmpegBoundedQueue::deliversEveryItemOnce()
+{
+    QFETCH(int, producers);
+    QFETCH(int, consumers);
+    QFETCH(int, capacity);
+
+    constexpr int ItemsPerProducer = 20000;
+    const int totalItems = producers * ItemsPerProducer;
+
+    BoundedQueue<int> queue(capacity);
+    std::vector<std::atomic<int>> received(totalItems);
+    std::atomic<int> poppedItems = 0;
+    std::atomic<int> orderViolations = 0;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (int i = 0; i < ItemsPerProducer; ++i) {
+                while (!queue.tryPush(p * ItemsPerProducer + i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, producers] {
+            std::vector<int> lastOfProducer(producers, -1);
+            while (poppedItems.load() < totalItems) {
+                int item = -1;
+                if (!queue.tryPop(item)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                ++poppedItems;
+                if (item < 0 || item >= totalItems) {
+                    ++orderViolations;
+                    continue;
+                }
+                ++received[item];
+                int &last = lastOfProducer[item / ItemsPerProducer];
+                if (item <= last)
+                    ++orderViolations;
+                last = item;
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    QCOMPARE(poppedItems.load(), totalItems);
+    QCOMPARE(orderViolations.load(), 0);
+    for (int item = 0; item < totalItems; ++item) {
+        if (received[item].load() != 1)
+            QFAIL(qPrintable(QStringLiteral("Item %1 was received %2 times")
+                                     .arg(item)
+                                     .arg(received[item].load())));
+    }
+    QVERIFY(queue.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(tst_QFFmpegBoundedQueue)
+
+#include "tst_qffmpegboundedqueue.moc"
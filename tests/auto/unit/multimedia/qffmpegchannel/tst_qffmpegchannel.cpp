@@ -0,0 +1,166 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "playbackengine/qffmpegchannel_p.h"
+
+using namespace QFFmpeg;
+
+namespace {
+
+// Counts the wake-ups a channel sends to it
+class WakeCounter : public PlaybackEngineObject
+{
+public:
+    int wakeCount = 0;
+
+protected:
+    void onWake() override { ++wakeCount; }
+};
+
+} // namespace
+
+class tst_QFFmpegChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void pushWakesWaitingConsumer();
+    void flushWakesWaitingConsumer();
+    void flushKeepsOrder();
+    void acknowledgeWakesWaitingProducer();
+    void isFullAtLimit();
+};
+
+void tst_QFFmpegChannel::pushWakesWaitingConsumer()
+{
+    WakeCounter producer;
+    WakeCounter consumer;
+    Channel<int> channel(producer, 2);
+    channel.setConsumer(consumer);
+
+    channel.push(1);
+    QCoreApplication::processEvents();
+    QCOMPARE(consumer.wakeCount, 0);
+
+    int item = 0;
+    QVERIFY(channel.pop(item));
+    QVERIFY(!channel.pop(item));
+    channel.requestConsumerWake();
+    QVERIFY(!channel.pop(item));
+
+    channel.push(2);
+    QTRY_COMPARE(consumer.wakeCount, 1);
+    QCOMPARE(producer.wakeCount, 0);
+}
+
+void tst_QFFmpegChannel::flushWakesWaitingConsumer()
+{
+    WakeCounter producer;
+    WakeCounter consumer;
+    Channel<int> channel(producer, 2);
+    channel.setConsumer(consumer);
+
+    // Past the limit; the last items wait in the producer's thread
+    for (int i = 0; i < 4; ++i)
+        channel.push(i);
+    QVERIFY(channel.isFull());
+
+    int item = -1;
+    QVERIFY(channel.pop(item));
+    QVERIFY(channel.pop(item));
+    channel.acknowledge();
+    channel.acknowledge();
+
+    // The consumer ran out of items and asks to be woken up
+    QVERIFY(!channel.pop(item));
+    channel.requestConsumerWake();
+    QVERIFY(!channel.pop(item));
+    QCoreApplication::processEvents();
+    QCOMPARE(consumer.wakeCount, 0);
+
+    channel.flush();
+    QTRY_COMPARE(consumer.wakeCount, 1);
+
+    QVERIFY(channel.pop(item));
+    QCOMPARE(item, 2);
+
+    // Nothing left to move, and the wake-up was consumed
+    channel.flush();
+    QCoreApplication::processEvents();
+    QCOMPARE(consumer.wakeCount, 1);
+}
+
+void tst_QFFmpegChannel::flushKeepsOrder()
+{
+    WakeCounter producer;
+    WakeCounter consumer;
+    Channel<int> channel(producer, 3);
+    channel.setConsumer(consumer);
+
+    constexpr int ItemCount = 20;
+    int next = 0;
+    for (int i = 0; i < ItemCount; ++i)
+        channel.push(i);
+
+    int item = -1;
+    while (next < ItemCount) {
+        channel.flush();
+        QVERIFY(channel.pop(item));
+        QCOMPARE(item, next++);
+        channel.acknowledge();
+    }
+    QVERIFY(!channel.pop(item));
+    QCOMPARE(channel.takeAcknowledged(), qint64(ItemCount));
+    QVERIFY(!channel.isFull());
+}
+
+void tst_QFFmpegChannel::acknowledgeWakesWaitingProducer()
+{
+    WakeCounter producer;
+    WakeCounter consumer;
+    Channel<int> channel(producer, 2);
+    channel.setConsumer(consumer);
+
+    channel.push(1);
+    channel.push(2);
+    QVERIFY(channel.isFull());
+    channel.requestProducerWake();
+
+    int item = 0;
+    QVERIFY(channel.pop(item));
+    channel.acknowledge();
+    QTRY_COMPARE(producer.wakeCount, 1);
+    QCOMPARE(channel.takeAcknowledged(), qint64(1));
+    QVERIFY(!channel.isFull());
+
+    // Only the first acknowledgement after a request wakes the producer
+    QVERIFY(channel.pop(item));
+    channel.acknowledge();
+    QCoreApplication::processEvents();
+    QCOMPARE(producer.wakeCount, 1);
+}
+
+void tst_QFFmpegChannel::isFullAtLimit()
+{
+    WakeCounter producer;
+    Channel<int> channel(producer, 3);
+
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(!channel.isFull());
+        channel.push(i);
+    }
+    QVERIFY(channel.isFull());
+
+    // Popped items still count until they are acknowledged
+    int item = -1;
+    QVERIFY(channel.pop(item));
+    QVERIFY(channel.isFull());
+    channel.acknowledge();
+    QVERIFY(!channel.isFull());
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegChannel)
+
+#include "tst_qffmpegchannel.moc"
@@ -0,0 +1,192 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "qffmpegrecyclingpool_p.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace QFFmpeg;
+
+namespace {
+
+struct Item
+{
+    int id = 0;
+};
+
+using Pool = RecyclingPool<Item>;
+
+} // namespace
+
+class tst_QFFmpegRecyclingPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void reusesReleasedItems();
+    void limitsItemsInUse();
+    void failedCreationIsNotCounted();
+    void resetRetiresItemsInUse();
+    void resetCountsItemsOfOldGenerations();
+    void closeDropsItemsInUse();
+    void releasesFromOtherThreads();
+};
+
+void tst_QFFmpegRecyclingPool::reusesReleasedItems()
+{
+    Pool pool(2);
+    int created = 0;
+    auto create = [&]() { return std::make_unique<Item>(Item{ ++created }); };
+
+    auto item = pool.acquire(create);
+    QVERIFY(item);
+    QCOMPARE(item->id, 1);
+    QCOMPARE(pool.inUse(), 1);
+
+    pool.release(std::move(item), pool.generation());
+    QCOMPARE(pool.inUse(), 0);
+
+    item = pool.acquire(create);
+    QVERIFY(item);
+    QCOMPARE(item->id, 1);
+    QCOMPARE(created, 1);
+    QCOMPARE(pool.inUse(), 1);
+}
+
+void tst_QFFmpegRecyclingPool::limitsItemsInUse()
+{
+    Pool pool(2);
+    auto create = []() { return std::make_unique<Item>(); };
+
+    auto first = pool.acquire(create);
+    auto second = pool.acquire(create);
+    QVERIFY(first);
+    QVERIFY(second);
+    QVERIFY(!pool.acquire(create));
+    QCOMPARE(pool.inUse(), 2);
+
+    pool.release(std::move(first), pool.generation());
+    QVERIFY(pool.acquire(create));
+}
+
+void tst_QFFmpegRecyclingPool::failedCreationIsNotCounted()
+{
+    Pool pool(1);
+
+    QVERIFY(!pool.acquire([]() { return Pool::Ptr(); }));
+    QCOMPARE(pool.inUse(), 0);
+    QVERIFY(pool.acquire([]() { return std::make_unique<Item>(); }));
+}
+
+void tst_QFFmpegRecyclingPool::resetRetiresItemsInUse()
+{
+    Pool pool(4);
+    int created = 0;
+    auto create = [&]() { return std::make_unique<Item>(Item{ ++created }); };
+
+    auto inUse = pool.acquire(create);
+    auto free = pool.acquire(create);
+    const quint64 oldGeneration = pool.generation();
+    pool.release(std::move(free), oldGeneration);
+
+    // The free item of the old generation goes back to the owner
+    const auto freed = pool.reset();
+    QCOMPARE(freed.size(), size_t(1));
+    QCOMPARE(freed.front()->id, 2);
+    QVERIFY(pool.generation() != oldGeneration);
+
+    // The item in use is retired on release, and isn't handed out again
+    pool.release(std::move(inUse), oldGeneration);
+    const auto retired = pool.takeRetired();
+    QCOMPARE(retired.size(), size_t(1));
+    QCOMPARE(retired.front()->id, 1);
+    QVERIFY(pool.takeRetired().empty());
+
+    auto item = pool.acquire(create);
+    QVERIFY(item);
+    QCOMPARE(item->id, 3);
+}
+
+void tst_QFFmpegRecyclingPool::resetCountsItemsOfOldGenerations()
+{
+    Pool pool(2);
+    auto create = []() { return std::make_unique<Item>(); };
+
+    auto first = pool.acquire(create);
+    auto second = pool.acquire(create);
+    const quint64 oldGeneration = pool.generation();
+
+    // The items of the old generation still count against the limit
+    QVERIFY(pool.reset().empty());
+    QCOMPARE(pool.inUse(), 2);
+    QVERIFY(!pool.acquire(create));
+
+    pool.release(std::move(first), oldGeneration);
+    QCOMPARE(pool.inUse(), 1);
+    auto third = pool.acquire(create);
+    QVERIFY(third);
+    QVERIFY(!pool.acquire(create));
+
+    pool.release(std::move(second), oldGeneration);
+    pool.release(std::move(third), pool.generation());
+    QCOMPARE(pool.inUse(), 0);
+    QCOMPARE(pool.takeRetired().size(), size_t(2));
+}
+
+void tst_QFFmpegRecyclingPool::closeDropsItemsInUse()
+{
+    Pool pool(4);
+    auto create = []() { return std::make_unique<Item>(); };
+
+    auto inUse = pool.acquire(create);
+    auto free = pool.acquire(create);
+    auto retired = pool.acquire(create);
+    const quint64 oldGeneration = pool.generation();
+    pool.release(std::move(retired), oldGeneration - 1);
+    pool.release(std::move(free), oldGeneration);
+
+    QCOMPARE(pool.close().size(), size_t(2));
+
+    pool.release(std::move(inUse), oldGeneration);
+    QCOMPARE(pool.inUse(), 0);
+    QVERIFY(pool.takeRetired().empty());
+}
+
+void tst_QFFmpegRecyclingPool::releasesFromOtherThreads()
+{
+    constexpr int MaxInUse = 4;
+    constexpr int Rounds = 1000;
+
+    Pool pool(MaxInUse);
+    auto create = []() { return std::make_unique<Item>(); };
+
+    for (int round = 0; round < Rounds; ++round) {
+        std::vector<Pool::Ptr> items;
+        while (auto item = pool.acquire(create))
+            items.push_back(std::move(item));
+        QCOMPARE(items.size(), size_t(MaxInUse));
+
+        const quint64 generation = pool.generation();
+        if (round % 10 == 0)
+            pool.reset();
+
+        std::vector<std::thread> threads;
+        for (auto &item : items) {
+            threads.emplace_back([&pool, generation, item = std::move(item)]() mutable {
+                pool.release(std::move(item), generation);
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+
+        QCOMPARE(pool.inUse(), 0);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_QFFmpegRecyclingPool)
+
+#include "tst_qffmpegrecyclingpool.moc"
@@ -0,0 +1,195 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "qffmpegswsframeconverter_p.h"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <thread>
+#include <vector>
+
+using namespace QFFmpeg;
+
+class tst_QFFmpegSwsFrameConverter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void reusesPooledFrames();
+    void followsSizeAndFormatChanges();
+    void keepsFramesAliveAfterChanges();
+    void convertsConcurrently();
+};
+
+// A frame with a different gradient in every plane
+static AVFrameUPtr sourceFrame(AVPixelFormat format, int width, int height, int seed = 0)
+{
+    auto frame = makeAVFrame();
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    if (av_frame_get_buffer(frame.get(), 0) < 0)
+        return {};
+
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    for (int plane = 0; plane < 4 && frame->data[plane]; ++plane) {
+        const bool isChroma = plane == 1 || plane == 2;
+        const int rows = isChroma ? AV_CEIL_RSHIFT(height, desc->log2_chroma_h) : height;
+        const int bytes = av_image_get_linesize(format, width, plane);
+        for (int y = 0; y < rows; ++y) {
+            uint8_t *line = frame->data[plane] + y * frame->linesize[plane];
+            for (int x = 0; x < bytes; ++x)
+                line[x] = uint8_t(16 + (x * (plane + 1) + y * 3 + seed) % 220);
+        }
+    }
+    return frame;
+}
+
+// Compares the visible pixels of two frames, ignoring the padding
+static bool samePixels(const AVFrame *a, const AVFrame *b)
+{
+    if (a->format != b->format || a->width != b->width || a->height != b->height)
+        return false;
+
+    const auto format = AVPixelFormat(a->format);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    for (int plane = 0; plane < 4 && a->data[plane]; ++plane) {
+        const bool isChroma = plane == 1 || plane == 2;
+        const int rows = isChroma ? AV_CEIL_RSHIFT(a->height, desc->log2_chroma_h) : a->height;
+        const int bytes = av_image_get_linesize(format, a->width, plane);
+        for (int y = 0; y < rows; ++y) {
+            if (memcmp(a->data[plane] + y * a->linesize[plane],
+                       b->data[plane] + y * b->linesize[plane], bytes)
+                != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+// The expected result, from a converter that has never seen another format
+static AVFrameUPtr reference(const AVFrame *frame, AVPixelFormat targetFormat)
+{
+    SwsFrameConverter converter;
+    return converter.convert(frame, targetFormat);
+}
+
+void tst_QFFmpegSwsFrameConverter::reusesPooledFrames()
+{
+    SwsFrameConverter converter;
+    auto source = sourceFrame(AV_PIX_FMT_YUV420P, 64, 48);
+    QVERIFY(source);
+
+    auto first = converter.convert(source.get(), AV_PIX_FMT_RGBA);
+    QVERIFY(first);
+    const uint8_t *buffer = first->buf[0]->data;
+    first.reset();
+
+    // The buffer of a released frame is handed out again
+    auto second = converter.convert(source.get(), AV_PIX_FMT_RGBA);
+    QVERIFY(second);
+    QCOMPARE(static_cast<const void *>(second->buf[0]->data), static_cast<const void *>(buffer));
+
+    // While it is still referenced, another buffer is used
+    auto third = converter.convert(source.get(), AV_PIX_FMT_RGBA);
+    QVERIFY(third);
+    QVERIFY(third->buf[0]->data != buffer);
+    QVERIFY(samePixels(second.get(), third.get()));
+}
+
+void tst_QFFmpegSwsFrameConverter::followsSizeAndFormatChanges()
+{
+    const struct {
+        AVPixelFormat source;
+        int width;
+        int height;
+        AVPixelFormat target;
+    } steps[] = {
+        { AV_PIX_FMT_YUV420P, 64, 48, AV_PIX_FMT_RGBA },
+        { AV_PIX_FMT_YUV420P, 64, 48, AV_PIX_FMT_RGBA },
+        { AV_PIX_FMT_YUV420P, 37, 21, AV_PIX_FMT_RGBA },
+        { AV_PIX_FMT_NV12, 37, 22, AV_PIX_FMT_RGBA },
+        { AV_PIX_FMT_NV12, 37, 22, AV_PIX_FMT_BGRA },
+        { AV_PIX_FMT_RGBA, 37, 22, AV_PIX_FMT_YUV420P },
+        { AV_PIX_FMT_YUV420P, 64, 48, AV_PIX_FMT_RGBA },
+    };
+
+    SwsFrameConverter converter;
+    int index = 0;
+    for (const auto &step : steps) {
+        auto source = sourceFrame(step.source, step.width, step.height, index);
+        QVERIFY(source);
+
+        auto converted = converter.convert(source.get(), step.target);
+        QVERIFY2(converted, qPrintable(QString::number(index)));
+        QCOMPARE(converted->format, int(step.target));
+        QCOMPARE(converted->width, step.width);
+        QCOMPARE(converted->height, step.height);
+
+        auto expected = reference(source.get(), step.target);
+        QVERIFY(expected);
+        QVERIFY2(samePixels(converted.get(), expected.get()),
+                 qPrintable(QStringLiteral("step %1").arg(index)));
+        ++index;
+    }
+}
+
+void tst_QFFmpegSwsFrameConverter::keepsFramesAliveAfterChanges()
+{
+    auto source = sourceFrame(AV_PIX_FMT_YUV420P, 64, 48);
+    auto expected = reference(source.get(), AV_PIX_FMT_RGBA);
+
+    AVFrameUPtr kept;
+    {
+        SwsFrameConverter converter;
+        kept = converter.convert(source.get(), AV_PIX_FMT_RGBA);
+        QVERIFY(kept);
+
+        // Replaces the pool while kept still uses a buffer of the old one
+        auto other = sourceFrame(AV_PIX_FMT_YUV420P, 32, 32);
+        QVERIFY(converter.convert(other.get(), AV_PIX_FMT_BGRA));
+    }
+
+    QVERIFY(samePixels(kept.get(), expected.get()));
+}
+
+void tst_QFFmpegSwsFrameConverter::convertsConcurrently()
+{
+    constexpr int Threads = 4;
+    constexpr int Iterations = 50;
+
+    AVFrameUPtr sources[Threads];
+    AVFrameUPtr expected[Threads];
+    for (int i = 0; i < Threads; ++i) {
+        // Every thread converts frames of another size, which changes the pool a lot
+        sources[i] = sourceFrame(AV_PIX_FMT_YUV420P, 32 + 16 * i, 24 + 8 * i, i);
+        expected[i] = reference(sources[i].get(), AV_PIX_FMT_RGBA);
+        QVERIFY(expected[i]);
+    }
+
+    SwsFrameConverter converter;
+    std::atomic<int> mismatches = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < Threads; ++i) {
+        threads.emplace_back([&, i]() {
+            for (int n = 0; n < Iterations; ++n) {
+                auto converted = converter.convert(sources[i].get(), AV_PIX_FMT_RGBA);
+                if (!converted || !samePixels(converted.get(), expected[i].get()))
+                    ++mismatches;
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    QCOMPARE(mismatches.load(), 0);
+}
+
+QTEST_APPLESS_MAIN(tst_QFFmpegSwsFrameConverter)
+
+#include "tst_qffmpegswsframeconverter.moc"
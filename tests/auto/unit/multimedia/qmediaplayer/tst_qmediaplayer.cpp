@@ -75,6 +75,11 @@ private slots:
     void testSeekable();
     void testPlaybackRate_data();
     void testPlaybackRate();
+    void testBufferingPolicy();
+    void testBufferingPolicyFill();
+    void testBufferingPolicyWatermarks();
+    void testLateVideoFrames();
+    void testSeekMode();
     void testError_data();
     void testError();
     void testErrorString_data();
@@ -450,6 +455,101 @@ void tst_QMediaPlayer::testPlaybackRate()
     }
 }
 
+void tst_QMediaPlayer::testBufferingPolicy()
+{
+    QCOMPARE(player->bufferingPolicy(), QMediaBufferingPolicy());
+    QCOMPARE(player->bufferedDuration(), qint64(0));
+    QCOMPARE(player->bufferedBytes(), qint64(0));
+
+    QMediaBufferingPolicy policy;
+    policy.setMaximumDuration(10000);
+    policy.setMaximumBytes(1 << 20);
+    policy.setLowWatermark(0.5f);
+
+    QSignalSpy spy(player, &QMediaPlayer::bufferingPolicyChanged);
+    player->setBufferingPolicy(policy);
+    QCOMPARE(player->bufferingPolicy(), policy);
+    QCOMPARE(mockPlayer->bufferingPolicy(), policy);
+    QCOMPARE(spy.size(), 1);
+
+    player->setBufferingPolicy(policy);
+    QCOMPARE(spy.size(), 1);
+}
+
+void tst_QMediaPlayer::testBufferingPolicyFill()
+{
+    QMediaBufferingPolicy policy;
+    QCOMPARE(policy.maximumDuration(), qint64(4000));
+    QCOMPARE(policy.maximumBytes(), qint64(0));
+    QCOMPARE(policy.fill(2000, 1 << 30), 0.5f);
+
+    policy.setMaximumBytes(1000);
+    QCOMPARE(policy.fill(2000, 750), 0.75f);
+    QCOMPARE(policy.fill(2000, 250), 0.5f);
+
+    policy.setMaximumDuration(0);
+    QCOMPARE(policy.fill(1000000, 250), 0.25f);
+
+    policy.setMaximumBytes(0);
+    QCOMPARE(policy.fill(1000000, 1000000), 0.f);
+}
+
+void tst_QMediaPlayer::testBufferingPolicyWatermarks()
+{
+    QMediaBufferingPolicy policy;
+    QCOMPARE(policy.lowWatermark(), 0.75f);
+    QCOMPARE(policy.highWatermark(), 1.f);
+
+    policy.setHighWatermark(2.f);
+    QCOMPARE(policy.highWatermark(), 1.f);
+
+    // A low watermark of 0 or less would never let reading resume
+    policy.setLowWatermark(0.f);
+    QCOMPARE_GT(policy.lowWatermark(), 0.f);
+    QVERIFY(policy.fill(0, 0) < policy.lowWatermark());
+    policy.setLowWatermark(-1.f);
+    QCOMPARE_GT(policy.lowWatermark(), 0.f);
+
+    // A high watermark of 0 or less would stop reading before anything is buffered
+    policy.setHighWatermark(0.f);
+    QCOMPARE_GT(policy.highWatermark(), 0.f);
+    QCOMPARE_LE(policy.lowWatermark(), policy.highWatermark());
+
+    // The watermarks push each other to keep low <= high
+    policy.setHighWatermark(0.5f);
+    policy.setLowWatermark(0.8f);
+    QCOMPARE(policy.lowWatermark(), 0.8f);
+    QCOMPARE(policy.highWatermark(), 0.8f);
+    policy.setHighWatermark(0.25f);
+    QCOMPARE(policy.lowWatermark(), 0.25f);
+    QCOMPARE(policy.highWatermark(), 0.25f);
+}
+
+void tst_QMediaPlayer::testLateVideoFrames()
+{
+    QCOMPARE(player->droppedVideoFrames(), qint64(0));
+    QCOMPARE(player->skippedVideoFrames(), qint64(0));
+
+    mockPlayer->_droppedVideoFrames = 12;
+    mockPlayer->_skippedVideoFrames = 34;
+    QCOMPARE(player->droppedVideoFrames(), qint64(12));
+    QCOMPARE(player->skippedVideoFrames(), qint64(34));
+}
+
+void tst_QMediaPlayer::testSeekMode()
+{
+    QCOMPARE(player->seekMode(), QMediaPlayer::AccurateSeek);
+
+    QSignalSpy spy(player, &QMediaPlayer::seekModeChanged);
+    player->setSeekMode(QMediaPlayer::KeyFrameSeek);
+    QCOMPARE(player->seekMode(), QMediaPlayer::KeyFrameSeek);
+    QCOMPARE(mockPlayer->seekMode(), QMediaPlayer::KeyFrameSeek);
+    QCOMPARE(spy.size(), 1);
+
+    player->setSeekMode(QMediaPlayer::KeyFrameSeek);
+    QCOMPARE(spy.size(), 1);
+}
+
 void tst_QMediaPlayer::testError_data()
 {
     setupCommonTestData();
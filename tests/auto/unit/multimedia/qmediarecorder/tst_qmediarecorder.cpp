@@ -40,6 +40,9 @@ private slots:
     void testAudioSettings();
     void testVideoSettings();
     void testSettingsApplied();
+    void testEncodingQueueDepth();
+    void testDroppedFrames();
+    void testEncodingThreadCount();
 
     void metaData();
 
@@ -376,6 +379,83 @@ void tst_QMediaRecorder::testSettingsApplied()
     encoder.stop();
 }
 
+void tst_QMediaRecorder::testEncodingQueueDepth()
+{
+    QMediaCaptureSession session;
+    QMediaRecorder recorder;
+    session.setRecorder(&recorder);
+    auto *mockControl = QMockIntegration::instance()->lastCaptureService()->mockControl;
+
+    QCOMPARE(recorder.encodingQueueDepth(), -1);
+
+    QSignalSpy spy(&recorder, &QMediaRecorder::encodingQueueDepthChanged);
+    recorder.setEncodingQueueDepth(30);
+    QCOMPARE(recorder.encodingQueueDepth(), 30);
+    QCOMPARE(spy.size(), 1);
+
+    recorder.setEncodingQueueDepth(30);
+    QCOMPARE(spy.size(), 1);
+
+    recorder.record();
+    QCOMPARE(mockControl->m_settings.encodingQueueDepth(), 30);
+    recorder.stop();
+}
+
+void tst_QMediaRecorder::testDroppedFrames()
+{
+    QMediaCaptureSession session;
+    QMediaRecorder recorder;
+    session.setRecorder(&recorder);
+    auto *mockControl = QMockIntegration::instance()->lastCaptureService()->mockControl;
+
+    QCOMPARE(recorder.droppedFrames(), qint64(0));
+
+    QSignalSpy spy(&recorder, &QMediaRecorder::droppedFramesChanged);
+    mockControl->droppedFramesChanged(3);
+    QCOMPARE(recorder.droppedFrames(), qint64(3));
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(spy.front().front().value<qint64>(), qint64(3));
+
+    mockControl->droppedFramesChanged(3);
+    QCOMPARE(spy.size(), 1);
+
+    QMediaRecorder unboundRecorder;
+    QCOMPARE(unboundRecorder.droppedFrames(), qint64(0));
+}
+
+void tst_QMediaRecorder::testEncodingThreadCount()
+{
+    QMediaCaptureSession session;
+    QMediaRecorder recorder;
+    session.setRecorder(&recorder);
+    auto *mockControl = QMockIntegration::instance()->lastCaptureService()->mockControl;
+
+    QCOMPARE(recorder.encodingThreadCount(), -1);
+
+    QSignalSpy spy(&recorder, &QMediaRecorder::encodingThreadCountChanged);
+    recorder.setEncodingThreadCount(4);
+    QCOMPARE(recorder.encodingThreadCount(), 4);
+    QCOMPARE(spy.size(), 1);
+
+    recorder.setEncodingThreadCount(4);
+    QCOMPARE(spy.size(), 1);
+
+    QCOMPARE(recorder.encodingThreadType(), QMediaRecorder::AutomaticThreading);
+
+    QSignalSpy typeSpy(&recorder, &QMediaRecorder::encodingThreadTypeChanged);
+    recorder.setEncodingThreadType(QMediaRecorder::SliceThreading);
+    QCOMPARE(recorder.encodingThreadType(), QMediaRecorder::SliceThreading);
+    QCOMPARE(typeSpy.size(), 1);
+
+    recorder.setEncodingThreadType(QMediaRecorder::SliceThreading);
+    QCOMPARE(typeSpy.size(), 1);
+
+    recorder.record();
+    QCOMPARE(mockControl->m_settings.encodingThreadCount(), 4);
+    QCOMPARE(mockControl->m_settings.encodingThreadType(), QMediaRecorder::SliceThreading);
+    recorder.stop();
+}
+
 void tst_QMediaRecorder::metaData()
 {
     QMediaCaptureSession session;
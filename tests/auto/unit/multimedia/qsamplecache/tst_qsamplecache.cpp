@@ -5,6 +5,8 @@
 
 #include <QtTest/QtTest>
 #include <private/qsamplecache_p.h>
+#include <QtMultimedia/qaudiodecoder.h>
+#include <qwavedecoder.h>
 
 class tst_QSampleCache : public QObject
 {
@@ -19,6 +21,13 @@ private slots:
     void testEnoughCapacity();
     void testNotEnoughCapacity();
     void testInvalidFile();
+    void testLeastRecentlyUsedEviction();
+    void testStatistics();
+    void testPreload();
+    void testCompressedFile();
+    void testMappedFile_data();
+    void testMappedFile();
+    void testTruncatedFile();
 
 private:
 
@@ -141,6 +150,198 @@ void tst_QSampleCache::testInvalidFile()
     QVERIFY(!cache.isCached(QUrl::fromLocalFile("invalid")));
 }
 
+void tst_QSampleCache::testLeastRecentlyUsedEviction()
+{
+    const QUrl url1 = QUrl::fromLocalFile(QFINDTESTDATA("testdata/test.wav"));
+    const QUrl url2 = QUrl::fromLocalFile(QFINDTESTDATA("testdata/test2.wav"));
+    // A third sample of the same size: test.wav under another URL
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName3 = dir.filePath(QStringLiteral("test3.wav"));
+    QVERIFY(QFile::copy(url1.toLocalFile(), fileName3));
+    const QUrl url3 = QUrl::fromLocalFile(fileName3);
+
+    QSampleCache cache;
+
+    QSample* sample = cache.requestSample(url1);
+    QTRY_VERIFY(!cache.isLoading());
+    const qint64 sampleSize = sample->data().size();
+    sample->release();
+    cache.setCapacity(sampleSize * 2); // room for two of the samples
+
+    auto load = [&](const QUrl &url) {
+        QSample *loaded = cache.requestSample(url);
+        QTRY_VERIFY(!cache.isLoading());
+        QCOMPARE(loaded->state(), QSample::Ready);
+        loaded->release();
+    };
+
+    load(url1);
+    load(url2);
+    // Use the first sample again, so that the second one is the least recently used
+    load(url1);
+
+    load(url3);
+
+    QVERIFY(cache.isCached(url1));
+    QVERIFY(!cache.isCached(url2));
+    QVERIFY(cache.isCached(url3));
+    QCOMPARE(cache.statistics().evictions, qint64(1));
+}
+
+void tst_QSampleCache::testStatistics()
+{
+    const QUrl url = QUrl::fromLocalFile(QFINDTESTDATA("testdata/test.wav"));
+
+    QSampleCache cache;
+
+    QSample* sample = cache.requestSample(url);
+    QTRY_VERIFY(!cache.isLoading());
+    QSample* sampleCached = cache.requestSample(url);
+    QTRY_VERIFY(!cache.isLoading());
+
+    QSampleCache::Statistics statistics = cache.statistics();
+    QCOMPARE(statistics.misses, qint64(1));
+    QCOMPARE(statistics.hits, qint64(1));
+    QCOMPARE(statistics.samples, qsizetype(1));
+    QCOMPARE(statistics.usage, qint64(sample->data().size()));
+
+    sample->release();
+    sampleCached->release();
+
+    statistics = cache.statistics();
+    QCOMPARE(statistics.samples, qsizetype(0));
+    QCOMPARE(statistics.usage, qint64(0));
+}
+
+void tst_QSampleCache::testPreload()
+{
+    const QUrl url1 = QUrl::fromLocalFile(QFINDTESTDATA("testdata/test.wav"));
+    const QUrl url2 = QUrl::fromLocalFile(QFINDTESTDATA("testdata/test2.wav"));
+
+    QSampleCache cache;
+
+    cache.preload({ url1, url2 });
+    QTRY_VERIFY(!cache.isLoading());
+    QVERIFY(cache.isCached(url1));
+    QVERIFY(cache.isCached(url2));
+
+    // Ready right away
+    QSample* sample = cache.requestSample(url1);
+    QCOMPARE(sample->state(), QSample::Ready);
+    QCOMPARE(cache.statistics().hits, qint64(1));
+    QCOMPARE(cache.statistics().misses, qint64(0));
+
+    // The request took the reference of the preload over
+    sample->release();
+    QVERIFY(!cache.isCached(url1));
+    QVERIFY(cache.isCached(url2));
+}
+
+void tst_QSampleCache::testCompressedFile()
+{
+    if (!QAudioDecoder().isSupported())
+        QSKIP("The media backend can't decode audio");
+
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Int16);
+    format.setChannelCount(2);
+    format.setSampleRate(44100);
+
+    QSampleCache cache;
+    cache.setDecodingFormat(format);
+
+    QSample* sample = cache.requestSample(QUrl::fromLocalFile(QFINDTESTDATA("testdata/nokia-tune.mp3")));
+    QVERIFY(sample);
+    QTRY_VERIFY_WITH_TIMEOUT(sample->state() == QSample::Ready || sample->state() == QSample::Error,
+                             10000);
+    if (sample->state() == QSample::Error) {
+        sample->release();
+        QSKIP("The media backend can't decode MP3");
+    }
+
+    QCOMPARE(sample->format(), format);
+    QVERIFY(!sample->data().isEmpty());
+    QCOMPARE(sample->data().size() % format.bytesPerFrame(), 0);
+    QCOMPARE(cache.statistics().usage, qint64(sample->data().size()));
+
+    sample->release();
+}
+
+void tst_QSampleCache::testMappedFile_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<bool>("mapped");
+
+    QTest::newRow("16 bit") << QStringLiteral("testdata/test.wav") << true;
+    QTest::newRow("list chunk before data") << QStringLiteral("testdata/list_chunk.wav") << true;
+    // Samples that don't have the byte order of the host are swapped, so they're copied
+    QTest::newRow("big endian") << QStringLiteral("testdata/big_endian.wav")
+                                << (QSysInfo::ByteOrder == QSysInfo::BigEndian);
+    // 24 bit samples are converted to 16 bit
+    QTest::newRow("24 bit") << QStringLiteral("testdata/24bit.wav") << false;
+}
+
+void tst_QSampleCache::testMappedFile()
+{
+    QFETCH(QString, fileName);
+    QFETCH(bool, mapped);
+
+    const QString path = QFINDTESTDATA(fileName);
+    QVERIFY(!path.isEmpty());
+
+    // The samples as QWaveDecoder reads them
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QWaveDecoder decoder(&file);
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+    QVERIFY(decoder.size() > 0);
+    const QByteArray expected = decoder.read(decoder.size());
+    QCOMPARE(qint64(expected.size()), decoder.size());
+
+    QSampleCache cache;
+
+    QSample* sample = cache.requestSample(QUrl::fromLocalFile(path));
+    QVERIFY(sample);
+    QTRY_VERIFY(!cache.isLoading());
+    QCOMPARE(sample->state(), QSample::Ready);
+
+    QCOMPARE(sample->format(), decoder.audioFormat());
+    QCOMPARE(sample->data(), expected);
+    // Mapped samples are raw data, which the array shares with the file instead of owning it
+    QCOMPARE(!sample->data().isDetached(), mapped);
+    QCOMPARE(cache.statistics().usage, qint64(expected.size()));
+
+    sample->release();
+}
+
+void tst_QSampleCache::testTruncatedFile()
+{
+    QFile source(QFINDTESTDATA("testdata/test.wav"));
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    const QByteArray data = source.readAll();
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile truncated(dir.filePath("truncated.wav"));
+    QVERIFY(truncated.open(QIODevice::WriteOnly));
+    truncated.write(data.left(data.size() - 100));
+    truncated.close();
+
+    QSampleCache cache;
+
+    QSample* sample = cache.requestSample(QUrl::fromLocalFile(truncated.fileName()));
+    QVERIFY(sample);
+    QTRY_VERIFY(!cache.isLoading());
+    QCOMPARE(sample->state(), QSample::Ready);
+    QVERIFY(sample->data().size() > 0);
+    // The cache charges what it keeps, not the size from the header
+    QCOMPARE(cache.statistics().usage, qint64(sample->data().size()));
+
+    sample->release();
+    QCOMPARE(cache.statistics().usage, qint64(0));
+}
+
 QTEST_MAIN(tst_QSampleCache)
 
 #include "tst_qsamplecache.moc"
@@ -0,0 +1,233 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <private/qsoundeffectmixer_p.h>
+
+#include <utility>
+#include <vector>
+
+using Notifications = QList<std::pair<quint64, bool>>;
+
+static QAudioFormat audioFormat(QAudioFormat::SampleFormat sampleFormat, int sampleRate,
+                                int channels)
+{
+    QAudioFormat format;
+    format.setSampleFormat(sampleFormat);
+    format.setSampleRate(sampleRate);
+    format.setChannelCount(channels);
+    return format;
+}
+
+// Pulls frames from a mixer without an output, as its sink would
+static std::vector<float> pull(QSoundEffectMixer &mixer, qsizetype frames)
+{
+    std::vector<float> samples(frames * mixer.format().channelCount());
+    const qint64 bytes = qint64(samples.size() * sizeof(float));
+    if (mixer.mix(reinterpret_cast<char *>(samples.data()), bytes) != bytes)
+        return {};
+    return samples;
+}
+
+// A voice together with the notifications it received
+class Voice
+{
+public:
+    explicit Voice(float gain = 1.f)
+        : voice(std::make_shared<QSoundEffectVoice>(
+                &receiver, [this](quint64 playId, bool finished) {
+                    notifications.append({ playId, finished });
+                }))
+    {
+        voice->setGain(gain);
+    }
+
+    ~Voice() { voice->detach(); }
+
+    QObject receiver;
+    Notifications notifications;
+    const std::shared_ptr<QSoundEffectVoice> voice;
+};
+
+class tst_QSoundEffectMixer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void convertResamples();
+    void convertMapsChannels_data();
+    void convertMapsChannels();
+    void countsLoopsDown();
+    void stopsVoice();
+    void stealsVoiceWhenAllAreBusy();
+    void deliversNotificationsOnlyWhilePlaying();
+};
+
+void tst_QSoundEffectMixer::convertResamples()
+{
+    QSoundEffectMixer mixer(audioFormat(QAudioFormat::Float, 48000, 2), 4);
+
+    const QAudioFormat format = audioFormat(QAudioFormat::Int16, 24000, 1);
+    const std::vector<qint16> input = { 0, 16384, -16384, 8192 };
+    const QByteArray data(reinterpret_cast<const char *>(input.data()),
+                          qsizetype(input.size() * sizeof(qint16)));
+
+    // Every input frame, and one interpolated between each two of them, on both channels
+    const QList<float> output = mixer.convert(data, format);
+    QCOMPARE(output.size(), qsizetype(input.size() * 2 - 1) * 2);
+
+    for (qsizetype frame = 0; frame < output.size() / 2; ++frame) {
+        const qsizetype i = frame / 2;
+        float expected = format.normalizedSampleValue(&input[i]);
+        if (frame % 2)
+            expected = (expected + format.normalizedSampleValue(&input[i + 1])) / 2;
+
+        QVERIFY2(qAbs(output[frame * 2] - expected) < 1e-6f, qPrintable(QString::number(frame)));
+        QCOMPARE(output[frame * 2 + 1], output[frame * 2]);
+    }
+}
+
+void tst_QSoundEffectMixer::convertMapsChannels_data()
+{
+    QTest::addColumn<int>("inChannels");
+    QTest::addColumn<int>("outChannels");
+    QTest::addColumn<QList<float>>("input");
+    QTest::addColumn<QList<float>>("expected");
+
+    QTest::newRow("mono to stereo") << 1 << 2 << QList<float>{ 0.5f }
+                                    << QList<float>{ 0.5f, 0.5f };
+    QTest::newRow("stereo to mono") << 2 << 1 << QList<float>{ 0.5f, -0.25f }
+                                    << QList<float>{ 0.125f };
+    QTest::newRow("stereo to quad") << 2 << 4 << QList<float>{ 0.5f, -0.25f }
+                                    << QList<float>{ 0.5f, -0.25f, 0.f, 0.f };
+    QTest::newRow("quad to stereo") << 4 << 2 << QList<float>{ 0.5f, -0.25f, 0.75f, 1.f }
+                                    << QList<float>{ 0.5f, -0.25f };
+}
+
+void tst_QSoundEffectMixer::convertMapsChannels()
+{
+    QFETCH(int, inChannels);
+    QFETCH(int, outChannels);
+    QFETCH(QList<float>, input);
+    QFETCH(QList<float>, expected);
+
+    QSoundEffectMixer mixer(audioFormat(QAudioFormat::Float, 48000, outChannels), 4);
+
+    // Two equal frames at the rate of the mixer, which are taken over as they are
+    const QList<float> frames = input + input;
+    const QByteArray data(reinterpret_cast<const char *>(frames.constData()),
+                          frames.size() * qsizetype(sizeof(float)));
+    QCOMPARE(mixer.convert(data, audioFormat(QAudioFormat::Float, 48000, inChannels)),
+             expected + expected);
+}
+
+void tst_QSoundEffectMixer::countsLoopsDown()
+{
+    QSoundEffectMixer mixer(audioFormat(QAudioFormat::Float, 48000, 1), 4);
+
+    constexpr qsizetype Frames = 100;
+    const QList<float> data(Frames, 0.5f);
+
+    Voice voice(0.5f);
+    const quint64 playId = voice.voice->startPlay(3);
+    mixer.play(voice.voice, data);
+
+    // Three loops in one go, then silence
+    const std::vector<float> output = pull(mixer, Frames * 4);
+    QCOMPARE(output.size(), size_t(Frames * 4));
+    for (qsizetype i = 0; i < Frames * 3; ++i)
+        QCOMPARE(output[i], 0.25f);
+    for (qsizetype i = Frames * 3; i < Frames * 4; ++i)
+        QCOMPARE(output[i], 0.f);
+    QCOMPARE(voice.voice->loopsRemaining(), 0);
+
+    // The end of each loop but the last one, and then the end of the play
+    const Notifications expected = { { playId, false }, { playId, false }, { playId, true } };
+    QTRY_COMPARE(voice.notifications, expected);
+
+    // A finished voice isn't mixed anymore
+    for (float sample : pull(mixer, Frames))
+        QCOMPARE(sample, 0.f);
+    QTest::qWait(50);
+    QCOMPARE(voice.notifications, expected);
+}
+
+void tst_QSoundEffectMixer::stopsVoice()
+{
+    QSoundEffectMixer mixer(audioFormat(QAudioFormat::Float, 48000, 1), 4);
+
+    Voice voice;
+    voice.voice->startPlay(QSoundEffectVoice::Infinite);
+    mixer.play(voice.voice, QList<float>(10, 0.5f));
+
+    // Infinite loops are mixed without notifications
+    for (float sample : pull(mixer, 1000))
+        QCOMPARE(sample, 0.5f);
+
+    mixer.stop(voice.voice);
+    for (float sample : pull(mixer, 100))
+        QCOMPARE(sample, 0.f);
+
+    QTest::qWait(50);
+    QVERIFY(voice.notifications.isEmpty());
+}
+
+void tst_QSoundEffectMixer::stealsVoiceWhenAllAreBusy()
+{
+    QSoundEffectMixer mixer(audioFormat(QAudioFormat::Float, 48000, 1), 2);
+
+    Voice loud;
+    Voice quiet(0.5f);
+    Voice next;
+
+    loud.voice->startPlay(QSoundEffectVoice::Infinite);
+    mixer.play(loud.voice, QList<float>(100, 0.125f));
+    const quint64 quietPlayId = quiet.voice->startPlay(QSoundEffectVoice::Infinite);
+    mixer.play(quiet.voice, QList<float>(100, 0.5f));
+
+    for (float sample : pull(mixer, 100))
+        QCOMPARE(sample, 0.375f);
+
+    // Both voices are busy, so the quieter one makes room
+    next.voice->startPlay(QSoundEffectVoice::Infinite);
+    mixer.play(next.voice, QList<float>(100, 0.5f));
+
+    for (float sample : pull(mixer, 100))
+        QCOMPARE(sample, 0.625f);
+
+    QTRY_COMPARE(quiet.notifications, Notifications({ { quietPlayId, true } }));
+    QVERIFY(loud.notifications.isEmpty());
+    QVERIFY(next.notifications.isEmpty());
+}
+
+void tst_QSoundEffectMixer::deliversNotificationsOnlyWhilePlaying()
+{
+    QSoundEffectMixer mixer(audioFormat(QAudioFormat::Float, 48000, 1), 4);
+    QVERIFY(!mixer.isDeliveringNotifications());
+
+    constexpr qsizetype Frames = 100;
+    Voice voice;
+    const quint64 firstPlayId = voice.voice->startPlay(1);
+    mixer.play(voice.voice, QList<float>(Frames, 0.5f));
+    QVERIFY(mixer.isDeliveringNotifications());
+
+    // The timer keeps running until the end of the play has been delivered
+    pull(mixer, Frames * 2);
+    pull(mixer, Frames);
+    QTRY_COMPARE(voice.notifications, Notifications({ { firstPlayId, true } }));
+    QTRY_VERIFY(!mixer.isDeliveringNotifications());
+
+    // The next play starts it again
+    const quint64 secondPlayId = voice.voice->startPlay(1);
+    mixer.play(voice.voice, QList<float>(Frames, 0.5f));
+    QVERIFY(mixer.isDeliveringNotifications());
+    pull(mixer, Frames * 2);
+    pull(mixer, Frames);
+    QTRY_COMPARE(voice.notifications,
+                 Notifications({ { firstPlayId, true }, { secondPlayId, true } }));
+    QTRY_VERIFY(!mixer.isDeliveringNotifications());
+}
+
+QTEST_GUILESS_MAIN(tst_QSoundEffectMixer)
+
+#include "tst_qsoundeffectmixer.moc"
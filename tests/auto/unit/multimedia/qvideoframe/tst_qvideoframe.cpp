@@ -8,6 +8,8 @@
 #include <qvideoframe.h>
 #include <qvideoframeformat.h>
 #include "private/qmemoryvideobuffer_p.h"
+#include "private/qvideoframeconversionhelper_p.h"
+#include "private/qvideoframeconverter_p.h"
 #include <QtGui/QImage>
 #include <QtCore/QPointer>
 #include <QtMultimedia/private/qtmultimedia-config_p.h>
@@ -60,6 +62,18 @@ private slots:
     void image_data();
     void image();
 
+    void imageFromYUV_data();
+    void imageFromYUV();
+
+    void imageFromYUVWithChroma_data();
+    void imageFromYUVWithChroma();
+
+    void imageWithTransform_data();
+    void imageWithTransform();
+
+    void imageWithTransformInBands_data();
+    void imageWithTransformInBands();
+
     void emptyData();
 };
 
@@ -957,6 +971,349 @@ void tst_QVideoFrame::image()
     QCOMPARE(img.size(), size);
 }
 
+void tst_QVideoFrame::imageFromYUV_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QVideoFrameFormat::ColorRange>("colorRange");
+    QTest::addColumn<int>("luma");
+    QTest::addColumn<int>("gray");
+
+    const QVideoFrameFormat::PixelFormat formats[] = {
+        QVideoFrameFormat::Format_YUV420P, QVideoFrameFormat::Format_YUV422P,
+        QVideoFrameFormat::Format_NV12,    QVideoFrameFormat::Format_NV21,
+        QVideoFrameFormat::Format_UYVY,    QVideoFrameFormat::Format_YUYV,
+    };
+
+    for (auto format : formats) {
+        const QByteArray name = QVideoFrameFormat::pixelFormatToString(format).toLatin1();
+        QTest::addRow("%s video black", name.constData())
+                << format << QVideoFrameFormat::ColorRange_Video << 16 << 0;
+        QTest::addRow("%s video gray", name.constData())
+                << format << QVideoFrameFormat::ColorRange_Video << 126 << 128;
+        QTest::addRow("%s video white", name.constData())
+                << format << QVideoFrameFormat::ColorRange_Video << 235 << 255;
+        QTest::addRow("%s full gray", name.constData())
+                << format << QVideoFrameFormat::ColorRange_Full << 100 << 100;
+    }
+}
+
+void tst_QVideoFrame::imageFromYUV()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QVideoFrameFormat::ColorRange, colorRange);
+    QFETCH(int, luma);
+    QFETCH(int, gray);
+
+    // The width is chosen to exercise both the vectorized and the scalar code paths
+    const QSize size(50, 4);
+    QVideoFrameFormat format(size, pixelFormat);
+    format.setColorRange(colorRange);
+
+    QVideoFrame frame(format);
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    if (pixelFormat == QVideoFrameFormat::Format_UYVY
+        || pixelFormat == QVideoFrameFormat::Format_YUYV) {
+        const int lumaOffset = pixelFormat == QVideoFrameFormat::Format_UYVY ? 1 : 0;
+        for (int y = 0; y < size.height(); ++y) {
+            uchar *line = frame.bits(0) + y * frame.bytesPerLine(0);
+            for (int x = 0; x < size.width() * 2; ++x)
+                line[x] = (x % 2) == lumaOffset ? luma : 128;
+        }
+    } else {
+        memset(frame.bits(0), luma, frame.mappedBytes(0));
+        for (int plane = 1; plane < frame.planeCount(); ++plane)
+            memset(frame.bits(plane), 128, frame.mappedBytes(plane));
+    }
+    frame.unmap();
+
+    const QImage img = frame.toImage();
+    QVERIFY(!img.isNull());
+    QCOMPARE(img.size(), size);
+
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            const QRgb pixel = img.pixel(x, y);
+            QVERIFY2(qAbs(qRed(pixel) - gray) <= 1 && qAbs(qGreen(pixel) - gray) <= 1
+                             && qAbs(qBlue(pixel) - gray) <= 1,
+                     qPrintable(QStringLiteral("pixel %1,%2 is %3")
+                                        .arg(x).arg(y).arg(pixel, 8, 16)));
+        }
+    }
+}
+
+void tst_QVideoFrame::imageFromYUVWithChroma_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QVideoFrameFormat::ColorSpace>("colorSpace");
+    QTest::addColumn<QVideoFrameFormat::ColorRange>("colorRange");
+
+    const QVideoFrameFormat::PixelFormat formats[] = {
+        QVideoFrameFormat::Format_YUV420P, QVideoFrameFormat::Format_YUV422P,
+        QVideoFrameFormat::Format_YV12,    QVideoFrameFormat::Format_NV12,
+        QVideoFrameFormat::Format_NV21,    QVideoFrameFormat::Format_UYVY,
+        QVideoFrameFormat::Format_YUYV,
+    };
+    const std::pair<QVideoFrameFormat::ColorSpace, const char *> colorSpaces[] = {
+        { QVideoFrameFormat::ColorSpace_BT601, "BT.601" },
+        { QVideoFrameFormat::ColorSpace_BT709, "BT.709" },
+        { QVideoFrameFormat::ColorSpace_BT2020, "BT.2020" },
+    };
+
+    for (auto format : formats) {
+        const QByteArray name = QVideoFrameFormat::pixelFormatToString(format).toLatin1();
+        for (const auto &[colorSpace, colorSpaceName] : colorSpaces) {
+            QTest::addRow("%s %s video", name.constData(), colorSpaceName)
+                    << format << colorSpace << QVideoFrameFormat::ColorRange_Video;
+            QTest::addRow("%s %s full", name.constData(), colorSpaceName)
+                    << format << colorSpace << QVideoFrameFormat::ColorRange_Full;
+        }
+    }
+}
+
+void tst_QVideoFrame::imageFromYUVWithChroma()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QVideoFrameFormat::ColorSpace, colorSpace);
+    QFETCH(QVideoFrameFormat::ColorRange, colorRange);
+
+    // An odd width, so that the vectorized code is followed by the scalar code for the
+    // leftover pixels, and a half chroma sample at the end of each row
+    const QSize size(67, 6);
+    QVideoFrameFormat format(size, pixelFormat);
+    format.setColorSpace(colorSpace);
+    format.setColorRange(colorRange);
+
+    const bool verticalSubsampling = pixelFormat == QVideoFrameFormat::Format_YUV420P
+            || pixelFormat == QVideoFrameFormat::Format_YV12
+            || pixelFormat == QVideoFrameFormat::Format_NV12
+            || pixelFormat == QVideoFrameFormat::Format_NV21;
+
+    // Covers the whole value range, including saturated colors that have to be clamped
+    auto lumaAt = [](int x, int y) { return (x * 37 + y * 71) & 0xff; };
+    auto uAt = [](int cx, int cy) { return (cx * 53 + cy * 29 + 7) & 0xff; };
+    auto vAt = [](int cx, int cy) { return (cx * 97 + cy * 43 + 191) & 0xff; };
+    auto chromaRow = [&](int y) { return verticalSubsampling ? y / 2 : y; };
+
+    QVideoFrame frame(format);
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    const int chromaWidth = (size.width() + 1) / 2;
+    for (int y = 0; y < size.height(); ++y) {
+        const int cy = chromaRow(y);
+        switch (pixelFormat) {
+        case QVideoFrameFormat::Format_UYVY:
+        case QVideoFrameFormat::Format_YUYV: {
+            const bool uyvy = pixelFormat == QVideoFrameFormat::Format_UYVY;
+            uchar *line = frame.bits(0) + y * frame.bytesPerLine(0);
+            for (int cx = 0; cx < chromaWidth; ++cx) {
+                uchar *macroPixel = line + 4 * cx;
+                macroPixel[uyvy ? 1 : 0] = lumaAt(2 * cx, y);
+                macroPixel[uyvy ? 3 : 2] = lumaAt(2 * cx + 1, y);
+                macroPixel[uyvy ? 0 : 1] = uAt(cx, cy);
+                macroPixel[uyvy ? 2 : 3] = vAt(cx, cy);
+            }
+            break;
+        }
+        default: {
+            uchar *line = frame.bits(0) + y * frame.bytesPerLine(0);
+            for (int x = 0; x < size.width(); ++x)
+                line[x] = lumaAt(x, y);
+
+            if (verticalSubsampling && y % 2)
+                break;
+
+            if (frame.planeCount() == 2) {
+                const bool nv21 = pixelFormat == QVideoFrameFormat::Format_NV21;
+                uchar *uv = frame.bits(1) + cy * frame.bytesPerLine(1);
+                for (int cx = 0; cx < chromaWidth; ++cx) {
+                    uv[2 * cx + (nv21 ? 1 : 0)] = uAt(cx, cy);
+                    uv[2 * cx + (nv21 ? 0 : 1)] = vAt(cx, cy);
+                }
+            } else {
+                const bool yv12 = pixelFormat == QVideoFrameFormat::Format_YV12;
+                uchar *u = frame.bits(yv12 ? 2 : 1) + cy * frame.bytesPerLine(yv12 ? 2 : 1);
+                uchar *v = frame.bits(yv12 ? 1 : 2) + cy * frame.bytesPerLine(yv12 ? 1 : 2);
+                for (int cx = 0; cx < chromaWidth; ++cx) {
+                    u[cx] = uAt(cx, cy);
+                    v[cx] = vAt(cx, cy);
+                }
+            }
+            break;
+        }
+        }
+    }
+    frame.unmap();
+
+    // The RHI would convert on the GPU, with a different precision
+    const QImage img = qImageFromVideoFrameOnCpu(frame);
+    QVERIFY(!img.isNull());
+    QCOMPARE(img.size(), size);
+
+    // The luma weights of the color space
+    double kr = 0.299;
+    double kb = 0.114;
+    if (colorSpace == QVideoFrameFormat::ColorSpace_BT709) {
+        kr = 0.2126;
+        kb = 0.0722;
+    } else if (colorSpace == QVideoFrameFormat::ColorSpace_BT2020) {
+        kr = 0.2627;
+        kb = 0.0593;
+    }
+    const bool fullRange = colorRange == QVideoFrameFormat::ColorRange_Full;
+
+    const YUVToRGBCoefficients &coefficients = qYUVToRGBCoefficients(format);
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            const int luma = lumaAt(x, y);
+            const int u = uAt(x / 2, chromaRow(y));
+            const int v = vAt(x / 2, chromaRow(y));
+            const QRgb pixel = img.pixel(x, y);
+
+            // The vectorized converters must produce exactly what the scalar one does
+            const QRgb scalar =
+                    qYUVToARGB32(coefficients, luma, qYUVExpandChroma(coefficients, u, v));
+            QVERIFY2(pixel == scalar,
+                     qPrintable(QStringLiteral("pixel %1,%2 is %3, scalar conversion gives %4")
+                                        .arg(x).arg(y).arg(pixel, 8, 16).arg(scalar, 8, 16)));
+
+            // And the matrix and range have to match the color space of the frame
+            const double yy = fullRange ? luma : (luma - 16) * 255. / 219.;
+            const double pb = fullRange ? u - 128 : (u - 128) * 255. / 224.;
+            const double pr = fullRange ? v - 128 : (v - 128) * 255. / 224.;
+            const double r = yy + 2 * (1 - kr) * pr;
+            const double b = yy + 2 * (1 - kb) * pb;
+            const double g = (yy - kr * r - kb * b) / (1 - kr - kb);
+            auto isClose = [](int value, double expected) {
+                return qAbs(value - qBound(0., expected, 255.)) <= 2;
+            };
+            QVERIFY2(isClose(qRed(pixel), r) && isClose(qGreen(pixel), g)
+                             && isClose(qBlue(pixel), b),
+                     qPrintable(QStringLiteral("pixel %1,%2 is %3, expected %4,%5,%6")
+                                        .arg(x).arg(y).arg(pixel, 8, 16)
+                                        .arg(r).arg(g).arg(b)));
+        }
+    }
+}
+
+void tst_QVideoFrame::imageWithTransform_data()
+{
+    QTest::addColumn<QVideoFrame::RotationAngle>("rotation");
+    QTest::addColumn<bool>("mirrored");
+
+    for (auto rotation : { QVideoFrame::Rotation0, QVideoFrame::Rotation90,
+                           QVideoFrame::Rotation180, QVideoFrame::Rotation270 }) {
+        QTest::addRow("rotation %d", int(rotation)) << rotation << false;
+        QTest::addRow("rotation %d mirrored", int(rotation)) << rotation << true;
+    }
+}
+
+void tst_QVideoFrame::imageWithTransform()
+{
+    QFETCH(QVideoFrame::RotationAngle, rotation);
+    QFETCH(bool, mirrored);
+
+    auto createFrame = [] {
+        QVideoFrame frame(QVideoFrameFormat(QSize(64, 33), QVideoFrameFormat::Format_XRGB8888));
+        if (!frame.map(QVideoFrame::WriteOnly))
+            return QVideoFrame();
+        for (int y = 0; y < frame.height(); ++y) {
+            uchar *line = frame.bits(0) + y * frame.bytesPerLine(0);
+            for (int x = 0; x < frame.width(); ++x) {
+                line[4 * x] = 0xff;
+                line[4 * x + 1] = x * 4;
+                line[4 * x + 2] = y * 4;
+                line[4 * x + 3] = (x + y) & 0xff;
+            }
+        }
+        frame.unmap();
+        return frame;
+    };
+
+    const QImage reference = createFrame().toImage();
+    QVERIFY(!reference.isNull());
+
+    QVideoFrame frame = createFrame();
+    frame.setRotationAngle(rotation);
+    frame.setMirrored(mirrored);
+    const QImage image = frame.toImage();
+
+    QTransform transform;
+    if (mirrored)
+        transform.scale(-1.f, 1.f);
+    transform.rotate(float(rotation));
+    const QImage expected = reference.transformed(transform);
+
+    QCOMPARE(image.size(), expected.size());
+    QCOMPARE(image.convertToFormat(QImage::Format_RGB32),
+             expected.convertToFormat(QImage::Format_RGB32));
+}
+
+void tst_QVideoFrame::imageWithTransformInBands_data()
+{
+    QTest::addColumn<QVideoFrame::RotationAngle>("rotation");
+    QTest::addColumn<bool>("mirrored");
+
+    QTest::addRow("rotation 0") << QVideoFrame::Rotation0 << false;
+    QTest::addRow("rotation 90") << QVideoFrame::Rotation90 << false;
+    QTest::addRow("rotation 180 mirrored") << QVideoFrame::Rotation180 << true;
+    QTest::addRow("rotation 270 mirrored") << QVideoFrame::Rotation270 << true;
+}
+
+void tst_QVideoFrame::imageWithTransformInBands()
+{
+    QFETCH(QVideoFrame::RotationAngle, rotation);
+    QFETCH(bool, mirrored);
+
+    // Large enough to be converted in several bands, with a height that doesn't divide
+    // evenly into them
+    const QSize size(1000, 1030);
+    QVideoFrameFormat format(size, QVideoFrameFormat::Format_YUV420P);
+    format.setColorSpace(QVideoFrameFormat::ColorSpace_BT709);
+
+    auto lumaAt = [](int x, int y) { return (x + 3 * y) & 0xff; };
+    auto uAt = [](int cx, int cy) { return (cx * 5 + cy) & 0xff; };
+    auto vAt = [](int cx, int cy) { return (cx + cy * 7) & 0xff; };
+
+    QVideoFrame frame(format);
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    for (int y = 0; y < size.height(); ++y) {
+        uchar *line = frame.bits(0) + y * frame.bytesPerLine(0);
+        for (int x = 0; x < size.width(); ++x)
+            line[x] = lumaAt(x, y);
+    }
+    for (int cy = 0; cy < size.height() / 2; ++cy) {
+        uchar *u = frame.bits(1) + cy * frame.bytesPerLine(1);
+        uchar *v = frame.bits(2) + cy * frame.bytesPerLine(2);
+        for (int cx = 0; cx < size.width() / 2; ++cx) {
+            u[cx] = uAt(cx, cy);
+            v[cx] = vAt(cx, cy);
+        }
+    }
+    frame.unmap();
+
+    // Converted serially, pixel by pixel
+    QImage reference(size, QImage::Format_RGB32);
+    const YUVToRGBCoefficients &coefficients = qYUVToRGBCoefficients(format);
+    for (int y = 0; y < size.height(); ++y) {
+        auto *line = reinterpret_cast<QRgb *>(reference.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            const YUVChroma uv = qYUVExpandChroma(coefficients, uAt(x / 2, y / 2),
+                                                  vAt(x / 2, y / 2));
+            line[x] = qYUVToARGB32(coefficients, lumaAt(x, y), uv);
+        }
+    }
+
+    QTransform transform;
+    if (mirrored)
+        transform.scale(-1.f, 1.f);
+    transform.rotate(float(rotation));
+    const QImage expected = reference.transformed(transform);
+
+    const QImage image = qImageFromVideoFrameOnCpu(frame, rotation, mirrored);
+
+    QCOMPARE(image.size(), expected.size());
+    QCOMPARE(image.convertToFormat(QImage::Format_RGB32), expected);
+}
+
 void tst_QVideoFrame::emptyData()
 {
     QByteArray data(nullptr, 0);
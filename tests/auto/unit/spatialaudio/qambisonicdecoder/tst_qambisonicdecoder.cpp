@@ -0,0 +1,209 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <private/qambisonicdecoder_p.h>
+
+#include <cmath>
+#include <vector>
+
+class tst_QAmbisonicDecoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void blockMatchesFrameByFrame_data();
+    void blockMatchesFrameByFrame();
+    void int16MatchesFloat_data() { blockMatchesFrameByFrame_data(); }
+    void int16MatchesFloat();
+    void int16Saturates();
+};
+
+// Spans several blocks of the decoder and is neither a multiple of 4 nor of 8,
+// so both the vectorized loops and their scalar tails run.
+static constexpr int Frames = 301;
+
+// A few partials per channel, different for every channel, well inside [-1, 1]
+static std::vector<float> testSignal(int channel, float amplitude = 0.2f)
+{
+    std::vector<float> data(Frames);
+    for (int i = 0; i < Frames; ++i) {
+        data[i] = amplitude * (0.6f * std::sin(0.013f * (channel + 1) * i)
+                               + 0.4f * std::sin(0.9f * i + channel));
+    }
+    return data;
+}
+
+static QAudioFormat formatFor(int channelConfig, QAudioFormat::SampleFormat sampleFormat)
+{
+    QAudioFormat format;
+    format.setSampleFormat(sampleFormat);
+    format.setSampleRate(48000);
+    format.setChannelConfig(QAudioFormat::ChannelConfig(channelConfig));
+    return format;
+}
+
+struct Signals
+{
+    explicit Signals(int nChannels, float amplitude = 0.2f)
+    {
+        for (int i = 0; i < nChannels; ++i) {
+            channels[i] = testSignal(i, amplitude);
+            input[i] = channels[i].data();
+        }
+        reverbChannels[0] = testSignal(100, amplitude);
+        reverbChannels[1] = testSignal(101, amplitude);
+    }
+
+    const float *inputAt(int channel, int offset) const { return input[channel] + offset; }
+
+    std::vector<float> channels[QAmbisonicDecoder::maxAmbisonicChannels];
+    const float *input[QAmbisonicDecoder::maxAmbisonicChannels] = {};
+    std::vector<float> reverbChannels[2];
+};
+
+void tst_QAmbisonicDecoder::blockMatchesFrameByFrame_data()
+{
+    QTest::addColumn<int>("level");
+    QTest::addColumn<int>("channelConfig");
+    QTest::addColumn<bool>("withReverb");
+
+    const struct {
+        const char *name;
+        QAudioFormat::ChannelConfig config;
+    } layouts[] = {
+        { "Mono", QAudioFormat::ChannelConfigMono },
+        { "Stereo", QAudioFormat::ChannelConfigStereo },
+        { "2.1", QAudioFormat::ChannelConfig2Dot1 },
+        { "3.0", QAudioFormat::ChannelConfig3Dot0 },
+        { "3.1", QAudioFormat::ChannelConfig3Dot1 },
+        { "5.0", QAudioFormat::ChannelConfigSurround5Dot0 },
+        { "5.1", QAudioFormat::ChannelConfigSurround5Dot1 },
+        { "7.0", QAudioFormat::ChannelConfigSurround7Dot0 },
+        { "7.1", QAudioFormat::ChannelConfigSurround7Dot1 },
+    };
+
+    for (int level = QAmbisonicDecoder::AmbisonicLevel1;
+         level <= QAmbisonicDecoder::maxAmbisonicLevel; ++level) {
+        for (const auto &layout : layouts) {
+            QTest::addRow("Level%d %s", level, layout.name)
+                    << level << int(layout.config) << false;
+            QTest::addRow("Level%d %s reverb", level, layout.name)
+                    << level << int(layout.config) << true;
+        }
+    }
+}
+
+// Decoding a single frame per call only runs the scalar code, so this compares the
+// block and SIMD implementation against it.
+void tst_QAmbisonicDecoder::blockMatchesFrameByFrame()
+{
+    QFETCH(int, level);
+    QFETCH(int, channelConfig);
+    QFETCH(bool, withReverb);
+
+    const QAudioFormat format = formatFor(channelConfig, QAudioFormat::Float);
+    QAmbisonicDecoder block(QAmbisonicDecoder::AmbisonicLevel(level), format);
+    QAmbisonicDecoder scalar(QAmbisonicDecoder::AmbisonicLevel(level), format);
+    QVERIFY(block.hasValidConfig());
+    const int nInput = block.nInputChannels();
+    const int nOutput = block.nOutputChannels();
+
+    Signals s(nInput);
+    const float *noReverb[2] = { nullptr, nullptr };
+    const float *reverb[2] = { s.reverbChannels[0].data(), s.reverbChannels[1].data() };
+    const float **blockReverb = withReverb ? reverb : noReverb;
+
+    std::vector<float> blockOutput(block.outputSize(Frames));
+    block.processBufferWithReverb(s.input, blockReverb, blockOutput.data(), Frames);
+
+    std::vector<float> scalarOutput(scalar.outputSize(Frames));
+    for (int i = 0; i < Frames; ++i) {
+        const float *input[QAmbisonicDecoder::maxAmbisonicChannels];
+        for (int c = 0; c < nInput; ++c)
+            input[c] = s.inputAt(c, i);
+        const float *frameReverb[2] = { nullptr, nullptr };
+        if (withReverb) {
+            frameReverb[0] = reverb[0] + i;
+            frameReverb[1] = reverb[1] + i;
+        }
+        scalar.processBufferWithReverb(input, frameReverb, scalarOutput.data() + i*nOutput, 1);
+    }
+
+    // A quarter of one LSB of 16 bit audio. The summation order differs slightly.
+    constexpr float tolerance = 1.f/(1 << 17);
+    for (int i = 0; i < Frames*nOutput; ++i) {
+        if (std::abs(blockOutput[i] - scalarOutput[i]) > tolerance)
+            QFAIL(qPrintable(QStringLiteral("frame %1, channel %2: %3 != %4")
+                                     .arg(i/nOutput).arg(i%nOutput)
+                                     .arg(blockOutput[i]).arg(scalarOutput[i])));
+    }
+}
+
+void tst_QAmbisonicDecoder::int16MatchesFloat()
+{
+    QFETCH(int, level);
+    QFETCH(int, channelConfig);
+    QFETCH(bool, withReverb);
+
+    QAmbisonicDecoder floatDecoder(QAmbisonicDecoder::AmbisonicLevel(level),
+                                   formatFor(channelConfig, QAudioFormat::Float));
+    QAmbisonicDecoder int16Decoder(QAmbisonicDecoder::AmbisonicLevel(level),
+                                   formatFor(channelConfig, QAudioFormat::Int16));
+    QVERIFY(floatDecoder.hasValidConfig());
+
+    Signals s(floatDecoder.nInputChannels());
+    const float *noReverb[2] = { nullptr, nullptr };
+    const float *reverb[2] = { s.reverbChannels[0].data(), s.reverbChannels[1].data() };
+
+    std::vector<float> floatOutput(floatDecoder.outputSize(Frames));
+    floatDecoder.processBufferWithReverb(s.input, withReverb ? reverb : noReverb,
+                                         floatOutput.data(), Frames);
+    std::vector<short> int16Output(int16Decoder.outputSize(Frames));
+    int16Decoder.processBufferWithReverb(s.input, withReverb ? reverb : noReverb,
+                                         int16Output.data(), Frames);
+
+    for (size_t i = 0; i < floatOutput.size(); ++i) {
+        const int expected = int(qBound(-32768.f, floatOutput[i]*32768.f, 32767.f));
+        if (std::abs(int16Output[i] - expected) > 1)
+            QFAIL(qPrintable(QStringLiteral("sample %1: %2 != %3")
+                                     .arg(i).arg(int16Output[i]).arg(expected)));
+    }
+}
+
+void tst_QAmbisonicDecoder::int16Saturates()
+{
+    // Loud enough that the sum of the channels exceeds the 16 bit range. This used to
+    // wrap around.
+    QAmbisonicDecoder floatDecoder(QAmbisonicDecoder::AmbisonicLevel3,
+                                   formatFor(QAudioFormat::ChannelConfigSurround7Dot1,
+                                             QAudioFormat::Float));
+    QAmbisonicDecoder int16Decoder(QAmbisonicDecoder::AmbisonicLevel3,
+                                   formatFor(QAudioFormat::ChannelConfigSurround7Dot1,
+                                             QAudioFormat::Int16));
+
+    Signals s(int16Decoder.nInputChannels(), 8.f);
+    std::vector<float> floatOutput(floatDecoder.outputSize(Frames));
+    floatDecoder.processBuffer(s.input, floatOutput.data(), Frames);
+    std::vector<short> int16Output(int16Decoder.outputSize(Frames));
+    int16Decoder.processBuffer(s.input, int16Output.data(), Frames);
+
+    int clipped = 0;
+    for (size_t i = 0; i < floatOutput.size(); ++i) {
+        const float f = floatOutput[i];
+        if (f >= 1.f) {
+            QCOMPARE(int16Output[i], short(32767));
+            ++clipped;
+        } else if (f <= -1.f) {
+            QCOMPARE(int16Output[i], short(-32768));
+            ++clipped;
+        } else {
+            QVERIFY(std::abs(int16Output[i] - int(f*32768.f)) <= 1);
+        }
+    }
+    QVERIFY(clipped > 0);
+}
+
+QTEST_APPLESS_MAIN(tst_QAmbisonicDecoder)
+
+#include "tst_qambisonicdecoder.moc"
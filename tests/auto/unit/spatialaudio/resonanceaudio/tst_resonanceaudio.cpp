@@ -0,0 +1,92 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <resonance_audio.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+class tst_ResonanceAudio : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void workerThreadsRenderIdenticalOutput_data();
+    void workerThreadsRenderIdenticalOutput();
+};
+
+static constexpr int Frames = 128;
+static constexpr int SampleRate = 48000;
+static constexpr int AmbisonicChannels = 16;
+static constexpr int Sources = 8;
+static constexpr int Buffers = 10;
+
+// Deterministic, different signal for every source and buffer
+static std::vector<float> sourceSignal(int source, int buffer)
+{
+    std::vector<float> data(Frames);
+    for (int i = 0; i < Frames; ++i) {
+        const int t = buffer * Frames + i;
+        data[i] = 0.25f * std::sin(0.01f * (source + 1) * t)
+                + 0.05f * std::sin(0.37f * t + source);
+    }
+    return data;
+}
+
+void tst_ResonanceAudio::workerThreadsRenderIdenticalOutput_data()
+{
+    QTest::addColumn<int>("workerThreads");
+
+    QTest::newRow("1 worker") << 1;
+    QTest::newRow("3 workers") << 3;
+    QTest::newRow("more workers than sources") << Sources + 2;
+}
+
+void tst_ResonanceAudio::workerThreadsRenderIdenticalOutput()
+{
+    QFETCH(int, workerThreads);
+
+    vraudio::ResonanceAudio serial(2, Frames, SampleRate);
+    vraudio::ResonanceAudio parallel(2, Frames, SampleRate);
+    parallel.setNumWorkerThreads(workerThreads);
+
+    vraudio::ResonanceAudio *engines[] = { &serial, &parallel };
+    std::vector<vraudio::ResonanceAudioApi::SourceId> ids[2];
+    for (int e = 0; e < 2; ++e) {
+        for (int s = 0; s < Sources; ++s) {
+            const auto id = engines[e]->api->CreateSoundObjectSource(vraudio::kBinauralHighQuality);
+            const float angle = 6.2831853f * s / Sources;
+            engines[e]->api->SetSourcePosition(id, 2.f * std::cos(angle), 0.5f * (s % 3),
+                                               2.f * std::sin(angle));
+            ids[e].push_back(id);
+        }
+    }
+
+    for (int b = 0; b < Buffers; ++b) {
+        const float *output[2][AmbisonicChannels];
+        const float *reverb[2][2];
+        for (int e = 0; e < 2; ++e) {
+            for (int s = 0; s < Sources; ++s) {
+                const std::vector<float> signal = sourceSignal(s, b);
+                engines[e]->api->SetInterleavedBuffer(ids[e][s], signal.data(), 1, Frames);
+            }
+            QCOMPARE(engines[e]->getAmbisonicOutput(output[e], reverb[e], AmbisonicChannels),
+                     Frames);
+        }
+
+        for (int c = 0; c < AmbisonicChannels; ++c) {
+            for (int i = 0; i < Frames; ++i) {
+                if (output[0][c][i] != output[1][c][i])
+                    QFAIL(qPrintable(QStringLiteral("buffer %1, channel %2, frame %3: %4 != %5")
+                                             .arg(b).arg(c).arg(i)
+                                             .arg(output[1][c][i]).arg(output[0][c][i])));
+            }
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_ResonanceAudio)
+
+#include "tst_resonanceaudio.moc"
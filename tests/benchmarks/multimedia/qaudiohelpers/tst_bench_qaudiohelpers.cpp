@@ -0,0 +1,172 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <private/qaudiohelpers_p.h>
+
+#include <random>
+#include <vector>
+
+using namespace QAudioHelperInternal;
+
+// The per sample floating point implementation qMultiplySamples() used before
+// it got integer and SIMD kernels.
+template<class T>
+static void referenceMultiplySamples(qreal factor, const void *src, void *dst, int samples)
+{
+    const T *pSrc = static_cast<const T *>(src);
+    T *pDst = static_cast<T *>(dst);
+    for (int i = 0; i < samples; i++)
+        pDst[i] = pSrc[i] * factor;
+}
+
+class tst_bench_QAudioHelpers : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void multiplySamples_data();
+    void multiplySamples();
+    void multiplySamplesReference_data() { multiplySamples_data(); }
+    void multiplySamplesReference();
+    void multiplySamplesRamp_data() { multiplySamples_data(); }
+    void multiplySamplesRamp();
+    void accumulateSamples_data();
+    void accumulateSamples();
+
+private:
+    static QByteArray noise(QAudioFormat::SampleFormat format, int samples);
+};
+
+// One second of 48 kHz stereo audio
+static constexpr int BenchmarkSamples = 48000 * 2;
+
+QByteArray tst_bench_QAudioHelpers::noise(QAudioFormat::SampleFormat format, int samples)
+{
+    QAudioFormat audioFormat;
+    audioFormat.setSampleFormat(format);
+    QByteArray data(samples * audioFormat.bytesPerSample(), Qt::Uninitialized);
+
+    std::mt19937 generator(42);
+    switch (format) {
+    case QAudioFormat::Int16:
+        for (int i = 0; i < samples; ++i)
+            reinterpret_cast<qint16 *>(data.data())[i] = qint16(generator());
+        break;
+    case QAudioFormat::Int32:
+        for (int i = 0; i < samples; ++i)
+            reinterpret_cast<qint32 *>(data.data())[i] = qint32(generator());
+        break;
+    case QAudioFormat::Float: {
+        std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+        for (int i = 0; i < samples; ++i)
+            reinterpret_cast<float *>(data.data())[i] = distribution(generator);
+        break;
+    }
+    default:
+        data.fill(char(0x80));
+        break;
+    }
+    return data;
+}
+
+void tst_bench_QAudioHelpers::multiplySamples_data()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("sampleFormat");
+
+    QTest::newRow("UInt8") << QAudioFormat::UInt8;
+    QTest::newRow("Int16") << QAudioFormat::Int16;
+    QTest::newRow("Int32") << QAudioFormat::Int32;
+    QTest::newRow("Float") << QAudioFormat::Float;
+}
+
+void tst_bench_QAudioHelpers::multiplySamples()
+{
+    QFETCH(QAudioFormat::SampleFormat, sampleFormat);
+
+    QAudioFormat format;
+    format.setSampleFormat(sampleFormat);
+    format.setChannelCount(2);
+    format.setSampleRate(48000);
+
+    const QByteArray src = noise(sampleFormat, BenchmarkSamples);
+    QByteArray dst(src.size(), Qt::Uninitialized);
+
+    QBENCHMARK {
+        qMultiplySamples(0.5, format, src.constData(), dst.data(), src.size());
+    }
+}
+
+void tst_bench_QAudioHelpers::multiplySamplesReference()
+{
+    QFETCH(QAudioFormat::SampleFormat, sampleFormat);
+
+    const QByteArray src = noise(sampleFormat, BenchmarkSamples);
+    QByteArray dst(src.size(), Qt::Uninitialized);
+
+    switch (sampleFormat) {
+    case QAudioFormat::Int16:
+        QBENCHMARK {
+            referenceMultiplySamples<qint16>(0.5, src.constData(), dst.data(), BenchmarkSamples);
+        }
+        break;
+    case QAudioFormat::Int32:
+        QBENCHMARK {
+            referenceMultiplySamples<qint32>(0.5, src.constData(), dst.data(), BenchmarkSamples);
+        }
+        break;
+    case QAudioFormat::Float:
+        QBENCHMARK {
+            referenceMultiplySamples<float>(0.5, src.constData(), dst.data(), BenchmarkSamples);
+        }
+        break;
+    default:
+        QSKIP("No reference implementation for this format");
+    }
+}
+
+void tst_bench_QAudioHelpers::multiplySamplesRamp()
+{
+    QFETCH(QAudioFormat::SampleFormat, sampleFormat);
+
+    QAudioFormat format;
+    format.setSampleFormat(sampleFormat);
+    format.setChannelCount(2);
+    format.setSampleRate(48000);
+
+    const QByteArray src = noise(sampleFormat, BenchmarkSamples);
+    QByteArray dst(src.size(), Qt::Uninitialized);
+
+    QBENCHMARK {
+        qMultiplySamples(0.25, 0.75, format, src.constData(), dst.data(), src.size());
+    }
+}
+
+void tst_bench_QAudioHelpers::accumulateSamples_data()
+{
+    QTest::addColumn<int>("voices");
+
+    QTest::newRow("1 voice") << 1;
+    QTest::newRow("8 voices") << 8;
+    QTest::newRow("32 voices") << 32;
+}
+
+// What the shared sound effect mixer does per period, for a second of audio
+void tst_bench_QAudioHelpers::accumulateSamples()
+{
+    QFETCH(int, voices);
+
+    const QByteArray src = noise(QAudioFormat::Float, BenchmarkSamples);
+    const auto *samples = reinterpret_cast<const float *>(src.constData());
+    std::vector<float> dst(BenchmarkSamples);
+
+    QBENCHMARK {
+        std::fill(dst.begin(), dst.end(), 0.f);
+        for (int i = 0; i < voices; ++i)
+            qAccumulateSamplesFloat(1.f / voices, samples, dst.data(), BenchmarkSamples);
+    }
+}
+
+QTEST_MAIN(tst_bench_QAudioHelpers)
+
+#include "tst_bench_qaudiohelpers.moc"
@@ -0,0 +1,218 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qmediacapturesession.h>
+#include <QtMultimedia/qmediaformat.h>
+#include <QtMultimedia/qmediarecorder.h>
+#include <QtMultimedia/qvideoframe.h>
+#include <QtMultimedia/private/qabstractvideobuffer_p.h>
+#include <QtMultimedia/private/qplatformcamera_p.h>
+#include <QtMultimedia/private/qplatformmediacapture_p.h>
+
+#include <vector>
+
+// Measures how long the media backend takes to record video, from the first frame of a
+// video source until the file is finalized. The frames need a conversion to the pixel format
+// of the encoder, which the FFmpeg backend pipelines with encoding unless the recorder is
+// limited to one encoding thread.
+
+namespace {
+
+// One second of 30 fps video
+constexpr int FrameCount = 30;
+constexpr qreal FrameRate = 30.;
+// Distinct source frames, so that the encoder doesn't just see a still image
+constexpr int SourceFrameCount = 8;
+constexpr int RecordingTimeout = 60000;
+
+constexpr QVideoFrameFormat::PixelFormat SourceFormat = QVideoFrameFormat::Format_BGRA8888;
+
+// Maps shared pixel data without copying it, so that every frame sent to the recorder is a
+// frame of its own without costing an allocation or a copy
+class SharedVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    SharedVideoBuffer(QByteArray data, int bytesPerLine)
+        : QAbstractVideoBuffer(QVideoFrame::NoHandle),
+          m_data(std::move(data)),
+          m_bytesPerLine(bytesPerLine)
+    {
+    }
+
+    QVideoFrame::MapMode mapMode() const override { return m_mapMode; }
+
+    MapData map(QVideoFrame::MapMode mode) override
+    {
+        MapData mapData;
+        if (m_mapMode != QVideoFrame::NotMapped || mode != QVideoFrame::ReadOnly)
+            return mapData;
+
+        m_mapMode = mode;
+        mapData.nPlanes = 1;
+        mapData.bytesPerLine[0] = m_bytesPerLine;
+        mapData.data[0] = reinterpret_cast<uchar *>(const_cast<char *>(m_data.constData()));
+        mapData.size[0] = int(m_data.size());
+        return mapData;
+    }
+
+    void unmap() override { m_mapMode = QVideoFrame::NotMapped; }
+
+private:
+    const QByteArray m_data;
+    const int m_bytesPerLine;
+    QVideoFrame::MapMode m_mapMode = QVideoFrame::NotMapped;
+};
+
+// A camera whose frames are pushed by the benchmark
+class FrameSource : public QPlatformCamera
+{
+public:
+    explicit FrameSource(const QSize &size) : QPlatformCamera(nullptr), m_size(size) { }
+
+    void setActive(bool active) override { m_active = active; }
+    bool isActive() const override { return m_active; }
+    void setCamera(const QCameraDevice &) override { }
+
+    QVideoFrameFormat frameFormat() const override
+    {
+        QVideoFrameFormat format(m_size, SourceFormat);
+        format.setFrameRate(FrameRate);
+        return format;
+    }
+
+    void sendFrame(const QByteArray &data, int index)
+    {
+        const int bytesPerLine = m_size.width() * 4;
+        QVideoFrame frame(new SharedVideoBuffer(data, bytesPerLine), frameFormat());
+        frame.setStartTime(qint64(index * 1000000 / FrameRate));
+        frame.setEndTime(qint64((index + 1) * 1000000 / FrameRate));
+        emit newVideoFrame(frame);
+    }
+
+private:
+    const QSize m_size;
+    bool m_active = true;
+};
+
+} // namespace
+
+class tst_bench_QFFmpegVideoEncoding : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void record_data();
+    void record();
+
+private:
+    static QByteArray sourceFrame(const QSize &size, int index);
+
+    QTemporaryDir m_tempDir;
+};
+
+QByteArray tst_bench_QFFmpegVideoEncoding::sourceFrame(const QSize &size, int index)
+{
+    QByteArray data(qsizetype(size.width()) * size.height() * 4, Qt::Uninitialized);
+
+    // A gradient moving with the index, as a camera pan would
+    auto *pixels = reinterpret_cast<quint32 *>(data.data());
+    for (int y = 0; y < size.height(); ++y) {
+        quint32 *line = pixels + qsizetype(y) * size.width();
+        for (int x = 0; x < size.width(); ++x) {
+            const quint32 value = quint32(x + y + index * 16);
+            line[x] = 0xff000000 | ((value & 0xff) << 16) | (((value >> 1) & 0xff) << 8)
+                    | ((value >> 2) & 0xff);
+        }
+    }
+
+    return data;
+}
+
+void tst_bench_QFFmpegVideoEncoding::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+
+    QMediaCaptureSession session;
+    if (!session.platformSession())
+        QSKIP("The media backend doesn't support capture sessions");
+
+    QMediaRecorder recorder;
+    if (!recorder.isAvailable())
+        QSKIP("The media backend doesn't support recording");
+}
+
+void tst_bench_QFFmpegVideoEncoding::record_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<QMediaRecorder::EncodingThreadType>("threadType");
+
+    QTest::newRow("1080p, 1 thread")
+            << QSize(1920, 1080) << 1 << QMediaRecorder::AutomaticThreading;
+    QTest::newRow("1080p, automatic threads")
+            << QSize(1920, 1080) << -1 << QMediaRecorder::AutomaticThreading;
+    QTest::newRow("1080p, slice threads")
+            << QSize(1920, 1080) << -1 << QMediaRecorder::SliceThreading;
+    QTest::newRow("2160p, automatic threads")
+            << QSize(3840, 2160) << -1 << QMediaRecorder::AutomaticThreading;
+    QTest::newRow("2160p, slice threads")
+            << QSize(3840, 2160) << -1 << QMediaRecorder::SliceThreading;
+}
+
+void tst_bench_QFFmpegVideoEncoding::record()
+{
+    QFETCH(QSize, size);
+    QFETCH(int, threadCount);
+    QFETCH(QMediaRecorder::EncodingThreadType, threadType);
+
+    std::vector<QByteArray> sources;
+    for (int i = 0; i < SourceFrameCount; ++i)
+        sources.push_back(sourceFrame(size, i));
+
+    QMediaFormat format(QMediaFormat::MPEG4);
+    if (format.supportedVideoCodecs(QMediaFormat::Encode).contains(QMediaFormat::VideoCodec::H264))
+        format.setVideoCodec(QMediaFormat::VideoCodec::H264);
+
+    FrameSource source(size);
+    QMediaCaptureSession session;
+    QMediaRecorder recorder;
+    session.setRecorder(&recorder);
+    session.platformSession()->setCamera(&source);
+
+    recorder.setMediaFormat(format);
+    recorder.setVideoResolution(size);
+    recorder.setVideoFrameRate(FrameRate);
+    recorder.setEncodingThreadCount(threadCount);
+    recorder.setEncodingThreadType(threadType);
+    // The frames come faster than real time; none of them may be dropped
+    recorder.setEncodingQueueDepth(FrameCount);
+
+    int recording = 0;
+    // Each iteration records FrameCount frames from scratch, including finalizing the file
+    QBENCHMARK {
+        const QString fileName = m_tempDir.filePath(QStringLiteral("recording%1").arg(recording++));
+        recorder.setOutputLocation(QUrl::fromLocalFile(fileName));
+
+        recorder.record();
+        QTRY_COMPARE(recorder.recorderState(), QMediaRecorder::RecordingState);
+
+        for (int i = 0; i < FrameCount; ++i)
+            source.sendFrame(sources[i % sources.size()], i);
+
+        recorder.stop();
+        QTRY_COMPARE_WITH_TIMEOUT(recorder.recorderState(), QMediaRecorder::StoppedState,
+                                  RecordingTimeout);
+
+        QCOMPARE(recorder.error(), QMediaRecorder::NoError);
+        QCOMPARE(recorder.droppedFrames(), qint64(0));
+        QVERIFY(QFileInfo(recorder.actualLocation().toLocalFile()).size() > 0);
+    }
+
+    session.platformSession()->setCamera(nullptr);
+}
+
+QTEST_MAIN(tst_bench_QFFmpegVideoEncoding)
+
+#include "tst_bench_qffmpegvideoencoding.moc"
@@ -0,0 +1,96 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qmediaplayer.h>
+#include <QtMultimedia/qvideosink.h>
+#include <QtMultimedia/qvideoframe.h>
+
+#include <array>
+
+// Measures the time from setting the position of a paused player until the video frame
+// of the new position is shown, as when scrubbing through a video or stepping frames.
+//
+// The short clip of the test data keeps the distance to the preceding key frame small;
+// set QT_BENCH_SEEKING_MEDIA to the path of a long video for realistic numbers.
+
+// Positions spread over the media and visited out of order, as when scrubbing
+static constexpr std::array SeekFractions = { 0.5, 0.1, 0.9, 0.3, 0.7, 0.2, 0.8 };
+static constexpr int FrameTimeout = 10000;
+
+class tst_bench_QMediaPlayerSeeking : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void seek_data();
+    void seek();
+
+private:
+    QUrl m_media;
+};
+
+void tst_bench_QMediaPlayerSeeking::initTestCase()
+{
+    const QString path = qEnvironmentVariable("QT_BENCH_SEEKING_MEDIA");
+    if (!path.isEmpty()) {
+        m_media = QUrl::fromLocalFile(path);
+        return;
+    }
+
+    const QString testData =
+            QFINDTESTDATA("../../../auto/integration/qmediaplayerbackend/testdata/colors.mp4");
+    if (testData.isEmpty())
+        QSKIP("No media to seek in");
+
+    m_media = QUrl::fromLocalFile(testData);
+}
+
+void tst_bench_QMediaPlayerSeeking::seek_data()
+{
+    QTest::addColumn<QMediaPlayer::SeekMode>("seekMode");
+
+    QTest::newRow("accurate") << QMediaPlayer::AccurateSeek;
+    QTest::newRow("key frame") << QMediaPlayer::KeyFrameSeek;
+}
+
+void tst_bench_QMediaPlayerSeeking::seek()
+{
+    QFETCH(QMediaPlayer::SeekMode, seekMode);
+
+    QMediaPlayer player;
+    QVideoSink sink;
+    player.setVideoSink(&sink);
+    player.setSeekMode(seekMode);
+    player.setSource(m_media);
+
+    QTRY_VERIFY_WITH_TIMEOUT(player.mediaStatus() == QMediaPlayer::LoadedMedia
+                                     || player.mediaStatus() == QMediaPlayer::InvalidMedia,
+                             FrameTimeout);
+    if (player.mediaStatus() == QMediaPlayer::InvalidMedia || !player.hasVideo())
+        QSKIP("The media backend can't play the video");
+    if (!player.isSeekable())
+        QSKIP("The media backend can't seek in the video");
+
+    QSignalSpy frames(&sink, &QVideoSink::videoFrameChanged);
+    player.pause();
+    QVERIFY(!frames.isEmpty() || frames.wait(FrameTimeout));
+
+    const qint64 duration = player.duration();
+    QVERIFY(duration > 0);
+
+    size_t index = 0;
+    QBENCHMARK {
+        frames.clear();
+        const auto fraction = SeekFractions[index++ % SeekFractions.size()];
+        player.setPosition(qint64(duration * fraction));
+
+        // The frame may come before we start waiting
+        QVERIFY(!frames.isEmpty() || frames.wait(FrameTimeout));
+    }
+}
+
+QTEST_MAIN(tst_bench_QMediaPlayerSeeking)
+
+#include "tst_bench_qmediaplayerseeking.moc"
@@ -0,0 +1,119 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <private/qambisonicdecoder_p.h>
+
+#include <cmath>
+#include <vector>
+
+class tst_bench_QAmbisonicDecoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void processBuffer_data();
+    void processBuffer();
+    void processBufferWithReverb_data() { processBuffer_data(); }
+    void processBufferWithReverb();
+};
+
+// One period of the audio engine at 48 kHz
+static constexpr int BenchmarkFrames = 1024;
+
+// The decoder does the same work for any input, it only has to stay in range
+static std::vector<float> testSignal(int channel)
+{
+    std::vector<float> data(BenchmarkFrames);
+    for (int i = 0; i < BenchmarkFrames; ++i)
+        data[i] = 0.25f * std::sin(0.01f * (channel + 1) * i);
+    return data;
+}
+
+void tst_bench_QAmbisonicDecoder::processBuffer_data()
+{
+    QTest::addColumn<int>("level");
+    QTest::addColumn<int>("channelConfig");
+
+    const struct {
+        const char *name;
+        QAudioFormat::ChannelConfig config;
+    } layouts[] = {
+        { "Mono", QAudioFormat::ChannelConfigMono },
+        { "Stereo", QAudioFormat::ChannelConfigStereo },
+        { "2.1", QAudioFormat::ChannelConfig2Dot1 },
+        { "3.0", QAudioFormat::ChannelConfig3Dot0 },
+        { "3.1", QAudioFormat::ChannelConfig3Dot1 },
+        { "5.0", QAudioFormat::ChannelConfigSurround5Dot0 },
+        { "5.1", QAudioFormat::ChannelConfigSurround5Dot1 },
+        { "7.0", QAudioFormat::ChannelConfigSurround7Dot0 },
+        { "7.1", QAudioFormat::ChannelConfigSurround7Dot1 },
+    };
+
+    for (int level = QAmbisonicDecoder::AmbisonicLevel1;
+         level <= QAmbisonicDecoder::maxAmbisonicLevel; ++level) {
+        for (const auto &layout : layouts) {
+            QTest::addRow("Level%d %s", level, layout.name)
+                    << level << int(layout.config);
+        }
+    }
+}
+
+void tst_bench_QAmbisonicDecoder::processBuffer()
+{
+    QFETCH(int, level);
+    QFETCH(int, channelConfig);
+
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Float);
+    format.setSampleRate(48000);
+    format.setChannelConfig(QAudioFormat::ChannelConfig(channelConfig));
+
+    QAmbisonicDecoder decoder(QAmbisonicDecoder::AmbisonicLevel(level), format);
+    QVERIFY(decoder.hasValidConfig());
+
+    std::vector<float> channels[QAmbisonicDecoder::maxAmbisonicChannels];
+    const float *input[QAmbisonicDecoder::maxAmbisonicChannels];
+    for (int i = 0; i < decoder.nInputChannels(); ++i) {
+        channels[i] = testSignal(i);
+        input[i] = channels[i].data();
+    }
+    std::vector<float> output(decoder.outputSize(BenchmarkFrames));
+
+    QBENCHMARK {
+        decoder.processBuffer(input, output.data(), BenchmarkFrames);
+    }
+}
+
+void tst_bench_QAmbisonicDecoder::processBufferWithReverb()
+{
+    QFETCH(int, level);
+    QFETCH(int, channelConfig);
+
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Int16);
+    format.setSampleRate(48000);
+    format.setChannelConfig(QAudioFormat::ChannelConfig(channelConfig));
+
+    QAmbisonicDecoder decoder(QAmbisonicDecoder::AmbisonicLevel(level), format);
+    QVERIFY(decoder.hasValidConfig());
+
+    std::vector<float> channels[QAmbisonicDecoder::maxAmbisonicChannels];
+    const float *input[QAmbisonicDecoder::maxAmbisonicChannels];
+    for (int i = 0; i < decoder.nInputChannels(); ++i) {
+        channels[i] = testSignal(i);
+        input[i] = channels[i].data();
+    }
+    const std::vector<float> reverbLeft = testSignal(100);
+    const std::vector<float> reverbRight = testSignal(101);
+    const float *reverb[2] = { reverbLeft.data(), reverbRight.data() };
+    std::vector<short> output(decoder.outputSize(BenchmarkFrames));
+
+    QBENCHMARK {
+        decoder.processBufferWithReverb(input, reverb, output.data(), BenchmarkFrames);
+    }
+}
+
+QTEST_MAIN(tst_bench_QAmbisonicDecoder)
+
+#include "tst_bench_qambisonicdecoder.moc"